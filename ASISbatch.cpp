@@ -0,0 +1,530 @@
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// ASISbatch.cpp
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the batch receive of ASIS messages
+//
+// V1.2.0	2026-10-19	Added batch receive of ASIS messages
+//					Batch receive reads capture files with any number of messages
+//					.png files are written 1 bit per pixel with PNGwriter instead of GDI+
+//					The message image is an Image<int> that the BCAengine takes
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+//	Batch receive decodes every ASIS message in the .bin files in a directory
+//	(or that match a wildcard file pattern) the same way as the Receive ASIS dialog:
+//		read message, BCA iterations from the footer
+//		run the BCA with the single point CW rules
+//		save the .raw image, and optionally the .bmp and .png images
+//	Each file can be a single message or a capture with any number of messages,
+//	see ASIScontainer.h.  Files are decoded on a pool of worker threads, one per
+//	processor.  Each message is kept in memory from the .bin file to the image
+//	files, the .bmp and .png files are made from the BCA image, not read back
+//	from the .raw file.  The output files use the input filename in the output
+//	directory, with _0001, _0002, ... added unless the file is exactly one message.
+//	A summary .csv file has one line per message.
+//
+#include "framework.h"
+#include <stdio.h>
+#include <limits.h>
+#include <vector>
+#include <algorithm>
+#include <atlstr.h>
+#include "globals.h"
+#include "AppErrors.h"
+#include "Appfunctions.h"
+#include "imageheader.h"
+#include "FileFunctions.h"
+#include "CA.h"
+#include "Image.h"
+#include "BCAengine.h"
+#include "ASIScontainer.h"
+#include "ASISbatch.h"
+#include "PNGwriter.h"
+
+// shared by the batch worker threads
+typedef struct {
+	ASISBATCHFILE* Files;		// files to decode
+	LONG NumFiles;
+	volatile LONG NextFile;		// next file to decode
+	ASISFORMAT Format;			// message layout
+	WCHAR* OutputDir;
+	BOOL SaveBMPfile;
+	BOOL SavePNGfile;
+	int PNGlevel;				// deflate level of the .png files
+} ASISBATCHWORK;
+
+static int ListASISfiles(WCHAR* Input, std::vector<ASISBATCHFILE>& Files);
+static int ReceiveASISfile(ASISBATCHFILE* File, ASISBATCHWORK* Work);
+static int ReceiveASISitem(ASISBATCHITEM* Item, ASISVIEW* View, WCHAR* Filename,
+	BOOL SingleMessage, ASISBATCHWORK* Work);
+static int SaveBatchRaw(WCHAR* Filename, int* Image, IMAGINGHEADER* Header);
+static DWORD WINAPI ASISbatchProc(LPVOID Param);
+
+//*******************************************************************************
+//
+//  ReceiveASISbatch
+//
+// Decode every ASIS message in a directory or matching a file pattern
+//
+// Parameters:
+//	WCHAR* Input		directory (all .bin files in it) or file pattern
+//						with wildcards, i.e. C:\Captures\Data*.bin
+//	WCHAR* OutputDir	directory for the decoded images
+//	WCHAR* SummaryFile	summary .csv file
+//	ASISFORMAT* Format	message layout
+//	BOOL SaveBMPfile	TRUE also save .bmp image files
+//	BOOL SavePNGfile	TRUE also save .png image files
+//	int* NumFiles		returns # of files found
+//	int* NumMessages	returns # of messages found
+//	int* NumFailed		returns # of messages that could not be decoded
+//						or whose images could not be saved, and files
+//						with no messages
+//
+//	return value:
+//	1 - Success, the summary shows the results for each message
+//	!=1 Error see standardized app error list in AppErrors.h
+//
+//*******************************************************************************
+int ReceiveASISbatch(WCHAR* Input, WCHAR* OutputDir, WCHAR* SummaryFile, ASISFORMAT* Format,
+	BOOL SaveBMPfile, BOOL SavePNGfile, int* NumFiles, int* NumMessages, int* NumFailed)
+{
+	std::vector<ASISBATCHFILE> Files;
+	ASISBATCHWORK Work;
+	int iRes;
+
+	*NumFiles = 0;
+	*NumMessages = 0;
+	*NumFailed = 0;
+
+	iRes = ListASISfiles(Input, Files);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+	*NumFiles = (int)Files.size();
+
+	Work.Files = Files.data();
+	Work.NumFiles = (LONG)Files.size();
+	Work.NextFile = 0;
+	Work.Format = *Format;
+	Work.OutputDir = OutputDir;
+	Work.SaveBMPfile = SaveBMPfile;
+	Work.SavePNGfile = SavePNGfile;
+
+	Work.PNGlevel = GetPNGlevel();
+
+	SYSTEM_INFO SysInfo;
+	int NumThreads;
+
+	GetSystemInfo(&SysInfo);
+	NumThreads = (int)SysInfo.dwNumberOfProcessors;
+	if (NumThreads > MAXIMUM_WAIT_OBJECTS) NumThreads = MAXIMUM_WAIT_OBJECTS;
+	if (NumThreads > (int)Work.NumFiles) NumThreads = (int)Work.NumFiles;
+	if (NumThreads < 1) NumThreads = 1;
+
+	std::vector<HANDLE> Threads(NumThreads);
+	int Started = 0;
+	for (int t = 0; t < NumThreads; t++) {
+		Threads[t] = CreateThread(NULL, 0, ASISbatchProc, &Work, 0, NULL);
+		if (Threads[t] == NULL) {
+			break;
+		}
+		Started++;
+	}
+	if (Started == 0) {
+		// no threads, decode them all here
+		ASISbatchProc(&Work);
+	}
+	for (int t = 0; t < Started; t++) {
+		WaitForSingleObject(Threads[t], INFINITE);
+		CloseHandle(Threads[t]);
+	}
+
+	// write summary, in file name order
+	FILE* Out;
+	_wfopen_s(&Out, SummaryFile, L"w");
+	if (Out == NULL) {
+		return APPERR_FILEOPEN;
+	}
+
+	fprintf(Out, "File, Message, Bit offset, Status, Iterations, X size, Y size, "
+		"Bits set in message, Bits set in image, Header, Footer\n");
+	for (auto& File : Files) {
+		WCHAR Fname[_MAX_FNAME];
+		WCHAR Ext[_MAX_EXT];
+
+		_wsplitpath_s(File.Filename, NULL, 0, NULL, 0, Fname, _MAX_FNAME, Ext, _MAX_EXT);
+		if (File.Status != APP_SUCCESS && File.Messages.size() == 0) {
+			(*NumFailed)++;
+			fprintf(Out, "\"%ls%ls\", , , %d\n", Fname, Ext, File.Status);
+			continue;
+		}
+		for (auto& Item : File.Messages) {
+			(*NumMessages)++;
+			if (Item.Status != APP_SUCCESS) {
+				(*NumFailed)++;
+			}
+			fprintf(Out, "\"%ls%ls\", %d, %lld, %d, %d, %d, %d, %d, %d, ", Fname, Ext,
+				Item.Index + 1, Item.FileBitOffset, Item.Status, Item.Iterations,
+				Item.Xsize, Item.Ysize, Item.BitCountIn, Item.BitCountOut);
+			for (int i = 0; i < 10; i++) {
+				fprintf(Out, "%02X", Item.Header[i]);
+			}
+			fprintf(Out, ", ");
+			for (int i = 0; i < 10; i++) {
+				fprintf(Out, "%02X", Item.Footer[i]);
+			}
+			fprintf(Out, "\n");
+		}
+		if (File.Status != APP_SUCCESS) {
+			// read error after some messages
+			(*NumFailed)++;
+			fprintf(Out, "\"%ls%ls\", , , %d\n", Fname, Ext, File.Status);
+		}
+	}
+
+	iRes = APP_SUCCESS;
+	if (ferror(Out)) {
+		iRes = APPERR_FILEWRITE;
+	}
+	fclose(Out);
+
+	return iRes;
+}
+
+//*******************************************************************************
+//
+//  ListASISfiles
+//
+// Find the files to decode, sorted by filename
+//
+//*******************************************************************************
+static int ListASISfiles(WCHAR* Input, std::vector<ASISBATCHFILE>& Files)
+{
+	WCHAR Pattern[MAX_PATH];
+	WCHAR Drive[_MAX_DRIVE];
+	WCHAR Dir[_MAX_DIR];
+	DWORD Attributes;
+	int err;
+
+	Attributes = GetFileAttributes(Input);
+	if (Attributes != INVALID_FILE_ATTRIBUTES && (Attributes & FILE_ATTRIBUTE_DIRECTORY)) {
+		// all the .bin files in the directory
+		size_t Length = wcslen(Input);
+		if (Length > 0 && (Input[Length - 1] == L'\\' || Input[Length - 1] == L'/')) {
+			err = swprintf_s(Pattern, MAX_PATH, L"%s*.bin", Input);
+		}
+		else {
+			err = swprintf_s(Pattern, MAX_PATH, L"%s\\*.bin", Input);
+		}
+		if (err < 0) {
+			return APPERR_PARAMETER;
+		}
+	}
+	else {
+		wcscpy_s(Pattern, MAX_PATH, Input);
+	}
+
+	err = _wsplitpath_s(Pattern, Drive, _MAX_DRIVE, Dir, _MAX_DIR, NULL, 0, NULL, 0);
+	if (err != 0) {
+		return APPERR_PARAMETER;
+	}
+
+	WIN32_FIND_DATA FindData;
+	HANDLE hFind;
+
+	hFind = FindFirstFile(Pattern, &FindData);
+	if (hFind == INVALID_HANDLE_VALUE) {
+		return APPERR_FILEOPEN;
+	}
+	do {
+		if (FindData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+			continue;
+		}
+		ASISBATCHFILE File;
+		File.Status = APPERR_PARAMETER;
+		err = _wmakepath_s(File.Filename, MAX_PATH, Drive, Dir, FindData.cFileName, NULL);
+		if (err != 0) {
+			continue;
+		}
+		Files.push_back(File);
+	} while (FindNextFile(hFind, &FindData));
+	FindClose(hFind);
+
+	if (Files.size() == 0) {
+		return APPERR_FILEOPEN;
+	}
+
+	std::sort(Files.begin(), Files.end(), [](const ASISBATCHFILE& a, const ASISBATCHFILE& b) {
+		return _wcsicmp(a.Filename, b.Filename) < 0;
+		});
+
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  ASISbatchProc
+//
+// Worker thread, decodes files until there are none left
+//
+//*******************************************************************************
+static DWORD WINAPI ASISbatchProc(LPVOID Param)
+{
+	ASISBATCHWORK* Work = (ASISBATCHWORK*)Param;
+	LONG Next;
+
+	while ((Next = InterlockedIncrement(&Work->NextFile) - 1) < Work->NumFiles) {
+		Work->Files[Next].Status = ReceiveASISfile(&Work->Files[Next], Work);
+	}
+	return 0;
+}
+
+//*******************************************************************************
+//
+//  ReceiveASISfile
+//
+// Decode all the messages in one file, the file is read once
+//
+//*******************************************************************************
+static int ReceiveASISfile(ASISBATCHFILE* File, ASISBATCHWORK* Work)
+{
+	ASISreader Reader;
+	ASISVIEW View;
+	BOOL SingleMessage = FALSE;
+	int iRes;
+
+	iRes = Reader.Open(File->Filename, &Work->Format);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	// a file that is exactly one message keeps its name for the outputs
+	if (Work->Format.Ysize > 0) {
+		int Xsize = (Work->Format.Xsize > 0) ? Work->Format.Xsize : Work->Format.Ysize;
+		__int64 MessageBits = ASIS_SYNC_BITS + (__int64)Xsize * Work->Format.Ysize + Work->Format.FooterBits;
+		SingleMessage = (Reader.GetFileSize() * 8 == MessageBits);
+	}
+
+	while ((iRes = Reader.Next(&View)) == 1) {
+		ASISBATCHITEM Item;
+		memset(&Item, 0, sizeof(ASISBATCHITEM));
+		Item.Index = View.Index;
+		Item.FileBitOffset = View.FileBitOffset;
+		Item.Status = ReceiveASISitem(&Item, &View, File->Filename, SingleMessage, Work);
+		File->Messages.push_back(Item);
+	}
+	if (iRes < 0) {
+		return iRes;
+	}
+	if (File->Messages.size() == 0) {
+		// no sync header in the file
+		return APPERR_FILETYPE;
+	}
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  ReceiveASISitem
+//
+// Decode one message and save its images
+//
+//*******************************************************************************
+static int ReceiveASISitem(ASISBATCHITEM* Item, ASISVIEW* View, WCHAR* Filename,
+	BOOL SingleMessage, ASISBATCHWORK* Work)
+{
+	// single point CW rules for BCA, same as the Receive ASIS dialog
+	int Rules[16] = { 0, 2, 8, 3, 1, 5, 6, 7, 4, 9,10,11,12,13,14,15 };
+	IMAGINGHEADER ImageHeader;
+	Image<int> InputImage;
+	int StopReason;
+	int iRes;
+
+	ASISviewBits(View, 0, ASIS_SYNC_BITS, Item->Header);
+	ASISviewBits(View, ASIS_SYNC_BITS + View->BodyBits, View->FooterBits, Item->Footer);
+	Item->Xsize = View->Xsize;
+	Item->Ysize = View->Ysize;
+
+	FOOTERDECODE Decode[FOOTER_NUM_CONVENTIONS];
+	if (DecodeUnaryFooter(Item->Footer, View->FooterBits, Decode) != APP_SUCCESS ||
+		Decode[0].Overflow || Decode[0].Iterations > INT_MAX) {
+		return APPERR_PARAMETER;
+	}
+	Item->Iterations = (int)Decode[0].Iterations;
+
+	iRes = InputImage.Create(View->Xsize, View->Ysize, 1, FALSE);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+	Item->BitCountIn = ASISviewImage(View, InputImage.GetPixels());
+
+	ImageHeader.Endian = (short)-1;  // PC format
+	ImageHeader.HeaderSize = (short)sizeof(IMAGINGHEADER);
+	ImageHeader.ID = (short)0xaaaa;
+	ImageHeader.Version = (short)1;
+	ImageHeader.NumFrames = (short)1;
+	ImageHeader.PixelSize = 1;
+	ImageHeader.Xsize = View->Xsize;
+	ImageHeader.Ysize = View->Ysize;
+	for (int i = 0; i < 6; i++) {
+		ImageHeader.Padding[i] = 0;
+	}
+
+	// the engine owns InputImage from here on
+	BCAengine Engine;
+	iRes = Engine.AttachImage(std::move(InputImage), &ImageHeader);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+	Engine.SetRules(Rules, Rules);
+
+	// EvenStep is true if the number of iterations is odd
+	Engine.SetEvenStep((Item->Iterations % 2) ? TRUE : FALSE);
+	Engine.Run(TRUE, Item->Iterations, Item->Iterations, &StopReason);
+	Item->BitCountOut = Engine.GetBitCount();
+
+	// output filenames
+	WCHAR Fname[_MAX_FNAME];
+	WCHAR OutputFile[MAX_PATH];
+	int err;
+
+	err = _wsplitpath_s(Filename, NULL, 0, NULL, 0, Fname, _MAX_FNAME, NULL, 0);
+	if (err != 0) {
+		return APPERR_PARAMETER;
+	}
+	if (!SingleMessage) {
+		WCHAR Number[16];
+		swprintf_s(Number, 16, L"_%04d", Item->Index + 1);
+		if (wcscat_s(Fname, _MAX_FNAME, Number) != 0) {
+			return APPERR_PARAMETER;
+		}
+	}
+
+	err = _wmakepath_s(OutputFile, MAX_PATH, NULL, Work->OutputDir, Fname, L".raw");
+	if (err != 0) {
+		return APPERR_PARAMETER;
+	}
+	iRes = SaveBatchRaw(OutputFile, Engine.GetImage().GetPixels(), &ImageHeader);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	if (!Work->SaveBMPfile && !Work->SavePNGfile) {
+		return APP_SUCCESS;
+	}
+
+	// greyscale image for the .bmp and .png files
+	int* Pixels = Engine.GetImage().GetPixels();
+	int NumPixels = ImageHeader.Xsize * ImageHeader.Ysize;
+	COLORREF* Colors = new COLORREF[(size_t)NumPixels];
+	if (Colors == nullptr) {
+		return APPERR_MEMALLOC;
+	}
+	for (int i = 0; i < NumPixels; i++) {
+		BYTE Grey = (Pixels[i] != 0) ? 255 : 0;
+		Colors[i] = RGB(Grey, Grey, Grey);
+	}
+
+	if (Work->SaveBMPfile) {
+		err = _wmakepath_s(OutputFile, MAX_PATH, NULL, Work->OutputDir, Fname, L".bmp");
+		if (err != 0) {
+			delete[] Colors;
+			return APPERR_PARAMETER;
+		}
+		iRes = SaveImageBMP(OutputFile, Colors, ImageHeader.Xsize, ImageHeader.Ysize);
+		if (iRes != APP_SUCCESS) {
+			delete[] Colors;
+			return iRes;
+		}
+	}
+
+	// with AutoPNG set SaveImageBMP() has already saved the same .png file
+	if (Work->SavePNGfile && !(Work->SaveBMPfile && AutoPNG)) {
+		err = _wmakepath_s(OutputFile, MAX_PATH, NULL, Work->OutputDir, Fname, L".png");
+		if (err != 0) {
+			delete[] Colors;
+			return APPERR_PARAMETER;
+		}
+		// the image is binary, 1 bit per pixel
+		size_t RowBytes = ((size_t)ImageHeader.Xsize + 7) / 8;
+		std::vector<BYTE> Bits(RowBytes * ImageHeader.Ysize);
+		for (int y = 0; y < ImageHeader.Ysize; y++) {
+			PackPixelBits(Pixels + (size_t)y * ImageHeader.Xsize, ImageHeader.Xsize,
+				Bits.data() + y * RowBytes, FALSE);
+		}
+		PNGIMAGE PNGImage;
+		PNGImage.Xsize = ImageHeader.Xsize;
+		PNGImage.Ysize = ImageHeader.Ysize;
+		PNGImage.Format = PNG_GREY1;
+		PNGImage.Stride = RowBytes;
+		PNGImage.Pixels = Bits.data();
+		iRes = SavePNG(OutputFile, &PNGImage, Work->PNGlevel);
+		if (iRes != APP_SUCCESS) {
+			delete[] Colors;
+			return iRes;
+		}
+	}
+
+	delete[] Colors;
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  SaveBatchRaw
+//
+// Save a decoded message image as a .raw file, 1 byte pixels.
+// This is SaveImageFile() without the message box, it is called from the
+// worker threads and the errors are reported in the summary file.
+//
+//*******************************************************************************
+static int SaveBatchRaw(WCHAR* Filename, int* Image, IMAGINGHEADER* Header)
+{
+	FILE* Out;
+	size_t NumPixels = (size_t)Header->Xsize * Header->Ysize * Header->NumFrames;
+	int iRes = APP_SUCCESS;
+
+	if (Header->PixelSize != 1) {
+		return APPERR_PARAMETER;
+	}
+
+	BYTE* Pixels = new BYTE[NumPixels];
+	if (Pixels == nullptr) {
+		return APPERR_MEMALLOC;
+	}
+	for (size_t i = 0; i < NumPixels; i++) {
+		Pixels[i] = (Image[i] > 255) ? 255 : (BYTE)Image[i];
+	}
+
+	_wfopen_s(&Out, Filename, L"wb");
+	if (Out == NULL) {
+		delete[] Pixels;
+		return APPERR_FILEOPEN;
+	}
+	if (fwrite(Header, sizeof(IMAGINGHEADER), 1, Out) != 1 ||
+		fwrite(Pixels, 1, NumPixels, Out) != NumPixels) {
+		iRes = APPERR_FILEWRITE;
+	}
+	fclose(Out);
+	delete[] Pixels;
+
+	return iRes;
+}
@@ -0,0 +1,54 @@
+#pragma once
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// ASISbatch.h
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+// V1.2.0	2026-10-19	Added batch receive of ASIS messages
+//					Batch receive reads capture files with any number of messages
+//
+#include "framework.h"
+#include <vector>
+#include "ASIScontainer.h"
+
+// results for one message in a batch receive
+typedef struct {
+	int Index;					// message # in the capture file
+	__int64 FileBitOffset;		// # of bits before the message in the file
+	int Status;					// APP_SUCCESS or error from decoding this message
+	int Iterations;				// BCA iterations from the footer
+	int Xsize;					// image size
+	int Ysize;
+	int BitCountIn;				// # bits set in the message image
+	int BitCountOut;			// # bits set in the image after the BCA
+	BYTE Header[10];
+	BYTE Footer[10];
+} ASISBATCHITEM;
+
+// one capture file in a batch receive
+typedef struct {
+	WCHAR Filename[MAX_PATH];	// ASIS message or capture .bin file
+	int Status;					// APP_SUCCESS or error reading the file
+	std::vector<ASISBATCHITEM> Messages;
+} ASISBATCHFILE;
+
+int ReceiveASISbatch(WCHAR* Input, WCHAR* OutputDir, WCHAR* SummaryFile, ASISFORMAT* Format,
+	BOOL SaveBMPfile, BOOL SavePNGfile, int* NumFiles, int* NumMessages, int* NumFailed);
@@ -0,0 +1,492 @@
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// ASIScontainer.cpp
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the definitions of the ASISreader class methods/functions
+//
+// V1.2.0	2026-10-19	Added ASISreader class, streaming ASIS message container parser
+//					LoadBigEndian64() is shared from BitOrder.h
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+//	Sync headers are found at any bit offset.  For each byte the 8 possible
+//	bit offsets are checked with two 64 bit big endian loads, only bytes
+//	followed by a 0xFF byte can start a sync header so most bytes are skipped
+//	with one compare.
+//
+//	With a fixed image size the search for the next sync header starts after
+//	the end of the message, the body is never searched.  With variable size
+//	messages the body is everything up to the footer before the next sync header.
+//
+#include "framework.h"
+#include <stdio.h>
+#include <limits.h>
+#include <cmath>
+#include "AppErrors.h"
+#include "imageheader.h"
+#include "CA.h"
+#include "BitOrder.h"
+#include "ASIScontainer.h"
+
+#define ASIS_READ_BLOCK (1 << 20)	// initial buffer size and read size
+#define ASIS_READ_PAD 16			// 0 bytes after the data for the 64 bit loads
+
+#define ASIS_SYNC_HEAD 0xFFFF0690u	// first 32 bits of the sync header
+#define ASIS_SYNC_TAIL 0x44884488u	// last 32 bits of the sync header
+
+//*******************************************************************************
+//
+//  ASISreader()
+//  class constructor
+//
+//*******************************************************************************
+ASISreader::ASISreader()
+{
+	Format.FooterBits = ASIS_MAX_FOOTER_BITS;
+	Format.Xsize = 256;
+	Format.Ysize = 256;
+}
+
+//*******************************************************************************
+//
+//  ~ASISreader()
+//  class destructor
+//
+//*******************************************************************************
+ASISreader::~ASISreader()
+{
+	Close();
+}
+
+//*******************************************************************************
+//
+//  Open
+//
+// Open an ASIS capture file for reading
+//
+// Parameters:
+//	WCHAR* Filename				capture file
+//	ASISFORMAT* MessageFormat	message layout
+//
+//	return value:
+//	1 - Success
+//	!=1 Error see standardized app error list in AppErrors.h
+//
+//*******************************************************************************
+int ASISreader::Open(WCHAR* Filename, ASISFORMAT* MessageFormat)
+{
+	Close();
+
+	if (MessageFormat->FooterBits < 1 || MessageFormat->FooterBits > ASIS_MAX_FOOTER_BITS ||
+		MessageFormat->Xsize < 0 || MessageFormat->Ysize < 0) {
+		return APPERR_PARAMETER;
+	}
+	if (MessageFormat->Ysize > 0) {
+		int Xsize = (MessageFormat->Xsize > 0) ? MessageFormat->Xsize : MessageFormat->Ysize;
+		if ((__int64)Xsize * MessageFormat->Ysize > INT_MAX - 2 * ASIS_SYNC_BITS) {
+			return APPERR_PARAMETER;
+		}
+	}
+	Format = *MessageFormat;
+
+	_wfopen_s(&In, Filename, L"rb");
+	if (In == NULL) {
+		return APPERR_FILEOPEN;
+	}
+	_fseeki64(In, 0, SEEK_END);
+	FileSize = _ftelli64(In);
+	_fseeki64(In, 0, SEEK_SET);
+
+	Buffer = new BYTE[(size_t)ASIS_READ_BLOCK + ASIS_READ_PAD];
+	if (Buffer == nullptr) {
+		fclose(In);
+		In = NULL;
+		return APPERR_MEMALLOC;
+	}
+	BufferSize = ASIS_READ_BLOCK;
+	memset(Buffer, 0, ASIS_READ_PAD);
+
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  Close
+//
+//*******************************************************************************
+void ASISreader::Close()
+{
+	if (In != NULL) {
+		fclose(In);
+		In = NULL;
+	}
+	if (Buffer != nullptr) {
+		delete[] Buffer;
+		Buffer = nullptr;
+	}
+	BufferSize = 0;
+	DataEnd = 0;
+	BufferBitBase = 0;
+	SearchBit = 0;
+	EndOfFile = FALSE;
+	NumMessages = 0;
+	SkippedBits = 0;
+	FileSize = 0;
+}
+
+//*******************************************************************************
+//
+//  Fill
+//
+// Read the next block of the file into the buffer, the buffer is made
+// larger if it is full.
+//
+//	return value:
+//	1 - Success (EndOfFile is set at the end of the file)
+//	!=1 Error see standardized app error list in AppErrors.h
+//
+//*******************************************************************************
+int ASISreader::Fill()
+{
+	if (EndOfFile) {
+		return APP_SUCCESS;
+	}
+
+	if (BufferSize - DataEnd < ASIS_READ_BLOCK / 2) {
+		// message is larger than the buffer
+		size_t NewSize = BufferSize * 2;
+		BYTE* NewBuffer = new BYTE[NewSize + ASIS_READ_PAD];
+		if (NewBuffer == nullptr) {
+			return APPERR_MEMALLOC;
+		}
+		memcpy(NewBuffer, Buffer, DataEnd);
+		delete[] Buffer;
+		Buffer = NewBuffer;
+		BufferSize = NewSize;
+	}
+
+	size_t iRead = fread(Buffer + DataEnd, 1, BufferSize - DataEnd, In);
+	if (iRead == 0) {
+		EndOfFile = TRUE;
+		if (ferror(In)) {
+			return APPERR_FILEREAD;
+		}
+	}
+	DataEnd += iRead;
+	memset(Buffer + DataEnd, 0, ASIS_READ_PAD);
+
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  Compact
+//
+// Drop the bytes before the search position from the buffer
+//
+//*******************************************************************************
+void ASISreader::Compact()
+{
+	size_t Drop = (size_t)(SearchBit >> 3);
+
+	if (Drop == 0) {
+		return;
+	}
+	memmove(Buffer, Buffer + Drop, DataEnd - Drop + ASIS_READ_PAD);
+	DataEnd -= Drop;
+	BufferBitBase += (__int64)Drop * 8;
+	SearchBit -= (__int64)Drop * 8;
+}
+
+//*******************************************************************************
+//
+//  FindSync
+//
+// Find the first sync header at or after FromBit that is all in the buffer
+//
+//	return value:
+//	bit in Buffer where the sync header starts
+//	-1 not found
+//
+//*******************************************************************************
+__int64 ASISreader::FindSync(__int64 FromBit)
+{
+	__int64 LastStart = (__int64)DataEnd * 8 - ASIS_SYNC_BITS;
+
+	for (__int64 b = FromBit >> 3; b * 8 <= LastStart; b++) {
+		// bits 8-15 of every sync header start are in Buffer[b+1]
+		if (Buffer[b + 1] != 0xFF) {
+			continue;
+		}
+		unsigned __int64 Head = LoadBigEndian64(Buffer + b);
+		unsigned __int64 Tail = LoadBigEndian64(Buffer + b + 6);
+		for (int s = 0; s < 8; s++) {
+			__int64 Start = b * 8 + s;
+			if (Start < FromBit) continue;
+			if (Start > LastStart) break;
+			if ((unsigned int)(Head >> (32 - s)) == ASIS_SYNC_HEAD &&
+				(unsigned int)(Tail >> (32 - s)) == ASIS_SYNC_TAIL) {
+				return Start;
+			}
+		}
+	}
+	return -1;
+}
+
+//*******************************************************************************
+//
+//  Next
+//
+// Find the next message in the file
+//
+// Parameters:
+//	ASISVIEW* View		returns view of the message, valid until the next
+//						call to Next() or Close()
+//
+//	return value:
+//	1 - message returned in View
+//	0 - no more messages
+//	<0 Error see standardized app error list in AppErrors.h
+//
+//*******************************************************************************
+int ASISreader::Next(ASISVIEW* View)
+{
+	__int64 Start;
+	__int64 End;
+	int BodyBits;
+	int iRes;
+
+	if (In == NULL) {
+		return APPERR_PARAMETER;
+	}
+
+	// find the sync header
+	for (;;) {
+		Compact();
+		Start = FindSync(SearchBit);
+		if (Start >= 0) {
+			break;
+		}
+		// the last bits could be the start of a sync header
+		__int64 Keep = (__int64)DataEnd * 8 - (ASIS_SYNC_BITS - 1);
+		if (Keep > SearchBit) {
+			SkippedBits += Keep - SearchBit;
+			SearchBit = Keep;
+		}
+		if (EndOfFile) {
+			SkippedBits += (__int64)DataEnd * 8 - SearchBit;
+			SearchBit = (__int64)DataEnd * 8;
+			return 0;
+		}
+		iRes = Fill();
+		if (iRes != APP_SUCCESS) {
+			return iRes;
+		}
+	}
+	SkippedBits += Start - SearchBit;
+
+	// find the end of the message
+	if (Format.Ysize > 0) {
+		int Xsize = (Format.Xsize > 0) ? Format.Xsize : Format.Ysize;
+		BodyBits = Xsize * Format.Ysize;
+		End = Start + ASIS_SYNC_BITS + BodyBits + Format.FooterBits;
+		while (End > (__int64)DataEnd * 8 && !EndOfFile) {
+			iRes = Fill();
+			if (iRes != APP_SUCCESS) {
+				return iRes;
+			}
+		}
+		if (End > (__int64)DataEnd * 8) {
+			// message is cut off by the end of the file
+			SkippedBits += (__int64)DataEnd * 8 - Start;
+			SearchBit = (__int64)DataEnd * 8;
+			return 0;
+		}
+		View->Xsize = Xsize;
+		View->Ysize = Format.Ysize;
+	}
+	else {
+		// the body has at least 1 bit
+		__int64 From = Start + ASIS_SYNC_BITS + Format.FooterBits + 1;
+		for (;;) {
+			End = FindSync(From);
+			if (End >= 0) {
+				break;
+			}
+			if (EndOfFile) {
+				End = (__int64)DataEnd * 8;
+				break;
+			}
+			__int64 Keep = (__int64)DataEnd * 8 - (ASIS_SYNC_BITS - 1);
+			if (Keep > From) {
+				From = Keep;
+			}
+			iRes = Fill();
+			if (iRes != APP_SUCCESS) {
+				return iRes;
+			}
+		}
+		if (End - Start - ASIS_SYNC_BITS - Format.FooterBits < 1) {
+			// too short for a message at the end of the file
+			SkippedBits += End - Start;
+			SearchBit = End;
+			return 0;
+		}
+		if (End - Start - ASIS_SYNC_BITS - Format.FooterBits > INT_MAX) {
+			return APPERR_FILESIZE;
+		}
+		BodyBits = (int)(End - Start - ASIS_SYNC_BITS - Format.FooterBits);
+
+		// image size from the body size
+		if (Format.Xsize > 0) {
+			View->Xsize = Format.Xsize;
+			View->Ysize = BodyBits / Format.Xsize;
+		}
+		else {
+			int Side = (int)sqrt((double)BodyBits);
+			while ((__int64)(Side + 1) * (Side + 1) <= BodyBits) Side++;
+			while ((__int64)Side * Side > BodyBits) Side--;
+			if (Side * Side == BodyBits) {
+				View->Xsize = Side;
+				View->Ysize = Side;
+			}
+			else {
+				View->Xsize = BodyBits;
+				View->Ysize = 1;
+			}
+		}
+	}
+
+	View->Data = Buffer + (Start >> 3);
+	View->BitOffset = (int)(Start & 7);
+	View->FileBitOffset = BufferBitBase + Start;
+	View->Index = NumMessages;
+	View->BodyBits = BodyBits;
+	View->FooterBits = Format.FooterBits;
+
+	NumMessages++;
+	SearchBit = End;
+	return 1;
+}
+
+//*******************************************************************************
+//
+//  GetNumMessages
+//
+//*******************************************************************************
+int ASISreader::GetNumMessages()
+{
+	return NumMessages;
+}
+
+//*******************************************************************************
+//
+//  GetSkippedBits
+//
+// # of bits read so far that are not in any message
+//
+//*******************************************************************************
+__int64 ASISreader::GetSkippedBits()
+{
+	return SkippedBits;
+}
+
+//*******************************************************************************
+//
+//  GetFileSize
+//
+//*******************************************************************************
+__int64 ASISreader::GetFileSize()
+{
+	return FileSize;
+}
+
+//*******************************************************************************
+//
+//  ASISviewBits
+//
+// Copy bits from a message view into bytes, MSB first.
+// Unused bits in the last byte are 0.
+//
+// Parameters:
+//	ASISVIEW* View		message
+//	int FirstBit		first bit to copy, 0 is the first bit of the sync header
+//	int NumBits			# of bits to copy
+//	BYTE* Bytes			returns bits, (NumBits+7)/8 bytes
+//
+//*******************************************************************************
+void ASISviewBits(ASISVIEW* View, int FirstBit, int NumBits, BYTE* Bytes)
+{
+	__int64 Bit = (__int64)View->BitOffset + FirstBit;
+	const BYTE* Source = View->Data + (Bit >> 3);
+	int Shift = (int)(Bit & 7);
+	int NumBytes = (NumBits + 7) / 8;
+
+	if (Shift == 0) {
+		memcpy(Bytes, Source, (size_t)NumBytes);
+	}
+	else {
+		// the byte after the last one is always in the buffer (data or pad)
+		for (int i = 0; i < NumBytes; i++) {
+			Bytes[i] = (BYTE)((Source[i] << Shift) | (Source[i + 1] >> (8 - Shift)));
+		}
+	}
+	if (NumBits & 7) {
+		Bytes[NumBytes - 1] &= (BYTE)(0xFF << (8 - (NumBits & 7)));
+	}
+}
+
+//*******************************************************************************
+//
+//  ASISviewImage
+//
+// Unpack the body of a message view into a binary 0/255 image
+//
+// Parameters:
+//	ASISVIEW* View		message
+//	int* Image			returns image, View->Xsize * View->Ysize pixels
+//
+//	return value:
+//	# of bits set in the image
+//
+//*******************************************************************************
+int ASISviewImage(ASISVIEW* View, int* Image)
+{
+	int NumPixels = View->Xsize * View->Ysize;
+	int Bit = View->BitOffset + ASIS_SYNC_BITS;
+
+	if ((Bit & 7) == 0) {
+		// body is byte aligned, unpack it where it is
+		return UnpackPixelBits((BYTE*)View->Data + (Bit >> 3), NumPixels, Image, FALSE);
+	}
+
+	// realign a block at a time
+	BYTE Block[4096];
+	int Count = 0;
+	for (int i = 0; i < NumPixels; i += 8 * (int)sizeof(Block)) {
+		int Length = NumPixels - i;
+		if (Length > 8 * (int)sizeof(Block)) {
+			Length = 8 * (int)sizeof(Block);
+		}
+		ASISviewBits(View, ASIS_SYNC_BITS + i, Length, Block);
+		Count += UnpackPixelBits(Block, Length, Image + i, FALSE);
+	}
+	return Count;
+}
@@ -0,0 +1,99 @@
+#pragma once
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// ASIScontainer.h
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+// V1.2.0	2026-10-19	Added ASISreader class, streaming ASIS message container parser
+//
+//	An ASIS capture is any number of messages, back to back or with other
+//	data between them, each one:
+//		sync header		80 bits  FF FF 06 90 xx xx 44 88 44 88
+//		body			Xsize * Ysize bits, 1 bit per pixel MSB first
+//		footer			FooterBits, unary iteration count
+//	Messages can start at any bit in the file.
+//
+//	The file is read once, in blocks.  Next() returns a view of each message
+//	that points into the read buffer, the message is not copied.  A view is
+//	only valid until the next call to Next() or Close().
+//
+#include "framework.h"
+#include <stdio.h>
+
+#define ASIS_SYNC_BITS 80			// # of bits in the sync header
+#define ASIS_MAX_FOOTER_BITS 80		// footers must fit in BYTE Footer[10]
+
+// message layout
+typedef struct {
+	int FooterBits;		// # of bits in the footer, 1 to ASIS_MAX_FOOTER_BITS
+	int Xsize;			// image x size, 0 square image from the # of body bits
+	int Ysize;			// image y size, 0 variable size messages, each message
+						// ends at the next sync header (or the end of the file)
+} ASISFORMAT;
+
+// one message in the read buffer
+typedef struct {
+	const BYTE* Data;		// byte with the first bit of the message
+	int BitOffset;			// first bit of the message in Data[0], 0 is the 0x80 bit
+	__int64 FileBitOffset;	// # of bits before the message in the file
+	int Index;				// message # in the file, 0 is first
+	int BodyBits;			// # of bits in the body
+	int FooterBits;			// # of bits in the footer
+	int Xsize;				// image size, Xsize * Ysize <= BodyBits
+	int Ysize;
+} ASISVIEW;
+
+class ASISreader {
+private:
+	FILE* In = NULL;
+	ASISFORMAT Format;
+	__int64 FileSize = 0;
+
+	// read buffer, always has ASIS_READ_PAD 0 bytes after the data
+	BYTE* Buffer = nullptr;
+	size_t BufferSize = 0;		// allocated size, not counting the pad
+	size_t DataEnd = 0;			// # of bytes of file data in Buffer
+	__int64 BufferBitBase = 0;	// file bit offset of Buffer[0]
+	__int64 SearchBit = 0;		// bit in Buffer where the next sync search starts
+	BOOL EndOfFile = FALSE;
+
+	int NumMessages = 0;
+	__int64 SkippedBits = 0;	// # of bits not in any message
+
+	int Fill();
+	void Compact();
+	__int64 FindSync(__int64 FromBit);
+
+public:
+	ASISreader();
+	~ASISreader();
+
+	int Open(WCHAR* Filename, ASISFORMAT* MessageFormat);
+	int Next(ASISVIEW* View);
+	void Close();
+
+	int GetNumMessages();
+	__int64 GetSkippedBits();
+	__int64 GetFileSize();
+};
+
+void ASISviewBits(ASISVIEW* View, int FirstBit, int NumBits, BYTE* Bytes);
+int ASISviewImage(ASISVIEW* View, int* Image);
@@ -8,6 +8,8 @@
 //     -4 incorect file type
 //     -5 file size mismatch (filesize does not match expected filesize)
 //     -6 not yet implemented
+//     -7 file write failure
+//     -8 file checksum mismatch (file is corrupt)
 
 #define APP_SUCCESS	1
 #define APPERR_PARAMETER 0
@@ -18,3 +20,4 @@
 #define APPERR_FILESIZE -5
 #define APPERR_NYI -6
 #define APPERR_FILEWRITE -7
+#define APPERR_CHECKSUM -8
@@ -43,10 +43,13 @@
 //     -4 incorect file type
 //     -5 file sizes mismatch
 //     -6 not yet implemented
+//     -7 file write failure
+//     -8 file checksum mismatch
 //
 // Some function return TRUE/FALSE results
 // 
 // V1.0.0	2024-06-21	Initial release
+// V1.2.0	2026-10-19	Added messages for file write and checksum errors
 //
 //  This module is a copy of the AppFunctions module used in MySETIviewer and customized
 //  for this application
@@ -442,6 +445,14 @@ void MessageMySETIBCAError(HWND hWnd, int ErrNo, const wchar_t* Title) {
         MessageBox(hWnd, L"Not yet implemented", Title, MB_OK);
         break;
 
+    case -7:
+        MessageBox(hWnd, L"File write error", Title, MB_OK);
+        break;
+
+    case -8:
+        MessageBox(hWnd, L"File checksum error, file is corrupt", Title, MB_OK);
+        break;
+
     default:
         break;
     }
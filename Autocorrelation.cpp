@@ -0,0 +1,534 @@
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// Autocorrelation.cpp
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the bitstream autocorrelation used to find the line length
+// and block period of a message in a packed bitstream file
+//
+// V1.2.0	2026-10-19	Added bitstream autocorrelation, line length and block period finder
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+//	The bits are unpacked to a +1,-1 signal with the mean removed and the
+//	autocorrelation is found with an FFT:
+//		X = FFT(x), P = |X|^2, C = IFFT(P)
+//	The signal is 0 padded to at least NumBits + MaxLag so lags up to MaxLag
+//	do not wrap around.
+//
+//	The FFT is an in place radix 2 FFT.  The forward FFT is decimation in
+//	frequency (natural order in, bit reversed order out) and the inverse is
+//	decimation in time (bit reversed order in, natural order out) so the
+//	power spectrum never has to be put in natural order.
+//
+//	After the first few stages of the forward FFT the array splits into
+//	independent blocks.  These first stages, and the last stages of the
+//	inverse, are done on all the worker threads a range of butterflies at a
+//	time.  Each block is then transformed, squared and inverse transformed
+//	by one thread.
+//
+#include "framework.h"
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include "AppErrors.h"
+#include "Autocorrelation.h"
+
+#define FFT_STAGE_ITEM (1 << 16)	// # of butterflies in one work item for the whole array stages
+#define PEAK_NEIGHBORS 4			// # of lags on each side of a peak for its score
+#define PEAK_HARMONIC 0.9			// a peak is a harmonic if Lag/m scores this much of it
+
+typedef struct {
+	double Re;
+	double Im;
+} FFTCOMPLEX;
+
+// FFT work phases
+#define FFT_DIF_STAGE 0		// one forward stage over the whole array
+#define FFT_BLOCKS 1		// forward, |X|^2 and inverse of each block
+#define FFT_DIT_STAGE 2		// one inverse stage over the whole array
+
+// shared by the FFT worker threads
+typedef struct {
+	FFTCOMPLEX* Data;
+	int N;						// # of points, power of 2
+	int BlockSize;				// # of points in the independent blocks
+	FFTCOMPLEX* Fine;			// W^k for k < FineSize, W = exp(-2*pi*i/N)
+	FFTCOMPLEX* Coarse;			// W^(k*FineSize) for k < N/2/FineSize
+	int FineShift;				// FineSize = 1 << FineShift
+	FFTCOMPLEX* BlockTwiddle;	// exp(-2*pi*i*k/BlockSize) for k < BlockSize/2
+	int Phase;
+	int Half;					// butterfly span for the whole array stages
+	LONG NumItems;
+	volatile LONG NextItem;
+} FFTWORK;
+
+static void RunFFTPhase(FFTWORK* Work, int Phase, int Half, LONG NumItems);
+static DWORD WINAPI FFTProc(LPVOID Param);
+static void FFTStage(FFTWORK* Work, LONG Item);
+static void FFTBlock(FFTWORK* Work, LONG Item);
+static BOOL PeakScore(std::vector<double>& Correlation, int Lag, double* Score);
+
+//*******************************************************************************
+//
+//  BitAutocorrelation
+//
+// Autocorrelation of the bits in a packed bitstream file
+//
+// Parameters:
+//	WCHAR* Filename				packed bitstream file
+//	BOOL InputBitOrder			FALSE bytes are MSB first, TRUE LSB first,
+//								same as BitImageDlg
+//	__int64 SkipBits			# of bits at the start of the file that are not
+//								used (prologue)
+//	int NumBits					# of bits used, up to AUTOCORR_MAX_BITS,
+//								less if the file is shorter
+//	int MaxLag					largest lag, limited to the # of bits used - 1
+//	std::vector<double>& Correlation	returns the autocorrelation for lags
+//								0 to MaxLag.  Each lag is normalized by the
+//								# of bit pairs at that lag, 1 is a perfect match.
+//	int* BitsUsed				returns the # of bits used
+//
+//	return value:
+//	1 - Success
+//	!=1 Error see standardized app error list in AppErrors.h
+//
+//*******************************************************************************
+int BitAutocorrelation(WCHAR* Filename, BOOL InputBitOrder, __int64 SkipBits, int NumBits,
+	int MaxLag, std::vector<double>& Correlation, int* BitsUsed)
+{
+	FILE* In;
+	BYTE* Bytes;
+	__int64 FileSize;
+	size_t NumBytes;
+	int N;
+	int LogN;
+
+	Correlation.clear();
+	*BitsUsed = 0;
+	if (SkipBits < 0 || NumBits < 2 || NumBits > AUTOCORR_MAX_BITS || MaxLag < 1) {
+		return APPERR_PARAMETER;
+	}
+
+	_wfopen_s(&In, Filename, L"rb");
+	if (In == NULL) {
+		return APPERR_FILEOPEN;
+	}
+	_fseeki64(In, 0, SEEK_END);
+	FileSize = _ftelli64(In);
+	if (FileSize * 8 - SkipBits < 2) {
+		fclose(In);
+		return APPERR_FILESIZE;
+	}
+	if (NumBits > FileSize * 8 - SkipBits) {
+		NumBits = (int)(FileSize * 8 - SkipBits);
+	}
+	if (MaxLag > NumBits - 1) {
+		MaxLag = NumBits - 1;
+	}
+
+	// bytes with the bits that are used
+	NumBytes = (size_t)((SkipBits % 8 + NumBits + 7) / 8);
+	Bytes = new BYTE[NumBytes];
+	if (Bytes == nullptr) {
+		fclose(In);
+		return APPERR_MEMALLOC;
+	}
+	_fseeki64(In, SkipBits / 8, SEEK_SET);
+	if (fread(Bytes, 1, NumBytes, In) != NumBytes) {
+		delete[] Bytes;
+		fclose(In);
+		return APPERR_FILEREAD;
+	}
+	fclose(In);
+
+	for (N = 2, LogN = 1; N < NumBits + MaxLag; N <<= 1, LogN++);
+
+	FFTWORK Work;
+	Work.N = N;
+	Work.Data = new FFTCOMPLEX[N];
+	if (Work.Data == nullptr) {
+		delete[] Bytes;
+		return APPERR_MEMALLOC;
+	}
+
+	// +1,-1 signal with the mean removed
+	int NumOnes = 0;
+	for (int i = 0; i < NumBits; i++) {
+		int Bit = (int)(SkipBits % 8) + i;
+		int Value = InputBitOrder ? (Bytes[Bit >> 3] >> (Bit & 7)) & 1 : (Bytes[Bit >> 3] >> (7 - (Bit & 7))) & 1;
+		Work.Data[i].Re = Value ? 1.0 : -1.0;
+		Work.Data[i].Im = 0.0;
+		NumOnes += Value;
+	}
+	delete[] Bytes;
+	double Mean = (double)(2 * NumOnes - NumBits) / (double)NumBits;
+	for (int i = 0; i < NumBits; i++) {
+		Work.Data[i].Re -= Mean;
+	}
+	memset(&Work.Data[NumBits], 0, sizeof(FFTCOMPLEX) * (N - NumBits));
+
+	// # of stages done over the whole array, enough blocks to keep the threads busy
+	SYSTEM_INFO SysInfo;
+	int NumThreads;
+	int SplitStages;
+
+	GetSystemInfo(&SysInfo);
+	NumThreads = (int)SysInfo.dwNumberOfProcessors;
+	if (NumThreads > MAXIMUM_WAIT_OBJECTS) NumThreads = MAXIMUM_WAIT_OBJECTS;
+	if (NumThreads < 1) NumThreads = 1;
+	for (SplitStages = 0; (1 << SplitStages) < 4 * NumThreads && SplitStages < LogN - 1; SplitStages++);
+	Work.BlockSize = N >> SplitStages;
+
+	// twiddle factors, W^k = Coarse[k >> FineShift] * Fine[k & (FineSize - 1)]
+	const double TwoPi = 6.283185307179586476925286766559;
+	Work.FineShift = LogN / 2;
+	int FineSize = 1 << Work.FineShift;
+	int CoarseSize = (N / 2 + FineSize - 1) / FineSize;
+	Work.Fine = new FFTCOMPLEX[FineSize];
+	Work.Coarse = new FFTCOMPLEX[CoarseSize];
+	Work.BlockTwiddle = new FFTCOMPLEX[Work.BlockSize / 2];
+	if (Work.Fine == nullptr || Work.Coarse == nullptr || Work.BlockTwiddle == nullptr) {
+		if (Work.Fine != nullptr) delete[] Work.Fine;
+		if (Work.Coarse != nullptr) delete[] Work.Coarse;
+		if (Work.BlockTwiddle != nullptr) delete[] Work.BlockTwiddle;
+		delete[] Work.Data;
+		return APPERR_MEMALLOC;
+	}
+	for (int k = 0; k < FineSize; k++) {
+		Work.Fine[k].Re = cos(TwoPi * k / N);
+		Work.Fine[k].Im = -sin(TwoPi * k / N);
+	}
+	for (int k = 0; k < CoarseSize; k++) {
+		Work.Coarse[k].Re = cos(TwoPi * ((double)k * FineSize) / N);
+		Work.Coarse[k].Im = -sin(TwoPi * ((double)k * FineSize) / N);
+	}
+	for (int k = 0; k < Work.BlockSize / 2; k++) {
+		Work.BlockTwiddle[k].Re = cos(TwoPi * k / Work.BlockSize);
+		Work.BlockTwiddle[k].Im = -sin(TwoPi * k / Work.BlockSize);
+	}
+
+	LONG StageItems = (LONG)((N / 2 + FFT_STAGE_ITEM - 1) / FFT_STAGE_ITEM);
+	for (int Half = N / 2; Half >= Work.BlockSize; Half >>= 1) {
+		RunFFTPhase(&Work, FFT_DIF_STAGE, Half, StageItems);
+	}
+	RunFFTPhase(&Work, FFT_BLOCKS, 0, (LONG)(N / Work.BlockSize));
+	for (int Half = Work.BlockSize; Half < N; Half <<= 1) {
+		RunFFTPhase(&Work, FFT_DIT_STAGE, Half, StageItems);
+	}
+
+	// the power spectrum is real and even so the inverse was done as a forward
+	// FFT, Data[k] is N * C[k]
+	Correlation.resize((size_t)MaxLag + 1);
+	double Zero = Work.Data[0].Re;
+	for (int k = 0; k <= MaxLag; k++) {
+		if (Zero <= 0.0) {
+			// all bits are the same
+			Correlation[k] = 0.0;
+		}
+		else {
+			Correlation[k] = (Work.Data[k].Re / (double)(NumBits - k)) / (Zero / (double)NumBits);
+		}
+	}
+
+	delete[] Work.Fine;
+	delete[] Work.Coarse;
+	delete[] Work.BlockTwiddle;
+	delete[] Work.Data;
+	*BitsUsed = NumBits;
+
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  RunFFTPhase
+//
+// Run one phase of the FFT on the worker threads
+//
+//*******************************************************************************
+static void RunFFTPhase(FFTWORK* Work, int Phase, int Half, LONG NumItems)
+{
+	SYSTEM_INFO SysInfo;
+	int NumThreads;
+
+	Work->Phase = Phase;
+	Work->Half = Half;
+	Work->NumItems = NumItems;
+	Work->NextItem = 0;
+
+	GetSystemInfo(&SysInfo);
+	NumThreads = (int)SysInfo.dwNumberOfProcessors;
+	if (NumThreads > MAXIMUM_WAIT_OBJECTS) NumThreads = MAXIMUM_WAIT_OBJECTS;
+	if (NumThreads > (int)NumItems) NumThreads = (int)NumItems;
+	if (NumThreads < 1) NumThreads = 1;
+
+	std::vector<HANDLE> Threads(NumThreads);
+	int Started = 0;
+	for (int t = 0; t < NumThreads; t++) {
+		Threads[t] = CreateThread(NULL, 0, FFTProc, Work, 0, NULL);
+		if (Threads[t] == NULL) {
+			break;
+		}
+		Started++;
+	}
+	if (Started == 0) {
+		// no threads, do it all here
+		FFTProc(Work);
+	}
+	for (int t = 0; t < Started; t++) {
+		WaitForSingleObject(Threads[t], INFINITE);
+		CloseHandle(Threads[t]);
+	}
+}
+
+//*******************************************************************************
+//
+//  FFTProc
+//
+// Worker thread, does work items until there are none left
+//
+//*******************************************************************************
+static DWORD WINAPI FFTProc(LPVOID Param)
+{
+	FFTWORK* Work = (FFTWORK*)Param;
+	LONG Next;
+
+	while ((Next = InterlockedIncrement(&Work->NextItem) - 1) < Work->NumItems) {
+		if (Work->Phase == FFT_BLOCKS) {
+			FFTBlock(Work, Next);
+		}
+		else {
+			FFTStage(Work, Next);
+		}
+	}
+	return 0;
+}
+
+//*******************************************************************************
+//
+//  FFTStage
+//
+// FFT_STAGE_ITEM butterflies of a stage over the whole array.  Butterfly q
+// is j = q % Half in the block of 2*Half points starting at (q / Half)*2*Half.
+//
+//*******************************************************************************
+static void FFTStage(FFTWORK* Work, LONG Item)
+{
+	FFTCOMPLEX* Data = Work->Data;
+	int Half = Work->Half;
+	int Step = Work->N / (2 * Half);		// twiddle W_2Half^j = W_N^(j*Step)
+	int FineMask = (1 << Work->FineShift) - 1;
+	int First = Item * FFT_STAGE_ITEM;
+	int Last = First + FFT_STAGE_ITEM;
+
+	if (Last > Work->N / 2) {
+		Last = Work->N / 2;
+	}
+	for (int q = First; q < Last; q++) {
+		int j = q & (Half - 1);
+		int a = q + (q & ~(Half - 1));
+		int b = a + Half;
+		int k = j * Step;
+		FFTCOMPLEX* C = &Work->Coarse[k >> Work->FineShift];
+		FFTCOMPLEX* F = &Work->Fine[k & FineMask];
+		double Wr = C->Re * F->Re - C->Im * F->Im;
+		double Wi = C->Re * F->Im + C->Im * F->Re;
+		double Tr;
+		double Ti;
+
+		if (Work->Phase == FFT_DIF_STAGE) {
+			Tr = Data[a].Re - Data[b].Re;
+			Ti = Data[a].Im - Data[b].Im;
+			Data[a].Re += Data[b].Re;
+			Data[a].Im += Data[b].Im;
+			Data[b].Re = Tr * Wr - Ti * Wi;
+			Data[b].Im = Tr * Wi + Ti * Wr;
+		}
+		else {
+			Tr = Data[b].Re * Wr - Data[b].Im * Wi;
+			Ti = Data[b].Re * Wi + Data[b].Im * Wr;
+			Data[b].Re = Data[a].Re - Tr;
+			Data[b].Im = Data[a].Im - Ti;
+			Data[a].Re += Tr;
+			Data[a].Im += Ti;
+		}
+	}
+}
+
+//*******************************************************************************
+//
+//  FFTBlock
+//
+// Forward FFT of one block, |X|^2 then the inverse FFT of the block
+//
+//*******************************************************************************
+static void FFTBlock(FFTWORK* Work, LONG Item)
+{
+	FFTCOMPLEX* Data = Work->Data + (size_t)Item * Work->BlockSize;
+	FFTCOMPLEX* Twiddle = Work->BlockTwiddle;
+	int BlockSize = Work->BlockSize;
+
+	// decimation in frequency
+	for (int Half = BlockSize / 2; Half >= 1; Half >>= 1) {
+		int Step = BlockSize / (2 * Half);
+		for (int Block = 0; Block < BlockSize; Block += 2 * Half) {
+			for (int j = 0; j < Half; j++) {
+				FFTCOMPLEX* A = &Data[Block + j];
+				FFTCOMPLEX* B = A + Half;
+				FFTCOMPLEX* W = &Twiddle[j * Step];
+				double Tr = A->Re - B->Re;
+				double Ti = A->Im - B->Im;
+				A->Re += B->Re;
+				A->Im += B->Im;
+				B->Re = Tr * W->Re - Ti * W->Im;
+				B->Im = Tr * W->Im + Ti * W->Re;
+			}
+		}
+	}
+
+	// power spectrum
+	for (int i = 0; i < BlockSize; i++) {
+		Data[i].Re = Data[i].Re * Data[i].Re + Data[i].Im * Data[i].Im;
+		Data[i].Im = 0.0;
+	}
+
+	// decimation in time
+	for (int Half = 1; Half < BlockSize; Half <<= 1) {
+		int Step = BlockSize / (2 * Half);
+		for (int Block = 0; Block < BlockSize; Block += 2 * Half) {
+			for (int j = 0; j < Half; j++) {
+				FFTCOMPLEX* A = &Data[Block + j];
+				FFTCOMPLEX* B = A + Half;
+				FFTCOMPLEX* W = &Twiddle[j * Step];
+				double Tr = B->Re * W->Re - B->Im * W->Im;
+				double Ti = B->Re * W->Im + B->Im * W->Re;
+				B->Re = A->Re - Tr;
+				B->Im = A->Im - Ti;
+				A->Re += Tr;
+				A->Im += Ti;
+			}
+		}
+	}
+}
+
+//*******************************************************************************
+//
+//  PeakScore
+//
+// Score of a lag if it is a peak, a correlation >= the lags on each side of it.
+// The score is how far the peak is above the mean of the PEAK_NEIGHBORS lags
+// on each side.
+//
+//	return value:
+//	TRUE Lag is a peak, FALSE not a peak
+//
+//*******************************************************************************
+static BOOL PeakScore(std::vector<double>& Correlation, int Lag, double* Score)
+{
+	int Last = (int)Correlation.size() - 1;
+	double Sum = 0.0;
+	int Count = 0;
+
+	if (Lag < 1 || Lag >= Last ||
+		Correlation[Lag] < Correlation[Lag - 1] || Correlation[Lag] < Correlation[Lag + 1]) {
+		return FALSE;
+	}
+	for (int i = 1; i <= PEAK_NEIGHBORS; i++) {
+		if (Lag - i >= 1) {
+			Sum += Correlation[Lag - i];
+			Count++;
+		}
+		if (Lag + i <= Last) {
+			Sum += Correlation[Lag + i];
+			Count++;
+		}
+	}
+	*Score = Correlation[Lag] - Sum / Count;
+	return TRUE;
+}
+
+//*******************************************************************************
+//
+//  FindPeriodPeaks
+//
+// Find the peaks in the autocorrelation in a range of lags, ranked by their
+// PeakScore().  A periodic bitstream has a peak at every multiple of its
+// period, a peak is left out if there is a peak in the range at Lag/m that
+// scores at least PEAK_HARMONIC of it.
+//
+// Parameters:
+//	std::vector<double>& Correlation	autocorrelation from BitAutocorrelation()
+//	int MinLag					smallest lag, >= 1
+//	int MaxLag					largest lag
+//	int MaxPeaks				# of peaks returned, up to AUTOCORR_MAX_PEAKS
+//	std::vector<PERIODPEAK>& Peaks	returns the peaks, best first
+//
+//	return value:
+//	1 - Success
+//	!=1 Error see standardized app error list in AppErrors.h
+//
+//*******************************************************************************
+int FindPeriodPeaks(std::vector<double>& Correlation, int MinLag, int MaxLag, int MaxPeaks,
+	std::vector<PERIODPEAK>& Peaks)
+{
+	std::vector<PERIODPEAK> AllPeaks;
+
+	Peaks.clear();
+	if (MinLag < 1 || MaxLag < MinLag || MaxPeaks < 1) {
+		return APPERR_PARAMETER;
+	}
+	if (MaxPeaks > AUTOCORR_MAX_PEAKS) {
+		MaxPeaks = AUTOCORR_MAX_PEAKS;
+	}
+
+	for (int Lag = MinLag; Lag <= MaxLag; Lag++) {
+		PERIODPEAK Peak;
+
+		if (PeakScore(Correlation, Lag, &Peak.Score)) {
+			Peak.Lag = Lag;
+			Peak.Correlation = Correlation[Lag];
+			AllPeaks.push_back(Peak);
+		}
+	}
+
+	// best first, the shorter lag first for the same score
+	std::stable_sort(AllPeaks.begin(), AllPeaks.end(), [](const PERIODPEAK& a, const PERIODPEAK& b) {
+		return a.Score > b.Score;
+	});
+
+	for (size_t i = 0; i < AllPeaks.size() && (int)Peaks.size() < MaxPeaks; i++) {
+		BOOL Harmonic = FALSE;
+
+		for (int m = 2; AllPeaks[i].Lag / m >= MinLag && !Harmonic; m++) {
+			double Score;
+
+			if ((AllPeaks[i].Lag % m) == 0 && PeakScore(Correlation, AllPeaks[i].Lag / m, &Score) &&
+				Score >= PEAK_HARMONIC * AllPeaks[i].Score) {
+				Harmonic = TRUE;
+			}
+		}
+		if (!Harmonic) {
+			Peaks.push_back(AllPeaks[i]);
+		}
+	}
+
+	return APP_SUCCESS;
+}
@@ -0,0 +1,53 @@
+#pragma once
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// Autocorrelation.h
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+// V1.2.0	2026-10-19	Added bitstream autocorrelation, line length and block period finder
+//
+#include "framework.h"
+#include <vector>
+
+#define AUTOCORR_MAX_BITS (1 << 22)	// most bits in the autocorrelation
+#define AUTOCORR_MAX_PEAKS 32		// most peaks listed for each lag range
+
+// one peak in the autocorrelation
+typedef struct {
+	int Lag;				// # of bits, line length or block period
+	double Correlation;		// autocorrelation at Lag, -1 to 1
+	double Score;			// Correlation minus the mean of the lags next to it, used to rank peaks
+} PERIODPEAK;
+
+// AutocorrDlg parameters when it is opened from BitImageDlg
+typedef struct {
+	WCHAR InputFile[MAX_PATH];	// bitstream file
+	BOOL InputBitOrder;			// TRUE bytes in the file are LSB first
+	int PrologueSize;			// # of bits skipped at the start of the file
+	int BitDepth;				// image bit depth, a line is xsize*BitDepth bits
+	int LineBits;				// returns the selected line length in bits, -1 none
+	int BlockBits;				// returns the selected block period in bits, -1 none
+} AUTOCORRDLGPARAM;
+
+int BitAutocorrelation(WCHAR* Filename, BOOL InputBitOrder, __int64 SkipBits, int NumBits,
+	int MaxLag, std::vector<double>& Correlation, int* BitsUsed);
+int FindPeriodPeaks(std::vector<double>& Correlation, int MinLag, int MaxLag, int MaxPeaks,
+	std::vector<PERIODPEAK>& Peaks);
@@ -0,0 +1,1109 @@
+//
+// MySETIBCA, an application for decoding, encoding message images using 
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+// 
+// BCAengine.cpp
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the definitions of the BCAengine class methods/functions
+// 
+// V1.2.0	2026-10-19	Added BCAengine class, replaces the global BCA state
+//					Added checkpoint/restart files and background checkpoint writer
+//					Added information tape for exact backward steps
+//					Iterations are 64 bit, LoadCheckpoint() rejects a negative iteration
+//					The image is an Image<int>, AttachImage() and DetachImage() move it
+//					CRC32 table is built once, GetIteration() reads under the engine lock
+//					LoadCheckpoint() checks the BitCount of the image
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+#include "framework.h"
+#include <stdio.h>
+#include <io.h>
+#include <limits.h>
+#include <array>
+#include "AppErrors.h"
+#include "imageheader.h"
+#include "FileFunctions.h"
+#include "CA.h"
+#include "Image.h"
+#include "BCAengine.h"
+
+//*******************************************************************************
+//
+//  BCAengine()
+//  class constructor
+// 
+//*******************************************************************************
+BCAengine::BCAengine()
+{
+	InitializeCriticalSection(&EngineLock);
+	InitParticleList(&Particles);
+	InitStopCondition(&Stop);
+	InitInfoTape(&Tape);
+	memset(&ImageHeader, 0, sizeof(IMAGINGHEADER));
+}
+
+//*******************************************************************************
+//
+//  ~BCAengine()
+//  class destructor
+// 
+//*******************************************************************************
+BCAengine::~BCAengine()
+{
+	StopCheckpoints();
+	ReleaseImage();
+	FreeParticleList(&Particles);
+	FreeStopCondition(&Stop);
+	FreeInfoTape(&Tape);
+	DeleteCriticalSection(&EngineLock);
+}
+
+//*******************************************************************************
+//
+//  LoadImage
+// 
+// Load the image to be processed from a .raw or .bmp file.
+// The image is converted to a single frame binary 0/255 image.
+// The iteration is reset to 0 and the next step is even.
+// 
+// Parameters:
+//	WCHAR* Filename		.raw or .bmp image file
+//	int Threshold		pixels >= Threshold are set (255)
+// 
+// return
+//	APP_SUCCESS			image loaded
+//	APPERR_FILETYPE		not a .raw or .bmp image file
+//	APPERR_PARAMETER	image x,y sizes are not even
+//
+//*******************************************************************************
+int BCAengine::LoadImage(WCHAR* Filename, int Threshold)
+{
+	int iRes;
+	Image<int> NewImage;
+	IMAGINGHEADER NewHeader;
+
+	ReleaseImage();
+
+	iRes = LoadImageFile(NewImage, Filename, &NewHeader);
+	if (iRes != APP_SUCCESS) {
+		// then try .bmp format
+		iRes = ReadBMPfile(NewImage, Filename, &NewHeader);
+		if (iRes != APP_SUCCESS) {
+			return APPERR_FILETYPE;
+		}
+	}
+
+	// the image must be even in xsize and ysize
+	if (((NewHeader.Xsize % 2) != 0) || ((NewHeader.Ysize % 2) != 0)) {
+		return APPERR_PARAMETER;
+	}
+
+	// check if this is 3 frame image (3 frame raw files are used as color images)
+	// If it is convert the 3 frames into the first frame as a binary 0 or 255
+	iRes = BinarizeImageFrames(NewImage, &NewHeader, Threshold);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	return AttachImage(std::move(NewImage), &NewHeader);
+}
+
+//*******************************************************************************
+//
+//  AttachImage
+// 
+// Use an image that is already in memory.  The engine takes the pixels of
+// NewImage, NewImage is empty after this.  If the image is not attached
+// NewImage is not changed.
+// The iteration is reset to 0 and the next step is even.
+// 
+// Parameters:
+//	Image<int>&& NewImage	single frame binary 0/255 image, rows are not padded
+//	IMAGINGHEADER* Header	header for NewImage, snapshots are saved with it
+// 
+// return
+//	APP_SUCCESS			image attached
+//	APPERR_PARAMETER	no image, image x,y sizes are not even or it is
+//						not a single frame image with rows that are not padded
+//
+//*******************************************************************************
+int BCAengine::AttachImage(Image<int>&& NewImage, IMAGINGHEADER* Header)
+{
+	if (NewImage.IsEmpty() || NewImage.GetNumFrames() != 1 ||
+		NewImage.GetStride() != (size_t)NewImage.GetXsize() ||
+		Header->Xsize != NewImage.GetXsize() || Header->Ysize != NewImage.GetYsize() ||
+		((Header->Xsize % 2) != 0) || ((Header->Ysize % 2) != 0)) {
+		return APPERR_PARAMETER;
+	}
+
+	ReleaseImage();
+
+	EnterCriticalSection(&EngineLock);
+	Lattice = std::move(NewImage);
+	ImageHeader = *Header;
+	ImageHeader.NumFrames = 1;
+	CurrentIteration = 0;
+	EvenStep = TRUE;
+	StatsCursor = 0;
+	for (int i = 0; i < 5; i++) {
+		LastHisto[i] = 0;
+	}
+	// particle list and tape no longer match the image
+	Particles.Valid = FALSE;
+	ClearInfoTape(&Tape);
+	LeaveCriticalSection(&EngineLock);
+
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  ReleaseImage
+// 
+// Delete the image being processed
+// 
+//*******************************************************************************
+void BCAengine::ReleaseImage()
+{
+	EnterCriticalSection(&EngineLock);
+	Lattice.Release();
+	Particles.Valid = FALSE;
+	ClearInfoTape(&Tape);
+	FreeStopCondition(&Stop);
+	LeaveCriticalSection(&EngineLock);
+	return;
+}
+
+//*******************************************************************************
+//
+//  DetachImage
+// 
+// Give the image being processed back to the caller.  The caller owns
+// the image after this.
+// 
+// return
+//	the image, empty if no image
+// 
+//*******************************************************************************
+Image<int> BCAengine::DetachImage()
+{
+	Image<int> OldImage;
+
+	EnterCriticalSection(&EngineLock);
+	OldImage = std::move(Lattice);
+	Particles.Valid = FALSE;
+	ClearInfoTape(&Tape);
+	FreeStopCondition(&Stop);
+	LeaveCriticalSection(&EngineLock);
+	return OldImage;
+}
+
+//*******************************************************************************
+//
+//  IsImageLoaded
+// 
+// return
+//	TRUE if there is an image to process
+// 
+//*******************************************************************************
+BOOL BCAengine::IsImageLoaded()
+{
+	return !Lattice.IsEmpty();
+}
+
+//*******************************************************************************
+//
+//  GetImage
+// 
+// The image being processed.  This is owned by the engine, GetPixels()
+// is the single frame (int) image with rows that are not padded.
+// Only use this from the thread running the engine,
+// other threads must use GetSnapshot().
+// 
+// return
+//	the image, empty if no image
+// 
+//*******************************************************************************
+Image<int>& BCAengine::GetImage()
+{
+	return Lattice;
+}
+
+//*******************************************************************************
+//
+//  GetImageHeader
+// 
+// return
+//	pointer to the header of the image being processed
+// 
+//*******************************************************************************
+IMAGINGHEADER* BCAengine::GetImageHeader()
+{
+	return &ImageHeader;
+}
+
+//*******************************************************************************
+//
+//  GetBitCount
+// 
+// return
+//	# of set pixels in the image, -1 if no image
+// 
+//*******************************************************************************
+int BCAengine::GetBitCount()
+{
+	if (Lattice.IsEmpty()) {
+		return -1;
+	}
+	return CountBitInImage(Lattice.GetPixels(), &ImageHeader);
+}
+
+//*******************************************************************************
+//
+//  GetSnapshot
+// 
+// Thread safe copy of the current image and state.  This can be called
+// from any thread while the engine is running, the copy is always of a
+// complete iteration.
+// 
+// Parameters:
+//	Image<int>& ImageCopy	returns copy of image
+//	IMAGINGHEADER* Header	returns header of image
+//	__int64* Iteration		returns iteration of the image
+//	BOOL* Even				returns TRUE if the next step is even
+// 
+// return
+//	APP_SUCCESS			copy made
+//	APPERR_PARAMETER	no image
+//	APPERR_MEMALLOC		could not allocate copy
+// 
+//*******************************************************************************
+int BCAengine::GetSnapshot(Image<int>& ImageCopy, IMAGINGHEADER* Header, __int64* Iteration, BOOL* Even)
+{
+	int iRes;
+
+	ImageCopy.Release();
+
+	EnterCriticalSection(&EngineLock);
+	if (Lattice.IsEmpty()) {
+		LeaveCriticalSection(&EngineLock);
+		return APPERR_PARAMETER;
+	}
+
+	iRes = ImageCopy.Create(Lattice.GetXsize(), Lattice.GetYsize(), 1, FALSE);
+	if (iRes != APP_SUCCESS) {
+		LeaveCriticalSection(&EngineLock);
+		return iRes;
+	}
+	memcpy(ImageCopy.GetPixels(), Lattice.GetPixels(),
+		(size_t)Lattice.GetXsize() * (size_t)Lattice.GetYsize() * sizeof(int));
+
+	*Header = ImageHeader;
+	*Iteration = CurrentIteration;
+	*Even = EvenStep;
+	LeaveCriticalSection(&EngineLock);
+
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  SetRules
+// 
+// Set the 2x2 block substitution rules
+// 
+// Parameters:
+//	int* Forward		16 forward rules
+//	int* Backward		16 backward rules
+// 
+//*******************************************************************************
+void BCAengine::SetRules(int* Forward, int* Backward)
+{
+	EnterCriticalSection(&EngineLock);
+	for (int i = 0; i < 16; i++) {
+		if (ForwardRules[i] != Forward[i]) {
+			// tape can only be replayed with the rules it was recorded with
+			ClearInfoTape(&Tape);
+		}
+		ForwardRules[i] = Forward[i];
+		BackwardRules[i] = Backward[i];
+	}
+	LeaveCriticalSection(&EngineLock);
+	return;
+}
+
+//*******************************************************************************
+//
+//  GetRules
+// 
+// Parameters:
+//	int* Forward		returns 16 forward rules
+//	int* Backward		returns 16 backward rules
+// 
+//*******************************************************************************
+void BCAengine::GetRules(int* Forward, int* Backward)
+{
+	for (int i = 0; i < 16; i++) {
+		Forward[i] = ForwardRules[i];
+		Backward[i] = BackwardRules[i];
+	}
+	return;
+}
+
+//*******************************************************************************
+//
+//  Reset
+// 
+// Reset to iteration 0, next step is even
+// 
+//*******************************************************************************
+void BCAengine::Reset()
+{
+	EnterCriticalSection(&EngineLock);
+	CurrentIteration = 0;
+	EvenStep = TRUE;
+	ClearInfoTape(&Tape);
+	LeaveCriticalSection(&EngineLock);
+	return;
+}
+
+//*******************************************************************************
+//
+//  GetIteration
+// 
+// return
+//	current iteration
+// 
+//*******************************************************************************
+__int64 BCAengine::GetIteration()
+{
+	__int64 Iteration;
+
+	// the iteration is 64 bit, a 32 bit build can not read it in one load
+	EnterCriticalSection(&EngineLock);
+	Iteration = CurrentIteration;
+	LeaveCriticalSection(&EngineLock);
+	return Iteration;
+}
+
+//*******************************************************************************
+//
+//  GetEvenStep
+// 
+// return
+//	TRUE if the next step is even (2x2 grid starts at 0,0)
+// 
+//*******************************************************************************
+BOOL BCAengine::GetEvenStep()
+{
+	return EvenStep;
+}
+
+//*******************************************************************************
+//
+//  SetEvenStep
+// 
+// Parameters:
+//	BOOL Even			TRUE next step is even, FALSE next step is odd
+// 
+//*******************************************************************************
+void BCAengine::SetEvenStep(BOOL Even)
+{
+	EnterCriticalSection(&EngineLock);
+	if (EvenStep != Even) {
+		ClearInfoTape(&Tape);
+	}
+	EvenStep = Even;
+	LeaveCriticalSection(&EngineLock);
+	return;
+}
+
+//*******************************************************************************
+//
+//  StepForward
+// 
+// Run one forward iteration
+// 
+// Parameters:
+//	int* Histo			returns count of 0,1,2,3,4 #pixel set in 2x2 block
+// 
+// return
+//	STOP_NONE (0) or the STOP_xxx flags of the stop conditions that were met
+// 
+//*******************************************************************************
+int BCAengine::StepForward(int* Histo)
+{
+	if (Lattice.IsEmpty()) {
+		return STOP_NONE;
+	}
+
+	EnterCriticalSection(&EngineLock);
+	for (int i = 0; i < 5; i++) {
+		Histo[i] = 0;
+	}
+	if (Tape.Enabled) {
+		if (RecordInfoTape(EvenStep, Lattice.GetPixels(), ImageHeader.Xsize, ImageHeader.Ysize,
+			ForwardRules, &Tape) != APP_SUCCESS) {
+			// out of memory, stop recording
+			ClearInfoTape(&Tape);
+			Tape.Enabled = FALSE;
+		}
+	}
+	MargolusBCAauto(EvenStep, Lattice.GetPixels(), ImageHeader.Xsize, ImageHeader.Ysize,
+		ForwardRules, Histo, &Particles, &Stop);
+	CurrentIteration++;
+	EvenStep = !EvenStep;
+	for (int i = 0; i < 5; i++) {
+		LastHisto[i] = Histo[i];
+	}
+	LeaveCriticalSection(&EngineLock);
+
+	return CheckStopCondition(&Stop, Histo);
+}
+
+//*******************************************************************************
+//
+//  StepBackward
+// 
+// Run one backward iteration
+// 
+// Parameters:
+//	int* Histo			returns count of 0,1,2,3,4 #pixel set in 2x2 block
+// 
+// return
+//	STOP_NONE (0) or the STOP_xxx flags of the stop conditions that were met
+// 
+//*******************************************************************************
+int BCAengine::StepBackward(int* Histo)
+{
+	if (Lattice.IsEmpty()) {
+		return STOP_NONE;
+	}
+
+	EnterCriticalSection(&EngineLock);
+	for (int i = 0; i < 5; i++) {
+		Histo[i] = 0;
+	}
+	EvenStep = !EvenStep;
+	// replay the tape if this step was recorded, this is exact even if
+	// the backward rules are not the inverse of the forward rules
+	if (Tape.NumSteps > 0 && ReplayInfoTape(EvenStep, Lattice.GetPixels(), ImageHeader.Xsize, ImageHeader.Ysize,
+		ForwardRules, Histo, &Tape, &Stop) == APP_SUCCESS) {
+		Particles.Valid = FALSE;
+	}
+	else {
+		ClearInfoTape(&Tape);
+		MargolusBCAauto(EvenStep, Lattice.GetPixels(), ImageHeader.Xsize, ImageHeader.Ysize,
+			BackwardRules, Histo, &Particles, &Stop);
+	}
+	CurrentIteration--;
+	for (int i = 0; i < 5; i++) {
+		LastHisto[i] = Histo[i];
+	}
+	LeaveCriticalSection(&EngineLock);
+
+	return CheckStopCondition(&Stop, Histo);
+}
+
+//*******************************************************************************
+//
+//  Run
+// 
+// Run a number of iterations without any display updates.  This can be
+// called from a worker thread.  The run ends when:
+//		NumberSteps iterations are done
+//		the iteration limit is reached
+//		a stop condition is met
+//		RequestStop() is called from another thread
+// 
+// Parameters:
+//	BOOL Forward		TRUE run forward, FALSE run backward
+//	int NumberSteps		maximum # of iterations to run
+//	__int64 Limit		forward or backward iteration limit
+//	int* StopReason		returns STOP_xxx flags of the stop conditions that were met
+// 
+// return
+//	# of iterations done
+// 
+//*******************************************************************************
+int BCAengine::Run(BOOL Forward, int NumberSteps, __int64 Limit, int* StopReason)
+{
+	int Histo[5];
+	int Steps = 0;
+
+	*StopReason = STOP_NONE;
+	StopRequest = FALSE;
+	Running = Forward ? 1 : -1;
+
+	while (Steps < NumberSteps && !StopRequest) {
+		if (Forward) {
+			if (CurrentIteration >= Limit) break;
+			*StopReason = StepForward(Histo);
+		}
+		else {
+			if (CurrentIteration <= Limit) break;
+			*StopReason = StepBackward(Histo);
+		}
+		Steps++;
+		if (*StopReason != STOP_NONE) break;
+	}
+
+	Running = 0;
+	return Steps;
+}
+
+//*******************************************************************************
+//
+//  GetRunning
+// 
+// return
+//	-1 running backward, 0 stopped, +1 running forward
+// 
+//*******************************************************************************
+int BCAengine::GetRunning()
+{
+	return Running;
+}
+
+//*******************************************************************************
+//
+//  SetRunning
+// 
+// Used by the Margolus BCA dialog to track timer driven runs
+// 
+// Parameters:
+//	int State			-1 running backward, 0 stopped, +1 running forward
+// 
+//*******************************************************************************
+void BCAengine::SetRunning(int State)
+{
+	Running = State;
+	return;
+}
+
+//*******************************************************************************
+//
+//  RequestStop
+// 
+// Request Run() to stop at the end of the current iteration.
+// This can be called from any thread.
+// 
+//*******************************************************************************
+void BCAengine::RequestStop()
+{
+	StopRequest = TRUE;
+	return;
+}
+
+//*******************************************************************************
+//
+//  GetStopCondition
+// 
+// return
+//	pointer to the stop conditions, used to set the enables and limits
+// 
+//*******************************************************************************
+STOPCONDITION* BCAengine::GetStopCondition()
+{
+	return &Stop;
+}
+
+//*******************************************************************************
+//
+//  StartStopCondition
+// 
+// Set up the stop conditions for the current image.
+// The current image becomes the initial image.
+// 
+// Parameters:
+//	int* ReferenceImage	(optional) target image for the Hamming distance,
+//						must be the same size as the image, nullptr if not used
+// 
+// return
+//	APP_SUCCESS or standardized app error
+// 
+//*******************************************************************************
+int BCAengine::StartStopCondition(int* ReferenceImage)
+{
+	int iRes;
+
+	if (Lattice.IsEmpty()) {
+		return APPERR_PARAMETER;
+	}
+
+	EnterCriticalSection(&EngineLock);
+	iRes = ::StartStopCondition(&Stop, Lattice.GetPixels(), ImageHeader.Xsize, ImageHeader.Ysize, ReferenceImage);
+	LeaveCriticalSection(&EngineLock);
+
+	return iRes;
+}
+
+//*******************************************************************************
+//
+//  CountStatsRow
+// 
+// Record that a histogram row was saved for the current iteration.
+// The count is the statistics cursor saved in checkpoints so a resumed
+// run knows whether its histogram file is already started.
+// 
+//*******************************************************************************
+void BCAengine::CountStatsRow()
+{
+	StatsCursor++;
+	return;
+}
+
+//*******************************************************************************
+//
+//  GetStatsCursor
+// 
+// return
+//	# of histogram rows saved since the image was loaded
+// 
+//*******************************************************************************
+__int64 BCAengine::GetStatsCursor()
+{
+	return StatsCursor;
+}
+
+//*******************************************************************************
+//
+//  CRC32
+// 
+// CRC-32 (IEEE 802.3) used for the checkpoint file checksum
+// 
+// Parameters:
+//	unsigned int Crc	CRC from previous block, 0 for the first block
+//	const BYTE* Data	data block
+//	size_t Length		# of bytes in data block
+// 
+// return
+//	updated CRC
+// 
+//*******************************************************************************
+static unsigned int CRC32(unsigned int Crc, const BYTE* Data, size_t Length)
+{
+	// built on the first call, the initialization of a function static
+	// is thread safe so the UI and checkpoint threads can both get here
+	static const std::array<unsigned int, 256> Table = [] {
+		std::array<unsigned int, 256> t;
+		for (unsigned int i = 0; i < 256; i++) {
+			unsigned int c = i;
+			for (int k = 0; k < 8; k++) {
+				c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+			}
+			t[i] = c;
+		}
+		return t;
+	}();
+
+	Crc = ~Crc;
+	for (size_t i = 0; i < Length; i++) {
+		Crc = Table[(Crc ^ Data[i]) & 0xff] ^ (Crc >> 8);
+	}
+	return ~Crc;
+}
+
+//*******************************************************************************
+//
+//  SaveCheckpoint
+// 
+// Save everything needed to resume the run in a checkpoint file.
+// The engine state is copied under the engine lock so this can be called
+// from the background checkpoint thread while the engine is running.
+// The file is written to Filename.tmp which then replaces Filename.
+// 
+// Parameters:
+//	WCHAR* Filename		checkpoint file
+// 
+// return
+//	APP_SUCCESS or standardized app error
+// 
+//*******************************************************************************
+int BCAengine::SaveCheckpoint(WCHAR* Filename)
+{
+	BCACHECKPOINT Checkpoint;
+	unsigned __int64* Packed;
+	WCHAR TempFilename[MAX_PATH];
+	FILE* Out;
+	errno_t ErrNum;
+	int iRes;
+
+	memset(&Checkpoint, 0, sizeof(BCACHECKPOINT));
+
+	EnterCriticalSection(&EngineLock);
+	if (Lattice.IsEmpty()) {
+		LeaveCriticalSection(&EngineLock);
+		return APPERR_PARAMETER;
+	}
+	iRes = PackImageBits(Lattice.GetPixels(), ImageHeader.Xsize, ImageHeader.Ysize, &Packed);
+	if (iRes != APP_SUCCESS) {
+		LeaveCriticalSection(&EngineLock);
+		return iRes;
+	}
+	memcpy(Checkpoint.Signature, BCA_CHECKPOINT_SIGNATURE, 8);
+	Checkpoint.Version = BCA_CHECKPOINT_VERSION;
+	Checkpoint.HeaderSize = sizeof(BCACHECKPOINT);
+	Checkpoint.Xsize = ImageHeader.Xsize;
+	Checkpoint.Ysize = ImageHeader.Ysize;
+	Checkpoint.EvenStep = EvenStep;
+	Checkpoint.NumWords = (ImageHeader.Xsize * ImageHeader.Ysize + 63) / 64;
+	Checkpoint.Iteration = CurrentIteration;
+	for (int i = 0; i < 16; i++) {
+		Checkpoint.ForwardRules[i] = ForwardRules[i];
+		Checkpoint.BackwardRules[i] = BackwardRules[i];
+	}
+	Checkpoint.StatsCursor = StatsCursor;
+	for (int i = 0; i < 5; i++) {
+		Checkpoint.LastHisto[i] = LastHisto[i];
+	}
+	Checkpoint.BitCount = CountBitInImage(Lattice.GetPixels(), &ImageHeader);
+	LeaveCriticalSection(&EngineLock);
+
+	// the file write is done outside the lock so the engine is not held up
+	Checkpoint.Checksum = CRC32(0, (BYTE*)&Checkpoint, sizeof(BCACHECKPOINT));
+	Checkpoint.Checksum = CRC32(Checkpoint.Checksum, (BYTE*)Packed,
+		(size_t)Checkpoint.NumWords * sizeof(unsigned __int64));
+
+	swprintf_s(TempFilename, MAX_PATH, L"%s.tmp", Filename);
+	ErrNum = _wfopen_s(&Out, TempFilename, L"wb");
+	if (!Out) {
+		delete[] Packed;
+		return APPERR_FILEOPEN;
+	}
+
+	iRes = APP_SUCCESS;
+	if (fwrite(&Checkpoint, sizeof(BCACHECKPOINT), 1, Out) != 1 ||
+		fwrite(Packed, sizeof(unsigned __int64), (size_t)Checkpoint.NumWords, Out) != (size_t)Checkpoint.NumWords) {
+		iRes = APPERR_FILEWRITE;
+	}
+	delete[] Packed;
+
+	// make sure the checkpoint is on disk before it replaces the old one
+	if (fflush(Out) != 0 || _commit(_fileno(Out)) != 0) {
+		iRes = APPERR_FILEWRITE;
+	}
+	fclose(Out);
+
+	if (iRes != APP_SUCCESS) {
+		DeleteFile(TempFilename);
+		return iRes;
+	}
+
+	if (!MoveFileEx(TempFilename, Filename, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+		DeleteFile(TempFilename);
+		return APPERR_FILEWRITE;
+	}
+
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  LoadCheckpoint
+// 
+// Resume a run from a checkpoint file.  This replaces the image, rules,
+// iteration, even/odd step and statistics cursor.  The stop conditions
+// are cleared, use StartStopCondition() to set them up for the resumed image.
+// 
+// Parameters:
+//	WCHAR* Filename		checkpoint file
+// 
+// return
+//	APP_SUCCESS			run can be resumed
+//	APPERR_FILEOPEN		checkpoint file could not be opened
+//	APPERR_FILETYPE		not a checkpoint file
+//	APPERR_FILEREAD		checkpoint file is too short
+//	APPERR_CHECKSUM		checkpoint file is corrupt or the image bit count is wrong
+//	APPERR_MEMALLOC		not enough memory for the image
+// 
+//*******************************************************************************
+int BCAengine::LoadCheckpoint(WCHAR* Filename)
+{
+	BCACHECKPOINT Checkpoint;
+	unsigned __int64* Packed;
+	unsigned int Checksum;
+	Image<int> NewImage;
+	IMAGINGHEADER NewHeader;
+	FILE* In;
+	errno_t ErrNum;
+	int iRes;
+
+	ErrNum = _wfopen_s(&In, Filename, L"rb");
+	if (!In) {
+		return APPERR_FILEOPEN;
+	}
+
+	if (fread(&Checkpoint, sizeof(BCACHECKPOINT), 1, In) != 1) {
+		fclose(In);
+		return APPERR_FILEREAD;
+	}
+
+	if (memcmp(Checkpoint.Signature, BCA_CHECKPOINT_SIGNATURE, 8) != 0 ||
+		Checkpoint.Version != BCA_CHECKPOINT_VERSION ||
+		Checkpoint.HeaderSize != sizeof(BCACHECKPOINT) ||
+		Checkpoint.Xsize <= 0 || Checkpoint.Ysize <= 0 ||
+		(Checkpoint.Xsize % 2) != 0 || (Checkpoint.Ysize % 2) != 0 ||
+		Checkpoint.Xsize > INT_MAX / Checkpoint.Ysize ||
+		Checkpoint.NumWords != (Checkpoint.Xsize * Checkpoint.Ysize + 63) / 64) {
+		fclose(In);
+		return APPERR_FILETYPE;
+	}
+
+	Packed = new unsigned __int64[(size_t)Checkpoint.NumWords];
+	if (Packed == nullptr) {
+		fclose(In);
+		return APPERR_MEMALLOC;
+	}
+	if (fread(Packed, sizeof(unsigned __int64), (size_t)Checkpoint.NumWords, In) != (size_t)Checkpoint.NumWords) {
+		delete[] Packed;
+		fclose(In);
+		return APPERR_FILEREAD;
+	}
+	fclose(In);
+
+	Checksum = Checkpoint.Checksum;
+	Checkpoint.Checksum = 0;
+	Checkpoint.Checksum = CRC32(0, (BYTE*)&Checkpoint, sizeof(BCACHECKPOINT));
+	Checkpoint.Checksum = CRC32(Checkpoint.Checksum, (BYTE*)Packed,
+		(size_t)Checkpoint.NumWords * sizeof(unsigned __int64));
+	if (Checksum != Checkpoint.Checksum) {
+		delete[] Packed;
+		return APPERR_CHECKSUM;
+	}
+
+	for (int i = 0; i < 16; i++) {
+		if (Checkpoint.ForwardRules[i] < 0 || Checkpoint.ForwardRules[i] > 15 ||
+			Checkpoint.BackwardRules[i] < 0 || Checkpoint.BackwardRules[i] > 15) {
+			delete[] Packed;
+			return APPERR_FILETYPE;
+		}
+	}
+	if (Checkpoint.Iteration < 0 || Checkpoint.StatsCursor < 0) {
+		delete[] Packed;
+		return APPERR_FILETYPE;
+	}
+
+	iRes = UnpackImageBits(Packed, Checkpoint.Xsize, Checkpoint.Ysize, NewImage);
+	delete[] Packed;
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	memset(&NewHeader, 0, sizeof(IMAGINGHEADER));
+	NewHeader.Endian = (short)-1;  // PC format
+	NewHeader.HeaderSize = (short)sizeof(IMAGINGHEADER);
+	NewHeader.ID = (short)0xaaaa;
+	NewHeader.Version = (short)1;
+	NewHeader.Xsize = Checkpoint.Xsize;
+	NewHeader.Ysize = Checkpoint.Ysize;
+	NewHeader.PixelSize = 1;
+	NewHeader.NumFrames = 1;
+
+	if (CountBitInImage(NewImage.GetPixels(), &NewHeader) != Checkpoint.BitCount) {
+		return APPERR_CHECKSUM;
+	}
+
+	iRes = AttachImage(std::move(NewImage), &NewHeader);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	EnterCriticalSection(&EngineLock);
+	for (int i = 0; i < 16; i++) {
+		ForwardRules[i] = Checkpoint.ForwardRules[i];
+		BackwardRules[i] = Checkpoint.BackwardRules[i];
+	}
+	CurrentIteration = Checkpoint.Iteration;
+	EvenStep = Checkpoint.EvenStep ? TRUE : FALSE;
+	StatsCursor = Checkpoint.StatsCursor;
+	for (int i = 0; i < 5; i++) {
+		LastHisto[i] = Checkpoint.LastHisto[i];
+	}
+	LeaveCriticalSection(&EngineLock);
+
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  CheckpointProc
+// 
+// Background checkpoint thread.  Saves a checkpoint every CheckpointInterval
+// until CheckpointEvent is signaled.  A checkpoint is only written when the
+// iteration has changed since the last one.
+// 
+// Parameters:
+//	LPVOID Param		BCAengine instance
+// 
+//*******************************************************************************
+DWORD WINAPI BCAengine::CheckpointProc(LPVOID Param)
+{
+	BCAengine* Engine = (BCAengine*)Param;
+	__int64 LastIteration = Engine->GetIteration();
+	__int64 Iteration;
+
+	while (WaitForSingleObject(Engine->CheckpointEvent, Engine->CheckpointInterval) == WAIT_TIMEOUT) {
+		Iteration = Engine->GetIteration();
+		if (Iteration == LastIteration) {
+			continue;
+		}
+		LastIteration = Iteration;
+		Engine->CheckpointStatus = Engine->SaveCheckpoint(Engine->CheckpointFile);
+	}
+	return 0;
+}
+
+//*******************************************************************************
+//
+//  StartCheckpoints
+// 
+// Start the background checkpoint thread
+// 
+// Parameters:
+//	WCHAR* Filename		checkpoint file
+//	int Minutes			minutes between checkpoints
+// 
+// return
+//	APP_SUCCESS or standardized app error
+// 
+//*******************************************************************************
+int BCAengine::StartCheckpoints(WCHAR* Filename, int Minutes)
+{
+	if (Filename == nullptr || wcslen(Filename) == 0 || Minutes <= 0) {
+		return APPERR_PARAMETER;
+	}
+
+	StopCheckpoints();
+
+	wcscpy_s(CheckpointFile, MAX_PATH, Filename);
+	CheckpointInterval = (DWORD)Minutes * 60 * 1000;
+	CheckpointStatus = APP_SUCCESS;
+
+	CheckpointEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (CheckpointEvent == NULL) {
+		return APPERR_MEMALLOC;
+	}
+	CheckpointThread = CreateThread(NULL, 0, CheckpointProc, this, 0, NULL);
+	if (CheckpointThread == NULL) {
+		CloseHandle(CheckpointEvent);
+		CheckpointEvent = NULL;
+		return APPERR_MEMALLOC;
+	}
+
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  StopCheckpoints
+// 
+// Stop the background checkpoint thread, waits for a checkpoint being
+// written to finish.
+// 
+//*******************************************************************************
+void BCAengine::StopCheckpoints()
+{
+	if (CheckpointThread == NULL) {
+		return;
+	}
+
+	SetEvent(CheckpointEvent);
+	WaitForSingleObject(CheckpointThread, INFINITE);
+	CloseHandle(CheckpointThread);
+	CloseHandle(CheckpointEvent);
+	CheckpointThread = NULL;
+	CheckpointEvent = NULL;
+	return;
+}
+
+//*******************************************************************************
+//
+//  GetCheckpointStatus
+// 
+// return
+//	result of the last background checkpoint, APP_SUCCESS or standardized app error
+// 
+//*******************************************************************************
+int BCAengine::GetCheckpointStatus()
+{
+	return CheckpointStatus;
+}
+
+//*******************************************************************************
+//
+//  SetTapeRecording
+// 
+// Turn the information tape on or off.  While it is on every forward step
+// is recorded and backward steps replay the tape exactly until it is empty.
+// Turning it off discards the tape.
+// 
+// Parameters:
+//	BOOL Record			TRUE record forward steps
+// 
+//*******************************************************************************
+void BCAengine::SetTapeRecording(BOOL Record)
+{
+	EnterCriticalSection(&EngineLock);
+	if (!Record) {
+		ClearInfoTape(&Tape);
+	}
+	Tape.Enabled = Record;
+	LeaveCriticalSection(&EngineLock);
+	return;
+}
+
+//*******************************************************************************
+//
+//  GetTapeRecording
+// 
+// return
+//	TRUE if forward steps are being recorded
+// 
+//*******************************************************************************
+BOOL BCAengine::GetTapeRecording()
+{
+	return Tape.Enabled;
+}
+
+//*******************************************************************************
+//
+//  GetTapeSteps
+// 
+// return
+//	# of backward steps that can be replayed exactly from the tape
+// 
+//*******************************************************************************
+int BCAengine::GetTapeSteps()
+{
+	return Tape.NumSteps;
+}
+
+//*******************************************************************************
+//
+//  GetTapeBytes
+// 
+// return
+//	# of bytes used by the tape
+// 
+//*******************************************************************************
+size_t BCAengine::GetTapeBytes()
+{
+	return Tape.Size;
+}
@@ -0,0 +1,187 @@
+#pragma once
+//
+// MySETIBCA, an application for decoding, encoding message images using 
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+// 
+// BCAengine.h
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>. 
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+// V1.2.0	2026-10-19	Added BCAengine class
+//					Added checkpoint/restart files
+//					Added information tape for exact backward steps
+//					Iterations are 64 bit
+//					The image is an Image<int>
+//					Running is volatile, it is read by other threads
+//
+//	This contains the Margolus block cellular automata simulation class
+// 
+//	Each BCAengine owns everything needed to run one BCA simulation:
+//		the image (lattice), an Image<int>, and its file header
+//		the forward and backward rules
+//		the current iteration and even/odd step
+//		the sparse engine particle list
+//		the run stop conditions
+// 
+//	There is no shared state between instances so more than one simulation
+//	can be run at the same time.  An instance can be run on a worker thread,
+//	other threads must use GetSnapshot() to read the image while it is running.
+//	All other methods should only be called by the thread running the instance.
+//
+//	The Margolus BCA dialog is a view of the MargolusEngine instance.
+//
+//	With the information tape on, backward steps replay the recorded forward
+//	steps exactly instead of using the backward rules.  The tape is not saved
+//	in checkpoint files.
+//
+//	Checkpoint files (.bcack) hold everything needed to resume a run:
+//		BCACHECKPOINT header
+//		packed image, 1 bit per pixel, see PackImageBits()
+//	The checksum is a CRC-32 of the header (with Checksum = 0) and the packed image.
+//	Checkpoints are written to a temporary file that then replaces the checkpoint
+//	file so a crash while writing never leaves a damaged checkpoint.
+//
+#include "framework.h"
+#include "AppErrors.h"
+#include "imageheader.h"
+#include "CA.h"
+#include "Image.h"
+
+#define BCA_CHECKPOINT_SIGNATURE "BCACHKPT"
+#define BCA_CHECKPOINT_VERSION 1
+
+typedef struct BCACHECKPOINT {
+	char Signature[8];			// BCA_CHECKPOINT_SIGNATURE, not null terminated
+	int Version;				// BCA_CHECKPOINT_VERSION
+	int HeaderSize;				// sizeof(BCACHECKPOINT)
+	int Xsize;					// image x size
+	int Ysize;					// image y size
+	int EvenStep;				// TRUE when next iteration step is even
+	int NumWords;				// # of 64 bit words in packed image
+	__int64 Iteration;			// current iteration
+	int ForwardRules[16];
+	int BackwardRules[16];
+	__int64 StatsCursor;		// # of histogram rows saved for this run
+	int LastHisto[5];			// histogram from the last iteration
+	int BitCount;				// # of bits set in image
+	unsigned int Checksum;		// CRC-32, see above
+	int Reserved;				// keeps size a multiple of 8
+} BCACHECKPOINT;
+
+class BCAengine {
+private:
+	// variables
+	CRITICAL_SECTION EngineLock;	// guards image and state for GetSnapshot()
+
+	// image being processed, single frame binary 0/255, rows are not padded
+	Image<int> Lattice;
+	IMAGINGHEADER ImageHeader;	// PixelSize is the file pixel size, used to save it
+
+	// 2x2 block substitution rules
+	int ForwardRules[16] = { 0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15 };
+	int BackwardRules[16] = { 0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15 };
+
+	__int64 CurrentIteration = 0;	// also used to tell whether current frame is even or odd
+	BOOL EvenStep = TRUE;		// True when next iteration step is even
+
+	volatile int Running = 0;	// -1 running backward
+								// 0 stopped
+								// +1 runing forward
+	volatile BOOL StopRequest = FALSE;	// request to stop Run() at the end of the current iteration
+
+	PARTICLELIST Particles;		// sparse engine particle list for Image
+	STOPCONDITION Stop;			// run stop conditions
+	INFOTAPE Tape;				// information tape for exact backward steps
+
+	int LastHisto[5] = { 0,0,0,0,0 };	// histogram from the last iteration
+	__int64 StatsCursor = 0;	// # of histogram rows saved since image was loaded
+
+	// background checkpoint writer
+	HANDLE CheckpointThread = NULL;
+	HANDLE CheckpointEvent = NULL;	// signaled to end CheckpointThread
+	WCHAR CheckpointFile[MAX_PATH] = L"";
+	DWORD CheckpointInterval = 0;	// msec between checkpoints
+	volatile int CheckpointStatus = APP_SUCCESS;	// result of last background checkpoint
+
+	static DWORD WINAPI CheckpointProc(LPVOID Param);
+
+public:
+
+	// forward method/function declarations
+	//	method/functions definition are done in BCAengine.cpp
+
+	// class constructor
+	BCAengine();
+	// class destructor
+	~BCAengine();
+
+	// image
+	int LoadImage(WCHAR* Filename, int Threshold);
+	int AttachImage(Image<int>&& NewImage, IMAGINGHEADER* Header);
+	void ReleaseImage();
+	Image<int> DetachImage();
+	BOOL IsImageLoaded();
+	Image<int>& GetImage();
+	IMAGINGHEADER* GetImageHeader();
+	int GetBitCount();
+	int GetSnapshot(Image<int>& ImageCopy, IMAGINGHEADER* Header, __int64* Iteration, BOOL* Even);
+
+	// rules
+	void SetRules(int* Forward, int* Backward);
+	void GetRules(int* Forward, int* Backward);
+
+	// iteration state
+	void Reset();
+	__int64 GetIteration();
+	BOOL GetEvenStep();
+	void SetEvenStep(BOOL Even);
+
+	// stepping
+	int StepForward(int* Histo);
+	int StepBackward(int* Histo);
+	int Run(BOOL Forward, int NumberSteps, __int64 Limit, int* StopReason);
+
+	// run state
+	int GetRunning();
+	void SetRunning(int State);
+	void RequestStop();
+
+	// stop conditions
+	STOPCONDITION* GetStopCondition();
+	int StartStopCondition(int* ReferenceImage);
+
+	// statistics
+	void CountStatsRow();
+	__int64 GetStatsCursor();
+
+	// checkpoint/restart
+	int SaveCheckpoint(WCHAR* Filename);
+	int LoadCheckpoint(WCHAR* Filename);
+	int StartCheckpoints(WCHAR* Filename, int Minutes);
+	void StopCheckpoints();
+	int GetCheckpointStatus();
+
+	// information tape
+	void SetTapeRecording(BOOL Record);
+	BOOL GetTapeRecording();
+	int GetTapeSteps();
+	size_t GetTapeBytes();
+};
+
+// simulation used by the Margolus BCA dialog and the display layer 0
+extern BCAengine* MargolusEngine;
@@ -20,6 +20,21 @@
 // 
 // V1.0.0	2024-06-21	Initial release
 // V1.1.6   2024-11-25  Correction for EOF processing in ConvertText2BitStream()
+// V1.2.0   2026-10-19  Added Find bit pattern dialog, the prologue size can be set
+//                      from a match found in the bitstream
+//                      Added Run length profile dialog
+//                      BitStream2Image() reads the input in large blocks, pixels are taken
+//                      from 64 bit words and each frame is written with one fwrite
+//                      Added Find line length dialog, x size and # bits in block can be set
+//                      from the autocorrelation of the bitstream
+//                      Added Parameter sweep gallery dialog
+//                      Parameter sweep gallery reports errors writing the image files
+//                      ConvertText2BitStream() uses ReadBitText() instead of fscanf_s()
+//                      for each bit, Text2StreamDlg can parse the text on all processors
+//                      Find line length sets # bits in block to the block period less
+//                      the block header bits
+//                      LoadBigEndian64(), ReverseBits32() and ReverseByte[] are shared from
+//                      BitOrder.h
 //
 // This contains the import bitstream dialog and support functions
 // to read a binary bitstream like the data17.bin file form 'A Sign in Space'
@@ -39,18 +54,28 @@
 #include <libloaderapi.h>
 #include <shtypes.h>
 #include <stdio.h>
+#include <limits.h>
 #include <atlstr.h>
 #include <strsafe.h>
 #include "imageheader.h"
 #include "FileFunctions.h"
 #include "Appfunctions.h"
 #include "globals.h"
+#include "BitSearch.h"
+#include "RunProfile.h"
+#include "Autocorrelation.h"
+#include "Gallery.h"
+#include "BitText.h"
+#include "BitOrder.h"
 
 int BitStream2Image(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
     int PrologueSize, int BlockHeaderBits, int NumBlockBodyBits, int BlockNum, int xsize,
     int BitDepth, int BitOrder, int BitScale, int Invert, int InputBitOrder);
 
-int ConvertText2BitStream(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int BitOrder);
+int ConvertText2BitStream(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int BitOrder, BOOL Parallel);
+
+INT_PTR CALLBACK BitSearchDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam);
+INT_PTR CALLBACK AutocorrDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam);
 
 //*******************************************************************************
 //
@@ -174,6 +199,67 @@ INT_PTR CALLBACK BitImageDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lPar
 
             return (INT_PTR)TRUE;
         }
+        case IDC_FIND_PATTERN:
+        {
+            BITSEARCHDLGPARAM SearchParam;
+
+            GetDlgItemText(hDlg, IDC_BINARY_INPUT, SearchParam.InputFile, MAX_PATH);
+            SearchParam.InputBitOrder = IsDlgButtonChecked(hDlg, IDC_INPUT_BITORDER) == BST_CHECKED;
+            SearchParam.PrologueSize = -1;
+
+            if (DialogBoxParam(hInst, MAKEINTRESOURCE(IDD_BITTOOLS_BITSEARCH), hDlg,
+                    BitSearchDlg, (LPARAM)&SearchParam) == IDOK && SearchParam.PrologueSize >= 0) {
+                SetDlgItemInt(hDlg, IDC_PROLOGUE_SIZE, SearchParam.PrologueSize, TRUE);
+            }
+            return (INT_PTR)TRUE;
+        }
+
+        case IDC_FIND_XSIZE:
+        {
+            AUTOCORRDLGPARAM AutocorrParam;
+            BOOL bSuccess;
+            int BlockHeaderBits;
+
+            GetDlgItemText(hDlg, IDC_BINARY_INPUT, AutocorrParam.InputFile, MAX_PATH);
+            AutocorrParam.InputBitOrder = IsDlgButtonChecked(hDlg, IDC_INPUT_BITORDER) == BST_CHECKED;
+            AutocorrParam.PrologueSize = GetDlgItemInt(hDlg, IDC_PROLOGUE_SIZE, &bSuccess, TRUE);
+            if (!bSuccess || AutocorrParam.PrologueSize < 0) {
+                MessageBox(hDlg, L"# of bits to skip in prologue must be >= 0", L"Find line length", MB_OK);
+                return (INT_PTR)TRUE;
+            }
+            AutocorrParam.BitDepth = GetDlgItemInt(hDlg, IDC_BIT_DEPTH, &bSuccess, TRUE);
+            if (!bSuccess || AutocorrParam.BitDepth < 1) {
+                MessageBox(hDlg, L"Bit depth must be 1 or more", L"Find line length", MB_OK);
+                return (INT_PTR)TRUE;
+            }
+            BlockHeaderBits = GetDlgItemInt(hDlg, IDC_BLOCK_HEADER_BITS, &bSuccess, TRUE);
+            if (!bSuccess || BlockHeaderBits < 0) {
+                MessageBox(hDlg, L"# of bits in block header must be >= 0", L"Find line length", MB_OK);
+                return (INT_PTR)TRUE;
+            }
+            AutocorrParam.LineBits = -1;
+            AutocorrParam.BlockBits = -1;
+
+            if (DialogBoxParam(hInst, MAKEINTRESOURCE(IDD_BITTOOLS_AUTOCORR), hDlg,
+                    AutocorrDlg, (LPARAM)&AutocorrParam) == IDOK) {
+                if (AutocorrParam.LineBits > 0) {
+                    SetDlgItemInt(hDlg, IDC_XSIZE, AutocorrParam.LineBits / AutocorrParam.BitDepth, TRUE);
+                }
+                // the block period includes the block header, BitStream2Image()
+                // skips the header and then reads the block body bits
+                if (AutocorrParam.BlockBits > 0) {
+                    if (AutocorrParam.BlockBits <= BlockHeaderBits) {
+                        MessageBox(hDlg, L"Block period must be larger than the # of bits in block header",
+                            L"Find line length", MB_OK);
+                    }
+                    else {
+                        SetDlgItemInt(hDlg, IDC_BLOCK_BITS, AutocorrParam.BlockBits - BlockHeaderBits, TRUE);
+                    }
+                }
+            }
+            return (INT_PTR)TRUE;
+        }
+
         case IDC_IMAGE_OUTPUT_BROWSE:
         {
             PWSTR pszFilename;
@@ -351,6 +437,10 @@ INT_PTR CALLBACK Text2StreamDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
             CheckDlgButton(hDlg, IDC_BITORDER, BST_CHECKED);
         }
 
+        if (GetPrivateProfileInt(L"Text2StreamDlg", L"Parallel", 0, (LPCTSTR)strAppNameINI)) {
+            CheckDlgButton(hDlg, IDC_TEXT_PARALLEL, BST_CHECKED);
+        }
+
         return (INT_PTR)TRUE;
     }
 
@@ -402,6 +492,7 @@ INT_PTR CALLBACK Text2StreamDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
             WCHAR InputFile[MAX_PATH];
             WCHAR OutputFile[MAX_PATH];
             int BitOrder = 0;
+            BOOL Parallel;
             int iRes;
 
             GetDlgItemText(hDlg, IDC_TEXT_INPUT, InputFile, MAX_PATH);
@@ -411,7 +502,11 @@ INT_PTR CALLBACK Text2StreamDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
                 BitOrder = 1;
             }
 
-            iRes = ConvertText2BitStream(hDlg, InputFile, OutputFile, BitOrder);
+            Parallel = IsDlgButtonChecked(hDlg, IDC_TEXT_PARALLEL) == BST_CHECKED;
+
+            HCURSOR OldCursor = SetCursor(LoadCursor(NULL, IDC_WAIT));
+            iRes = ConvertText2BitStream(hDlg, InputFile, OutputFile, BitOrder, Parallel);
+            SetCursor(OldCursor);
             if (iRes != APP_SUCCESS) {
                 MessageMySETIBCAError(hDlg, iRes, L"Convert");
                 return (INT_PTR)TRUE;
@@ -434,6 +529,13 @@ INT_PTR CALLBACK Text2StreamDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
                 WritePrivateProfileString(L"Text2StreamDlg", L"BitOrder", L"0", (LPCTSTR)strAppNameINI);
             }
 
+            if (IsDlgButtonChecked(hDlg, IDC_TEXT_PARALLEL) == BST_CHECKED) {
+                WritePrivateProfileString(L"Text2StreamDlg", L"Parallel", L"1", (LPCTSTR)strAppNameINI);
+            }
+            else {
+                WritePrivateProfileString(L"Text2StreamDlg", L"Parallel", L"0", (LPCTSTR)strAppNameINI);
+            }
+
             EndDialog(hDlg, LOWORD(wParam));
             return (INT_PTR)TRUE;
 
@@ -445,360 +547,1310 @@ INT_PTR CALLBACK Text2StreamDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
     return (INT_PTR)FALSE;
 }
 
-//******************************************************************************
+//*******************************************************************************
 //
-// BitStream2Image
-// 
-// Convert packed binary bitstream file to image file
+// Message handler for BitSearchDlg dialog box.
 // 
-// Parameters:
-//  HWND hDlg               Handle of calling window or dialog
-//  WCHAR* InputFile        Packed Binary Btstream input file
-//  CHAR* OutputFile        Name of text file to output
-//  int PrologueSize        # of bits to skip in prologue
-//  int BlockHeaderBits     # of block header bits to skip
-//  int NumBlockBodyBits    # of bits in block (each block is converted to a frame
-//                          in the output image file) 
-//  int BlockNum            # of block in bitstream (becomes # of frames
-//                          in the output image file
-//  int xsize               # of pixels in a row
-//  int BitDepth            # of bits converted per pixel
-//  int BitOrder            0 - LSB to MSB, 1 - MSB to LSB
-//  int BitScale            Scale binary output, 0,1 -> 0,255
+// Finds bit patterns in a packed bitstream file, see BitSearch.cpp
+// When opened from BitImageDlg, lParam is a BITSEARCHDLGPARAM and OK
+// returns the prologue size for the selected match.
 // 
-//  The Ysize of the image is calculated as Ysize = NumBlockBodyBits/(xsize*bitdepth)
-//
-//******************************************************************************
-int BitStream2Image(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
-    int PrologueSize, int BlockHeaderBits, int NumBlockBodyBits, int BlockNum, int xsize,
-    int BitDepth, int BitOrder, int BitScale, int Invert, int InputBitOrder)
-{
-    FILE* In;
-    FILE* OutRaw;
-    int CurrentBit = 0;
-    int CurrentPrologueBit = 0;
-    int CurrentByteBit;
-    int CurrentPage = 0;
-    int CurrentHeaderBit = 0;
-    int CurrentPageBit = 0;
-    int CurrentPageCol = 0;
-    int CurentX = 0;
-    int CurrentY = 0;
-    int CurrentPixelBit;
-    errno_t ErrNum;
-    union PIXEL {
-        unsigned char bit8;
-        unsigned short bit16;
-        long bit32;
-    } Pixel;
+//*******************************************************************************
 
-    if (xsize <= 0) {
-        MessageBox(hDlg, L"x size must be >= 1", L"File I/O", MB_OK);
-        return 0;
-    }
+// matches from the last search
+static std::vector<BITSEARCHHIT> SearchHits;
+static int SearchPatternNum[BITSEARCH_MAX_PATTERNS];     // pattern field # of each searched pattern
+static int SearchPatternBits[BITSEARCH_MAX_PATTERNS];    // # of bits in each searched pattern
 
-    if (NumBlockBodyBits <= 0) {
-        MessageBox(hDlg, L"# bits in block >= 1", L"File I/O", MB_OK);
-        return 0;
-    }
+static const int SearchPatternIDs[BITSEARCH_MAX_PATTERNS] = {
+    IDC_SEARCH_PATTERN1, IDC_SEARCH_PATTERN2, IDC_SEARCH_PATTERN3, IDC_SEARCH_PATTERN4 };
+static const int SearchErrorsIDs[BITSEARCH_MAX_PATTERNS] = {
+    IDC_SEARCH_ERRORS1, IDC_SEARCH_ERRORS2, IDC_SEARCH_ERRORS3, IDC_SEARCH_ERRORS4 };
 
-    if (BitDepth <= 0 || BitDepth > 32) {
-        MessageBox(hDlg, L"1 <= Image bit depth <= 32", L"File I/O", MB_OK);
-        return 0;
-    }
+INT_PTR CALLBACK BitSearchDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam)
+{
+    switch (message)
+    {
+        WCHAR szString[MAX_PATH];
 
-    if (BitDepth != 1 && BitScale) {
-        MessageBox(hDlg, L"Scale Binary can only be used if Image bit depth is 1", L"File I/O", MB_OK);
-        return 0;
-    }
+    case WM_INITDIALOG:
+    {
+        BITSEARCHDLGPARAM* Param = (BITSEARCHDLGPARAM*)lParam;
+        int iRes;
 
-    ErrNum = _wfopen_s(&In, InputFile, L"rb");
-    if (In == NULL) {
-        MessageBox(hDlg, L"Could not open input file", L"File I/O", MB_OK);
-        return -2;
-    }
+        SetWindowLongPtr(hDlg, DWLP_USER, (LONG_PTR)Param);
+        SearchHits.clear();
 
-    ErrNum = _wfopen_s(&OutRaw, OutputFile, L"wb");
-    if (OutRaw == NULL) {
-        fclose(In);
-        MessageBox(hDlg, L"Could not open raw output file", L"File I/O", MB_OK);
-        return -2;
-    }
+        if (Param != NULL) {
+            SetDlgItemText(hDlg, IDC_BINARY_INPUT, Param->InputFile);
+            if (Param->InputBitOrder) {
+                CheckDlgButton(hDlg, IDC_INPUT_BITORDER, BST_CHECKED);
+            }
+        }
+        else {
+            GetPrivateProfileString(L"BitSearchDlg", L"BinaryInput", L"OriginalSource\\data17.bin", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+            SetDlgItemText(hDlg, IDC_BINARY_INPUT, szString);
 
-    // Initialize image file header
-    IMAGINGHEADER ImgHeader;
+            iRes = GetPrivateProfileInt(L"BitSearchDlg", L"InputBitOrder", 0, (LPCTSTR)strAppNameINI);
+            if (iRes) {
+                CheckDlgButton(hDlg, IDC_INPUT_BITORDER, BST_CHECKED);
+            }
+        }
 
-    ImgHeader.Endian = (short)-1;  // PC format
-    ImgHeader.HeaderSize = (short)sizeof(IMAGINGHEADER);
-    ImgHeader.ID = (short)0xaaaa;
-    ImgHeader.Version = (short)1;
-    ImgHeader.NumFrames = (short)BlockNum;
-    if (BitDepth <= 8) {
-        ImgHeader.PixelSize = (short)1;
-    }
-    else if (BitDepth <= 16) {
-        ImgHeader.PixelSize = (short)2;
-    }
-    else {
-        ImgHeader.PixelSize = (short)4;
-    }
-    ImgHeader.Xsize = xsize;
-    ImgHeader.Ysize = (NumBlockBodyBits / (xsize * BitDepth));
-    ImgHeader.Padding[0] = 0;
-    ImgHeader.Padding[1] = 0;
-    ImgHeader.Padding[2] = 0;
-    ImgHeader.Padding[3] = 0;
-    ImgHeader.Padding[4] = 0;
-    ImgHeader.Padding[5] = 0;
+        for (int i = 0; i < BITSEARCH_MAX_PATTERNS; i++) {
+            WCHAR Key[32];
 
-    // write header to file
-    fwrite(&ImgHeader, sizeof(IMAGINGHEADER), 1, OutRaw);
+            swprintf_s(Key, 32, L"Pattern%d", i + 1);
+            // the first pattern defaults to the ASIS sync header
+            GetPrivateProfileString(L"BitSearchDlg", Key, (i == 0) ? L"0xFFFF0690????44884488" : L"",
+                szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+            SetDlgItemText(hDlg, SearchPatternIDs[i], szString);
 
-    CurrentPixelBit = BitDepth - 1;
-    Pixel.bit32 = 0;
+            swprintf_s(Key, 32, L"Errors%d", i + 1);
+            GetPrivateProfileString(L"BitSearchDlg", Key, L"0", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+            SetDlgItemText(hDlg, SearchErrorsIDs[i], szString);
+        }
 
-    while (!feof(In)) {
-        char CurrentByte;
-        int BitValue;
-        size_t NumRead;
-        CurrentByteBit = 0;
+        GetPrivateProfileString(L"BitSearchDlg", L"MaxHits", L"10000", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_SEARCH_MAX_HITS, szString);
 
-        NumRead = fread(&CurrentByte, 1, 1, In);
-        if (NumRead <= 0) {
-            break;
+        iRes = GetPrivateProfileInt(L"BitSearchDlg", L"SkipPattern", 1, (LPCTSTR)strAppNameINI);
+        if (iRes) {
+            CheckDlgButton(hDlg, IDC_SEARCH_SKIP_PATTERN, BST_CHECKED);
         }
 
-        // process data bit by bit in the order of the bit transmission message
-        // input file is byte oriented MSB to LSB representing the bit order that the message was received
-        // This does not imply any bit ordering in the message itself.
-        while (CurrentByteBit < 8) {
-            // MSB to LSB in input data file 
-            if (InputBitOrder) {
-                BitValue = CurrentByte & (0x01 << CurrentByteBit);
-            }
-            else {
-                BitValue = CurrentByte & (0x80 >> CurrentByteBit);
-            }
-            if (Invert == 1) {
-                if (BitValue == 0) {
-                    BitValue = 1;
-                }
-                else {
-                    BitValue = 0;
-                }
+        return (INT_PTR)TRUE;
+    }
+
+    case WM_COMMAND:
+        switch (LOWORD(wParam)) {
+        case IDC_INPUT_BROWSE:
+        {
+            PWSTR pszFilename;
+            GetDlgItemText(hDlg, IDC_BINARY_INPUT, szString, MAX_PATH);
+            COMDLG_FILTERSPEC bitType[] =
+            {
+                 { L"bit stream files", L"*.bin" },
+                 { L"All Files", L"*.*" },
+            };
+
+            if (!CCFileOpen(hDlg, szString, &pszFilename, FALSE, 2, bitType, L"*.bin")) {
+                return (INT_PTR)TRUE;
             }
-            // Prologue block processing
-            // skip prologue, PrologueSize bits
-            if (PrologueSize > 0) {  // 0 based index
-                if (CurrentPrologueBit < PrologueSize) {
-                    CurrentByteBit++;
-                    CurrentPrologueBit++;
-                    CurrentBit++;
-                    continue;
-                }
-                else {
-                    if (CurrentPrologueBit == PrologueSize) {
-                        // mark so don't process in this block again
-                        CurrentPrologueBit++;
-                    }
-                }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
             }
-            // end of prologque processing
+            SetDlgItemText(hDlg, IDC_BINARY_INPUT, szString);
+            return (INT_PTR)TRUE;
+        }
 
-            // Page header block processing, one header per page
-            // skip page headers
-            if (BlockHeaderBits > 0) {
-                if (CurrentHeaderBit < BlockHeaderBits) {
-                    // process header bits
-                    CurrentByteBit++;
-                    CurrentHeaderBit++;
-                    CurrentBit++;
-                    continue;
-                }
-            }
-            // end of page header block processing
-
-            // these bits belong in page/tile/image
-
-            if (CurrentPageBit < NumBlockBodyBits) {
-                // this assumes that there could be 1 to 16 bits per pixel in the resulting image
-                if (BitValue) {
-                    // add to image byte if if bit depth is <=8, add to image int16 is bit depth >8
-                    // right now don't worry about pixel bit depth > 16
-                    // PixelByte, Pixel are a union.
-
-                    // data is always stored in resulting image MSB to LSB in byte/short
-                    // since Pixel value starts as 0 only need to set bits not clear them
-                    // Decode using Endian flag for LSB-MSB or MSB-LSB order
-                    if (BitDepth <= 8) {
-                        if (BitOrder) {
-                            // bit stream order is MSB to LSB
-                            Pixel.bit8 = Pixel.bit8 | (1 << CurrentPixelBit);
-                        }
-                        else {
-                            // bit stream order is LSB to MSB
-                            Pixel.bit8 = Pixel.bit8 | (1 << ((BitDepth - 1) - CurrentPixelBit));
-                        }
-                    }
-                    else if (BitDepth <= 16) {
-                        if (BitOrder) {
-                            // bit stream order is MSB to LSB
-                            Pixel.bit16 = Pixel.bit16 | (1 << CurrentPixelBit);
-                        }
-                        else {
-                            // bit stream order is LSB to MSB
-                            Pixel.bit16 = Pixel.bit16 | (1 << ((BitDepth - 1) - CurrentPixelBit));
-                        }
-                    }
-                    else {
-                        if (BitOrder) {
-                            // bit stream order is MSB to LSB
-                            Pixel.bit32 = Pixel.bit32 | (1 << CurrentPixelBit);
-                        }
-                        else {
-                            // bit stream order is LSB to MSB
-                            Pixel.bit32 = Pixel.bit32 | (1 << ((BitDepth - 1) - CurrentPixelBit));
-                        }
-                    }
-                }
-                CurrentPixelBit--;
-                if (CurrentPixelBit < 0) {
-                    if (BitDepth <= 8) {
-                        if (BitScale && Pixel.bit8 && (BitDepth == 1)) {
-                            Pixel.bit8 = 255;
-                        }
-                        fwrite(&Pixel.bit8, 1, 1, OutRaw);
-                    }
-                    else if (BitDepth <= 16) {
-                        fwrite(&Pixel.bit16, 2, 1, OutRaw);
-                    }
-                    else {
-                        fwrite(&Pixel.bit32, 4, 1, OutRaw);
+        case IDC_SEARCH:
+        {
+            BITPATTERN Patterns[BITSEARCH_MAX_PATTERNS];
+            WCHAR InputFile[MAX_PATH];
+            BOOL InputBitOrder;
+            BOOL Truncated;
+            BOOL bSuccess;
+            int NumPatterns = 0;
+            int MaxHits;
+            int iRes;
 
-                    }
-                    Pixel.bit16 = 0;
-                    CurrentPixelBit = BitDepth - 1;
+            GetDlgItemText(hDlg, IDC_BINARY_INPUT, InputFile, MAX_PATH);
+            InputBitOrder = IsDlgButtonChecked(hDlg, IDC_INPUT_BITORDER) == BST_CHECKED;
+
+            for (int i = 0; i < BITSEARCH_MAX_PATTERNS; i++) {
+                int MaxErrors;
+
+                GetDlgItemText(hDlg, SearchPatternIDs[i], szString, MAX_PATH);
+                if (szString[0] == 0) {
+                    continue;
                 }
-                CurrentPageCol++;
-                if (CurrentPageCol >= xsize) {
-                    CurrentPageCol = 0;
+                MaxErrors = GetDlgItemInt(hDlg, SearchErrorsIDs[i], &bSuccess, TRUE);
+                if (ParseBitPattern(szString, MaxErrors, &Patterns[NumPatterns]) != APP_SUCCESS) {
+                    WCHAR NewMessage[MAX_PATH];
+                    swprintf_s(NewMessage, MAX_PATH, L"Pattern %d is not valid\n"
+                        L"0,1 for each bit or 0x then hex digits, ? is don't care, up to %d bits\n"
+                        L"Bit errors must be less than the # of bits compared, up to %d",
+                        i + 1, BITSEARCH_MAX_BITS, BITSEARCH_MAX_ERRORS);
+                    MessageBox(hDlg, NewMessage, L"Find bit pattern", MB_OK);
+                    return (INT_PTR)TRUE;
                 }
-                CurrentByteBit++;
-                CurrentPageBit++;
-                CurrentBit++;
-                continue;
+                SearchPatternNum[NumPatterns] = i + 1;
+                SearchPatternBits[NumPatterns] = Patterns[NumPatterns].NumBits;
+                NumPatterns++;
             }
-            else {
-                // start on next page
-                CurrentHeaderBit = 0;
-                CurrentPageBit = 0;
-                CurrentPixelBit = BitDepth - 1;
-                CurrentPage++;
-                if (CurrentPage == BlockNum) {
-                    fclose(In);
-                    fclose(OutRaw);
-                    return 1;
-                }
+            if (NumPatterns == 0) {
+                MessageBox(hDlg, L"Enter a pattern to search for", L"Find bit pattern", MB_OK);
+                return (INT_PTR)TRUE;
             }
-        }
-    }
-    fclose(In);
-    fclose(OutRaw);
 
+            MaxHits = GetDlgItemInt(hDlg, IDC_SEARCH_MAX_HITS, &bSuccess, TRUE);
+            if (MaxHits < 1) {
+                MessageBox(hDlg, L"Most matches listed must be >= 1", L"Find bit pattern", MB_OK);
+                return (INT_PTR)TRUE;
+            }
 
-    return 1;
-}
-
-//*******************************************************************
-//
-// ConvertText2BitStream
-// 
-// Convert textfile to a packed BitStream binary file
-// 
-// Parameters:
-//  HWND hDlg               handle of calling window/dialog
-//  WCHAR* InputFile        text file with space delmited list of values
-//                          value < 0 , cause error to be returned
-//                          value = 0 is taken as bit with value 0
-//                          value > 0 is taken as bit with value 1
-//                          (file is multiple always of 8 bits)
-//  WCHAR* OutputFile       Packed Binary bit stream file
-//
-//*******************************************************************
-int ConvertText2BitStream(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int BitOrder)
-{
-    FILE* In;
-    FILE* Out;
-    int BitNumber;
-    int BitValue;
-    int ByteValue;
-    int iRes;
-    int TotalBits;
-    int TotalOneBits;
-    int TotalBytes;
-    errno_t ErrNum;
+            HWND hwndList = GetDlgItem(hDlg, IDC_SEARCH_HITS);
+            SendMessage(hwndList, LB_RESETCONTENT, 0, 0);
+            SetDlgItemText(hDlg, IDC_SEARCH_RESULT, L"");
 
-    BitNumber = 0;
-    ByteValue = 0;
-    TotalBits = 0;
-    TotalOneBits = 0;
-    TotalBytes = 0;
+            HCURSOR OldCursor = SetCursor(LoadCursor(NULL, IDC_WAIT));
+            iRes = BitSearchFile(InputFile, Patterns, NumPatterns, InputBitOrder,
+                MaxHits, SearchHits, &Truncated);
+            SetCursor(OldCursor);
+            if (iRes != APP_SUCCESS) {
+                MessageMySETIBCAError(hDlg, iRes, L"Find bit pattern");
+                return (INT_PTR)TRUE;
+            }
 
-    ErrNum = _wfopen_s(&In, InputFile, L"r");
-    if (In == NULL) {
-        MessageBox(hDlg, L"Could not open input file", L"File I/O", MB_OK);
-        return -2;
-    }
+            SendMessage(hwndList, WM_SETREDRAW, FALSE, 0);
+            for (int i = 0; i < (int)SearchHits.size(); i++) {
+                WCHAR Line[MAX_PATH];
+                int index;
 
-    ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
-    if (Out == NULL) {
-        fclose(In);
-        MessageBox(hDlg, L"Could not open raw output file", L"File I/O", MB_OK);
-        return -2;
-    }
+                swprintf_s(Line, MAX_PATH, L"bit %lld  (byte %lld bit %d)  pattern %d  %d errors",
+                    SearchHits[i].BitOffset, SearchHits[i].BitOffset / 8, (int)(SearchHits[i].BitOffset % 8),
+                    SearchPatternNum[SearchHits[i].Pattern], SearchHits[i].Errors);
+                index = (int)SendMessage(hwndList, LB_ADDSTRING, 0, (LPARAM)Line);
+                SendMessage(hwndList, LB_SETITEMDATA, index, (LPARAM)i);
+            }
+            SendMessage(hwndList, WM_SETREDRAW, TRUE, 0);
+            InvalidateRect(hwndList, NULL, TRUE);
 
-    while (!feof(In)) {
-        iRes = fscanf_s(In, "%d", &BitValue);
-        if (iRes != 1) {
-            // This is also a likely EOF condition
-            // so treat this error as if it is an EOF
-            // it could also be caused by text in the input file as oppsed to a number
-            break;
-        }
-        if (BitValue < 0) {
-            fclose(Out);
-            fclose(In);
-            return -3;
-        }
-        if (BitValue > 0) {
-            if (BitOrder) {
-                ByteValue = ByteValue | (0x01 << BitNumber);
+            if (Truncated) {
+                swprintf_s(szString, MAX_PATH, L"first %d matches, there are more", (int)SearchHits.size());
             }
             else {
-                ByteValue = ByteValue | (0x80 >> BitNumber);
+                swprintf_s(szString, MAX_PATH, L"%d matches", (int)SearchHits.size());
             }
-            TotalOneBits++;
-        }
-        TotalBits++;
-        BitNumber++;
-        if (BitNumber >= 8) {
-            fwrite(&ByteValue, 1, 1, Out);
-            ByteValue = 0;
-            BitNumber = 0;
-            TotalBytes++;
+            SetDlgItemText(hDlg, IDC_SEARCH_RESULT, szString);
+            return (INT_PTR)TRUE;
         }
-    }
 
-    if (BitNumber != 0) {
-        fwrite(&ByteValue, 1, 1, Out);
-    }
+        case IDC_SEARCH_SAVE:
+        {
+            PWSTR pszFilename;
+            FILE* Out;
 
-    TCHAR pszMessageBuf[MAX_PATH];
-    StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH, TEXT("Bitsream properties\n# of bits: %d\n# of set bits: %d\nBytes writtten: %d"),
-        TotalBits, TotalOneBits, TotalBytes);
-    MessageBox(hDlg, pszMessageBuf, L"Completed", MB_OK);
+            if (SearchHits.size() == 0) {
+                MessageBox(hDlg, L"No matches to save", L"Find bit pattern", MB_OK);
+                return (INT_PTR)TRUE;
+            }
+
+            szString[0] = 0;
+            COMDLG_FILTERSPEC csvType[] =
+            {
+                 { L"csv files", L"*.csv" },
+                 { L"All Files", L"*.*" },
+            };
+            if (!CCFileSave(hDlg, szString, &pszFilename, FALSE, 2, csvType, L".csv")) {
+                return (INT_PTR)TRUE;
+            }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
+            }
+
+            _wfopen_s(&Out, szString, L"w");
+            if (Out == NULL) {
+                MessageMySETIBCAError(hDlg, APPERR_FILEOPEN, L"Find bit pattern");
+                return (INT_PTR)TRUE;
+            }
+            fprintf(Out, "Bit offset, Byte, Bit in byte, Pattern, Errors\n");
+            for (auto& Hit : SearchHits) {
+                fprintf(Out, "%lld, %lld, %d, %d, %d\n", Hit.BitOffset, Hit.BitOffset / 8,
+                    (int)(Hit.BitOffset % 8), SearchPatternNum[Hit.Pattern], Hit.Errors);
+            }
+            if (ferror(Out)) {
+                MessageMySETIBCAError(hDlg, APPERR_FILEWRITE, L"Find bit pattern");
+            }
+            fclose(Out);
+            return (INT_PTR)TRUE;
+        }
+
+        case IDOK:
+        {
+            BITSEARCHDLGPARAM* Param = (BITSEARCHDLGPARAM*)GetWindowLongPtr(hDlg, DWLP_USER);
+            BOOL SkipPattern = IsDlgButtonChecked(hDlg, IDC_SEARCH_SKIP_PATTERN) == BST_CHECKED;
+
+            if (Param != NULL) {
+                int Selection = (int)SendDlgItemMessage(hDlg, IDC_SEARCH_HITS, LB_GETCURSEL, 0, 0);
+                if (Selection != LB_ERR) {
+                    int i = (int)SendDlgItemMessage(hDlg, IDC_SEARCH_HITS, LB_GETITEMDATA, Selection, 0);
+                    __int64 Prologue = SearchHits[i].BitOffset;
+                    if (SkipPattern) {
+                        Prologue += SearchPatternBits[SearchHits[i].Pattern];
+                    }
+                    if (Prologue > INT_MAX) {
+                        MessageBox(hDlg, L"Match is too far into the file for the prologue size", L"Find bit pattern", MB_OK);
+                        return (INT_PTR)TRUE;
+                    }
+                    Param->PrologueSize = (int)Prologue;
+                }
+            }
+            else {
+                // BitImageDlg saves the input file and bit order
+                GetDlgItemText(hDlg, IDC_BINARY_INPUT, szString, MAX_PATH);
+                WritePrivateProfileString(L"BitSearchDlg", L"BinaryInput", szString, (LPCTSTR)strAppNameINI);
+
+                if (IsDlgButtonChecked(hDlg, IDC_INPUT_BITORDER) == BST_CHECKED) {
+                    WritePrivateProfileString(L"BitSearchDlg", L"InputBitOrder", L"1", (LPCTSTR)strAppNameINI);
+                }
+                else {
+                    WritePrivateProfileString(L"BitSearchDlg", L"InputBitOrder", L"0", (LPCTSTR)strAppNameINI);
+                }
+            }
+
+            for (int i = 0; i < BITSEARCH_MAX_PATTERNS; i++) {
+                WCHAR Key[32];
+
+                swprintf_s(Key, 32, L"Pattern%d", i + 1);
+                GetDlgItemText(hDlg, SearchPatternIDs[i], szString, MAX_PATH);
+                WritePrivateProfileString(L"BitSearchDlg", Key, szString, (LPCTSTR)strAppNameINI);
+
+                swprintf_s(Key, 32, L"Errors%d", i + 1);
+                GetDlgItemText(hDlg, SearchErrorsIDs[i], szString, MAX_PATH);
+                WritePrivateProfileString(L"BitSearchDlg", Key, szString, (LPCTSTR)strAppNameINI);
+            }
+
+            GetDlgItemText(hDlg, IDC_SEARCH_MAX_HITS, szString, MAX_PATH);
+            WritePrivateProfileString(L"BitSearchDlg", L"MaxHits", szString, (LPCTSTR)strAppNameINI);
+
+            WritePrivateProfileString(L"BitSearchDlg", L"SkipPattern", SkipPattern ? L"1" : L"0", (LPCTSTR)strAppNameINI);
+
+            SearchHits.clear();
+            SearchHits.shrink_to_fit();
+            EndDialog(hDlg, LOWORD(wParam));
+            return (INT_PTR)TRUE;
+        }
+
+        case IDCANCEL:
+            SearchHits.clear();
+            SearchHits.shrink_to_fit();
+            EndDialog(hDlg, LOWORD(wParam));
+            return (INT_PTR)TRUE;
+        }
+    }
+    return (INT_PTR)FALSE;
+}
+
+//******************************************************************************
+//
+// RunProfileDlg
+//
+// Run length profile of a packed bitstream file.  The profile is saved
+// to a .csv file, the totals and the longest runs are shown in the dialog.
+//
+//******************************************************************************
+INT_PTR CALLBACK RunProfileDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam)
+{
+    UNREFERENCED_PARAMETER(lParam);
+    switch (message)
+    {
+        WCHAR szString[MAX_PATH];
+
+    case WM_INITDIALOG:
+    {
+        int iRes;
+
+        GetPrivateProfileString(L"RunProfileDlg", L"BinaryInput", L"OriginalSource\\data17.bin", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_BINARY_INPUT, szString);
+
+        iRes = GetPrivateProfileInt(L"RunProfileDlg", L"InputBitOrder", 0, (LPCTSTR)strAppNameINI);
+        if (iRes) {
+            CheckDlgButton(hDlg, IDC_INPUT_BITORDER, BST_CHECKED);
+        }
+
+        GetPrivateProfileString(L"RunProfileDlg", L"PrologueSize", L"0", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_PROLOGUE_SIZE, szString);
+
+        GetPrivateProfileString(L"RunProfileDlg", L"WindowBits", L"0", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_RUN_WINDOW_BITS, szString);
+
+        GetPrivateProfileString(L"RunProfileDlg", L"ProfileOutput", L"RunProfile.csv", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_BINARY_OUTPUT, szString);
+
+        return (INT_PTR)TRUE;
+    }
+
+    case WM_COMMAND:
+        switch (LOWORD(wParam)) {
+        case IDC_INPUT_BROWSE:
+        {
+            PWSTR pszFilename;
+            GetDlgItemText(hDlg, IDC_BINARY_INPUT, szString, MAX_PATH);
+            COMDLG_FILTERSPEC bitType[] =
+            {
+                 { L"bit stream files", L"*.bin" },
+                 { L"All Files", L"*.*" },
+            };
+
+            if (!CCFileOpen(hDlg, szString, &pszFilename, FALSE, 2, bitType, L"*.bin")) {
+                return (INT_PTR)TRUE;
+            }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
+            }
+            SetDlgItemText(hDlg, IDC_BINARY_INPUT, szString);
+            return (INT_PTR)TRUE;
+        }
+
+        case IDC_OUTPUT_BROWSE:
+        {
+            PWSTR pszFilename;
+            GetDlgItemText(hDlg, IDC_BINARY_OUTPUT, szString, MAX_PATH);
+            COMDLG_FILTERSPEC csvType[] =
+            {
+                 { L"csv files", L"*.csv" },
+                 { L"All Files", L"*.*" },
+            };
+            if (!CCFileSave(hDlg, szString, &pszFilename, FALSE, 2, csvType, L".csv")) {
+                return (INT_PTR)TRUE;
+            }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
+            }
+            SetDlgItemText(hDlg, IDC_BINARY_OUTPUT, szString);
+            return (INT_PTR)TRUE;
+        }
+
+        case IDC_RUN_PROFILE:
+        {
+            std::vector<RUNWINDOW> Windows;
+            RUNPROFILE* Profile;
+            WCHAR InputFile[MAX_PATH];
+            WCHAR OutputFile[MAX_PATH];
+            WCHAR Result[512];
+            BOOL InputBitOrder;
+            BOOL bSuccess;
+            int PrologueSize;
+            int WindowBits;
+            int iRes;
+
+            GetDlgItemText(hDlg, IDC_BINARY_INPUT, InputFile, MAX_PATH);
+            GetDlgItemText(hDlg, IDC_BINARY_OUTPUT, OutputFile, MAX_PATH);
+            InputBitOrder = IsDlgButtonChecked(hDlg, IDC_INPUT_BITORDER) == BST_CHECKED;
+
+            PrologueSize = GetDlgItemInt(hDlg, IDC_PROLOGUE_SIZE, &bSuccess, TRUE);
+            if (!bSuccess || PrologueSize < 0) {
+                MessageBox(hDlg, L"# of bits to skip in prologue must be >= 0", L"Run length profile", MB_OK);
+                return (INT_PTR)TRUE;
+            }
+            WindowBits = GetDlgItemInt(hDlg, IDC_RUN_WINDOW_BITS, &bSuccess, TRUE);
+            if (!bSuccess || (WindowBits != 0 && WindowBits < 64)) {
+                MessageBox(hDlg, L"# of bits in each window must be 0 or >= 64", L"Run length profile", MB_OK);
+                return (INT_PTR)TRUE;
+            }
+
+            Profile = new RUNPROFILE;
+            if (Profile == NULL) {
+                MessageMySETIBCAError(hDlg, APPERR_MEMALLOC, L"Run length profile");
+                return (INT_PTR)TRUE;
+            }
+            SetDlgItemText(hDlg, IDC_RUN_RESULT, L"");
+
+            HCURSOR OldCursor = SetCursor(LoadCursor(NULL, IDC_WAIT));
+            iRes = RunProfileFile(InputFile, InputBitOrder, PrologueSize, WindowBits,
+                Profile, (WindowBits != 0) ? &Windows : NULL);
+            SetCursor(OldCursor);
+            if (iRes == APPERR_PARAMETER) {
+                delete Profile;
+                swprintf_s(Result, 512, L"The prologue must be less than the # of bits in the file\n"
+                    L"and there can be at most %d windows", RUNPROFILE_MAX_WINDOWS);
+                MessageBox(hDlg, Result, L"Run length profile", MB_OK);
+                return (INT_PTR)TRUE;
+            }
+            if (iRes != APP_SUCCESS) {
+                delete Profile;
+                MessageMySETIBCAError(hDlg, iRes, L"Run length profile");
+                return (INT_PTR)TRUE;
+            }
+
+            swprintf_s(Result, 512, L"%lld bits, %lld 0 bits, %lld 1 bits\n"
+                L"%lld 0 runs, %lld 1 runs\n"
+                L"longest 0 run %lld bits at bit %lld\n"
+                L"longest 1 run %lld bits at bit %lld",
+                Profile->TotalBits, Profile->NumBits[0], Profile->NumBits[1],
+                Profile->NumRuns[0], Profile->NumRuns[1],
+                (Profile->NumTop[0] != 0) ? Profile->Top[0][0].Length : 0,
+                (Profile->NumTop[0] != 0) ? Profile->Top[0][0].BitOffset : 0,
+                (Profile->NumTop[1] != 0) ? Profile->Top[1][0].Length : 0,
+                (Profile->NumTop[1] != 0) ? Profile->Top[1][0].BitOffset : 0);
+            SetDlgItemText(hDlg, IDC_RUN_RESULT, Result);
+
+            iRes = SaveRunProfile(OutputFile, InputFile, Profile, &Windows);
+            delete Profile;
+            if (iRes != APP_SUCCESS) {
+                MessageMySETIBCAError(hDlg, iRes, L"Run length profile");
+            }
+            return (INT_PTR)TRUE;
+        }
+
+        case IDOK:
+            GetDlgItemText(hDlg, IDC_BINARY_INPUT, szString, MAX_PATH);
+            WritePrivateProfileString(L"RunProfileDlg", L"BinaryInput", szString, (LPCTSTR)strAppNameINI);
+
+            if (IsDlgButtonChecked(hDlg, IDC_INPUT_BITORDER) == BST_CHECKED) {
+                WritePrivateProfileString(L"RunProfileDlg", L"InputBitOrder", L"1", (LPCTSTR)strAppNameINI);
+            }
+            else {
+                WritePrivateProfileString(L"RunProfileDlg", L"InputBitOrder", L"0", (LPCTSTR)strAppNameINI);
+            }
+
+            GetDlgItemText(hDlg, IDC_PROLOGUE_SIZE, szString, MAX_PATH);
+            WritePrivateProfileString(L"RunProfileDlg", L"PrologueSize", szString, (LPCTSTR)strAppNameINI);
+
+            GetDlgItemText(hDlg, IDC_RUN_WINDOW_BITS, szString, MAX_PATH);
+            WritePrivateProfileString(L"RunProfileDlg", L"WindowBits", szString, (LPCTSTR)strAppNameINI);
+
+            GetDlgItemText(hDlg, IDC_BINARY_OUTPUT, szString, MAX_PATH);
+            WritePrivateProfileString(L"RunProfileDlg", L"ProfileOutput", szString, (LPCTSTR)strAppNameINI);
+
+            EndDialog(hDlg, LOWORD(wParam));
+            return (INT_PTR)TRUE;
+
+        case IDCANCEL:
+            EndDialog(hDlg, LOWORD(wParam));
+            return (INT_PTR)TRUE;
+        }
+    }
+    return (INT_PTR)FALSE;
+}
+
+//******************************************************************************
+//
+// AutocorrDlg
+//
+// Find the line length and block period of a packed bitstream from the
+// peaks in its autocorrelation.  When it is opened from BitImageDlg the
+// selected line length and block period are returned to set x size and
+// # bits in block.
+//
+//******************************************************************************
+INT_PTR CALLBACK AutocorrDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam)
+{
+    switch (message)
+    {
+        WCHAR szString[MAX_PATH];
+
+    case WM_INITDIALOG:
+    {
+        AUTOCORRDLGPARAM* Param = (AUTOCORRDLGPARAM*)lParam;
+        int iRes;
+
+        SetWindowLongPtr(hDlg, DWLP_USER, (LONG_PTR)Param);
+
+        if (Param != NULL) {
+            SetDlgItemText(hDlg, IDC_BINARY_INPUT, Param->InputFile);
+            if (Param->InputBitOrder) {
+                CheckDlgButton(hDlg, IDC_INPUT_BITORDER, BST_CHECKED);
+            }
+            SetDlgItemInt(hDlg, IDC_PROLOGUE_SIZE, Param->PrologueSize, TRUE);
+        }
+        else {
+            GetPrivateProfileString(L"AutocorrDlg", L"BinaryInput", L"OriginalSource\\data17.bin", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+            SetDlgItemText(hDlg, IDC_BINARY_INPUT, szString);
+
+            iRes = GetPrivateProfileInt(L"AutocorrDlg", L"InputBitOrder", 0, (LPCTSTR)strAppNameINI);
+            if (iRes) {
+                CheckDlgButton(hDlg, IDC_INPUT_BITORDER, BST_CHECKED);
+            }
+
+            GetPrivateProfileString(L"AutocorrDlg", L"PrologueSize", L"0", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+            SetDlgItemText(hDlg, IDC_PROLOGUE_SIZE, szString);
+        }
+
+        GetPrivateProfileString(L"AutocorrDlg", L"NumBits", L"1048576", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_AUTOCORR_NUM_BITS, szString);
+
+        GetPrivateProfileString(L"AutocorrDlg", L"LineMin", L"8", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_AUTOCORR_LINE_MIN, szString);
+
+        GetPrivateProfileString(L"AutocorrDlg", L"LineMax", L"2048", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_AUTOCORR_LINE_MAX, szString);
+
+        GetPrivateProfileString(L"AutocorrDlg", L"BlockMin", L"4096", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_AUTOCORR_BLOCK_MIN, szString);
+
+        GetPrivateProfileString(L"AutocorrDlg", L"BlockMax", L"262144", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_AUTOCORR_BLOCK_MAX, szString);
+
+        return (INT_PTR)TRUE;
+    }
+
+    case WM_COMMAND:
+        switch (LOWORD(wParam)) {
+        case IDC_INPUT_BROWSE:
+        {
+            PWSTR pszFilename;
+            GetDlgItemText(hDlg, IDC_BINARY_INPUT, szString, MAX_PATH);
+            COMDLG_FILTERSPEC bitType[] =
+            {
+                 { L"bit stream files", L"*.bin" },
+                 { L"All Files", L"*.*" },
+            };
+
+            if (!CCFileOpen(hDlg, szString, &pszFilename, FALSE, 2, bitType, L"*.bin")) {
+                return (INT_PTR)TRUE;
+            }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
+            }
+            SetDlgItemText(hDlg, IDC_BINARY_INPUT, szString);
+            return (INT_PTR)TRUE;
+        }
+
+        case IDC_AUTOCORR:
+        {
+            AUTOCORRDLGPARAM* Param = (AUTOCORRDLGPARAM*)GetWindowLongPtr(hDlg, DWLP_USER);
+            std::vector<double> Correlation;
+            std::vector<PERIODPEAK> Peaks;
+            WCHAR InputFile[MAX_PATH];
+            BOOL InputBitOrder;
+            BOOL bSuccess;
+            BOOL bRangeOK;
+            int PrologueSize;
+            int NumBits;
+            int LineMin, LineMax;
+            int BlockMin, BlockMax;
+            int BitsUsed;
+            int BitDepth = 1;
+            int iRes;
+
+            if (Param != NULL) {
+                BitDepth = Param->BitDepth;
+            }
+
+            GetDlgItemText(hDlg, IDC_BINARY_INPUT, InputFile, MAX_PATH);
+            InputBitOrder = IsDlgButtonChecked(hDlg, IDC_INPUT_BITORDER) == BST_CHECKED;
+            PrologueSize = GetDlgItemInt(hDlg, IDC_PROLOGUE_SIZE, &bSuccess, TRUE);
+            if (!bSuccess || PrologueSize < 0) {
+                MessageBox(hDlg, L"# of bits to skip in prologue must be >= 0", L"Find line length", MB_OK);
+                return (INT_PTR)TRUE;
+            }
+
+            NumBits = GetDlgItemInt(hDlg, IDC_AUTOCORR_NUM_BITS, &bSuccess, TRUE);
+            if (!bSuccess || NumBits < 2 || NumBits > AUTOCORR_MAX_BITS) {
+                swprintf_s(szString, MAX_PATH, L"# bits used must be 2 to %d", AUTOCORR_MAX_BITS);
+                MessageBox(hDlg, szString, L"Find line length", MB_OK);
+                return (INT_PTR)TRUE;
+            }
+
+            LineMin = GetDlgItemInt(hDlg, IDC_AUTOCORR_LINE_MIN, &bRangeOK, TRUE);
+            LineMax = GetDlgItemInt(hDlg, IDC_AUTOCORR_LINE_MAX, &bSuccess, TRUE);
+            bRangeOK = bRangeOK && bSuccess;
+            BlockMin = GetDlgItemInt(hDlg, IDC_AUTOCORR_BLOCK_MIN, &bSuccess, TRUE);
+            bRangeOK = bRangeOK && bSuccess;
+            BlockMax = GetDlgItemInt(hDlg, IDC_AUTOCORR_BLOCK_MAX, &bSuccess, TRUE);
+            bRangeOK = bRangeOK && bSuccess;
+            if (!bRangeOK || LineMin < 1 || LineMax < LineMin || BlockMin < 1 || BlockMax < BlockMin) {
+                MessageBox(hDlg, L"Line length and block period ranges must be 1 or more, smallest first", L"Find line length", MB_OK);
+                return (INT_PTR)TRUE;
+            }
+
+            HWND hwndLines = GetDlgItem(hDlg, IDC_AUTOCORR_LINES);
+            HWND hwndBlocks = GetDlgItem(hDlg, IDC_AUTOCORR_BLOCKS);
+            SendMessage(hwndLines, LB_RESETCONTENT, 0, 0);
+            SendMessage(hwndBlocks, LB_RESETCONTENT, 0, 0);
+            SetDlgItemText(hDlg, IDC_AUTOCORR_RESULT, L"");
+
+            HCURSOR OldCursor = SetCursor(LoadCursor(NULL, IDC_WAIT));
+            iRes = BitAutocorrelation(InputFile, InputBitOrder, PrologueSize, NumBits,
+                (LineMax > BlockMax) ? LineMax + 1 : BlockMax + 1, Correlation, &BitsUsed);
+            SetCursor(OldCursor);
+            if (iRes != APP_SUCCESS) {
+                MessageMySETIBCAError(hDlg, iRes, L"Find line length");
+                return (INT_PTR)TRUE;
+            }
+
+            // line lengths, x size is the line length / image bit depth
+            FindPeriodPeaks(Correlation, LineMin, LineMax, AUTOCORR_MAX_PEAKS, Peaks);
+            for (auto& Peak : Peaks) {
+                WCHAR Line[MAX_PATH];
+                int index;
+
+                if ((Peak.Lag % BitDepth) == 0) {
+                    swprintf_s(Line, MAX_PATH, L"%d bits  (x size %d)  %.3f", Peak.Lag, Peak.Lag / BitDepth, Peak.Correlation);
+                }
+                else {
+                    swprintf_s(Line, MAX_PATH, L"%d bits  %.3f", Peak.Lag, Peak.Correlation);
+                }
+                index = (int)SendMessage(hwndLines, LB_ADDSTRING, 0, (LPARAM)Line);
+                SendMessage(hwndLines, LB_SETITEMDATA, index, (LPARAM)Peak.Lag);
+            }
+            if (Peaks.size() != 0) {
+                SendMessage(hwndLines, LB_SETCURSEL, 0, 0);
+            }
+
+            FindPeriodPeaks(Correlation, BlockMin, BlockMax, AUTOCORR_MAX_PEAKS, Peaks);
+            for (auto& Peak : Peaks) {
+                WCHAR Line[MAX_PATH];
+                int index;
+
+                swprintf_s(Line, MAX_PATH, L"%d bits  %.3f", Peak.Lag, Peak.Correlation);
+                index = (int)SendMessage(hwndBlocks, LB_ADDSTRING, 0, (LPARAM)Line);
+                SendMessage(hwndBlocks, LB_SETITEMDATA, index, (LPARAM)Peak.Lag);
+            }
+
+            swprintf_s(szString, MAX_PATH, L"%d bits used, lags up to %d", BitsUsed, (int)Correlation.size() - 1);
+            SetDlgItemText(hDlg, IDC_AUTOCORR_RESULT, szString);
+            return (INT_PTR)TRUE;
+        }
+
+        case IDOK:
+        {
+            AUTOCORRDLGPARAM* Param = (AUTOCORRDLGPARAM*)GetWindowLongPtr(hDlg, DWLP_USER);
+
+            if (Param != NULL) {
+                int Selection = (int)SendDlgItemMessage(hDlg, IDC_AUTOCORR_LINES, LB_GETCURSEL, 0, 0);
+                if (Selection != LB_ERR) {
+                    Param->LineBits = (int)SendDlgItemMessage(hDlg, IDC_AUTOCORR_LINES, LB_GETITEMDATA, Selection, 0);
+                    if ((Param->LineBits % Param->BitDepth) != 0) {
+                        MessageBox(hDlg, L"Line length must be a multiple of the image bit depth", L"Find line length", MB_OK);
+                        return (INT_PTR)TRUE;
+                    }
+                }
+                Selection = (int)SendDlgItemMessage(hDlg, IDC_AUTOCORR_BLOCKS, LB_GETCURSEL, 0, 0);
+                if (Selection != LB_ERR) {
+                    Param->BlockBits = (int)SendDlgItemMessage(hDlg, IDC_AUTOCORR_BLOCKS, LB_GETITEMDATA, Selection, 0);
+                }
+            }
+            else {
+                // BitImageDlg saves the input file, bit order and prologue
+                GetDlgItemText(hDlg, IDC_BINARY_INPUT, szString, MAX_PATH);
+                WritePrivateProfileString(L"AutocorrDlg", L"BinaryInput", szString, (LPCTSTR)strAppNameINI);
+
+                if (IsDlgButtonChecked(hDlg, IDC_INPUT_BITORDER) == BST_CHECKED) {
+                    WritePrivateProfileString(L"AutocorrDlg", L"InputBitOrder", L"1", (LPCTSTR)strAppNameINI);
+                }
+                else {
+                    WritePrivateProfileString(L"AutocorrDlg", L"InputBitOrder", L"0", (LPCTSTR)strAppNameINI);
+                }
+
+                GetDlgItemText(hDlg, IDC_PROLOGUE_SIZE, szString, MAX_PATH);
+                WritePrivateProfileString(L"AutocorrDlg", L"PrologueSize", szString, (LPCTSTR)strAppNameINI);
+            }
+
+            GetDlgItemText(hDlg, IDC_AUTOCORR_NUM_BITS, szString, MAX_PATH);
+            WritePrivateProfileString(L"AutocorrDlg", L"NumBits", szString, (LPCTSTR)strAppNameINI);
+
+            GetDlgItemText(hDlg, IDC_AUTOCORR_LINE_MIN, szString, MAX_PATH);
+            WritePrivateProfileString(L"AutocorrDlg", L"LineMin", szString, (LPCTSTR)strAppNameINI);
+
+            GetDlgItemText(hDlg, IDC_AUTOCORR_LINE_MAX, szString, MAX_PATH);
+            WritePrivateProfileString(L"AutocorrDlg", L"LineMax", szString, (LPCTSTR)strAppNameINI);
+
+            GetDlgItemText(hDlg, IDC_AUTOCORR_BLOCK_MIN, szString, MAX_PATH);
+            WritePrivateProfileString(L"AutocorrDlg", L"BlockMin", szString, (LPCTSTR)strAppNameINI);
+
+            GetDlgItemText(hDlg, IDC_AUTOCORR_BLOCK_MAX, szString, MAX_PATH);
+            WritePrivateProfileString(L"AutocorrDlg", L"BlockMax", szString, (LPCTSTR)strAppNameINI);
+
+            EndDialog(hDlg, LOWORD(wParam));
+            return (INT_PTR)TRUE;
+        }
+
+        case IDCANCEL:
+            EndDialog(hDlg, LOWORD(wParam));
+            return (INT_PTR)TRUE;
+        }
+    }
+    return (INT_PTR)FALSE;
+}
+
+//******************************************************************************
+//
+// GalleryDlg
+//
+// Parameter sweep gallery, an image for each combination of the BitImageDlg
+// parameters in a grid made from one read of the bitstream file.  The images
+// are ranked by a structure score and the top left of each is put in a mosaic.
+//
+//******************************************************************************
+static BOOL GetGalleryFlags(HWND hDlg, int Control0, int Control1, GALLERYRANGE* Range)
+{
+    BOOL Use0 = IsDlgButtonChecked(hDlg, Control0) == BST_CHECKED;
+    BOOL Use1 = IsDlgButtonChecked(hDlg, Control1) == BST_CHECKED;
+
+    if (!Use0 && !Use1) {
+        return FALSE;
+    }
+    Range->First = Use0 ? 0 : 1;
+    Range->Last = Use1 ? 1 : 0;
+    Range->Step = 1;
+    return TRUE;
+}
+
+INT_PTR CALLBACK GalleryDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam)
+{
+    UNREFERENCED_PARAMETER(lParam);
+    // INI key, control, default
+    static const struct {
+        const WCHAR* Key;
+        int Control;
+        const WCHAR* Default;
+    } GalleryText[] = {
+        { L"BinaryInput", IDC_BINARY_INPUT, L"OriginalSource\\data17.bin" },
+        { L"OutputDir", IDC_GALLERY_OUTPUT, L"" },
+        { L"Name", IDC_GALLERY_NAME, L"gallery" },
+        { L"PrologueFirst", IDC_GALLERY_PROLOGUE_FIRST, L"0" },
+        { L"PrologueLast", IDC_GALLERY_PROLOGUE_LAST, L"0" },
+        { L"PrologueStep", IDC_GALLERY_PROLOGUE_STEP, L"1" },
+        { L"XsizeFirst", IDC_GALLERY_XSIZE_FIRST, L"248" },
+        { L"XsizeLast", IDC_GALLERY_XSIZE_LAST, L"260" },
+        { L"XsizeStep", IDC_GALLERY_XSIZE_STEP, L"1" },
+        { L"BitDepthFirst", IDC_GALLERY_DEPTH_FIRST, L"1" },
+        { L"BitDepthLast", IDC_GALLERY_DEPTH_LAST, L"1" },
+        { L"BlockHeaderBits", IDC_BLOCK_HEADER_BITS, L"0" },
+        { L"NumBlockBodyBits", IDC_BLOCK_BITS, L"65536" },
+        { L"CellSize", IDC_GALLERY_CELL, L"64" },
+        { L"Columns", IDC_GALLERY_COLUMNS, L"8" },
+    };
+    // INI key, check box, default
+    static const struct {
+        const WCHAR* Key;
+        int Control;
+        int Default;
+    } GalleryCheck[] = {
+        { L"BitOrder0", IDC_GALLERY_BITORDER0, 1 },
+        { L"BitOrder1", IDC_GALLERY_BITORDER1, 0 },
+        { L"InputBitOrder0", IDC_GALLERY_INBITORDER0, 1 },
+        { L"InputBitOrder1", IDC_GALLERY_INBITORDER1, 0 },
+        { L"Invert0", IDC_GALLERY_INVERT0, 1 },
+        { L"Invert1", IDC_GALLERY_INVERT1, 0 },
+        { L"SaveRaw", IDC_GALLERY_SAVE_RAW, 0 },
+        { L"SavePNG", IDC_GALLERY_SAVE_PNG, 1 },
+    };
+
+    switch (message)
+    {
+        WCHAR szString[MAX_PATH];
+
+    case WM_INITDIALOG:
+        for (auto& Text : GalleryText) {
+            GetPrivateProfileString(L"GalleryDlg", Text.Key, Text.Default, szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+            SetDlgItemText(hDlg, Text.Control, szString);
+        }
+        for (auto& Check : GalleryCheck) {
+            if (GetPrivateProfileInt(L"GalleryDlg", Check.Key, Check.Default, (LPCTSTR)strAppNameINI)) {
+                CheckDlgButton(hDlg, Check.Control, BST_CHECKED);
+            }
+        }
+        return (INT_PTR)TRUE;
+
+    case WM_COMMAND:
+        switch (LOWORD(wParam)) {
+        case IDC_INPUT_BROWSE:
+        {
+            PWSTR pszFilename;
+            GetDlgItemText(hDlg, IDC_BINARY_INPUT, szString, MAX_PATH);
+            COMDLG_FILTERSPEC bitType[] =
+            {
+                 { L"bit stream files", L"*.bin" },
+                 { L"All Files", L"*.*" },
+            };
+
+            if (!CCFileOpen(hDlg, szString, &pszFilename, FALSE, 2, bitType, L"*.bin")) {
+                return (INT_PTR)TRUE;
+            }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
+            }
+            SetDlgItemText(hDlg, IDC_BINARY_INPUT, szString);
+            return (INT_PTR)TRUE;
+        }
+
+        case IDC_GALLERY_OUTPUT_BROWSE:
+        {
+            PWSTR pszFilename;
+            GetDlgItemText(hDlg, IDC_GALLERY_OUTPUT, szString, MAX_PATH);
+            COMDLG_FILTERSPEC dirType[] =
+            {
+                 { L"All Files", L"*.*" } };
+            if (!CCFileOpen(hDlg, szString, &pszFilename, TRUE, 1, dirType, L"")) {
+                return (INT_PTR)TRUE;
+            }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
+            }
+            SetDlgItemText(hDlg, IDC_GALLERY_OUTPUT, szString);
+            return (INT_PTR)TRUE;
+        }
+
+        case IDC_GALLERY:
+        {
+            GALLERYPARAM Param;
+            std::vector<GALLERYTILE> Tiles;
+            WCHAR InputFile[MAX_PATH];
+            WCHAR OutputDir[MAX_PATH];
+            WCHAR Name[_MAX_FNAME];
+            BOOL bSuccess;
+            int NumMade = 0;
+            int iRes;
+
+            GetDlgItemText(hDlg, IDC_BINARY_INPUT, InputFile, MAX_PATH);
+            GetDlgItemText(hDlg, IDC_GALLERY_OUTPUT, OutputDir, MAX_PATH);
+            GetDlgItemText(hDlg, IDC_GALLERY_NAME, Name, _MAX_FNAME);
+            if (wcslen(Name) == 0) {
+                MessageBox(hDlg, L"Enter a name for the gallery files", L"Parameter sweep gallery", MB_OK);
+                return (INT_PTR)TRUE;
+            }
+
+            Param.PrologueSize.First = GetDlgItemInt(hDlg, IDC_GALLERY_PROLOGUE_FIRST, &bSuccess, TRUE);
+            Param.PrologueSize.Last = GetDlgItemInt(hDlg, IDC_GALLERY_PROLOGUE_LAST, &bSuccess, TRUE);
+            Param.PrologueSize.Step = GetDlgItemInt(hDlg, IDC_GALLERY_PROLOGUE_STEP, &bSuccess, TRUE);
+            Param.Xsize.First = GetDlgItemInt(hDlg, IDC_GALLERY_XSIZE_FIRST, &bSuccess, TRUE);
+            Param.Xsize.Last = GetDlgItemInt(hDlg, IDC_GALLERY_XSIZE_LAST, &bSuccess, TRUE);
+            Param.Xsize.Step = GetDlgItemInt(hDlg, IDC_GALLERY_XSIZE_STEP, &bSuccess, TRUE);
+            Param.BitDepth.First = GetDlgItemInt(hDlg, IDC_GALLERY_DEPTH_FIRST, &bSuccess, TRUE);
+            Param.BitDepth.Last = GetDlgItemInt(hDlg, IDC_GALLERY_DEPTH_LAST, &bSuccess, TRUE);
+            Param.BitDepth.Step = 1;
+            if (!GetGalleryFlags(hDlg, IDC_GALLERY_BITORDER0, IDC_GALLERY_BITORDER1, &Param.BitOrder) ||
+                !GetGalleryFlags(hDlg, IDC_GALLERY_INBITORDER0, IDC_GALLERY_INBITORDER1, &Param.InputBitOrder) ||
+                !GetGalleryFlags(hDlg, IDC_GALLERY_INVERT0, IDC_GALLERY_INVERT1, &Param.Invert)) {
+                MessageBox(hDlg, L"Check at least one value of bit order, input bit order and invert", L"Parameter sweep gallery", MB_OK);
+                return (INT_PTR)TRUE;
+            }
+            Param.BlockHeaderBits = GetDlgItemInt(hDlg, IDC_BLOCK_HEADER_BITS, &bSuccess, TRUE);
+            if (Param.BlockHeaderBits < 0) {
+                Param.BlockHeaderBits = 0;
+            }
+            Param.NumBlockBodyBits = GetDlgItemInt(hDlg, IDC_BLOCK_BITS, &bSuccess, TRUE);
+            Param.CellSize = GetDlgItemInt(hDlg, IDC_GALLERY_CELL, &bSuccess, TRUE);
+            Param.Columns = GetDlgItemInt(hDlg, IDC_GALLERY_COLUMNS, &bSuccess, TRUE);
+            Param.SaveRawFiles = IsDlgButtonChecked(hDlg, IDC_GALLERY_SAVE_RAW) == BST_CHECKED;
+            Param.SavePNGfiles = IsDlgButtonChecked(hDlg, IDC_GALLERY_SAVE_PNG) == BST_CHECKED;
+
+            SetDlgItemText(hDlg, IDC_GALLERY_RESULT, L"");
+            HCURSOR OldCursor = SetCursor(LoadCursor(NULL, IDC_WAIT));
+            iRes = SweepGallery(InputFile, OutputDir, Name, &Param, Tiles);
+            SetCursor(OldCursor);
+            if (iRes == APPERR_PARAMETER && Tiles.size() == 0) {
+                swprintf_s(szString, MAX_PATH, L"Check the ranges, first <= last, step >= 1, bit depth 1 to %d,\n"
+                    L"mosaic cell 1 to %d, at most %d images",
+                    GALLERY_MAX_BIT_DEPTH, GALLERY_MAX_CELL_SIZE, GALLERY_MAX_TILES);
+                MessageBox(hDlg, szString, L"Parameter sweep gallery", MB_OK);
+                return (INT_PTR)TRUE;
+            }
+            if (iRes != APP_SUCCESS) {
+                MessageMySETIBCAError(hDlg, iRes, L"Parameter sweep gallery");
+                return (INT_PTR)TRUE;
+            }
+
+            int FileError = APP_SUCCESS;
+            for (auto& Tile : Tiles) {
+                if (Tile.Status == APP_SUCCESS) {
+                    NumMade++;
+                }
+                else if (FileError == APP_SUCCESS &&
+                    (Tile.Status == APPERR_FILEOPEN || Tile.Status == APPERR_FILEWRITE)) {
+                    // the image was made but its .raw or .png file could not be written
+                    FileError = Tile.Status;
+                }
+            }
+            if (FileError != APP_SUCCESS) {
+                MessageMySETIBCAError(hDlg, FileError, L"Parameter sweep gallery, saving image files");
+            }
+            if (NumMade == 0) {
+                swprintf_s(szString, MAX_PATH, L"No images, the file is too short or # bits in block < x size * bit depth");
+            }
+            else {
+                swprintf_s(szString, MAX_PATH, L"%d of %d images, best: prologue %d, x size %d, bit depth %d, score %.3f",
+                    NumMade, (int)Tiles.size(), Tiles[0].PrologueSize, Tiles[0].Xsize, Tiles[0].BitDepth, Tiles[0].Score);
+            }
+            SetDlgItemText(hDlg, IDC_GALLERY_RESULT, szString);
+            return (INT_PTR)TRUE;
+        }
+
+        case IDOK:
+            for (auto& Text : GalleryText) {
+                GetDlgItemText(hDlg, Text.Control, szString, MAX_PATH);
+                WritePrivateProfileString(L"GalleryDlg", Text.Key, szString, (LPCTSTR)strAppNameINI);
+            }
+            for (auto& Check : GalleryCheck) {
+                if (IsDlgButtonChecked(hDlg, Check.Control) == BST_CHECKED) {
+                    WritePrivateProfileString(L"GalleryDlg", Check.Key, L"1", (LPCTSTR)strAppNameINI);
+                }
+                else {
+                    WritePrivateProfileString(L"GalleryDlg", Check.Key, L"0", (LPCTSTR)strAppNameINI);
+                }
+            }
+            EndDialog(hDlg, LOWORD(wParam));
+            return (INT_PTR)TRUE;
+
+        case IDCANCEL:
+            EndDialog(hDlg, LOWORD(wParam));
+            return (INT_PTR)TRUE;
+        }
+    }
+    return (INT_PTR)FALSE;
+}
+
+//******************************************************************************
+//
+// Buffered bitstream reader used by BitStream2Image
+//
+// The input file is read BITREADER_SIZE bytes at a time.  There are always
+// 8 zero bytes after the data in the buffer so a 64 bit word can be loaded
+// from any byte in the buffer.
+//
+//******************************************************************************
+#define BITREADER_SIZE (4 << 20)
+
+typedef struct {
+    FILE* In;
+    BYTE* Buffer;           // BITREADER_SIZE + 8 bytes
+    __int64 BufferStart;    // file byte # of Buffer[0]
+    size_t BufferBytes;     // # of file bytes in Buffer
+    BOOL Eof;               // TRUE no more bytes after the buffer
+    int InputBitOrder;      // bytes in the file are LSB first, reversed as they are read
+} BITREADER;
+
+//******************************************************************************
+//
+// FillBitReader
+// 
+// Make sure the 8 bytes starting at file byte # Byte are in the buffer.
+// Byte must not be before the start of the buffer.
+// 
+// Parameters:
+//  BITREADER* Reader       reader
+//  __int64 Byte            file byte #
+// 
+//  return value:
+//  # of bytes from Byte that are in the file, 0 to 8
+//  -1 if the file could not be read
+//
+//******************************************************************************
+static int FillBitReader(BITREADER* Reader, __int64 Byte)
+{
+    __int64 BufferEnd = Reader->BufferStart + (__int64)Reader->BufferBytes;
+    size_t Keep = 0;
+    size_t NumRead;
+
+    if (Byte + 8 <= BufferEnd) {
+        return 8;
+    }
+    if (Reader->Eof) {
+        return (Byte < BufferEnd) ? (int)(BufferEnd - Byte) : 0;
+    }
+
+    // keep the bytes from Byte on, skip to Byte if it is past the buffer
+    if (Byte < BufferEnd) {
+        Keep = (size_t)(BufferEnd - Byte);
+        memmove(Reader->Buffer, Reader->Buffer + (Byte - Reader->BufferStart), Keep);
+    }
+    else if (Byte > BufferEnd) {
+        if (_fseeki64(Reader->In, Byte, SEEK_SET) != 0) {
+            return -1;
+        }
+    }
+    Reader->BufferStart = Byte;
+
+    NumRead = fread(Reader->Buffer + Keep, 1, BITREADER_SIZE - Keep, Reader->In);
+    if (NumRead < BITREADER_SIZE - Keep) {
+        if (ferror(Reader->In)) {
+            return -1;
+        }
+        Reader->Eof = TRUE;
+    }
+    if (Reader->InputBitOrder) {
+        for (size_t i = Keep; i < Keep + NumRead; i++) {
+            Reader->Buffer[i] = ReverseByte[Reader->Buffer[i]];
+        }
+    }
+    Reader->BufferBytes = Keep + NumRead;
+    memset(Reader->Buffer + Reader->BufferBytes, 0, 8);
+
+    return (Reader->BufferBytes < 8) ? (int)Reader->BufferBytes : 8;
+}
+
+//******************************************************************************
+//
+// BitStream2Image
+// 
+// Convert packed binary bitstream file to image file
+// 
+// Parameters:
+//  HWND hDlg               Handle of calling window or dialog
+//  WCHAR* InputFile        Packed Binary Btstream input file
+//  CHAR* OutputFile        Name of text file to output
+//  int PrologueSize        # of bits to skip in prologue
+//  int BlockHeaderBits     # of block header bits to skip
+//  int NumBlockBodyBits    # of bits in block (each block is converted to a frame
+//                          in the output image file) 
+//  int BlockNum            # of block in bitstream (becomes # of frames
+//                          in the output image file
+//  int xsize               # of pixels in a row
+//  int BitDepth            # of bits converted per pixel
+//  int BitOrder            0 - LSB to MSB, 1 - MSB to LSB
+//  int BitScale            Scale binary output, 0,1 -> 0,255
+//  int Invert              1 - invert each bit of the input
+//  int InputBitOrder       1 - bytes in the input file are LSB to MSB
+// 
+//  The Ysize of the image is calculated as Ysize = NumBlockBodyBits/(xsize*bitdepth)
+//
+//  The input is read in large blocks and each pixel is taken from a 64 bit
+//  word with shifts.  Each block is converted into a frame buffer that is
+//  written with one fwrite.  Bits left over at the end of a block that do not
+//  make a whole pixel are skipped.  If the input ends before the last block
+//  the output stops at the last whole pixel.
+//
+//******************************************************************************
+int BitStream2Image(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile,
+    int PrologueSize, int BlockHeaderBits, int NumBlockBodyBits, int BlockNum, int xsize,
+    int BitDepth, int BitOrder, int BitScale, int Invert, int InputBitOrder)
+{
+    FILE* In;
+    FILE* OutRaw;
+    BITREADER Reader;
+    BYTE* Frame;
+    size_t PixelSize;
+    int PixelsPerBlock;
+    unsigned int InvertMask;
+    __int64 CurrentBit;
+    BOOL EndOfInput = FALSE;
+    int iRes = APP_SUCCESS;
+    errno_t ErrNum;
+
+    if (xsize <= 0) {
+        MessageBox(hDlg, L"x size must be >= 1", L"File I/O", MB_OK);
+        return 0;
+    }
+
+    if (NumBlockBodyBits <= 0) {
+        MessageBox(hDlg, L"# bits in block >= 1", L"File I/O", MB_OK);
+        return 0;
+    }
+
+    if (BitDepth <= 0 || BitDepth > 32) {
+        MessageBox(hDlg, L"1 <= Image bit depth <= 32", L"File I/O", MB_OK);
+        return 0;
+    }
+
+    if (BitDepth != 1 && BitScale) {
+        MessageBox(hDlg, L"Scale Binary can only be used if Image bit depth is 1", L"File I/O", MB_OK);
+        return 0;
+    }
+
+    // no prologue, no block header if < 0
+    if (PrologueSize < 0) {
+        PrologueSize = 0;
+    }
+    if (BlockHeaderBits < 0) {
+        BlockHeaderBits = 0;
+    }
+
+    if (BitDepth <= 8) {
+        PixelSize = 1;
+    }
+    else if (BitDepth <= 16) {
+        PixelSize = 2;
+    }
+    else {
+        PixelSize = 4;
+    }
+    PixelsPerBlock = NumBlockBodyBits / BitDepth;
+    InvertMask = Invert ? (0xFFFFFFFF >> (32 - BitDepth)) : 0;
+
+    ErrNum = _wfopen_s(&In, InputFile, L"rb");
+    if (In == NULL) {
+        MessageBox(hDlg, L"Could not open input file", L"File I/O", MB_OK);
+        return -2;
+    }
+
+    ErrNum = _wfopen_s(&OutRaw, OutputFile, L"wb");
+    if (OutRaw == NULL) {
+        fclose(In);
+        MessageBox(hDlg, L"Could not open raw output file", L"File I/O", MB_OK);
+        return -2;
+    }
+
+    Reader.In = In;
+    Reader.Buffer = new BYTE[BITREADER_SIZE + 8];
+    Reader.BufferStart = 0;
+    Reader.BufferBytes = 0;
+    Reader.Eof = FALSE;
+    Reader.InputBitOrder = InputBitOrder;
+    Frame = new BYTE[(size_t)PixelsPerBlock * PixelSize];
+    if (Reader.Buffer == NULL || Frame == NULL) {
+        if (Reader.Buffer != NULL) delete[] Reader.Buffer;
+        if (Frame != NULL) delete[] Frame;
+        fclose(In);
+        fclose(OutRaw);
+        return APPERR_MEMALLOC;
+    }
+
+    // Initialize image file header
+    IMAGINGHEADER ImgHeader;
+
+    ImgHeader.Endian = (short)-1;  // PC format
+    ImgHeader.HeaderSize = (short)sizeof(IMAGINGHEADER);
+    ImgHeader.ID = (short)0xaaaa;
+    ImgHeader.Version = (short)1;
+    ImgHeader.NumFrames = (short)BlockNum;
+    ImgHeader.PixelSize = (short)PixelSize;
+    ImgHeader.Xsize = xsize;
+    ImgHeader.Ysize = (NumBlockBodyBits / (xsize * BitDepth));
+    ImgHeader.Padding[0] = 0;
+    ImgHeader.Padding[1] = 0;
+    ImgHeader.Padding[2] = 0;
+    ImgHeader.Padding[3] = 0;
+    ImgHeader.Padding[4] = 0;
+    ImgHeader.Padding[5] = 0;
+
+    // write header to file
+    if (fwrite(&ImgHeader, sizeof(IMAGINGHEADER), 1, OutRaw) != 1) {
+        iRes = APPERR_FILEWRITE;
+        BlockNum = 0;
+    }
+
+    // input file is byte oriented MSB to LSB representing the bit order that the message was received
+    // This does not imply any bit ordering in the message itself.
+    CurrentBit = PrologueSize;
+    for (int CurrentPage = 0; CurrentPage < BlockNum && !EndOfInput; CurrentPage++) {
+        int NumPixels = 0;
+
+        // skip page header
+        CurrentBit += BlockHeaderBits;
+
+        while (NumPixels < PixelsPerBlock) {
+            __int64 Byte = CurrentBit >> 3;
+            int Shift = (int)(CurrentBit & 7);
+            int NumBytes;
+            int NumBits;
+            int Count;
+            unsigned __int64 Word;
+
+            NumBytes = FillBitReader(&Reader, Byte);
+            if (NumBytes < 0) {
+                iRes = APPERR_FILEREAD;
+                EndOfInput = TRUE;
+                break;
+            }
+            NumBits = NumBytes * 8 - Shift;
+            if (NumBits < BitDepth) {
+                EndOfInput = TRUE;
+                break;
+            }
+
+            // all the whole pixels in this word
+            Word = LoadBigEndian64(Reader.Buffer + (size_t)(Byte - Reader.BufferStart)) << Shift;
+            Count = NumBits / BitDepth;
+            if (Count > PixelsPerBlock - NumPixels) {
+                Count = PixelsPerBlock - NumPixels;
+            }
+            for (int i = 0; i < Count; i++) {
+                // first bit of the pixel is the MSB of Value
+                unsigned int Value = (unsigned int)(Word >> (64 - BitDepth)) ^ InvertMask;
+                Word <<= BitDepth;
+
+                if (!BitOrder) {
+                    // bit stream order is LSB to MSB
+                    Value = ReverseBits32(Value) >> (32 - BitDepth);
+                }
+                if (PixelSize == 1) {
+                    if (BitScale && Value) {
+                        Value = 255;
+                    }
+                    Frame[NumPixels + i] = (BYTE)Value;
+                }
+                else if (PixelSize == 2) {
+                    ((unsigned short*)Frame)[NumPixels + i] = (unsigned short)Value;
+                }
+                else {
+                    ((unsigned int*)Frame)[NumPixels + i] = Value;
+                }
+            }
+            NumPixels += Count;
+            CurrentBit += (__int64)Count * BitDepth;
+        }
+
+        // skip the rest of the block
+        CurrentBit += NumBlockBodyBits - (__int64)PixelsPerBlock * BitDepth;
+
+        if (NumPixels > 0 && fwrite(Frame, PixelSize, NumPixels, OutRaw) != (size_t)NumPixels) {
+            iRes = APPERR_FILEWRITE;
+            break;
+        }
+    }
+
+    delete[] Reader.Buffer;
+    delete[] Frame;
+    fclose(In);
+    fclose(OutRaw);
+
+    return iRes;
+}
+
+//*******************************************************************
+//
+// ConvertText2BitStream
+// 
+// Convert textfile to a packed BitStream binary file
+// 
+// Parameters:
+//  HWND hDlg               handle of calling window/dialog
+//  WCHAR* InputFile        text file with space delmited list of values
+//                          value < 0 , cause error to be returned
+//                          value = 0 is taken as bit with value 0
+//                          value > 0 is taken as bit with value 1
+//                          (file is multiple always of 8 bits)
+//  WCHAR* OutputFile       Packed Binary bit stream file
+//  int BitOrder            0 - first bit is the MSB of each byte, 1 - the LSB
+//  BOOL Parallel           TRUE parse the text file on all processors
+//
+//  The text file is parsed by ReadBitText() in BitText.cpp
+//
+//*******************************************************************
+int ConvertText2BitStream(HWND hDlg, WCHAR* InputFile, WCHAR* OutputFile, int BitOrder, BOOL Parallel)
+{
+    FILE* Out;
+    std::vector<BYTE> Bytes;
+    BITTEXTINFO Info;
+    size_t NumBytes;
+    int iRes;
+    errno_t ErrNum;
+
+    iRes = ReadBitText(InputFile, BitOrder, -1, Parallel, Bytes, &Info);
+    if (iRes == APPERR_FILEOPEN) {
+        MessageBox(hDlg, L"Could not open input file", L"File I/O", MB_OK);
+        return -2;
+    }
+    if (iRes != APP_SUCCESS && Info.Stop != BITTEXT_NEGATIVE) {
+        return iRes;
+    }
+
+    ErrNum = _wfopen_s(&Out, OutputFile, L"wb");
+    if (Out == NULL) {
+        MessageBox(hDlg, L"Could not open raw output file", L"File I/O", MB_OK);
+        return -2;
+    }
+
+    // a value < 0 is an error, only the whole bytes before it are written
+    NumBytes = Bytes.size();
+    if (Info.Stop == BITTEXT_NEGATIVE) {
+        NumBytes = (size_t)(Info.NumBits / 8);
+    }
+    if (NumBytes != 0 && fwrite(Bytes.data(), 1, NumBytes, Out) != NumBytes) {
+        fclose(Out);
+        return APPERR_FILEWRITE;
+    }
+    fclose(Out);
+    if (Info.Stop == BITTEXT_NEGATIVE) {
+        return -3;
+    }
+
+    TCHAR pszMessageBuf[MAX_PATH];
+    StringCchPrintf(pszMessageBuf, (size_t)MAX_PATH, TEXT("Bitsream properties\n# of bits: %lld\n# of set bits: %lld\nBytes writtten: %lld"),
+        Info.NumBits, Info.NumOneBits, Info.NumBits / 8);
+    MessageBox(hDlg, pszMessageBuf, L"Completed", MB_OK);
 
-    fclose(In);
-    fclose(Out);
     return 1;
 }
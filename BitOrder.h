@@ -0,0 +1,73 @@
+#pragma once
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// BitOrder.h
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+// V1.2.0	2026-10-19	Added bit order helpers shared by the bitstream tools
+//
+//	Bitstream files are read MSB first, Bytes[0] bit 7 is the first bit.
+//	LSB first files have the bits in each byte reversed with ReverseByte[].
+//
+#include "framework.h"
+#include <string.h>
+#if defined(_MSC_VER)
+#include <stdlib.h>
+#endif
+
+// each byte with its bits in the reverse order, for LSB first files
+extern const BYTE ReverseByte[256];
+
+//*******************************************************************************
+//
+//  LoadBigEndian64
+//
+// 64 bits starting at Bytes[0], Bytes[0] is the high byte
+//
+//*******************************************************************************
+inline unsigned __int64 LoadBigEndian64(const BYTE* Bytes)
+{
+	unsigned __int64 Word;
+
+	memcpy(&Word, Bytes, sizeof(Word));
+#if defined(_MSC_VER)
+	return _byteswap_uint64(Word);
+#else
+	return __builtin_bswap64(Word);
+#endif
+}
+
+//*******************************************************************************
+//
+//  ReverseBits32
+//
+// Reverse the order of the bits in a 32 bit word.  The low n bits of a
+// value reversed are ReverseBits32(Value) >> (32 - n).
+//
+//*******************************************************************************
+inline unsigned int ReverseBits32(unsigned int Value)
+{
+	Value = ((Value >> 1) & 0x55555555) | ((Value & 0x55555555) << 1);
+	Value = ((Value >> 2) & 0x33333333) | ((Value & 0x33333333) << 2);
+	Value = ((Value >> 4) & 0x0f0f0f0f) | ((Value & 0x0f0f0f0f) << 4);
+	Value = ((Value >> 8) & 0x00ff00ff) | ((Value & 0x00ff00ff) << 8);
+	return (Value >> 16) | (Value << 16);
+}
@@ -0,0 +1,544 @@
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// BitSearch.cpp
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the bit pattern search of packed bitstream files
+//
+// V1.2.0	2026-10-19	Added bit pattern search of packed bitstream files
+//					LoadBigEndian64() and ReverseByte[] are shared from BitOrder.h
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+//	Patterns are found at any bit offset, not just byte boundaries, with up
+//	to MaxErrors bits different from the pattern (Hamming distance).
+//
+//	The search is bit parallel, 64 start positions are checked at once.
+//	For each pattern bit the 64 bitstream bits that line up with it are
+//	one 64 bit word.  XOR with the pattern bit gives the mismatches for all
+//	64 start positions.  The mismatches are added into saturating bit sliced
+//	counters, Err[i] has the positions with more than i errors.  The pattern
+//	bits are checked until every position has more than MaxErrors errors,
+//	in random data this is after a few bits, so the cost per position is
+//	only a few instructions for any pattern length.
+//
+//	The file is memory mapped and split into chunks that are searched on a
+//	pool of worker threads, one per processor.  Each chunk view overlaps the
+//	next chunk by the longest pattern so matches that cross chunk boundaries
+//	are found.
+//
+#include "framework.h"
+#include <vector>
+#include <algorithm>
+#include "AppErrors.h"
+#include "MappedFile.h"
+#include "BitOrder.h"
+#include "BitSearch.h"
+
+#define BITSEARCH_CHUNK (16 << 20)	// # of bytes of start positions in a chunk
+#define BITSEARCH_BLOCK (64 << 10)	// # of bytes searched at a time in a chunk
+#define BITSEARCH_PAD (8 * (BITSEARCH_WORDS + 2))	// bytes read past a block
+
+// pattern with the compared bits listed, for the search loop
+typedef struct {
+	int NumBits;
+	int MaxErrors;
+	int NumCompared;					// # of bits that are not don't care
+	short BitNum[BITSEARCH_MAX_BITS];	// pattern bit #
+	BYTE BitValue[BITSEARCH_MAX_BITS];	// pattern bit value
+} SEARCHPATTERN;
+
+// shared by the search worker threads
+typedef struct {
+	MappedFile* File;
+	SEARCHPATTERN* Patterns;
+	int NumPatterns;
+	int LoadWords;				// # of 64 bit words loaded for each 64 start positions
+	BOOL InputBitOrder;			// TRUE bytes in the file are LSB first
+	int MaxHits;
+	__int64 FileBits;
+	LONG NumChunks;
+	volatile LONG NextChunk;	// next chunk to search
+	volatile LONG FullChunk;	// first chunk with more than MaxHits matches
+	std::vector<BITSEARCHHIT>* ChunkHits;
+	int* ChunkStatus;
+} BITSEARCHWORK;
+
+static int SearchChunk(BITSEARCHWORK* Work, LONG Chunk);
+static void SearchBlock(const BYTE* Data, size_t NumBytes, __int64 FirstBit,
+	BITSEARCHWORK* Work, std::vector<BITSEARCHHIT>& Hits);
+static DWORD WINAPI BitSearchProc(LPVOID Param);
+
+//*******************************************************************************
+//
+//  ParseBitPattern
+//
+// Convert pattern text to a BITPATTERN.
+//
+//	binary:	0, 1 for each bit, ? for a don't care bit
+//			i.e. 1111111111111111
+//	hex:	0x prefix, then hex digits MSB first, ? for 4 don't care bits
+//			i.e. 0xFFFF0690????44884488 (ASIS sync header)
+//	spaces, underscores and commas between digits are ignored
+//
+// Parameters:
+//	WCHAR* Text				pattern text
+//	int MaxErrors			# of bits that can be different in a match
+//	BITPATTERN* Pattern		returns pattern
+//
+//	return value:
+//	1 - Success
+//	!=1 Error see standardized app error list in AppErrors.h
+//		APPERR_PARAMETER bad character, no bits, too many bits, or MaxErrors
+//		is not less than the # of compared bits
+//
+//*******************************************************************************
+int ParseBitPattern(WCHAR* Text, int MaxErrors, BITPATTERN* Pattern)
+{
+	BOOL Hex = FALSE;
+	int NumCompared = 0;
+
+	memset(Pattern, 0, sizeof(BITPATTERN));
+
+	while (*Text == L' ') {
+		Text++;
+	}
+	if (Text[0] == L'0' && (Text[1] == L'x' || Text[1] == L'X')) {
+		Hex = TRUE;
+		Text += 2;
+	}
+
+	for (; *Text != 0; Text++) {
+		WCHAR c = *Text;
+		int Value;
+		int Care;
+		int Bits;
+
+		if (c == L' ' || c == L'_' || c == L',' || c == L'\t') {
+			continue;
+		}
+
+		if (Hex) {
+			Bits = 4;
+			Care = 0xF;
+			if (c >= L'0' && c <= L'9') {
+				Value = c - L'0';
+			}
+			else if (c >= L'a' && c <= L'f') {
+				Value = c - L'a' + 10;
+			}
+			else if (c >= L'A' && c <= L'F') {
+				Value = c - L'A' + 10;
+			}
+			else if (c == L'?') {
+				Value = 0;
+				Care = 0;
+			}
+			else {
+				return APPERR_PARAMETER;
+			}
+		}
+		else {
+			Bits = 1;
+			Care = 1;
+			if (c == L'0' || c == L'1') {
+				Value = c - L'0';
+			}
+			else if (c == L'?') {
+				Value = 0;
+				Care = 0;
+			}
+			else {
+				return APPERR_PARAMETER;
+			}
+		}
+
+		for (int i = Bits - 1; i >= 0; i--) {
+			if (Pattern->NumBits >= BITSEARCH_MAX_BITS) {
+				return APPERR_PARAMETER;
+			}
+			int Word = Pattern->NumBits / 64;
+			unsigned __int64 Bit = 0x8000000000000000ULL >> (Pattern->NumBits % 64);
+			if ((Value >> i) & 1) {
+				Pattern->Bits[Word] |= Bit;
+			}
+			if ((Care >> i) & 1) {
+				Pattern->Mask[Word] |= Bit;
+				NumCompared++;
+			}
+			Pattern->NumBits++;
+		}
+	}
+
+	if (NumCompared == 0 || MaxErrors < 0 || MaxErrors > BITSEARCH_MAX_ERRORS ||
+		MaxErrors >= NumCompared) {
+		return APPERR_PARAMETER;
+	}
+	Pattern->MaxErrors = MaxErrors;
+
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  BitSearchFile
+//
+// Find every match of the patterns in a packed bitstream file
+//
+// Parameters:
+//	WCHAR* Filename				packed bitstream file
+//	BITPATTERN* Patterns		patterns to search for
+//	int NumPatterns				# of patterns, 1 to BITSEARCH_MAX_PATTERNS
+//	BOOL InputBitOrder			FALSE bytes are MSB first, TRUE LSB first,
+//								same as BitImageDlg
+//	int MaxHits					most matches returned
+//	std::vector<BITSEARCHHIT>& Hits	returns the matches in bitstream order,
+//								matches at the same offset in pattern order
+//	BOOL* Truncated				returns TRUE if there were more than MaxHits matches
+//
+//	return value:
+//	1 - Success
+//	!=1 Error see standardized app error list in AppErrors.h
+//
+//*******************************************************************************
+int BitSearchFile(WCHAR* Filename, BITPATTERN* Patterns, int NumPatterns, BOOL InputBitOrder,
+	int MaxHits, std::vector<BITSEARCHHIT>& Hits, BOOL* Truncated)
+{
+	SEARCHPATTERN Search[BITSEARCH_MAX_PATTERNS];
+	BITSEARCHWORK Work;
+	MappedFile File;
+	int iRes;
+
+	Hits.clear();
+	*Truncated = FALSE;
+
+	if (NumPatterns < 1 || NumPatterns > BITSEARCH_MAX_PATTERNS || MaxHits < 1) {
+		return APPERR_PARAMETER;
+	}
+
+	Work.LoadWords = 0;
+	for (int p = 0; p < NumPatterns; p++) {
+		if (Patterns[p].NumBits < 1 || Patterns[p].NumBits > BITSEARCH_MAX_BITS ||
+			Patterns[p].MaxErrors < 0 || Patterns[p].MaxErrors > BITSEARCH_MAX_ERRORS) {
+			return APPERR_PARAMETER;
+		}
+		Search[p].NumBits = Patterns[p].NumBits;
+		Search[p].MaxErrors = Patterns[p].MaxErrors;
+		Search[p].NumCompared = 0;
+		for (int j = 0; j < Patterns[p].NumBits; j++) {
+			unsigned __int64 Bit = 0x8000000000000000ULL >> (j % 64);
+			if (Patterns[p].Mask[j / 64] & Bit) {
+				Search[p].BitNum[Search[p].NumCompared] = (short)j;
+				Search[p].BitValue[Search[p].NumCompared] = (Patterns[p].Bits[j / 64] & Bit) ? 1 : 0;
+				Search[p].NumCompared++;
+			}
+		}
+		if (Search[p].NumCompared <= Search[p].MaxErrors) {
+			return APPERR_PARAMETER;
+		}
+		int Words = (Patterns[p].NumBits + 63) / 64 + 1;
+		if (Words > Work.LoadWords) {
+			Work.LoadWords = Words;
+		}
+	}
+
+	iRes = File.Open(Filename);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	Work.File = &File;
+	Work.Patterns = Search;
+	Work.NumPatterns = NumPatterns;
+	Work.InputBitOrder = InputBitOrder;
+	Work.MaxHits = MaxHits;
+	Work.FileBits = File.GetFileSize() * 8;
+	Work.NumChunks = (LONG)((File.GetFileSize() + BITSEARCH_CHUNK - 1) / BITSEARCH_CHUNK);
+	Work.NextChunk = 0;
+	Work.FullChunk = Work.NumChunks;
+
+	std::vector<std::vector<BITSEARCHHIT>> ChunkHits(Work.NumChunks);
+	std::vector<int> ChunkStatus(Work.NumChunks, APP_SUCCESS);
+	Work.ChunkHits = ChunkHits.data();
+	Work.ChunkStatus = ChunkStatus.data();
+
+	SYSTEM_INFO SysInfo;
+	int NumThreads;
+
+	GetSystemInfo(&SysInfo);
+	NumThreads = (int)SysInfo.dwNumberOfProcessors;
+	if (NumThreads > MAXIMUM_WAIT_OBJECTS) NumThreads = MAXIMUM_WAIT_OBJECTS;
+	if (NumThreads > (int)Work.NumChunks) NumThreads = (int)Work.NumChunks;
+	if (NumThreads < 1) NumThreads = 1;
+
+	std::vector<HANDLE> Threads(NumThreads);
+	int Started = 0;
+	for (int t = 0; t < NumThreads; t++) {
+		Threads[t] = CreateThread(NULL, 0, BitSearchProc, &Work, 0, NULL);
+		if (Threads[t] == NULL) {
+			break;
+		}
+		Started++;
+	}
+	if (Started == 0) {
+		// no threads, search it all here
+		BitSearchProc(&Work);
+	}
+	for (int t = 0; t < Started; t++) {
+		WaitForSingleObject(Threads[t], INFINITE);
+		CloseHandle(Threads[t]);
+	}
+
+	// chunks are in file order, chunks after a full chunk are not needed
+	for (LONG c = 0; c < Work.NumChunks; c++) {
+		if (ChunkStatus[c] != APP_SUCCESS) {
+			Hits.clear();
+			return ChunkStatus[c];
+		}
+		for (auto& Hit : ChunkHits[c]) {
+			if ((int)Hits.size() >= MaxHits) {
+				*Truncated = TRUE;
+				break;
+			}
+			Hits.push_back(Hit);
+		}
+		if (c >= Work.FullChunk) {
+			*Truncated = TRUE;
+			break;
+		}
+	}
+
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  BitSearchProc
+//
+// Worker thread, searches chunks until there are none left
+//
+//*******************************************************************************
+static DWORD WINAPI BitSearchProc(LPVOID Param)
+{
+	BITSEARCHWORK* Work = (BITSEARCHWORK*)Param;
+	LONG Next;
+
+	while ((Next = InterlockedIncrement(&Work->NextChunk) - 1) < Work->NumChunks) {
+		if (Next > Work->FullChunk) {
+			// an earlier chunk already has more than MaxHits matches
+			continue;
+		}
+		Work->ChunkStatus[Next] = SearchChunk(Work, Next);
+	}
+	return 0;
+}
+
+//*******************************************************************************
+//
+//  SearchChunk
+//
+// Find the matches that start in one chunk of the file.  The chunk is
+// searched in blocks.  Blocks near the end of the file, and all blocks in
+// LSB first files, are copied to a 0 padded buffer first.
+//
+//*******************************************************************************
+static int SearchChunk(BITSEARCHWORK* Work, LONG Chunk)
+{
+	std::vector<BITSEARCHHIT>& Hits = Work->ChunkHits[Chunk];
+	__int64 FileSize = Work->File->GetFileSize();
+	__int64 ChunkStart = (__int64)Chunk * BITSEARCH_CHUNK;
+	size_t ChunkBytes = BITSEARCH_CHUNK;
+	size_t ViewBytes;
+	BYTE* Copy = nullptr;
+	void* ViewBase;
+	BOOL Full = FALSE;
+
+	if ((__int64)ChunkBytes > FileSize - ChunkStart) {
+		ChunkBytes = (size_t)(FileSize - ChunkStart);
+	}
+	ViewBytes = ChunkBytes + BITSEARCH_PAD;
+	if ((__int64)ViewBytes > FileSize - ChunkStart) {
+		ViewBytes = (size_t)(FileSize - ChunkStart);
+	}
+
+	const BYTE* View = Work->File->MapView(ChunkStart, ViewBytes, &ViewBase);
+	if (View == nullptr) {
+		return APPERR_FILEREAD;
+	}
+
+	for (size_t Block = 0; Block < ChunkBytes; Block += BITSEARCH_BLOCK) {
+		size_t BlockBytes = BITSEARCH_BLOCK;
+		const BYTE* Data = View + Block;
+
+		if (BlockBytes > ChunkBytes - Block) {
+			BlockBytes = ChunkBytes - Block;
+		}
+
+		if (Work->InputBitOrder || Block + BlockBytes + BITSEARCH_PAD > ViewBytes) {
+			size_t Available = ViewBytes - Block;
+			if (Available > BlockBytes + BITSEARCH_PAD) {
+				Available = BlockBytes + BITSEARCH_PAD;
+			}
+			if (Copy == nullptr) {
+				Copy = new BYTE[BITSEARCH_BLOCK + BITSEARCH_PAD];
+				if (Copy == nullptr) {
+					MappedFile::UnmapView(ViewBase);
+					return APPERR_MEMALLOC;
+				}
+			}
+			if (Work->InputBitOrder) {
+				for (size_t i = 0; i < Available; i++) {
+					Copy[i] = ReverseByte[Data[i]];
+				}
+			}
+			else {
+				memcpy(Copy, Data, Available);
+			}
+			memset(Copy + Available, 0, BITSEARCH_BLOCK + BITSEARCH_PAD - Available);
+			Data = Copy;
+		}
+
+		SearchBlock(Data, BlockBytes, (ChunkStart + (__int64)Block) * 8, Work, Hits);
+
+		if ((int)Hits.size() > Work->MaxHits) {
+			Full = TRUE;
+			break;
+		}
+		if (Chunk > Work->FullChunk) {
+			// an earlier chunk already has more than MaxHits matches
+			break;
+		}
+	}
+
+	MappedFile::UnmapView(ViewBase);
+	if (Copy != nullptr) {
+		delete[] Copy;
+	}
+
+	std::sort(Hits.begin(), Hits.end(), [](const BITSEARCHHIT& a, const BITSEARCHHIT& b) {
+		if (a.BitOffset != b.BitOffset) {
+			return a.BitOffset < b.BitOffset;
+		}
+		return a.Pattern < b.Pattern;
+		});
+
+	if (Full) {
+		// FullChunk = min(FullChunk, Chunk)
+		LONG Current;
+		while (Chunk < (Current = Work->FullChunk)) {
+			InterlockedCompareExchange(&Work->FullChunk, Chunk, Current);
+		}
+	}
+
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  SearchBlock
+//
+// Find the matches that start in NumBytes bytes of the bitstream.
+// Data must have BITSEARCH_PAD readable bytes after NumBytes.
+//
+// Parameters:
+//	const BYTE* Data		bitstream bytes, MSB first
+//	size_t NumBytes			# of bytes of start positions
+//	__int64 FirstBit		bitstream bit # of the 0x80 bit of Data[0]
+//	BITSEARCHWORK* Work		patterns
+//	std::vector<BITSEARCHHIT>& Hits	matches are added to this
+//
+//*******************************************************************************
+static void SearchBlock(const BYTE* Data, size_t NumBytes, __int64 FirstBit,
+	BITSEARCHWORK* Work, std::vector<BITSEARCHHIT>& Hits)
+{
+	unsigned __int64 Text[BITSEARCH_WORDS + 2];
+	unsigned __int64 Err[BITSEARCH_MAX_ERRORS + 1];
+	__int64 EndBit = FirstBit + (__int64)NumBytes * 8;
+
+	for (size_t Byte = 0; Byte < NumBytes; Byte += 8) {
+		__int64 BaseBit = FirstBit + (__int64)Byte * 8;
+
+		for (int w = 0; w < Work->LoadWords; w++) {
+			Text[w] = LoadBigEndian64(Data + Byte + 8 * w);
+		}
+
+		for (int p = 0; p < Work->NumPatterns; p++) {
+			SEARCHPATTERN* Pattern = &Work->Patterns[p];
+			int MaxErrors = Pattern->MaxErrors;
+			unsigned __int64 Valid;
+			__int64 NumValid;
+
+			// start positions in this block where the whole pattern is in the file
+			NumValid = Work->FileBits - Pattern->NumBits + 1;
+			if (NumValid > EndBit) {
+				NumValid = EndBit;
+			}
+			NumValid -= BaseBit;
+			if (NumValid <= 0) {
+				continue;
+			}
+			Valid = (NumValid >= 64) ? ~0ULL : ~(~0ULL >> NumValid);
+
+			for (int i = 0; i <= MaxErrors; i++) {
+				Err[i] = 0;
+			}
+			for (int k = 0; k < Pattern->NumCompared; k++) {
+				int j = Pattern->BitNum[k];
+				int w = j >> 6;
+				int s = j & 63;
+				unsigned __int64 Mismatch;
+
+				// bitstream bits BaseBit+j to BaseBit+j+63, one for each start position
+				Mismatch = s ? ((Text[w] << s) | (Text[w + 1] >> (64 - s))) : Text[w];
+				if (Pattern->BitValue[k]) {
+					Mismatch = ~Mismatch;
+				}
+				for (int i = MaxErrors; i > 0; i--) {
+					Err[i] |= Err[i - 1] & Mismatch;
+				}
+				Err[0] |= Mismatch;
+
+				if ((Err[MaxErrors] | ~Valid) == ~0ULL) {
+					// no start position can match
+					break;
+				}
+			}
+
+			unsigned __int64 Match = ~Err[MaxErrors] & Valid;
+			for (int Lane = 0; Match != 0; Lane++) {
+				unsigned __int64 Bit = 0x8000000000000000ULL >> Lane;
+				if (!(Match & Bit)) {
+					continue;
+				}
+				Match &= ~Bit;
+
+				BITSEARCHHIT Hit;
+				Hit.BitOffset = BaseBit + Lane;
+				Hit.Pattern = p;
+				Hit.Errors = 0;
+				for (int i = 0; i < MaxErrors; i++) {
+					if (Err[i] & Bit) {
+						Hit.Errors++;
+					}
+				}
+				Hits.push_back(Hit);
+			}
+		}
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// BitSearch.h
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+// V1.2.0	2026-10-19	Added bit pattern search of packed bitstream files
+//
+#include "framework.h"
+#include <vector>
+
+#define BITSEARCH_MAX_BITS 256		// longest pattern
+#define BITSEARCH_WORDS (BITSEARCH_MAX_BITS / 64)
+#define BITSEARCH_MAX_PATTERNS 4	// # of patterns searched for at once
+#define BITSEARCH_MAX_ERRORS 8		// most bit errors allowed in a match
+
+// bit pattern to search for, bit 0 of the pattern is the 0x8000000000000000 bit of Bits[0]
+typedef struct {
+	unsigned __int64 Bits[BITSEARCH_WORDS];	// pattern bits
+	unsigned __int64 Mask[BITSEARCH_WORDS];	// 1 bits are compared, 0 bits are don't care
+	int NumBits;		// # of bits in the pattern, including don't care bits
+	int MaxErrors;		// # of compared bits that can be different (Hamming distance)
+} BITPATTERN;
+
+// one match
+typedef struct {
+	__int64 BitOffset;	// # of bits before the match in the bitstream
+	int Pattern;		// index of the pattern that matched
+	int Errors;			// # of compared bits that are different
+} BITSEARCHHIT;
+
+// BitSearchDlg parameters when it is opened from BitImageDlg
+typedef struct {
+	WCHAR InputFile[MAX_PATH];	// bitstream file
+	BOOL InputBitOrder;			// TRUE bytes in the file are LSB first
+	int PrologueSize;			// returns the prologue for the selected match, -1 none
+} BITSEARCHDLGPARAM;
+
+int ParseBitPattern(WCHAR* Text, int MaxErrors, BITPATTERN* Pattern);
+int BitSearchFile(WCHAR* Filename, BITPATTERN* Patterns, int NumPatterns, BOOL InputBitOrder,
+	int MaxHits, std::vector<BITSEARCHHIT>& Hits, BOOL* Truncated);
@@ -0,0 +1,589 @@
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// BitText.cpp
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the reader for bitstreams saved as text
+//
+// V1.2.0	2026-10-19	Added text bitstream reader
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+//	A text bitstream is a list of integers separated by white space, 0 is a
+//	0 bit, > 0 is a 1 bit.  The values are read the same way as repeated
+//	fscanf_s(In, "%d") calls, including where reading stops:
+//		a value may have a + or - sign, the sign can follow the value before
+//		it without white space (1-1 is 1 then -1)
+//		anything else that is not white space or a digit stops the reading
+//		a value < 0 stops the reading with an error
+//	The bits are only 0 or not 0 so the value is never converted, a value too
+//	large for an int is a 1 bit.
+//
+//	The file is memory mapped.  White space and digits are found 16 bytes at a
+//	time with SSE2 and the whole values in the 16 bytes are packed into bytes
+//	from bit masks, other text is parsed a byte at a time.
+//
+//	The file is split into chunks that start at white space so no value is
+//	split between two chunks.  In the parallel mode the chunks are parsed on a
+//	pool of worker threads, one per processor, and the packed bits of the
+//	chunks are joined in file order.
+//
+#include "framework.h"
+#include <stdio.h>
+#include <vector>
+#include "AppErrors.h"
+#include "MappedFile.h"
+#include "BitText.h"
+
+// SSE2 is in every x64 processor and is the default for x86 builds
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define BITTEXT_SSE2
+#endif
+
+#define BITTEXT_SCAN 4096		// # of bytes looked at a time for white space at a chunk boundary
+
+// packed bits from a chunk
+typedef struct {
+	BYTE* Bytes;				// enough zeroed bytes for all the values in the chunk
+	__int64 NumBits;
+	__int64 NumOneBits;
+	int BitOrder;				// 0 - first bit is the MSB of a byte, 1 - first bit is the LSB
+} BITTEXTOUT;
+
+// text chunk, bytes Begin to End - 1 of the file
+typedef struct {
+	__int64 Begin;
+	__int64 End;
+	std::vector<BYTE> Bytes;
+	BITTEXTOUT Out;
+	int Stop;
+	int Status;
+} BITTEXTCHUNK;
+
+// shared by the parse worker threads
+typedef struct {
+	MappedFile* File;
+	BITTEXTCHUNK* Chunks;
+	LONG NumChunks;
+	volatile LONG NextChunk;	// next chunk to parse
+	__int64 MaxBits;
+	int BitOrder;
+} BITTEXTWORK;
+
+static int ParseBitText(const BYTE* Text, size_t Size, __int64 MaxBits, BITTEXTOUT* Out);
+static int ParseTextChunk(MappedFile* File, BITTEXTCHUNK* Chunk, __int64 MaxBits, BITTEXTOUT* Out);
+static __int64 FindWhiteSpace(MappedFile* File, __int64 Offset);
+static void AppendBits(BITTEXTOUT* Out, BITTEXTOUT* Part, __int64 NumBits);
+static DWORD WINAPI BitTextProc(LPVOID Param);
+
+//*******************************************************************************
+//
+//  IsWhiteSpace
+//
+// same white space as isspace(), space, \t, \n, \v, \f and \r
+//
+//*******************************************************************************
+static inline BOOL IsWhiteSpace(BYTE c)
+{
+	return c == ' ' || (unsigned)(c - '\t') <= (unsigned)('\r' - '\t');
+}
+
+//*******************************************************************************
+//
+//  IsDigit
+//
+//*******************************************************************************
+static inline BOOL IsDigit(BYTE c)
+{
+	return (unsigned)(c - '0') <= 9;
+}
+
+//*******************************************************************************
+//
+//  PutBit
+//
+//*******************************************************************************
+static inline void PutBit(BITTEXTOUT* Out, BOOL Bit)
+{
+	if (Bit) {
+		if (Out->BitOrder) {
+			Out->Bytes[Out->NumBits >> 3] |= (BYTE)(0x01 << (Out->NumBits & 7));
+		}
+		else {
+			Out->Bytes[Out->NumBits >> 3] |= (BYTE)(0x80 >> (Out->NumBits & 7));
+		}
+		Out->NumOneBits++;
+	}
+	Out->NumBits++;
+}
+
+#ifdef BITTEXT_SSE2
+//*******************************************************************************
+//
+//  CountTrailingZeros32
+//
+// # of 0 bits after the last 1 bit.  Word must not be 0.
+//
+//*******************************************************************************
+static inline int CountTrailingZeros32(unsigned int Word)
+{
+#if defined(_MSC_VER)
+	unsigned long Index;
+	_BitScanForward(&Index, Word);
+	return (int)Index;
+#else
+	return __builtin_ctz(Word);
+#endif
+}
+
+//*******************************************************************************
+//
+//  CountLeadingZeros32
+//
+// # of 0 bits before the first 1 bit.  Word must not be 0.
+//
+//*******************************************************************************
+static inline int CountLeadingZeros32(unsigned int Word)
+{
+#if defined(_MSC_VER)
+	unsigned long Index;
+	_BitScanReverse(&Index, Word);
+	return 31 - (int)Index;
+#else
+	return __builtin_clz(Word);
+#endif
+}
+#endif
+
+//*******************************************************************************
+//
+//  ReadBitText
+//
+// Read a bitstream saved as text into packed bytes
+//
+// Parameters:
+//	WCHAR* InputFile		text file, values separated by white space
+//	int BitOrder			0 - first bit is the MSB of a byte, 1 - first bit is the LSB
+//	__int64 MaxBits			stop after this many values, < 0 read to the end
+//	BOOL Parallel			TRUE parse the file on all processors, for large files
+//	std::vector<BYTE>& Bytes	returns the packed bits, the last byte is padded with 0 bits
+//	BITTEXTINFO* Info		returns the # of values read and why the reading stopped
+//
+//	return value:
+//	1 - Success, reading stopped at the end of the file, at MaxBits or at text
+//		that is not a number
+//	!=1 Error see standardized app error list in AppErrors.h
+//		APPERR_FILEREAD if a value < 0 was read, Bytes and Info have the values
+//		before it
+//
+//*******************************************************************************
+int ReadBitText(WCHAR* InputFile, int BitOrder, __int64 MaxBits, BOOL Parallel,
+	std::vector<BYTE>& Bytes, BITTEXTINFO* Info)
+{
+	MappedFile File;
+	__int64 FileSize;
+	BITTEXTOUT Out;
+	int iRes;
+
+	Bytes.clear();
+	Info->NumBits = 0;
+	Info->NumOneBits = 0;
+	Info->Stop = BITTEXT_END;
+
+	iRes = File.Open(InputFile);
+	if (iRes == APPERR_FILESIZE) {
+		// empty file, no values
+		return APP_SUCCESS;
+	}
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+	FileSize = File.GetFileSize();
+
+	// there is at most one value for every 2 bytes of text, plus one
+	__int64 MostBits = FileSize / 2 + 1;
+	if (MaxBits >= 0 && MaxBits < MostBits) {
+		MostBits = MaxBits;
+	}
+	Bytes.assign((size_t)((MostBits + 7) / 8), 0);
+	Out.Bytes = Bytes.data();
+	Out.NumBits = 0;
+	Out.NumOneBits = 0;
+	Out.BitOrder = BitOrder;
+	if (MaxBits < 0) {
+		MaxBits = MostBits;
+	}
+
+	// chunks start at white space
+	std::vector<__int64> Bounds;
+	Bounds.push_back(0);
+	for (__int64 Nominal = BITTEXT_CHUNK; Nominal < FileSize; Nominal += BITTEXT_CHUNK) {
+		if (Nominal <= Bounds.back()) {
+			continue;
+		}
+		__int64 Bound = FindWhiteSpace(&File, Nominal);
+		if (Bound < 0) {
+			Bytes.clear();
+			return APPERR_FILEREAD;
+		}
+		if (Bound >= FileSize) {
+			break;
+		}
+		Bounds.push_back(Bound);
+	}
+	Bounds.push_back(FileSize);
+
+	std::vector<BITTEXTCHUNK> Chunks(Bounds.size() - 1);
+	for (size_t c = 0; c < Chunks.size(); c++) {
+		Chunks[c].Begin = Bounds[c];
+		Chunks[c].End = Bounds[c + 1];
+		Chunks[c].Stop = BITTEXT_END;
+		Chunks[c].Status = APP_SUCCESS;
+	}
+
+	if (!Parallel || Chunks.size() == 1) {
+		// one chunk at a time straight into Bytes
+		for (size_t c = 0; c < Chunks.size(); c++) {
+			iRes = ParseTextChunk(&File, &Chunks[c], MaxBits, &Out);
+			if (iRes != APP_SUCCESS) {
+				Bytes.clear();
+				return iRes;
+			}
+			Info->Stop = Chunks[c].Stop;
+			if (Chunks[c].Stop != BITTEXT_END || Out.NumBits >= MaxBits) {
+				break;
+			}
+		}
+	}
+	else {
+		BITTEXTWORK Work;
+
+		Work.File = &File;
+		Work.Chunks = Chunks.data();
+		Work.NumChunks = (LONG)Chunks.size();
+		Work.NextChunk = 0;
+		Work.MaxBits = MaxBits;
+		Work.BitOrder = BitOrder;
+
+		SYSTEM_INFO SysInfo;
+		int NumThreads;
+
+		GetSystemInfo(&SysInfo);
+		NumThreads = (int)SysInfo.dwNumberOfProcessors;
+		if (NumThreads > MAXIMUM_WAIT_OBJECTS) NumThreads = MAXIMUM_WAIT_OBJECTS;
+		if (NumThreads > (int)Work.NumChunks) NumThreads = (int)Work.NumChunks;
+		if (NumThreads < 1) NumThreads = 1;
+
+		std::vector<HANDLE> Threads(NumThreads);
+		int Started = 0;
+		for (int t = 0; t < NumThreads; t++) {
+			Threads[t] = CreateThread(NULL, 0, BitTextProc, &Work, 0, NULL);
+			if (Threads[t] == NULL) {
+				break;
+			}
+			Started++;
+		}
+		if (Started == 0) {
+			// no threads, parse it all here
+			BitTextProc(&Work);
+		}
+		for (int t = 0; t < Started; t++) {
+			WaitForSingleObject(Threads[t], INFINITE);
+			CloseHandle(Threads[t]);
+		}
+
+		// join the chunks in file order up to the first one that stopped
+		for (size_t c = 0; c < Chunks.size(); c++) {
+			if (Chunks[c].Status != APP_SUCCESS) {
+				Bytes.clear();
+				return Chunks[c].Status;
+			}
+			__int64 NumBits = Chunks[c].Out.NumBits;
+			if (NumBits > MaxBits - Out.NumBits) {
+				NumBits = MaxBits - Out.NumBits;
+			}
+			AppendBits(&Out, &Chunks[c].Out, NumBits);
+			if (Out.NumBits >= MaxBits) {
+				// the chunk was parsed past MaxBits, the text after MaxBits is not used
+				Info->Stop = BITTEXT_END;
+				break;
+			}
+			Info->Stop = Chunks[c].Stop;
+			if (Chunks[c].Stop != BITTEXT_END) {
+				break;
+			}
+		}
+	}
+
+	Info->NumBits = Out.NumBits;
+	Info->NumOneBits = Out.NumOneBits;
+	Bytes.resize((size_t)((Out.NumBits + 7) / 8));
+	if (Info->Stop == BITTEXT_NEGATIVE) {
+		return APPERR_FILEREAD;
+	}
+
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  BitTextProc
+//
+// Worker thread, parses chunks until there are none left.  Each chunk is
+// packed into its own bytes.
+//
+//*******************************************************************************
+static DWORD WINAPI BitTextProc(LPVOID Param)
+{
+	BITTEXTWORK* Work = (BITTEXTWORK*)Param;
+	LONG Next;
+
+	while ((Next = InterlockedIncrement(&Work->NextChunk) - 1) < Work->NumChunks) {
+		BITTEXTCHUNK* Chunk = &Work->Chunks[Next];
+		__int64 MostBits = (Chunk->End - Chunk->Begin) / 2 + 1;
+
+		if (MostBits > Work->MaxBits) {
+			MostBits = Work->MaxBits;
+		}
+		try {
+			Chunk->Bytes.assign((size_t)((MostBits + 7) / 8), 0);
+		}
+		catch (...) {
+			Chunk->Status = APPERR_MEMALLOC;
+			continue;
+		}
+		Chunk->Out.Bytes = Chunk->Bytes.data();
+		Chunk->Out.NumBits = 0;
+		Chunk->Out.NumOneBits = 0;
+		Chunk->Out.BitOrder = Work->BitOrder;
+		Chunk->Status = ParseTextChunk(Work->File, Chunk, Work->MaxBits, &Chunk->Out);
+	}
+	return 0;
+}
+
+//*******************************************************************************
+//
+//  ParseTextChunk
+//
+// Map a chunk and parse it
+//
+//*******************************************************************************
+static int ParseTextChunk(MappedFile* File, BITTEXTCHUNK* Chunk, __int64 MaxBits, BITTEXTOUT* Out)
+{
+	void* ViewBase;
+	const BYTE* Text = File->MapView(Chunk->Begin, (size_t)(Chunk->End - Chunk->Begin), &ViewBase);
+
+	if (Text == nullptr) {
+		return APPERR_FILEREAD;
+	}
+	Chunk->Stop = ParseBitText(Text, (size_t)(Chunk->End - Chunk->Begin), MaxBits, Out);
+	MappedFile::UnmapView(ViewBase);
+
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  ParseBitText
+//
+// Pack the values in text that starts between two values
+//
+//	return value:
+//	BITTEXT_END, BITTEXT_TEXT or BITTEXT_NEGATIVE
+//
+//*******************************************************************************
+static int ParseBitText(const BYTE* Text, size_t Size, __int64 MaxBits, BITTEXTOUT* Out)
+{
+	size_t i = 0;
+
+#ifdef BITTEXT_SSE2
+	const __m128i Zero = _mm_set1_epi8('0');
+	const __m128i Nine = _mm_set1_epi8(9);
+	const __m128i Space = _mm_set1_epi8(' ');
+	const __m128i Tab = _mm_set1_epi8('\t');
+	const __m128i Four = _mm_set1_epi8('\r' - '\t');
+#endif
+
+	while (TRUE) {
+#ifdef BITTEXT_SSE2
+		// 16 bytes of only digits and white space, there are at most 8 values
+		while (i + 16 <= Size && Out->NumBits + 8 <= MaxBits) {
+			__m128i Bytes = _mm_loadu_si128((const __m128i*)(Text + i));
+			__m128i Value = _mm_sub_epi8(Bytes, Zero);
+			__m128i Control = _mm_sub_epi8(Bytes, Tab);
+			unsigned int Digits = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(Value, Nine), Value));
+			unsigned int NonZero = Digits & ~(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(Bytes, Zero));
+			unsigned int White = (unsigned int)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(Bytes, Space),
+				_mm_cmpeq_epi8(_mm_min_epu8(Control, Four), Control)));
+
+			if ((Digits | White) != 0xFFFF || White == 0) {
+				break;
+			}
+
+			// a value after the last white space may continue past these 16 bytes
+			int Last = 31 - CountLeadingZeros32(White);
+			unsigned int Keep = (2u << Last) - 1;
+			Digits &= Keep;
+			NonZero &= Keep;
+
+			// first and last digit of each value
+			unsigned int Starts = Digits & ~(Digits << 1);
+			unsigned int Ends = Digits & ~(Digits >> 1);
+			while (Starts != 0) {
+				int First = CountTrailingZeros32(Starts);
+				unsigned int Before = (1u << First) - 1;
+				int End = CountTrailingZeros32(Ends & ~Before);
+				unsigned int Mask = ((2u << End) - 1) & ~Before;
+
+				PutBit(Out, (NonZero & Mask) != 0);
+				Starts &= Starts - 1;
+			}
+			i += (size_t)Last + 1;
+		}
+#endif
+		while (i < Size && IsWhiteSpace(Text[i])) {
+			i++;
+		}
+		if (i >= Size || Out->NumBits >= MaxBits) {
+			return BITTEXT_END;
+		}
+
+		BOOL Negative = FALSE;
+		BOOL NonZeroDigit = FALSE;
+
+		if (Text[i] == '+' || Text[i] == '-') {
+			Negative = (Text[i] == '-');
+			i++;
+		}
+		if (i >= Size || !IsDigit(Text[i])) {
+			// not a number
+			return BITTEXT_TEXT;
+		}
+		while (i < Size && IsDigit(Text[i])) {
+			if (Text[i] != '0') {
+				NonZeroDigit = TRUE;
+			}
+			i++;
+		}
+		if (Negative && NonZeroDigit) {
+			return BITTEXT_NEGATIVE;
+		}
+		PutBit(Out, NonZeroDigit);
+	}
+}
+
+//*******************************************************************************
+//
+//  FindWhiteSpace
+//
+// File offset of the first white space at or after Offset
+//
+//	return value:
+//	offset, the file size if there is none, -1 if the file could not be read
+//
+//*******************************************************************************
+static __int64 FindWhiteSpace(MappedFile* File, __int64 Offset)
+{
+	__int64 FileSize = File->GetFileSize();
+
+	while (Offset < FileSize) {
+		void* ViewBase;
+		size_t Size = (FileSize - Offset < BITTEXT_SCAN) ? (size_t)(FileSize - Offset) : BITTEXT_SCAN;
+		const BYTE* Text = File->MapView(Offset, Size, &ViewBase);
+
+		if (Text == nullptr) {
+			return -1;
+		}
+		for (size_t i = 0; i < Size; i++) {
+			if (IsWhiteSpace(Text[i])) {
+				MappedFile::UnmapView(ViewBase);
+				return Offset + (__int64)i;
+			}
+		}
+		MappedFile::UnmapView(ViewBase);
+		Offset += Size;
+	}
+
+	return FileSize;
+}
+
+//*******************************************************************************
+//
+//  AppendBits
+//
+// Add the first NumBits of Part to the end of Out, both have the same bit order
+//
+//*******************************************************************************
+static void AppendBits(BITTEXTOUT* Out, BITTEXTOUT* Part, __int64 NumBits)
+{
+	int Shift = (int)(Out->NumBits & 7);
+	BYTE* Dest = Out->Bytes + (Out->NumBits >> 3);
+	size_t NumBytes = (size_t)((NumBits + 7) / 8);
+
+	if (NumBits <= 0) {
+		return;
+	}
+
+	if (Shift == 0) {
+		memcpy(Dest, Part->Bytes, NumBytes);
+	}
+	else {
+		for (size_t i = 0; i < NumBytes; i++) {
+			BYTE Byte = Part->Bytes[i];
+
+			// the bits of the last byte past NumBits are 0 so they can be copied
+			if (Out->BitOrder) {
+				Dest[i] |= (BYTE)(Byte << Shift);
+				if ((Out->NumBits + (__int64)i * 8 + 8 - Shift) < Out->NumBits + NumBits) {
+					Dest[i + 1] = (BYTE)(Byte >> (8 - Shift));
+				}
+			}
+			else {
+				Dest[i] |= (BYTE)(Byte >> Shift);
+				if ((Out->NumBits + (__int64)i * 8 + 8 - Shift) < Out->NumBits + NumBits) {
+					Dest[i + 1] = (BYTE)(Byte << (8 - Shift));
+				}
+			}
+		}
+	}
+
+	// the bits past NumBits in the last byte are 0 when the part was cut at MaxBits
+	if (NumBits < Part->NumBits) {
+		__int64 EndBit = Out->NumBits + NumBits;
+		int Used = (int)(EndBit & 7);
+		if (Used != 0) {
+			BYTE Keep = Out->BitOrder ? (BYTE)((1 << Used) - 1) : (BYTE)(0xFF << (8 - Used));
+			Out->Bytes[EndBit >> 3] &= Keep;
+		}
+	}
+
+	if (NumBits == Part->NumBits) {
+		Out->NumOneBits += Part->NumOneBits;
+	}
+	else {
+		for (__int64 i = 0; i < NumBits; i++) {
+			BYTE Mask = Out->BitOrder ? (BYTE)(0x01 << (i & 7)) : (BYTE)(0x80 >> (i & 7));
+			if (Part->Bytes[i >> 3] & Mask) {
+				Out->NumOneBits++;
+			}
+		}
+	}
+	Out->NumBits += NumBits;
+}
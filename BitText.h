@@ -0,0 +1,44 @@
+#pragma once
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// BitText.h
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+// V1.2.0	2026-10-19	Added text bitstream reader
+//
+#include "framework.h"
+#include <vector>
+
+#define BITTEXT_CHUNK (16 << 20)	// # of text bytes parsed at a time, one chunk per thread
+
+// why ReadBitText() stopped
+#define BITTEXT_END 0			// end of the file or MaxBits values read
+#define BITTEXT_TEXT 1			// something that is not a number
+#define BITTEXT_NEGATIVE 2		// a value < 0
+
+typedef struct {
+	__int64 NumBits;		// # of values read
+	__int64 NumOneBits;		// # of values > 0
+	int Stop;				// BITTEXT_END, BITTEXT_TEXT or BITTEXT_NEGATIVE
+} BITTEXTINFO;
+
+int ReadBitText(WCHAR* InputFile, int BitOrder, __int64 MaxBits, BOOL Parallel,
+	std::vector<BYTE>& Bytes, BITTEXTINFO* Info);
@@ -46,9 +46,52 @@
 // V1.1.1   2024-07-01  Corrected bug that locked rule file with program was running
 // V1.1.2   2024-07-08  Added CountBitInImage()
 // V1.1.3   2024-07-18  Correction, allow 0 iterations for ASIS message
+// V1.2.0   2026-10-19  Added sparse particle list BCA engine for low density images
+//                          MargolusBCAsparse() only processes the 2x2 blocks that have
+//                          set cells.  MargolusBCAauto() switches between the dense and
+//                          sparse engines based on the # of set cells in the image.
+//                          functions added to support this:
+//                              InitParticleList()
+//                              FreeParticleList()
+//                              BuildParticleList()
+//                              MargolusBCAsparse()
+//                              MargolusBCAauto()
+//                      Added run stop conditions that are updated inside the BCA step
+//                          (bit count, histogram pattern, Hamming distance to a reference
+//                          image, return to initial image)
+//                          functions added to support this:
+//                              InitStopCondition()
+//                              FreeStopCondition()
+//                              PackImageBits()
+//                              HammingDistancePacked()
+//                              StartStopCondition()
+//                              CheckStopCondition()
+//                      Moved the BCA state globals into the BCAengine class (BCAengine.cpp)
+//                      Added UnpackImageBits() for BCA checkpoint files
+//                      Added information tape for exact backward steps when the forward
+//                          rules are not invertible
+//                          functions added to support this:
+//                              InitInfoTape()
+//                              FreeInfoTape()
+//                              ClearInfoTape()
+//                              RecordInfoTape()
+//                              ReplayInfoTape()
+//                      Added UnaryFooterSequences(), segmented prime factor sum sieve
+//                          used by the Unary dialog instead of factorCombinations()
+//                      Added unary footer codec, EncodeUnaryFooter() and DecodeUnaryFooter()
+//                          replace factorCombinations() in the ASIS send dialog and
+//                          the footer run length product in ReadASISmessage()
+//                          removed findFactors() and factorCombinations()
+//                      Added PackPixelBits() and UnpackPixelBits(), SSE2 kernels that pack/unpack
+//                          1 bit per pixel and count the set pixels in the same pass, used by
+//                          ReadASISmessage(), ConvertImage2Bitstream(), PackImageBits() and
+//                          UnpackImageBits().  CountBitInImage() uses SSE2.
+//                      Added CountBitInImage() for 1 bit per pixel Image<bool>
+//                      ReadASISmessage() and UnpackImageBits() return an Image<int>
+//                      Added BinarizeImageFrames()
 //
 //  This contains the Margolus block cellular functions
-//  This will get converted to a c++ class
+//  The simulation state is kept by the BCAengine class
 //  
 //  Still to do:
 //      Implement the forward BCA algorithim (even step)
@@ -62,43 +105,28 @@
 #include <atlstr.h>
 #include <strsafe.h>
 #include <cmath>
+#include <climits>
 #include <vector>
+#include <algorithm>
 #include "AppErrors.h"
 #include "ImageDialog.h"
 #include "Globals.h"
 #include "imageheader.h"
 #include "FileFunctions.h"
 #include "CA.h"
+#include "Image.h"
 
-// These are the state globals that start, stop and track processing
-
-// BCArunning == 0  && StopRunning == TRUE
-//  no processing is running
-// BCSrunning == -1 && StopRunnig = TRUE
-//  set BCSrunning to 0 (stopped) at the end the current iteration
-// BCSrunning == 1 && StopRunnig = TRUE
-//  set BCSrunning to 0 (stopped) at the end the current iteration
-// BCSrunning == -1 and StopRunning = FALSE
-//  run backward iteration
-// BCSrunning == 0 and StopRunning = FALSE
-//  run foward iteration
+// SSE2 is in every x64 processor and is the default for x86 builds
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define BITPACK_SSE2
+#endif
 
-int BCArunning = 0; // -1 running backward
-                    // 0 stopped
-                    // +1 runing forward
+// # of bits set in each of the 16 2x2 block numbers
+static const int BitsInBlock[16] = { 0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4 };
 
-BOOL BCAimageLoaded = FALSE;
-
-int CurrentIteration = 0; // also used to tell whether current frame is even or odd
-BOOL EvenStep = TRUE;      // Even step in Margolus neighborhood 
-BOOL StopRunning = TRUE; // request to stop iterations at the end of the  current iteration
-                         // This is set to FALSE to start runnning iterations
-                         // StateBCA will indicate backwards or forwards
-int ForwardRules[16] = { 0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15 };
-int BackwardRules[16] = { 0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15 };
-
-int* TheImage;
-IMAGINGHEADER BCAimageHeader;
+static void UpdateStopCondition(STOPCONDITION* Stop, int UL, int UR, int LL, int LR,
+    int OldCell, int NewCell);
 
 //******************************************************************************
 //
@@ -126,6 +154,8 @@ IMAGINGHEADER BCAimageHeader;
 //  int Ysize                   y size of image
 //  int* Rules                  list of the 16 block substituion rules
 //  int* Histo                  count of 0,1,2,3,4 #pixel set in 2x2 bloock
+//  STOPCONDITION* Stop         (optional) stop condition state updated for each
+//                              block that changes, nullptr if not used
 // 
 //  return value:
 //  1 - Success
@@ -133,10 +163,11 @@ IMAGINGHEADER BCAimageHeader;
 //
 //*******************************************************************************
 void MargolusBCAp1p1(BOOL EvenStep, int* TheImage, int Xsize, int Ysize,
-    int* Rules, int* Histo)
+    int* Rules, int* Histo, STOPCONDITION* Stop)
 {
     int Length = Xsize * Ysize / 4; // number of 2x2 blocks in image
     int Cell = 0;
+    int OldCell;
     int i;
     int x, y;
     int xp1, yp1;
@@ -194,7 +225,12 @@ void MargolusBCAp1p1(BOOL EvenStep, int* TheImage, int Xsize, int Ysize,
         }
 
         // Convert the 2x2 using the Rules
+        OldCell = Cell;
         Cell = Rules[Cell];
+        if (Stop != nullptr && OldCell != Cell) {
+            UpdateStopCondition(Stop, (y * Xsize) + x, (y * Xsize) + xp1,
+                (yp1 * Xsize) + x, (yp1 * Xsize) + xp1, OldCell, Cell);
+        }
         switch (Cell) {
         case 0:
             TheImage[(y * Xsize) + x] = 0;
@@ -308,31 +344,1278 @@ void MargolusBCAp1p1(BOOL EvenStep, int* TheImage, int Xsize, int Ysize,
             Histo[3]++;
             break;
 
-        case 14:
-            TheImage[(y * Xsize) + x] = 0;
-            TheImage[(y * Xsize) + xp1] = 255;
-            TheImage[(yp1 * Xsize) + x] = 255;
-            TheImage[(yp1 * Xsize) + xp1] = 255;
-            Histo[3]++; 
-            break;
+        case 14:
+            TheImage[(y * Xsize) + x] = 0;
+            TheImage[(y * Xsize) + xp1] = 255;
+            TheImage[(yp1 * Xsize) + x] = 255;
+            TheImage[(yp1 * Xsize) + xp1] = 255;
+            Histo[3]++; 
+            break;
+
+        case 15:
+            TheImage[(y * Xsize) + x] = 255;
+            TheImage[(y * Xsize) + xp1] = 255;
+            TheImage[(yp1 * Xsize) + x] = 255;
+            TheImage[(yp1 * Xsize) + xp1] = 255;
+            Histo[4]++;
+            break;
+        }
+
+        x = x + 2;
+        if (x >= Xsize) {
+            x = StartX;
+            y = y + 2;
+        }
+    }
+
+    return;
+}
+
+//******************************************************************************
+//
+// InitParticleList
+// 
+// Initialize an empty particle list.  The list is not valid until
+// BuildParticleList() has been called.
+// 
+//  PARTICLELIST* Particles     particle list to initialize
+// 
+//*******************************************************************************
+void InitParticleList(PARTICLELIST* Particles)
+{
+    Particles->Cells = nullptr;
+    Particles->Scratch = nullptr;
+    Particles->NumCells = 0;
+    Particles->MaxCells = 0;
+    Particles->Valid = FALSE;
+    return;
+}
+
+//******************************************************************************
+//
+// FreeParticleList
+// 
+// Release the memory used by a particle list.  The list is left empty
+// and invalid.
+// 
+//  PARTICLELIST* Particles     particle list to free
+// 
+//*******************************************************************************
+void FreeParticleList(PARTICLELIST* Particles)
+{
+    if (Particles->Cells != nullptr) {
+        delete[] Particles->Cells;
+    }
+    if (Particles->Scratch != nullptr) {
+        delete[] Particles->Scratch;
+    }
+    InitParticleList(Particles);
+    return;
+}
+
+//******************************************************************************
+//
+// BuildParticleList
+// 
+// Build the list of set cells (particles) in the image.
+// Each entry is the pixel index (y*Xsize + x) of a non zero pixel.
+// Room is reserved for the list to grow 4x before it has to be reallocated.
+// 
+//  int* TheImage               Pointer to the image
+//  int Xsize                   x size of image
+//  int Ysize                   y size of image
+//  PARTICLELIST* Particles     particle list to build
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+int BuildParticleList(int* TheImage, int Xsize, int Ysize, PARTICLELIST* Particles)
+{
+    int Count = 0;
+    int Length = Xsize * Ysize;
+
+    Particles->Valid = FALSE;
+    Particles->NumCells = 0;
+
+    if (TheImage == nullptr || Xsize <= 0 || Ysize <= 0) {
+        return APPERR_PARAMETER;
+    }
+
+    for (int i = 0; i < Length; i++) {
+        if (TheImage[i] != 0) {
+            Count++;
+        }
+    }
+
+    if (Particles->MaxCells < (Count * 4 + 4)) {
+        int NewMax = Count * 4 + 4;
+        int* NewCells;
+        int* NewScratch;
+
+        NewCells = new int[(size_t)NewMax];
+        if (NewCells == nullptr) {
+            return APPERR_MEMALLOC;
+        }
+        NewScratch = new int[(size_t)NewMax];
+        if (NewScratch == nullptr) {
+            delete[] NewCells;
+            return APPERR_MEMALLOC;
+        }
+        FreeParticleList(Particles);
+        Particles->Cells = NewCells;
+        Particles->Scratch = NewScratch;
+        Particles->MaxCells = NewMax;
+    }
+
+    for (int i = 0; i < Length; i++) {
+        if (TheImage[i] != 0) {
+            Particles->Cells[Particles->NumCells] = i;
+            Particles->NumCells++;
+        }
+    }
+
+    Particles->Valid = TRUE;
+    return APP_SUCCESS;
+}
+
+//******************************************************************************
+//
+// MargolusBCAsparse
+// 
+// This implements a step for a 2x2 Margolus block cellular automata using
+// a list of the set cells instead of scanning the whole image.
+// The set cells are sorted by the 2x2 block they fall in for this step and
+// the rule is only applied to the occupied blocks.  This produces the same
+// image and Histo as MargolusBCAp1p1() as long as Rules[0] is 0 (an empty block
+// stays empty).  The cost is proportional to the # of set cells rather than
+// the size of the image.
+// 
+//  BOOL EvenStep               Identifies a even or odd interation (step)
+//  int* TheImage               Pointer to the image
+//  int Xsize                   x size of image
+//  int Ysize                   y size of image
+//  int* Rules                  list of the 16 block substituion rules
+//  int* Histo                  count of 0,1,2,3,4 #pixel set in 2x2 bloock
+//  PARTICLELIST* Particles     list of set cells in TheImage, updated for the new image
+//  STOPCONDITION* Stop         (optional) stop condition state updated for each
+//                              block that changes, nullptr if not used
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//      TheImage is not changed if an error is returned
+//
+//*******************************************************************************
+int MargolusBCAsparse(BOOL EvenStep, int* TheImage, int Xsize, int Ysize,
+    int* Rules, int* Histo, PARTICLELIST* Particles, STOPCONDITION* Stop)
+{
+    int BlocksPerRow = Xsize / 2;
+    int NumBlocks = (Xsize / 2) * (Ysize / 2);
+    int NumCells = Particles->NumCells;
+    int* Keys = Particles->Scratch;
+    int Start;
+    int Occupied;
+    int NewCount;
+    int i;
+    int x, y;
+    int xp1, yp1;
+
+    if (!Particles->Valid || Rules[0] != 0) {
+        return APPERR_PARAMETER;
+    }
+
+    if (EvenStep) {
+        // 2x2 grid starts at 0,0
+        Start = 0;
+    }
+    else {
+        // 2x2 grid starts at 1,1
+        Start = 1;
+    }
+
+    // sort key is (block number * 4) + position of cell in the block
+    // position 0 - UL, 1 - UR, 2 - LL, 3 - LR
+    // this matches the bit number in the 0-15 block number
+    for (i = 0; i < NumCells; i++) {
+        int bx, by;
+
+        x = Particles->Cells[i] % Xsize;
+        y = Particles->Cells[i] / Xsize;
+        // position relative to the grid origin, handles wrap around
+        bx = x - Start;
+        if (bx < 0) bx += Xsize;
+        by = y - Start;
+        if (by < 0) by += Ysize;
+        Keys[i] = ((((by >> 1) * BlocksPerRow) + (bx >> 1)) << 2) | ((by & 1) << 1) | (bx & 1);
+    }
+    std::sort(Keys, Keys + NumCells);
+
+    // count occupied blocks, each one can produce up to 4 set cells
+    Occupied = 0;
+    for (i = 0; i < NumCells; i++) {
+        if (i == 0 || (Keys[i] >> 2) != (Keys[i - 1] >> 2)) {
+            Occupied++;
+        }
+    }
+    if ((Occupied * 4) > Particles->MaxCells) {
+        int NewMax = Occupied * 4;
+        int* NewCells;
+        int* NewScratch;
+
+        NewCells = new int[(size_t)NewMax];
+        if (NewCells == nullptr) {
+            return APPERR_MEMALLOC;
+        }
+        NewScratch = new int[(size_t)NewMax];
+        if (NewScratch == nullptr) {
+            delete[] NewCells;
+            return APPERR_MEMALLOC;
+        }
+        for (i = 0; i < NumCells; i++) {
+            NewScratch[i] = Keys[i];
+        }
+        delete[] Particles->Cells;
+        delete[] Particles->Scratch;
+        Particles->Cells = NewCells;
+        Particles->Scratch = NewScratch;
+        Particles->MaxCells = NewMax;
+        Keys = NewScratch;
+    }
+
+    // apply rules to each occupied block
+    // the new particle list is rebuilt in Cells
+    NewCount = 0;
+    for (i = 0; i < NumCells; ) {
+        int Block = Keys[i] >> 2;
+        int Cell = 0;
+        int Pixel[4];
+
+        // convert the 2x2 block to a 0-15 number
+        while (i < NumCells && (Keys[i] >> 2) == Block) {
+            Cell = Cell | (1 << (Keys[i] & 3));
+            i++;
+        }
+
+        x = Start + 2 * (Block % BlocksPerRow);
+        y = Start + 2 * (Block / BlocksPerRow);
+        // use the modulo to handle wrap around space on the boundaries as required
+        xp1 = (x + 1) % Xsize;
+        yp1 = (y + 1) % Ysize;
+
+        Pixel[0] = (y * Xsize) + x;     // UL cell
+        Pixel[1] = (y * Xsize) + xp1;   // UR cell
+        Pixel[2] = (yp1 * Xsize) + x;   // LL cell
+        Pixel[3] = (yp1 * Xsize) + xp1; // LR cell
+
+        // Convert the 2x2 using the Rules
+        if (Stop != nullptr && Rules[Cell] != Cell) {
+            UpdateStopCondition(Stop, Pixel[0], Pixel[1], Pixel[2], Pixel[3], Cell, Rules[Cell]);
+        }
+        Cell = Rules[Cell];
+        Histo[BitsInBlock[Cell]]++;
+
+        for (int k = 0; k < 4; k++) {
+            if (Cell & (1 << k)) {
+                TheImage[Pixel[k]] = 255;
+                Particles->Cells[NewCount] = Pixel[k];
+                NewCount++;
+            }
+            else {
+                TheImage[Pixel[k]] = 0;
+            }
+        }
+    }
+
+    // all the empty blocks stay empty
+    Histo[0] += NumBlocks - Occupied;
+
+    Particles->NumCells = NewCount;
+    return APP_SUCCESS;
+}
+
+//******************************************************************************
+//
+// MargolusBCAauto
+// 
+// This implements a step for a 2x2 Margolus block cellular automata cell
+// selecting between the dense engine, MargolusBCAp1p1(), and the sparse
+// engine, MargolusBCAsparse(), based on the density of set cells.
+// The sparse engine is used when the # of set cells is <= the image area
+// divided by SPARSE_DENSITY_DIVISOR and the rules leave an empty block empty.
+// The particle list is built from the image the first time a dense step
+// leaves the image sparse enough and is kept updated while the sparse
+// engine is used.
+// 
+// The caller must set Particles->Valid = FALSE whenever the image is changed
+// outside of this function (e.g. a new image is loaded).
+// 
+//  BOOL EvenStep               Identifies a even or odd interation (step)
+//  int* TheImage               Pointer to the image
+//  int Xsize                   x size of image
+//  int Ysize                   y size of image
+//  int* Rules                  list of the 16 block substituion rules
+//  int* Histo                  count of 0,1,2,3,4 #pixel set in 2x2 bloock
+//  PARTICLELIST* Particles     particle list for TheImage
+//  STOPCONDITION* Stop         (optional) stop condition state, nullptr if not used
+// 
+//  no return value
+//
+//*******************************************************************************
+void MargolusBCAauto(BOOL EvenStep, int* TheImage, int Xsize, int Ysize,
+    int* Rules, int* Histo, PARTICLELIST* Particles, STOPCONDITION* Stop)
+{
+    int SparseLimit = (Xsize * Ysize) / SPARSE_DENSITY_DIVISOR;
+    int LastHisto[5];
+    int Count;
+
+    if (Rules[0] == 0 && Particles->Valid && Particles->NumCells <= SparseLimit) {
+        if (MargolusBCAsparse(EvenStep, TheImage, Xsize, Ysize, Rules, Histo, Particles, Stop) == APP_SUCCESS) {
+            return;
+        }
+    }
+
+    // use dense engine
+    Particles->Valid = FALSE;
+
+    // Histo may be accumulating over several steps
+    for (int i = 0; i < 5; i++) {
+        LastHisto[i] = Histo[i];
+    }
+
+    MargolusBCAp1p1(EvenStep, TheImage, Xsize, Ysize, Rules, Histo, Stop);
+
+    if (Rules[0] != 0) {
+        return;
+    }
+
+    // # of set cells after this step
+    Count = 0;
+    for (int i = 1; i < 5; i++) {
+        Count += i * (Histo[i] - LastHisto[i]);
+    }
+    if (Count <= SparseLimit) {
+        // switch to sparse engine for the next step
+        BuildParticleList(TheImage, Xsize, Ysize, Particles);
+    }
+
+    return;
+}
+
+//******************************************************************************
+//
+// PopCount64
+// 
+// # of bits set in a 64 bit word
+// 
+//*******************************************************************************
+static int PopCount64(unsigned __int64 Word)
+{
+    Word = Word - ((Word >> 1) & 0x5555555555555555ULL);
+    Word = (Word & 0x3333333333333333ULL) + ((Word >> 2) & 0x3333333333333333ULL);
+    Word = (Word + (Word >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (int)((Word * 0x0101010101010101ULL) >> 56);
+}
+
+//******************************************************************************
+//
+// PackPixelBits
+// 
+// Pack pixels into 1 bit per pixel, non zero pixels are 1, and count them.
+// Pixel i is in byte (i / 8), bit order in the byte:
+//      LSBfirst FALSE  pixel 0 is the 0x80 bit (ASIS message body)
+//      LSBfirst TRUE   pixel 0 is the 0x01 bit (same as the 64 bit words
+//                      of PackImageBits() on little endian Windows)
+// Unused bits in the last byte are 0.
+// 
+// Uses SSE2, 16 pixels are compared to 0 and the results packed down to
+// 16 bytes so _mm_movemask_epi8() gives their bits in one instruction.
+// For MSB first the pixels in each group of 8 are reversed before packing.
+// 
+//  int* Pixels                 image pixels
+//  int NumPixels               # of pixels to pack
+//  BYTE* Bytes                 returns packed pixels, (NumPixels+7)/8 bytes
+// 
+//  return value:
+//  # of pixels set
+//
+//*******************************************************************************
+int PackPixelBits(int* Pixels, int NumPixels, BYTE* Bytes, BOOL LSBfirst)
+{
+    int Count = 0;
+    int i = 0;
+    int k = 0;
+
+#ifdef BITPACK_SSE2
+    const __m128i Zero = _mm_setzero_si128();
+    unsigned __int64 Word;
+
+    for (; i + 64 <= NumPixels; i += 64, k += 8) {
+        Word = 0;
+        for (int j = 0; j < 64; j += 16) {
+            __m128i A = _mm_loadu_si128((const __m128i*)(Pixels + i + j));
+            __m128i B = _mm_loadu_si128((const __m128i*)(Pixels + i + j + 4));
+            __m128i C = _mm_loadu_si128((const __m128i*)(Pixels + i + j + 8));
+            __m128i D = _mm_loadu_si128((const __m128i*)(Pixels + i + j + 12));
+            __m128i Packed;
+            if (LSBfirst) {
+                Packed = _mm_packs_epi16(_mm_packs_epi32(_mm_cmpeq_epi32(A, Zero), _mm_cmpeq_epi32(B, Zero)),
+                    _mm_packs_epi32(_mm_cmpeq_epi32(C, Zero), _mm_cmpeq_epi32(D, Zero)));
+            }
+            else {
+                A = _mm_shuffle_epi32(A, _MM_SHUFFLE(0, 1, 2, 3));
+                B = _mm_shuffle_epi32(B, _MM_SHUFFLE(0, 1, 2, 3));
+                C = _mm_shuffle_epi32(C, _MM_SHUFFLE(0, 1, 2, 3));
+                D = _mm_shuffle_epi32(D, _MM_SHUFFLE(0, 1, 2, 3));
+                Packed = _mm_packs_epi16(_mm_packs_epi32(_mm_cmpeq_epi32(B, Zero), _mm_cmpeq_epi32(A, Zero)),
+                    _mm_packs_epi32(_mm_cmpeq_epi32(D, Zero), _mm_cmpeq_epi32(C, Zero)));
+            }
+            // compare was == 0, invert for the set pixels
+            Word |= (unsigned __int64)(~_mm_movemask_epi8(Packed) & 0xffff) << j;
+        }
+        Count += PopCount64(Word);
+        for (int j = 0; j < 8; j++) {
+            Bytes[k + j] = (BYTE)(Word >> (8 * j));
+        }
+    }
+#endif
+
+    // rest of the pixels, one at a time
+    for (; i < NumPixels; k++) {
+        BYTE CurrentByte = 0;
+        for (int j = 0; j < 8 && i < NumPixels; j++, i++) {
+            if (Pixels[i] != 0) {
+                Count++;
+                CurrentByte |= LSBfirst ? (BYTE)(0x01 << j) : (BYTE)(0x80 >> j);
+            }
+        }
+        Bytes[k] = CurrentByte;
+    }
+
+    return Count;
+}
+
+//******************************************************************************
+//
+// UnpackPixelBits
+// 
+// Unpack 1 bit per pixel into binary 0/255 pixels and count the set pixels.
+// The bit order is the same as PackPixelBits().
+// 
+// Uses SSE2, each byte is copied to 4 ints, and'ed with the mask of the
+// bit each int is for and compared to the mask, 8 pixels in 2 stores.
+// 
+//  BYTE* Bytes                 packed pixels, (NumPixels+7)/8 bytes
+//  int NumPixels               # of pixels to unpack
+//  int* Pixels                 returns pixels
+// 
+//  return value:
+//  # of pixels set
+//
+//*******************************************************************************
+int UnpackPixelBits(BYTE* Bytes, int NumPixels, int* Pixels, BOOL LSBfirst)
+{
+    int Count = 0;
+    int i = 0;
+    int k = 0;
+
+#ifdef BITPACK_SSE2
+    const __m128i Set = _mm_set1_epi32(255);
+    __m128i MaskLo;
+    __m128i MaskHi;
+    if (LSBfirst) {
+        MaskLo = _mm_setr_epi32(0x01, 0x02, 0x04, 0x08);
+        MaskHi = _mm_setr_epi32(0x10, 0x20, 0x40, 0x80);
+    }
+    else {
+        MaskLo = _mm_setr_epi32(0x80, 0x40, 0x20, 0x10);
+        MaskHi = _mm_setr_epi32(0x08, 0x04, 0x02, 0x01);
+    }
+
+    for (; i + 64 <= NumPixels; i += 64, k += 8) {
+        unsigned __int64 Word;
+        memcpy(&Word, Bytes + k, sizeof(Word));
+        Count += PopCount64(Word);
+        for (int j = 0; j < 8; j++) {
+            __m128i Value = _mm_set1_epi32(Bytes[k + j]);
+            __m128i Lo = _mm_cmpeq_epi32(_mm_and_si128(Value, MaskLo), MaskLo);
+            __m128i Hi = _mm_cmpeq_epi32(_mm_and_si128(Value, MaskHi), MaskHi);
+            _mm_storeu_si128((__m128i*)(Pixels + i + 8 * j), _mm_and_si128(Lo, Set));
+            _mm_storeu_si128((__m128i*)(Pixels + i + 8 * j + 4), _mm_and_si128(Hi, Set));
+        }
+    }
+#endif
+
+    // rest of the pixels, one at a time
+    for (; i < NumPixels; k++) {
+        for (int j = 0; j < 8 && i < NumPixels; j++, i++) {
+            BYTE Mask = LSBfirst ? (BYTE)(0x01 << j) : (BYTE)(0x80 >> j);
+            if (Bytes[k] & Mask) {
+                Count++;
+                Pixels[i] = 255;
+            }
+            else {
+                Pixels[i] = 0;
+            }
+        }
+    }
+
+    return Count;
+}
+
+//******************************************************************************
+//
+// PackImageBits
+// 
+// Pack an image into 1 bit per pixel, non zero pixels are 1.
+// Pixel i (i = y*Xsize + x) is bit (i % 64) of word (i / 64).
+// Unused bits in the last word are 0.
+// 
+//  int* Image                  image to pack
+//  int Xsize                   x size of image
+//  int Ysize                   y size of image
+//  unsigned __int64** Packed   returns the packed image, caller must delete[]
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+int PackImageBits(int* Image, int Xsize, int Ysize, unsigned __int64** Packed)
+{
+    int Length = Xsize * Ysize;
+    int NumWords = (Length + 63) / 64;
+    unsigned __int64* Words;
+
+    *Packed = nullptr;
+    if (Image == nullptr || Length <= 0) {
+        return APPERR_PARAMETER;
+    }
+
+    Words = new unsigned __int64[(size_t)NumWords];
+    if (Words == nullptr) {
+        return APPERR_MEMALLOC;
+    }
+
+    // on little endian Windows the bytes of the words are in pixel order
+    Words[NumWords - 1] = 0;
+    PackPixelBits(Image, Length, (BYTE*)Words, TRUE);
+
+    *Packed = Words;
+    return APP_SUCCESS;
+}
+
+//******************************************************************************
+//
+// UnpackImageBits
+// 
+// Unpack a 1 bit per pixel image made by PackImageBits()
+// into a binary 0/255 image.
+// 
+//  unsigned __int64* Packed    packed image
+//  int Xsize                   x size of image
+//  int Ysize                   y size of image
+//  Image<int>& Dest            returns the unpacked image, rows are not padded
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+int UnpackImageBits(unsigned __int64* Packed, int Xsize, int Ysize, Image<int>& Dest)
+{
+    int iRes;
+
+    Dest.Release();
+    if (Packed == nullptr || Xsize <= 0 || Ysize <= 0) {
+        return APPERR_PARAMETER;
+    }
+
+    iRes = Dest.Create(Xsize, Ysize, 1, FALSE);
+    if (iRes != APP_SUCCESS) {
+        return iRes;
+    }
+
+    UnpackPixelBits((BYTE*)Packed, Xsize * Ysize, Dest.GetPixels(), TRUE);
+
+    return APP_SUCCESS;
+}
+
+//******************************************************************************
+//
+// HammingDistancePacked
+// 
+// # of bits that are different between two packed images
+// 
+//  unsigned __int64* Image1    packed image
+//  unsigned __int64* Image2    packed image
+//  int NumWords                # of 64 bit words in each image
+// 
+//  return value:
+//  Hamming distance
+//
+//*******************************************************************************
+int HammingDistancePacked(unsigned __int64* Image1, unsigned __int64* Image2, int NumWords)
+{
+    int Distance = 0;
+
+    for (int i = 0; i < NumWords; i++) {
+        Distance += PopCount64(Image1[i] ^ Image2[i]);
+    }
+    return Distance;
+}
+
+//******************************************************************************
+//
+// InitStopCondition
+// 
+// Initialize stop condition with all conditions disabled
+// 
+//  STOPCONDITION* Stop         stop condition to initialize
+// 
+//*******************************************************************************
+void InitStopCondition(STOPCONDITION* Stop)
+{
+    Stop->BitCountEnable = FALSE;
+    Stop->BitCountBelow = FALSE;
+    Stop->BitCountLimit = 0;
+    Stop->HistoEnable = FALSE;
+    for (int i = 0; i < 5; i++) {
+        Stop->HistoPattern[i] = -1;
+    }
+    Stop->HammingEnable = FALSE;
+    Stop->HammingLimit = 0;
+    Stop->InitialEnable = FALSE;
+    Stop->Xsize = 0;
+    Stop->Ysize = 0;
+    Stop->Reference = nullptr;
+    Stop->Initial = nullptr;
+    Stop->BitCount = 0;
+    Stop->ReferenceDistance = -1;
+    Stop->InitialDistance = -1;
+    return;
+}
+
+//******************************************************************************
+//
+// FreeStopCondition
+// 
+// Release the packed reference and initial images.
+// The enable flags and limits are not changed.
+// 
+//  STOPCONDITION* Stop         stop condition to free
+// 
+//*******************************************************************************
+void FreeStopCondition(STOPCONDITION* Stop)
+{
+    if (Stop->Reference != nullptr) {
+        delete[] Stop->Reference;
+        Stop->Reference = nullptr;
+    }
+    if (Stop->Initial != nullptr) {
+        delete[] Stop->Initial;
+        Stop->Initial = nullptr;
+    }
+    Stop->ReferenceDistance = -1;
+    Stop->InitialDistance = -1;
+    return;
+}
+
+//******************************************************************************
+//
+// StartStopCondition
+// 
+// Set up the stop condition state for the image that is about to be run.
+// The current image is saved as the initial image and the bit count and
+// Hamming distances are calculated once from the packed images.  After this
+// the BCA step functions keep these updated as blocks change.
+// 
+//  STOPCONDITION* Stop         stop condition to start
+//  int* TheImage               image the BCA will run on
+//  int Xsize                   x size of image
+//  int Ysize                   y size of image
+//  int* ReferenceImage         (optional) target image for Hamming distance,
+//                              must be Xsize x Ysize, nullptr if not used
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+int StartStopCondition(STOPCONDITION* Stop, int* TheImage, int Xsize, int Ysize,
+    int* ReferenceImage)
+{
+    int iRes;
+    int NumWords = ((Xsize * Ysize) + 63) / 64;
+
+    FreeStopCondition(Stop);
+    Stop->Xsize = Xsize;
+    Stop->Ysize = Ysize;
+
+    iRes = PackImageBits(TheImage, Xsize, Ysize, &Stop->Initial);
+    if (iRes != APP_SUCCESS) {
+        return iRes;
+    }
+    Stop->InitialDistance = 0;
+    Stop->BitCount = 0;
+    for (int i = 0; i < NumWords; i++) {
+        Stop->BitCount += PopCount64(Stop->Initial[i]);
+    }
+
+    if (ReferenceImage != nullptr) {
+        iRes = PackImageBits(ReferenceImage, Xsize, Ysize, &Stop->Reference);
+        if (iRes != APP_SUCCESS) {
+            FreeStopCondition(Stop);
+            return iRes;
+        }
+        Stop->ReferenceDistance = HammingDistancePacked(Stop->Initial, Stop->Reference, NumWords);
+    }
+
+    return APP_SUCCESS;
+}
+
+//******************************************************************************
+//
+// UpdateStopCondition
+// 
+// Called from the BCA step functions for each 2x2 block that is changed
+// by the rules.  Updates the bit count and the Hamming distances using
+// only the 4 cells in the block.
+// 
+//  STOPCONDITION* Stop         stop condition state
+//  int UL,UR,LL,LR             pixel index of the 4 cells in the block
+//  int OldCell                 block number (0-15) before the rule was applied
+//  int NewCell                 block number (0-15) after the rule was applied
+// 
+//*******************************************************************************
+static void UpdateStopCondition(STOPCONDITION* Stop, int UL, int UR, int LL, int LR,
+    int OldCell, int NewCell)
+{
+    int Cell;
+
+    Stop->BitCount += BitsInBlock[NewCell] - BitsInBlock[OldCell];
+
+    if (Stop->Reference != nullptr) {
+        // reference image cells as a 2x2 block number
+        Cell = (int)((Stop->Reference[UL >> 6] >> (UL & 63)) & 1);
+        Cell |= (int)((Stop->Reference[UR >> 6] >> (UR & 63)) & 1) << 1;
+        Cell |= (int)((Stop->Reference[LL >> 6] >> (LL & 63)) & 1) << 2;
+        Cell |= (int)((Stop->Reference[LR >> 6] >> (LR & 63)) & 1) << 3;
+        Stop->ReferenceDistance += BitsInBlock[NewCell ^ Cell] - BitsInBlock[OldCell ^ Cell];
+    }
+
+    if (Stop->Initial != nullptr) {
+        // initial image cells as a 2x2 block number
+        Cell = (int)((Stop->Initial[UL >> 6] >> (UL & 63)) & 1);
+        Cell |= (int)((Stop->Initial[UR >> 6] >> (UR & 63)) & 1) << 1;
+        Cell |= (int)((Stop->Initial[LL >> 6] >> (LL & 63)) & 1) << 2;
+        Cell |= (int)((Stop->Initial[LR >> 6] >> (LR & 63)) & 1) << 3;
+        Stop->InitialDistance += BitsInBlock[NewCell ^ Cell] - BitsInBlock[OldCell ^ Cell];
+    }
+    return;
+}
+
+//******************************************************************************
+//
+// CheckStopCondition
+// 
+// Check the enabled stop conditions after a BCA step
+// 
+//  STOPCONDITION* Stop         stop condition state
+//  int* Histo                  histogram from the step just completed
+// 
+//  return value:
+//  STOP_NONE (0) - no stop condition met
+//  otherwise the STOP_xxx flags of the conditions that were met
+//
+//*******************************************************************************
+int CheckStopCondition(STOPCONDITION* Stop, int* Histo)
+{
+    int Reason = STOP_NONE;
+
+    if (Stop->BitCountEnable) {
+        if (Stop->BitCountBelow) {
+            if (Stop->BitCount <= Stop->BitCountLimit) Reason |= STOP_BITCOUNT;
+        }
+        else {
+            if (Stop->BitCount >= Stop->BitCountLimit) Reason |= STOP_BITCOUNT;
+        }
+    }
+
+    if (Stop->HistoEnable && Histo != nullptr) {
+        BOOL Match = TRUE;
+        for (int i = 0; i < 5; i++) {
+            if (Stop->HistoPattern[i] >= 0 && Stop->HistoPattern[i] != Histo[i]) {
+                Match = FALSE;
+                break;
+            }
+        }
+        if (Match) Reason |= STOP_HISTOGRAM;
+    }
+
+    if (Stop->HammingEnable && Stop->Reference != nullptr) {
+        if (Stop->ReferenceDistance <= Stop->HammingLimit) Reason |= STOP_HAMMING;
+    }
+
+    if (Stop->InitialEnable && Stop->Initial != nullptr) {
+        if (Stop->InitialDistance == 0) Reason |= STOP_INITIAL;
+    }
+
+    return Reason;
+}
+
+//******************************************************************************
+//
+// InitInfoTape
+// 
+// Initialize an empty information tape, recording is off
+// 
+//  INFOTAPE* Tape              information tape to initialize
+// 
+//*******************************************************************************
+void InitInfoTape(INFOTAPE* Tape)
+{
+    Tape->Enabled = FALSE;
+    Tape->Data = nullptr;
+    Tape->Size = 0;
+    Tape->MaxSize = 0;
+    Tape->StepEnd = nullptr;
+    Tape->NumSteps = 0;
+    Tape->MaxSteps = 0;
+    return;
+}
+
+//******************************************************************************
+//
+// FreeInfoTape
+// 
+// Release the memory used by an information tape, recording is turned off
+// 
+//  INFOTAPE* Tape              information tape to free
+// 
+//*******************************************************************************
+void FreeInfoTape(INFOTAPE* Tape)
+{
+    if (Tape->Data != nullptr) {
+        delete[] Tape->Data;
+    }
+    if (Tape->StepEnd != nullptr) {
+        delete[] Tape->StepEnd;
+    }
+    InitInfoTape(Tape);
+    return;
+}
+
+//******************************************************************************
+//
+// ClearInfoTape
+// 
+// Remove all step records from the tape.  This must be done whenever the
+// image, the forward rules or the even/odd step are changed other than
+// by a BCA step.  Recording stays on if it was on.
+// 
+//  INFOTAPE* Tape              information tape to clear
+// 
+//*******************************************************************************
+void ClearInfoTape(INFOTAPE* Tape)
+{
+    Tape->Size = 0;
+    Tape->NumSteps = 0;
+    return;
+}
+
+// adaptive binary range coder used for the information tape
+// 11 bit probabilities of a 0 bit, adapted by 1/32 of the error after each bit
+#define TAPE_PROB_BITS 11
+#define TAPE_PROB_INIT (1 << (TAPE_PROB_BITS - 1))
+#define TAPE_MOVE_BITS 5
+#define TAPE_TOP (1 << 24)
+
+typedef struct {
+    INFOTAPE* Tape;
+    unsigned __int64 Low;
+    unsigned int Range;
+    BYTE Cache;
+    __int64 CacheSize;
+    BOOL Error;             // memory allocation failed
+} TAPEENCODER;
+
+typedef struct {
+    const BYTE* Next;
+    const BYTE* End;
+    unsigned int Range;
+    unsigned int Code;
+} TAPEDECODER;
+
+//******************************************************************************
+//
+// TapeOutByte
+// 
+// Append a byte to the tape data, the data buffer grows 2x when full
+// 
+//*******************************************************************************
+static void TapeOutByte(TAPEENCODER* Enc, BYTE Value)
+{
+    INFOTAPE* Tape = Enc->Tape;
+
+    if (Tape->Size >= Tape->MaxSize) {
+        size_t NewSize = Tape->MaxSize == 0 ? 4096 : Tape->MaxSize * 2;
+        BYTE* NewData = new BYTE[NewSize];
+        if (NewData == nullptr) {
+            Enc->Error = TRUE;
+            return;
+        }
+        if (Tape->Data != nullptr) {
+            memcpy(NewData, Tape->Data, Tape->Size);
+            delete[] Tape->Data;
+        }
+        Tape->Data = NewData;
+        Tape->MaxSize = NewSize;
+    }
+    Tape->Data[Tape->Size] = Value;
+    Tape->Size++;
+    return;
+}
+
+//******************************************************************************
+//
+// TapeShiftLow
+// 
+// Move the top byte of Low to the tape, handles the carry into bytes
+// that have already been held back in Cache
+// 
+//*******************************************************************************
+static void TapeShiftLow(TAPEENCODER* Enc)
+{
+    if ((unsigned int)Enc->Low < 0xFF000000 || (Enc->Low >> 32) != 0) {
+        BYTE Carry = (BYTE)(Enc->Low >> 32);
+        BYTE Temp = Enc->Cache;
+        do {
+            TapeOutByte(Enc, (BYTE)(Temp + Carry));
+            Temp = 0xFF;
+        } while (--Enc->CacheSize != 0);
+        Enc->Cache = (BYTE)((unsigned int)Enc->Low >> 24);
+    }
+    Enc->CacheSize++;
+    Enc->Low = (unsigned int)Enc->Low << 8;
+    return;
+}
+
+//******************************************************************************
+//
+// TapeEncodeBit
+// 
+//*******************************************************************************
+static void TapeEncodeBit(TAPEENCODER* Enc, unsigned short* Prob, int Bit)
+{
+    unsigned int Bound = (Enc->Range >> TAPE_PROB_BITS) * (*Prob);
+
+    if (Bit == 0) {
+        Enc->Range = Bound;
+        *Prob = (unsigned short)(*Prob + (((1 << TAPE_PROB_BITS) - *Prob) >> TAPE_MOVE_BITS));
+    }
+    else {
+        Enc->Low += Bound;
+        Enc->Range -= Bound;
+        *Prob = (unsigned short)(*Prob - (*Prob >> TAPE_MOVE_BITS));
+    }
+    while (Enc->Range < TAPE_TOP) {
+        Enc->Range <<= 8;
+        TapeShiftLow(Enc);
+    }
+    return;
+}
+
+//******************************************************************************
+//
+// TapeDecodeBit
+// 
+// Reading past the end of the step record returns 0 bytes
+// 
+//*******************************************************************************
+static int TapeDecodeBit(TAPEDECODER* Dec, unsigned short* Prob)
+{
+    unsigned int Bound = (Dec->Range >> TAPE_PROB_BITS) * (*Prob);
+    int Bit;
+
+    if (Dec->Code < Bound) {
+        Dec->Range = Bound;
+        *Prob = (unsigned short)(*Prob + (((1 << TAPE_PROB_BITS) - *Prob) >> TAPE_MOVE_BITS));
+        Bit = 0;
+    }
+    else {
+        Dec->Code -= Bound;
+        Dec->Range -= Bound;
+        *Prob = (unsigned short)(*Prob - (*Prob >> TAPE_MOVE_BITS));
+        Bit = 1;
+    }
+    while (Dec->Range < TAPE_TOP) {
+        Dec->Range <<= 8;
+        Dec->Code = (Dec->Code << 8) | (Dec->Next < Dec->End ? *Dec->Next++ : 0);
+    }
+    return Bit;
+}
+
+//******************************************************************************
+//
+// TapePreimages
+// 
+// Find the preimages of each 2x2 block value in the rules
+// 
+//  int* Rules                  16 rules
+//  int* Count                  returns # of preimages of each block value
+//  int* Index                  returns the rank of each block value among the
+//                              preimages of Rules[value]
+//  int Preimage[16][16]        returns the preimages of each block value
+//  int* Bits                   returns # of bits needed for a preimage rank
+//                              of each block value
+// 
+//  return value:
+//  TRUE if the rules are invertible (every block value has 1 preimage)
+//
+//*******************************************************************************
+static BOOL TapePreimages(int* Rules, int* Count, int* Index, int Preimage[16][16], int* Bits)
+{
+    BOOL Invertible = TRUE;
+
+    for (int i = 0; i < 16; i++) {
+        Count[i] = 0;
+    }
+    for (int i = 0; i < 16; i++) {
+        int Cell = Rules[i] & 15;
+        Index[i] = Count[Cell];
+        Preimage[Cell][Count[Cell]] = i;
+        Count[Cell]++;
+    }
+    for (int i = 0; i < 16; i++) {
+        if (Count[i] != 1) {
+            Invertible = FALSE;
+        }
+        Bits[i] = 0;
+        while ((1 << Bits[i]) < Count[i]) {
+            Bits[i]++;
+        }
+    }
+    return Invertible;
+}
+
+//******************************************************************************
+//
+// RecordInfoTape
+// 
+// Add a step record to the tape for the forward step that is about to be done.
+// This must be called before the step, while TheImage still holds the blocks
+// that the rules will replace.  Nothing is written to the record when the
+// rules are invertible.
+// 
+//  BOOL EvenStep               TRUE 2x2 grid starts at 0,0, FALSE starts at 1,1
+//  int* TheImage               Pointer to the image before the step
+//  int Xsize                   x size of image
+//  int Ysize                   y size of image
+//  int* Rules                  forward rules for the step
+//  INFOTAPE* Tape              information tape
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+int RecordInfoTape(BOOL EvenStep, int* TheImage, int Xsize, int Ysize, int* Rules, INFOTAPE* Tape)
+{
+    int Count[16];
+    int Index[16];
+    int Preimage[16][16];
+    int Bits[16];
+    int Start = EvenStep ? 0 : 1;
+
+    if (Tape->NumSteps >= Tape->MaxSteps) {
+        int NewMax = Tape->MaxSteps == 0 ? 1024 : Tape->MaxSteps * 2;
+        size_t* NewStepEnd = new size_t[NewMax];
+        if (NewStepEnd == nullptr) {
+            return APPERR_MEMALLOC;
+        }
+        if (Tape->StepEnd != nullptr) {
+            memcpy(NewStepEnd, Tape->StepEnd, Tape->NumSteps * sizeof(size_t));
+            delete[] Tape->StepEnd;
+        }
+        Tape->StepEnd = NewStepEnd;
+        Tape->MaxSteps = NewMax;
+    }
+
+    if (!TapePreimages(Rules, Count, Index, Preimage, Bits)) {
+        TAPEENCODER Enc;
+        unsigned short Prob[16][16];
+        size_t OldSize = Tape->Size;
+
+        for (int i = 0; i < 16; i++) {
+            for (int j = 0; j < 16; j++) {
+                Prob[i][j] = TAPE_PROB_INIT;
+            }
+        }
+        Enc.Tape = Tape;
+        Enc.Low = 0;
+        Enc.Range = 0xFFFFFFFF;
+        Enc.Cache = 0;
+        Enc.CacheSize = 1;
+        Enc.Error = FALSE;
+
+        for (int y = Start; y < Ysize + Start; y += 2) {
+            int Row = (y % Ysize) * Xsize;
+            int Rowp1 = ((y + 1) % Ysize) * Xsize;
+            for (int x = Start; x < Xsize + Start; x += 2) {
+                int xp1 = (x + 1) % Xsize;
+                int Cell = 0;
+
+                if (TheImage[Row + x] != 0) Cell = 1;
+                if (TheImage[Row + xp1] != 0) Cell += 2;
+                if (TheImage[Rowp1 + x] != 0) Cell += 4;
+                if (TheImage[Rowp1 + xp1] != 0) Cell += 8;
+
+                int NewCell = Rules[Cell] & 15;
+                if (Count[NewCell] > 1) {
+                    // binary tree coding of the preimage rank, context is the new block value
+                    int Node = 1;
+                    for (int b = Bits[NewCell] - 1; b >= 0; b--) {
+                        int Bit = (Index[Cell] >> b) & 1;
+                        TapeEncodeBit(&Enc, &Prob[NewCell][Node], Bit);
+                        Node = (Node << 1) | Bit;
+                    }
+                }
+            }
+        }
+        for (int i = 0; i < 5; i++) {
+            TapeShiftLow(&Enc);
+        }
+        if (Enc.Error) {
+            Tape->Size = OldSize;
+            return APPERR_MEMALLOC;
+        }
+    }
+
+    Tape->StepEnd[Tape->NumSteps] = Tape->Size;
+    Tape->NumSteps++;
+    return APP_SUCCESS;
+}
 
-        case 15:
-            TheImage[(y * Xsize) + x] = 255;
-            TheImage[(y * Xsize) + xp1] = 255;
-            TheImage[(yp1 * Xsize) + x] = 255;
-            TheImage[(yp1 * Xsize) + xp1] = 255;
-            Histo[4]++;
-            break;
+//******************************************************************************
+//
+// ReplayInfoTape
+// 
+// Undo the last recorded forward step exactly, using the inverse of the forward
+// rules and the tape for blocks with more than one preimage.  The step record
+// is removed from the tape.
+// 
+//  BOOL EvenStep               grid of the step being undone, TRUE 2x2 grid
+//                              starts at 0,0, FALSE starts at 1,1
+//  int* TheImage               Pointer to the image after the step
+//  int Xsize                   x size of image
+//  int Ysize                   y size of image
+//  int* Rules                  forward rules that were used for the step
+//  int* Histo                  Histogram of 0,1,2,3,4 bits set in the restored 2x2 blocks
+//  INFOTAPE* Tape              information tape
+//  STOPCONDITION* Stop         (optional) stop conditions to update, nullptr if not used
+// 
+//  return value:
+//  1 - Success
+//  0 - No step record on the tape or the image is not the result of the
+//      recorded step, the image is not changed
+//
+//*******************************************************************************
+int ReplayInfoTape(BOOL EvenStep, int* TheImage, int Xsize, int Ysize, int* Rules,
+    int* Histo, INFOTAPE* Tape, STOPCONDITION* Stop)
+{
+    int Count[16];
+    int Index[16];
+    int Preimage[16][16];
+    int Bits[16];
+    int Start = EvenStep ? 0 : 1;
+    TAPEDECODER Dec;
+    unsigned short Prob[16][16];
+
+    if (Tape->NumSteps <= 0) {
+        return APPERR_PARAMETER;
+    }
+
+    TapePreimages(Rules, Count, Index, Preimage, Bits);
+
+    // check every block has a preimage before changing the image
+    for (int y = Start; y < Ysize + Start; y += 2) {
+        int Row = (y % Ysize) * Xsize;
+        int Rowp1 = ((y + 1) % Ysize) * Xsize;
+        for (int x = Start; x < Xsize + Start; x += 2) {
+            int xp1 = (x + 1) % Xsize;
+            int Cell = 0;
+
+            if (TheImage[Row + x] != 0) Cell = 1;
+            if (TheImage[Row + xp1] != 0) Cell += 2;
+            if (TheImage[Rowp1 + x] != 0) Cell += 4;
+            if (TheImage[Rowp1 + xp1] != 0) Cell += 8;
+            if (Count[Cell] == 0) {
+                return APPERR_PARAMETER;
+            }
         }
+    }
 
-        x = x + 2;
-        if (x >= Xsize) {
-            x = StartX;
-            y = y + 2;
+    for (int i = 0; i < 16; i++) {
+        for (int j = 0; j < 16; j++) {
+            Prob[i][j] = TAPE_PROB_INIT;
         }
     }
+    Dec.Next = Tape->Data + (Tape->NumSteps >= 2 ? Tape->StepEnd[Tape->NumSteps - 2] : 0);
+    Dec.End = Tape->Data + Tape->StepEnd[Tape->NumSteps - 1];
+    Dec.Range = 0xFFFFFFFF;
+    Dec.Code = 0;
+    for (int i = 0; i < 5; i++) {
+        Dec.Code = (Dec.Code << 8) | (Dec.Next < Dec.End ? *Dec.Next++ : 0);
+    }
 
-    return;
+    for (int y = Start; y < Ysize + Start; y += 2) {
+        int Row = (y % Ysize) * Xsize;
+        int Rowp1 = ((y + 1) % Ysize) * Xsize;
+        for (int x = Start; x < Xsize + Start; x += 2) {
+            int xp1 = (x + 1) % Xsize;
+            int Cell = 0;
+            int OldCell;
+
+            if (TheImage[Row + x] != 0) Cell = 1;
+            if (TheImage[Row + xp1] != 0) Cell += 2;
+            if (TheImage[Rowp1 + x] != 0) Cell += 4;
+            if (TheImage[Rowp1 + xp1] != 0) Cell += 8;
+
+            OldCell = Cell;
+            if (Count[Cell] == 1) {
+                Cell = Preimage[Cell][0];
+            }
+            else {
+                int Node = 1;
+                for (int b = 0; b < Bits[Cell]; b++) {
+                    Node = (Node << 1) | TapeDecodeBit(&Dec, &Prob[Cell][Node]);
+                }
+                Node -= (1 << Bits[Cell]);
+                if (Node >= Count[Cell]) {
+                    // damaged record, keep the block in range
+                    Node = Count[Cell] - 1;
+                }
+                Cell = Preimage[Cell][Node];
+            }
+
+            if (Cell != OldCell) {
+                if (Stop != nullptr) {
+                    UpdateStopCondition(Stop, Row + x, Row + xp1, Rowp1 + x, Rowp1 + xp1, OldCell, Cell);
+                }
+                TheImage[Row + x] = (Cell & 1) ? 255 : 0;
+                TheImage[Row + xp1] = (Cell & 2) ? 255 : 0;
+                TheImage[Rowp1 + x] = (Cell & 4) ? 255 : 0;
+                TheImage[Rowp1 + xp1] = (Cell & 8) ? 255 : 0;
+            }
+            Histo[BitsInBlock[Cell]]++;
+        }
+    }
+
+    Tape->NumSteps--;
+    Tape->Size = Tape->NumSteps > 0 ? Tape->StepEnd[Tape->NumSteps - 1] : 0;
+    return APP_SUCCESS;
 }
 
 //******************************************************************************
@@ -386,17 +1669,18 @@ int ReadRulesFile(HWND hDlg, WCHAR* InputFile, int* Rules)
 //  
 // 
 //******************************************************************************
-int ReadASISmessage(WCHAR *Filename, IMAGINGHEADER* ImageHeader, int** NewImage,
+int ReadASISmessage(WCHAR *Filename, IMAGINGHEADER* ImageHeader, Image<int>& NewImage,
     BYTE* Header, BYTE* Footer, int* BCAiterations, int* BitCount)
 {
     FILE* In;
     size_t iRead;
 
+    NewImage.Release();
+
     //
     // open Filename
     _wfopen_s(&In, Filename, L"rb");
     if (In == NULL) {
-        *NewImage = NULL;
         return APPERR_FILEOPEN;
     }
 
@@ -404,32 +1688,27 @@ int ReadASISmessage(WCHAR *Filename, IMAGINGHEADER* ImageHeader, int** NewImage,
     // verify header format
     iRead = fread(Header, 1, 10, In);
     if (iRead != 10) {
-        *NewImage = NULL;
         fclose(In);
         return APPERR_FILEREAD;
     }
     if (Header[0] != 0xff || Header[1] != 0xff) {
         // This is not an ASIS message
-        *NewImage = NULL;
         fclose(In);
         return APPERR_PARAMETER;
     }
     if (Header[2] != 0x06 || Header[3] != 0x90) {
         // This may be unknown ASIS message type
-        *NewImage = NULL;
         fclose(In);
         return APPERR_PARAMETER;
     }
 
     if (Header[6] != 0x44 || Header[7] != 0x88) {
         // This may be unknown ASIS message type
-        *NewImage = NULL;
         fclose(In);
         return APPERR_PARAMETER;
     }
     if (Header[8] != 0x44 || Header[9] != 0x88) {
         // This may be unknown ASIS message type
-        *NewImage = NULL;
         fclose(In);
         return APPERR_PARAMETER;
     }
@@ -438,7 +1717,6 @@ int ReadASISmessage(WCHAR *Filename, IMAGINGHEADER* ImageHeader, int** NewImage,
     BYTE* MessageBody;
     MessageBody = new BYTE[(size_t)8192];  // alocate array of byte to receive image
     if (MessageBody == nullptr) {
-        *NewImage = NULL;
         fclose(In);
         return APPERR_MEMALLOC;
     }
@@ -447,7 +1725,6 @@ int ReadASISmessage(WCHAR *Filename, IMAGINGHEADER* ImageHeader, int** NewImage,
     if (iRead != 8192) {
         // not ASIS message
         delete[] MessageBody;
-        *NewImage = NULL;
         fclose(In);
         return APPERR_FILEREAD;
     }
@@ -457,7 +1734,6 @@ int ReadASISmessage(WCHAR *Filename, IMAGINGHEADER* ImageHeader, int** NewImage,
     if (iRead != 10) {
         // not ASIS message
         delete[] MessageBody;
-        *NewImage = NULL;
         fclose(In);
         return APPERR_FILEREAD;
     }
@@ -466,58 +1742,33 @@ int ReadASISmessage(WCHAR *Filename, IMAGINGHEADER* ImageHeader, int** NewImage,
     if (iRead == 1) {
         // not ASIS message
         delete[] MessageBody;
-        *NewImage = NULL;
         fclose(In);
         return APPERR_PARAMETER;
     }
     fclose(In);
     
-    // count the bit sequences in footer (both 1s and 0s)
-    int BitCountList[40];
-    int NumSequences;
-    NumSequences = BitSequences(Footer, BitCountList, 10, FALSE);
-    if (NumSequences == 0) {
+    // mulitply the length all sequences in the footer but the last
+    // use this as the BCAiterations required, a footer with only
+    // one sequence is 0 iterations (do not run the BCA)
+    FOOTERDECODE Decode[FOOTER_NUM_CONVENTIONS];
+    if (DecodeUnaryFooter(Footer, 80, Decode) != APP_SUCCESS ||
+        Decode[0].Overflow || Decode[0].Iterations > INT_MAX) {
         delete[] MessageBody;
-        *NewImage = NULL;
         return APPERR_PARAMETER;
     }
+    *BCAiterations = (int)Decode[0].Iterations;
 
-    if (NumSequences <= 1 ) {
-        // do not run the BCA
-        *BCAiterations = 0;
-    }
-    else {
-        // mulitply the length all sequences but the last
-        // use this as the BCAiterations required
-        *BCAiterations = 1;
-        for (int i = 0; i < (NumSequences - 1); i++) {
-            *BCAiterations *= BitCountList[i];
-        }
-    }
-
-    // Allocae the new image array
-    int* Image;
-    Image = new int[(size_t)65536];
-    if (Image == nullptr) {
+    // Allocate the new 256x256 image
+    int iRes;
+    iRes = NewImage.Create(256, 256, 1, FALSE);
+    if (iRes != APP_SUCCESS) {
         delete[] MessageBody;
-        *NewImage = NULL;
-        return APPERR_MEMALLOC;
+        return iRes;
     }
 
     // convert 8192 message into 65536 entries the NewImage
-    int Count=0;
-    for (int i = 0,k=0; i < 8192; i++) {
-        for (int j = 0; j < 8; j++) {
-            if ((MessageBody[i] & ((BYTE)0x80 >> j)) == 0) {
-                Image[k] = 0;
-            }
-            else {
-                Count++;
-                Image[k] = 255;
-            }
-            k++;
-        }
-    }
+    int Count;
+    Count = UnpackPixelBits(MessageBody, 65536, NewImage.GetPixels(), FALSE);
     delete[] MessageBody;
 
     // buld ImageHeader
@@ -537,7 +1788,6 @@ int ReadASISmessage(WCHAR *Filename, IMAGINGHEADER* ImageHeader, int** NewImage,
     ImageHeader->Padding[5] = 0;
 
     *BitCount = Count;
-    *NewImage = Image;
     return APP_SUCCESS;
 }
 
@@ -693,21 +1943,8 @@ int ConvertImage2Bitstream(int* InputImage, IMAGINGHEADER* ImageHeader,
     }
 
     // convert
-    BYTE CurrentByte;
-    int ImageIndex = 0;
-    int Count = 0;
-
-    for (int i = 0; i < MessageLength; i++) {
-        CurrentByte = 0;
-        for (int j = 0; j < 8; j++) {
-            if (InputImage[ImageIndex] != 0) {
-                    Count++;
-                    CurrentByte = CurrentByte | (0x80 >> j);
-            }
-            ImageIndex++;
-        }
-        Message[i] = CurrentByte;
-    }
+    int Count;
+    Count = PackPixelBits(InputImage, MessageLength * 8, Message, FALSE);
 
     *MessageBody = Message;
     *BitCount = Count;
@@ -779,6 +2016,57 @@ void BinarizeImage(int* TheImage, IMAGINGHEADER* BCAimageHeader, int Threshold)
     return;
 }
 
+//*******************************************************************************
+//
+// BinarizeImageFrames
+// 
+// Convert a loaded image to a single frame binary 0/255 image.
+// 3 frame images are color images, the frames are collapsed with
+// CollapseImageFrames().  Other images are binarized with BinarizeImage(),
+// only the first frame is kept.
+// 
+// Image<int>& TheImage             image, rows are not padded
+// IMAGINGHEADER* ImageHeader       header of the image file, NumFrames is set to 1
+// int Threshold
+// 
+// return parameter
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+// 
+//*******************************************************************************
+int BinarizeImageFrames(Image<int>& TheImage, IMAGINGHEADER* ImageHeader, int Threshold)
+{
+    int iRes;
+
+    if (TheImage.IsEmpty() || TheImage.GetStride() != (size_t)TheImage.GetXsize()) {
+        return APPERR_PARAMETER;
+    }
+
+    if (ImageHeader->NumFrames == 3) {
+        CollapseImageFrames(TheImage.GetPixels(), ImageHeader, Threshold);
+    }
+    else {
+        ImageHeader->NumFrames = 1;
+        BinarizeImage(TheImage.GetPixels(), ImageHeader, Threshold);
+    }
+
+    if (TheImage.GetNumFrames() == 1) {
+        return APP_SUCCESS;
+    }
+
+    // keep only the first frame
+    Image<int> FirstFrame;
+    iRes = FirstFrame.Create(TheImage.GetXsize(), TheImage.GetYsize(), 1, FALSE);
+    if (iRes != APP_SUCCESS) {
+        return iRes;
+    }
+    memcpy(FirstFrame.GetPixels(), TheImage.GetPixels(),
+        (size_t)TheImage.GetXsize() * (size_t)TheImage.GetYsize() * sizeof(int));
+    TheImage = std::move(FirstFrame);
+
+    return APP_SUCCESS;
+}
+
 //*******************************************************************************
 //
 // BinarizeImage
@@ -804,7 +2092,21 @@ int CountBitInImage(int* Image, IMAGINGHEADER* ImageHeader)
     if (Image==nullptr || ImageHeader->NumFrames > 1) {
         return -1;
     }
-    for (int i = 0; i < (ImageHeader->Xsize * ImageHeader->Ysize * ImageHeader->NumFrames); i++) {
+    int NumPixels = ImageHeader->Xsize * ImageHeader->Ysize * ImageHeader->NumFrames;
+    int i = 0;
+#ifdef BITPACK_SSE2
+    // compare gives -1 for each pixel > 0, subtract to count them
+    const __m128i Zero = _mm_setzero_si128();
+    __m128i Counts = _mm_setzero_si128();
+    for (; i + 4 <= NumPixels; i += 4) {
+        __m128i Value = _mm_loadu_si128((const __m128i*)(Image + i));
+        Counts = _mm_sub_epi32(Counts, _mm_cmpgt_epi32(Value, Zero));
+    }
+    int Lanes[4];
+    _mm_storeu_si128((__m128i*)Lanes, Counts);
+    Count = Lanes[0] + Lanes[1] + Lanes[2] + Lanes[3];
+#endif
+    for (; i < NumPixels; i++) {
         if (Image[i] > 0) {
             Count++;
         }
@@ -813,41 +2115,462 @@ int CountBitInImage(int* Image, IMAGINGHEADER* ImageHeader)
     return Count;
 }
 
-//***************************************************************
+//*******************************************************************************
+//
+// CountBitInImage
+// 
+// # of set pixels in a 1 bit per pixel image, all frames.
+// The row padding bits are 0 so whole rows are counted 64 bits at a time.
+// 
+// Image<bool>& Bits
+// 
+// return parameter
+// 
+//  0 to Xsize*Ysize*NumFrames, # of set pixels
+//
+//*******************************************************************************
+int CountBitInImage(const Image<bool>& Bits)
+{
+    int Count = 0;
+    size_t RowBytes = Bits.GetStride();
+
+    for (int y = 0; y < Bits.GetYsize() * Bits.GetNumFrames(); y++) {
+        const BYTE* Row = Bits.GetRow(y);
+        for (size_t k = 0; k + 8 <= RowBytes; k += 8) {
+            unsigned __int64 Word;
+            memcpy(&Word, Row + k, sizeof(Word));
+            Count += PopCount64(Word);
+        }
+    }
+
+    return Count;
+}
+
+// work for one range of the unary footer sieve
+typedef struct {
+    const int* Primes;          // primes <= sqrt(last value)
+    int NumPrimes;
+    int First;                  // first value in range
+    int Last;                   // last value in range
+    int Target;                 // sum of prime factors wanted
+    unsigned int* Rem;          // work space, unfactored part of each value
+    int* Sum;                   // work space, sum of prime factors found so far
+    std::vector<int>* Matches;  // returns values in range with sum == Target
+} UNARYRANGE;
+
+//******************************************************************************
+//
+// UnaryRangeProc
+// 
+// Find the values in a range whose prime factors (with repeats) add up to
+// the target.  Each prime power p^k that divides a value adds p to its sum,
+// what is left after dividing out the small primes is a single large prime.
+// 
+//*******************************************************************************
+static DWORD WINAPI UnaryRangeProc(LPVOID Param)
+{
+    UNARYRANGE* Range = (UNARYRANGE*)Param;
+    int Length = Range->Last - Range->First + 1;
+
+    for (int i = 0; i < Length; i++) {
+        Range->Rem[i] = (unsigned int)(Range->First + i);
+        Range->Sum[i] = 0;
+    }
+
+    for (int k = 0; k < Range->NumPrimes; k++) {
+        int p = Range->Primes[k];
+        for (__int64 pk = p; pk <= Range->Last; pk *= p) {
+            __int64 j = ((Range->First + pk - 1) / pk) * pk;
+            for (; j <= Range->Last; j += pk) {
+                Range->Rem[j - Range->First] /= p;
+                Range->Sum[j - Range->First] += p;
+            }
+        }
+    }
+
+    for (int i = 0; i < Length; i++) {
+        int Sum = Range->Sum[i];
+        if (Range->Rem[i] > 1) {
+            Sum += (int)Range->Rem[i];
+        }
+        if (Sum == Range->Target) {
+            Range->Matches->push_back(Range->First + i);
+        }
+    }
+    return 0;
+}
+
+//******************************************************************************
 //
-// These functions were generated by chatgpt
+// UnaryFooterSequences
+// 
+// List every BCA iteration count from 2 to NumSteps that can be encoded as
+// a unary footer, i.e. the sum of its prime factors (with repeats) is
+// BitString - LastValue.  Each line is written in the form
+//      count: value = factor * factor ..., LastValue
 // 
-// Function to find all combinations of factors that multiply to a given number
-//      findFactors()
-// Function to generate all factor combinations
-//      factorCombinations()
-//***************************************************************
-// Function to find all combinations of factors that multiply to a given number
-void findFactors(int num, int start, std::vector<int>& current, std::vector<std::vector<int>>& result) {
-    // Base case: if num becomes 1, we have found a valid combination
-    if (num == 1) {
-        if (!current.empty()) {
-            result.push_back(current);
+// This uses a segmented sieve instead of factoring every value.
+// Ranges are sieved on worker threads, one range per processor at a time,
+// and written to the file in order.
+// 
+//  FILE* Out                   opened text file for the list
+//  int NumSteps                largest iteration count to check
+//  int BitString               # of bits in the footer bit string
+//  int LastValue               last unary value in the footer
+//  int* SeqCount               returns the # of iteration counts found
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+int UnaryFooterSequences(FILE* Out, int NumSteps, int BitString, int LastValue, int* SeqCount)
+{
+    const int RangeSize = 1 << 18;
+    int Target = BitString - LastValue;
+    std::vector<int> Primes;
+    SYSTEM_INFO SysInfo;
+    int NumThreads;
+    int iRes = APP_SUCCESS;
+
+    *SeqCount = 0;
+    if (NumSteps < 2 || Target < 2) {
+        return APP_SUCCESS;
+    }
+
+    // primes up to sqrt(NumSteps), simple sieve
+    {
+        int Limit = (int)sqrt((double)NumSteps) + 1;
+        std::vector<BYTE> Composite(Limit + 1, 0);
+        for (int i = 2; i <= Limit; i++) {
+            if (Composite[i]) continue;
+            if ((__int64)i * i <= NumSteps) {
+                Primes.push_back(i);
+            }
+            for (__int64 j = (__int64)i * i; j <= Limit; j += i) {
+                Composite[(size_t)j] = 1;
+            }
+        }
+    }
+
+    GetSystemInfo(&SysInfo);
+    NumThreads = (int)SysInfo.dwNumberOfProcessors;
+    if (NumThreads < 1) NumThreads = 1;
+    if (NumThreads > MAXIMUM_WAIT_OBJECTS) NumThreads = MAXIMUM_WAIT_OBJECTS;
+
+    std::vector<UNARYRANGE> Ranges(NumThreads);
+    std::vector<std::vector<int>> Matches(NumThreads);
+    std::vector<HANDLE> Threads(NumThreads);
+    unsigned int* Rem = new unsigned int[(size_t)RangeSize * NumThreads];
+    int* Sum = new int[(size_t)RangeSize * NumThreads];
+    if (Rem == nullptr || Sum == nullptr) {
+        if (Rem != nullptr) delete[] Rem;
+        if (Sum != nullptr) delete[] Sum;
+        return APPERR_MEMALLOC;
+    }
+
+    // output is only the matches, let the file buffer be large
+    setvbuf(Out, NULL, _IOFBF, 1 << 20);
+
+    for (__int64 First = 2; First <= NumSteps && iRes == APP_SUCCESS; First += (__int64)RangeSize * NumThreads) {
+        int Started = 0;
+
+        for (int t = 0; t < NumThreads; t++) {
+            __int64 RangeFirst = First + (__int64)t * RangeSize;
+            if (RangeFirst > NumSteps) break;
+            __int64 RangeLast = RangeFirst + RangeSize - 1;
+            if (RangeLast > NumSteps) RangeLast = NumSteps;
+
+            Matches[t].clear();
+            Ranges[t].Primes = Primes.data();
+            Ranges[t].NumPrimes = (int)Primes.size();
+            Ranges[t].First = (int)RangeFirst;
+            Ranges[t].Last = (int)RangeLast;
+            Ranges[t].Target = Target;
+            Ranges[t].Rem = Rem + (size_t)t * RangeSize;
+            Ranges[t].Sum = Sum + (size_t)t * RangeSize;
+            Ranges[t].Matches = &Matches[t];
+
+            Threads[t] = CreateThread(NULL, 0, UnaryRangeProc, &Ranges[t], 0, NULL);
+            if (Threads[t] == NULL) {
+                // no thread, do this range here
+                UnaryRangeProc(&Ranges[t]);
+            }
+            Started++;
+        }
+
+        for (int t = 0; t < Started; t++) {
+            if (Threads[t] != NULL) {
+                WaitForSingleObject(Threads[t], INFINITE);
+                CloseHandle(Threads[t]);
+            }
+        }
+
+        // write the matches in order, factor each one with the small primes
+        for (int t = 0; t < Started; t++) {
+            for (int Value : Matches[t]) {
+                int Rest = Value;
+                int j = 0;
+
+                (*SeqCount)++;
+                fprintf(Out, "%d: %d = ", *SeqCount, Value);
+                for (int p : Primes) {
+                    if ((__int64)p * p > Rest) break;
+                    while (Rest % p == 0) {
+                        fprintf(Out, j == 0 ? "%d" : " * %d", p);
+                        Rest = Rest / p;
+                        j++;
+                    }
+                }
+                if (Rest > 1) {
+                    fprintf(Out, j == 0 ? "%d" : " * %d", Rest);
+                }
+                fprintf(Out, ", %d\n", LastValue);
+            }
+        }
+        if (ferror(Out)) {
+            iRes = APPERR_FILEWRITE;
         }
+    }
+
+    delete[] Rem;
+    delete[] Sum;
+    return iRes;
+}
+
+
+//******************************************************************************
+//
+// AddFooterRun
+// 
+// Multiply a run length into a footer decode product, the product is
+// saturated when it does not fit in __int64
+// 
+//*******************************************************************************
+static void AddFooterRun(FOOTERDECODE* Decode, int RunLength)
+{
+    Decode->NumFactors++;
+    if (Decode->Overflow) {
+        return;
+    }
+    if (Decode->Iterations > LLONG_MAX / RunLength) {
+        Decode->Overflow = TRUE;
+        Decode->Iterations = LLONG_MAX;
         return;
     }
+    Decode->Iterations *= RunLength;
+    return;
+}
+
+//******************************************************************************
+//
+// EncodeUnaryFooter
+// 
+// Generate the unary footer for a BCA iteration count.
+// The footer is alternating runs of 1s and 0s, starting with 1s, one run
+// for each prime factor of Iterations (smallest first).  The rest of the
+// footer is the terminator run.  0 iterations is an all 0s footer,
+// 1 iteration is a single 1 bit run.
+// 
+// The prime factors are the factorization with the fewest bits (a*b >= a+b
+// for a,b >= 2) so no other factor combinations need to be checked.  Trial
+// division stops once a factor could no longer fit in the footer, this is
+// bounded by FooterBits not by Iterations.
+// 
+//  int Iterations              BCA iteration count to encode, >= 0
+//  BYTE* Footer                returns footer, (FooterBits+7)/8 bytes, MSB first
+//  int FooterBits              # of bits in the footer
+//  int* BitsUsed               returns # of bits in the factor runs,
+//                              the smallest footer that holds Iterations
+//                              is BitsUsed+1 bits
+// 
+//  return value:
+//  1 - Success
+//  0 - Iterations can not be encoded in FooterBits
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+int EncodeUnaryFooter(int Iterations, BYTE* Footer, int FooterBits, int* BitsUsed)
+{
+    int Factors[32];    // an int has at most 31 prime factors
+    int NumFactors = 0;
+    int Budget;
+    int Sum = 0;
+
+    if (Footer == nullptr || FooterBits < 1 || Iterations < 0) {
+        return APPERR_PARAMETER;
+    }
+    // the terminator run needs at least 1 bit
+    Budget = FooterBits - 1;
+
+    if (Iterations == 1) {
+        Factors[NumFactors++] = 1;
+        Sum = 1;
+    }
+    else if (Iterations > 1) {
+        int Remainder = Iterations;
+        int Divisor = 2;
+
+        while (Divisor <= (Budget - Sum) && (__int64)Divisor * Divisor <= Remainder) {
+            if ((Remainder % Divisor) == 0) {
+                Factors[NumFactors++] = Divisor;
+                Sum += Divisor;
+                Remainder = Remainder / Divisor;
+            }
+            else {
+                Divisor += (Divisor == 2) ? 1 : 2;
+            }
+        }
+        if (Remainder > 1) {
+            // what is left is a prime, if it is larger than the bits left
+            // (or trial division stopped early) it does not fit
+            if (Remainder > (Budget - Sum)) {
+                return APPERR_PARAMETER;
+            }
+            Factors[NumFactors++] = Remainder;
+            Sum += Remainder;
+        }
+    }
+    if (Sum > Budget) {
+        return APPERR_PARAMETER;
+    }
 
-    // Start from the last factor added to avoid duplicates
-    for (int i = start; i <= num; ++i) {
-        if (num % i == 0) {
-            current.push_back(i);
-            findFactors(num / i, i, current, result);
-            current.pop_back(); // backtrack
+    memset(Footer, 0, (size_t)((FooterBits + 7) / 8));
+    int Bit = 0;
+    for (int i = 0; i < NumFactors; i++) {
+        if ((i & 1) == 0) {
+            // runs of 1s, runs of 0s are already cleared
+            for (int j = 0; j < Factors[i]; j++) {
+                Footer[(Bit + j) >> 3] |= (BYTE)(0x80 >> ((Bit + j) & 7));
+            }
+        }
+        Bit += Factors[i];
+    }
+    if (NumFactors != 0 && (NumFactors & 1) == 0) {
+        // terminator follows a run of 0s so it is 1s
+        for (; Bit < FooterBits; Bit++) {
+            Footer[Bit >> 3] |= (BYTE)(0x80 >> (Bit & 7));
         }
     }
+
+    if (BitsUsed != nullptr) {
+        *BitsUsed = Sum;
+    }
+    return APP_SUCCESS;
 }
 
-// Function to generate all factor combinations
-std::vector<std::vector<int>> factorCombinations(int num) {
-    std::vector<std::vector<int>> result;
-    std::vector<int> current;
-    findFactors(num, 2, current, result); // start with 2 to avoid including 1 in the combinations
-    return result;
+//******************************************************************************
+//
+// DecodeUnaryFooter
+// 
+// Decode a unary footer into every BCA iteration count consistent with it
+// under the alternative footer conventions:
+//      terminator: FOOTER_TERMINATOR_LAST   last run is the terminator
+//                  FOOTER_TERMINATOR_FIRST  first run is the terminator
+//                  FOOTER_TERMINATOR_NONE   no terminator, all runs count
+//      runs:       FOOTER_RUNS_ALL          runs of 1s and 0s are factors
+//                  FOOTER_RUNS_ONES         only runs of 1s are factors
+//                  FOOTER_RUNS_ZEROS        only runs of 0s are factors
+// The iteration count is the product of the factor runs, 0 if there are none.
+// Decode[0] is the ASIS convention (last run terminator, all runs) used
+// by ReadASISmessage().
+// 
+// The footer is read once, only the first, last and product of the middle
+// runs are kept so this works for footers of any length.
+// 
+//  BYTE* Footer                footer bits, MSB first
+//  int FooterBits              # of bits in the footer
+//  FOOTERDECODE* Decode        returns FOOTER_NUM_CONVENTIONS decodes
+// 
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list at top of this source file
+//
+//*******************************************************************************
+int DecodeUnaryFooter(BYTE* Footer, int FooterBits, FOOTERDECODE* Decode)
+{
+    FOOTERDECODE Middle[3];     // product of the runs between the first and last
+    int NumRuns = 0;
+    int FirstLength = 0;
+    int FirstBit = 0;
+    int LastLength = 0;
+    int LastBit = 0;
+    int RunLength = 0;
+    int RunBit = 0;
+
+    if (Footer == nullptr || FooterBits < 1 || Decode == nullptr) {
+        return APPERR_PARAMETER;
+    }
+
+    for (int s = 0; s < 3; s++) {
+        Middle[s].NumFactors = 0;
+        Middle[s].Iterations = 1;
+        Middle[s].Overflow = FALSE;
+    }
+
+    for (int i = 0; i <= FooterBits; i++) {
+        int Bit = -1;
+        if (i < FooterBits) {
+            Bit = (Footer[i >> 3] >> (7 - (i & 7))) & 1;
+        }
+        if (RunLength != 0 && Bit == RunBit) {
+            RunLength++;
+            continue;
+        }
+        if (RunLength != 0) {
+            // run has ended
+            NumRuns++;
+            if (NumRuns == 1) {
+                FirstLength = RunLength;
+                FirstBit = RunBit;
+            }
+            else {
+                if (NumRuns > 2) {
+                    // the previous last run is a middle run
+                    AddFooterRun(&Middle[FOOTER_RUNS_ALL], LastLength);
+                    AddFooterRun(&Middle[LastBit ? FOOTER_RUNS_ONES : FOOTER_RUNS_ZEROS], LastLength);
+                }
+                LastLength = RunLength;
+                LastBit = RunBit;
+            }
+        }
+        RunBit = Bit;
+        RunLength = 1;
+    }
+
+    for (int t = 0; t < 3; t++) {
+        for (int s = 0; s < 3; s++) {
+            FOOTERDECODE* Result = &Decode[t * 3 + s];
+
+            *Result = Middle[s];
+            Result->Terminator = t;
+            Result->Runs = s;
+            if (NumRuns == 1) {
+                // only the first run, nothing in the middle
+                if (t != FOOTER_TERMINATOR_NONE) {
+                    Result->NumFactors = 0;
+                }
+                else if (s == FOOTER_RUNS_ALL || (s == FOOTER_RUNS_ONES) == (FirstBit != 0)) {
+                    AddFooterRun(Result, FirstLength);
+                }
+            }
+            else {
+                if (t != FOOTER_TERMINATOR_FIRST &&
+                    (s == FOOTER_RUNS_ALL || (s == FOOTER_RUNS_ONES) == (FirstBit != 0))) {
+                    AddFooterRun(Result, FirstLength);
+                }
+                if (t != FOOTER_TERMINATOR_LAST &&
+                    (s == FOOTER_RUNS_ALL || (s == FOOTER_RUNS_ONES) == (LastBit != 0))) {
+                    AddFooterRun(Result, LastLength);
+                }
+            }
+            if (Result->NumFactors == 0) {
+                Result->Iterations = 0;
+            }
+        }
+    }
+
+    return APP_SUCCESS;
 }
 
 
@@ -3,29 +3,120 @@
 #define BINARY_THRESHOLD 50
 #include <vector>
 
-extern int BCArunning;	// -1 running backward
-						// 0 stopped
-						// +1 runing forward
-extern int CurrentIteration; // also used to tell whether current frame is even or odd
-extern BOOL EvenStep;	// True when iteration step is even
-extern BOOL BCAimageLoaded; // TRUE is image is loaded into memory for processing
-extern BOOL StopRunning; // request to stop iterations at the end of the  current iteration
-
-extern int* TheImage;
-extern IMAGINGHEADER BCAimageHeader;
-extern int ForwardRules[16];
-extern int BackwardRules[16];
+template <typename T> class Image;
+
+// The sparse BCA engine is used when the # of set cells in the image
+// is <= image area / SPARSE_DENSITY_DIVISOR
+#define SPARSE_DENSITY_DIVISOR 16
+
+// list of set cells (particles) in an image for the sparse BCA engine
+typedef struct {
+	int* Cells;		// pixel index (y*Xsize + x) of each set cell
+	int* Scratch;	// work list used by the engine, same size as Cells
+	int NumCells;	// # of set cells in the list
+	int MaxCells;	// allocated size of Cells and Scratch
+	BOOL Valid;		// TRUE when the list matches the image
+} PARTICLELIST;
+
+// reasons a run was stopped, returned by CheckStopCondition()
+#define STOP_NONE		0
+#define STOP_BITCOUNT	1	// # of set bits crossed the limit
+#define STOP_HISTOGRAM	2	// 2x2 block histogram matched the pattern
+#define STOP_HAMMING	4	// Hamming distance to the reference image <= limit
+#define STOP_INITIAL	8	// image returned to the initial image
+
+// stop conditions for BCA runs
+// BitCount, ReferenceDistance and InitialDistance are kept updated
+// by the BCA step functions
+typedef struct {
+	BOOL BitCountEnable;	// stop on # of set bits
+	BOOL BitCountBelow;		// TRUE stop when # bits <= limit, FALSE stop when >= limit
+	int BitCountLimit;
+	BOOL HistoEnable;		// stop on 2x2 block histogram pattern
+	int HistoPattern[5];	// -1 is don't care
+	BOOL HammingEnable;		// stop on Hamming distance to Reference
+	int HammingLimit;		// stop when distance <= limit
+	BOOL InitialEnable;		// stop when image is the same as Initial
+	int Xsize;
+	int Ysize;
+	unsigned __int64* Reference;	// packed reference image, nullptr if none
+	unsigned __int64* Initial;		// packed image at start of run
+	int BitCount;			// current # of set bits
+	int ReferenceDistance;	// current Hamming distance to Reference
+	int InitialDistance;	// current Hamming distance to Initial
+} STOPCONDITION;
+
+// information tape for exact backward steps with rules that are not invertible
+// For each forward step the tape holds, for every 2x2 block whose new value
+// has more than one preimage in the forward rules, which preimage it was.
+// This is range coded with adaptive probabilities, one record per step.
+typedef struct {
+	BOOL Enabled;		// TRUE record forward steps
+	BYTE* Data;			// range coded step records, back to back
+	size_t Size;		// # of bytes used in Data
+	size_t MaxSize;		// allocated size of Data
+	size_t* StepEnd;	// end of each step record in Data
+	int NumSteps;		// # of step records on the tape
+	int MaxSteps;		// allocated size of StepEnd
+} INFOTAPE;
+
+// unary footer conventions, see DecodeUnaryFooter()
+#define FOOTER_TERMINATOR_LAST	0	// last run is the terminator (ASIS)
+#define FOOTER_TERMINATOR_FIRST	1	// first run is the terminator
+#define FOOTER_TERMINATOR_NONE	2	// no terminator run
+#define FOOTER_RUNS_ALL			0	// runs of 1s and 0s are factors (ASIS)
+#define FOOTER_RUNS_ONES		1	// only runs of 1s are factors
+#define FOOTER_RUNS_ZEROS		2	// only runs of 0s are factors
+#define FOOTER_NUM_CONVENTIONS	9	// Terminator * 3 + Runs
+
+// BCA iteration count decoded from a unary footer with one convention
+typedef struct {
+	int Terminator;			// FOOTER_TERMINATOR_...
+	int Runs;				// FOOTER_RUNS_...
+	int NumFactors;			// # of runs multiplied
+	__int64 Iterations;		// product of the runs, 0 if there are none
+	BOOL Overflow;			// TRUE product does not fit in Iterations
+} FOOTERDECODE;
+
+// The BCA simulation state (image, rules, iteration) is kept in the
+// BCAengine class, see BCAengine.h
 
 int ReadRulesFile(HWND hDlg, WCHAR* InputFile, int* Rules);
 void MargolusBCAp1p1(BOOL EvenStep, int* TheImage, int Xsize, int Ysize,
-	int* Rules, int* Histo);
-int ReadASISmessage(WCHAR* Filename, IMAGINGHEADER* ImageHeader, int** NewImage,
+	int* Rules, int* Histo, STOPCONDITION* Stop = nullptr);
+void InitParticleList(PARTICLELIST* Particles);
+void FreeParticleList(PARTICLELIST* Particles);
+int BuildParticleList(int* TheImage, int Xsize, int Ysize, PARTICLELIST* Particles);
+int MargolusBCAsparse(BOOL EvenStep, int* TheImage, int Xsize, int Ysize,
+	int* Rules, int* Histo, PARTICLELIST* Particles, STOPCONDITION* Stop = nullptr);
+void MargolusBCAauto(BOOL EvenStep, int* TheImage, int Xsize, int Ysize,
+	int* Rules, int* Histo, PARTICLELIST* Particles, STOPCONDITION* Stop = nullptr);
+void InitStopCondition(STOPCONDITION* Stop);
+void FreeStopCondition(STOPCONDITION* Stop);
+int PackPixelBits(int* Pixels, int NumPixels, BYTE* Bytes, BOOL LSBfirst);
+int UnpackPixelBits(BYTE* Bytes, int NumPixels, int* Pixels, BOOL LSBfirst);
+int PackImageBits(int* Image, int Xsize, int Ysize, unsigned __int64** Packed);
+int UnpackImageBits(unsigned __int64* Packed, int Xsize, int Ysize, Image<int>& Dest);
+int HammingDistancePacked(unsigned __int64* Image1, unsigned __int64* Image2, int NumWords);
+int StartStopCondition(STOPCONDITION* Stop, int* TheImage, int Xsize, int Ysize,
+	int* ReferenceImage);
+int CheckStopCondition(STOPCONDITION* Stop, int* Histo);
+void InitInfoTape(INFOTAPE* Tape);
+void FreeInfoTape(INFOTAPE* Tape);
+void ClearInfoTape(INFOTAPE* Tape);
+int RecordInfoTape(BOOL EvenStep, int* TheImage, int Xsize, int Ysize, int* Rules, INFOTAPE* Tape);
+int ReplayInfoTape(BOOL EvenStep, int* TheImage, int Xsize, int Ysize, int* Rules,
+	int* Histo, INFOTAPE* Tape, STOPCONDITION* Stop = nullptr);
+int ReadASISmessage(WCHAR* Filename, IMAGINGHEADER* ImageHeader, Image<int>& NewImage,
 	BYTE* Header, BYTE* Footer, int* BCAiterations, int* BitCount);
 int BitSequences(BYTE* BitList, int* BitCountList, int MaxSequence, BOOL BitOrder);
 int ConvertImage2Bitstream(int* InputImage, IMAGINGHEADER* ImageHeader, 
 	BYTE** MessageBody, int MessageLength,int* BitCount);
 void CollapseImageFrames(int* Image, IMAGINGHEADER* ImageHeader, int Threshold);
 void BinarizeImage(int* TheImage, IMAGINGHEADER* BCAimageHeader, int Threshold);
+int BinarizeImageFrames(Image<int>& TheImage, IMAGINGHEADER* ImageHeader, int Threshold);
 int CountBitInImage(int* Image, IMAGINGHEADER* ImageHeader);
-void findFactors(int num, int start, std::vector<int>& current, std::vector<std::vector<int>>& result);
-std::vector<std::vector<int>> factorCombinations(int num);
\ No newline at end of file
+int CountBitInImage(const Image<bool>& Bits);
+int UnaryFooterSequences(FILE* Out, int NumSteps, int BitString, int LastValue, int* SeqCount);
+int EncodeUnaryFooter(int Iterations, BYTE* Footer, int FooterBits, int* BitsUsed);
+int DecodeUnaryFooter(BYTE* Footer, int FooterBits, FOOTERDECODE* Decode);
\ No newline at end of file
@@ -53,6 +53,26 @@
 //                      a specific last unary value in a fixed bit string length.
 // V1.1.8   2024-12-18  Corrected errors in output file for unary calculations
 //                      Added Generic Finite State Machine dialog
+// V1.2.0   2026-10-19  BCA steps use MargolusBCAauto() which switches to the sparse particle
+//                          list engine for low density images
+//                      Added stop conditions to Margolus BCA runs (bit count, histogram pattern,
+//                          Hamming distance to a reference image, return to the initial image)
+//                      Margolus BCA dialog is now a view of the MargolusEngine BCAengine instance,
+//                          ASIS receive and send each run their own BCAengine instance
+//                      Correction, send ASIS binarized the input image using the Margolus BCA image header
+//                      Added checkpoint/restart to Margolus BCA runs
+//                      Added information tape option for exact backward steps
+//                      Unary dialog uses a sieve instead of factoring every iteration count
+//                      Send ASIS generates the footer with EncodeUnaryFooter() (1 iteration no longer fails)
+//                      Added Receive ASIS batch dialog, decodes a directory of messages
+//                      Receive ASIS batch reads capture files with any number of messages
+//                      Receive ASIS no longer converts the .bmp file to .png a second time
+//                      Errors writing snapshot .png files are reported when a run stops,
+//                          after a single step or save, Receive ASIS reports .bmp/.png errors
+//                      Margolus BCA iteration count and iteration limits are 64 bit
+//                      Images are Image<int>, the BCAengine owns the image it is given
+//                      A run stops when its snapshot can not be saved
+//                      Receive ASIS batch checks the image size and reports the batch error
 // 
 // Cellular Automata tools dialog box handlers
 // 
@@ -83,12 +103,21 @@
 #include "FileFunctions.h"
 #include "shellapi.h"
 #include "GenericFSM.h"
+#include "Image.h"
+#include "BCAengine.h"
+#include "ASISbatch.h"
 
 BOOL NewHistoFile = TRUE;
 GenericFSM* MyFSM = nullptr;
 
 void ResetTheFSM(HWND hDlg, BOOL ClearResults);
 int ProcessSequenceUsingFSM(HWND hDlg, WCHAR* Sequence, size_t MaxSeqLength);
+BOOL ReadStopSettings(HWND hDlg, STOPCONDITION* Stop);
+void ShowStopStatus(HWND hDlg, int StopReason);
+void StartRunCheckpoints(HWND hDlg);
+void ShowTapeStatus(HWND hDlg);
+BOOL GetDlgItemInt64(HWND hDlg, int nIDDlgItem, __int64* Value);
+void SetDlgItemInt64(HWND hDlg, int nIDDlgItem, __int64 Value);
 
 // Add new callback prototype declarations in my MySETIBCA.cpp
 
@@ -118,12 +147,11 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
         }
         else {
             // then try .bmp file format
-            int* InputImage;
-            if (ReadBMPfile(&InputImage, szString, &ImageHeader) == APP_SUCCESS) {
+            Image<int> InputImage;
+            if (ReadBMPfile(InputImage, szString, &ImageHeader) == APP_SUCCESS) {
                 SetDlgItemInt(hDlg, IDC_XSIZEI, ImageHeader.Xsize, TRUE);
                 SetDlgItemInt(hDlg, IDC_YSIZEI, ImageHeader.Ysize, TRUE);
                 SetDlgItemInt(hDlg, IDC_NUM_FRAMES, ImageHeader.NumFrames, TRUE);
-                delete[] InputImage;
             }
             else {
                 // unrecognized file format
@@ -170,18 +198,78 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
             CheckDlgButton(hDlg, IDC_HISTO_FILE, BST_CHECKED);
         }
 
+        // stop conditions
+        iRes = GetPrivateProfileInt(L"MargolusBCADlg", L"StopBitsEnable", 0, (LPCTSTR)strAppNameINI);
+        if (iRes != 0) {
+            CheckDlgButton(hDlg, IDC_STOP_BITS, BST_CHECKED);
+        }
+        iRes = GetPrivateProfileInt(L"MargolusBCADlg", L"StopBitsBelow", 0, (LPCTSTR)strAppNameINI);
+        if (iRes != 0) {
+            CheckRadioButton(hDlg, IDC_STOP_BITS_GE, IDC_STOP_BITS_LE, IDC_STOP_BITS_LE);
+        }
+        else {
+            CheckRadioButton(hDlg, IDC_STOP_BITS_GE, IDC_STOP_BITS_LE, IDC_STOP_BITS_GE);
+        }
+        GetPrivateProfileString(L"MargolusBCADlg", L"StopBits", L"0", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_STOP_BITS_VALUE, szString);
+
+        iRes = GetPrivateProfileInt(L"MargolusBCADlg", L"StopHistoEnable", 0, (LPCTSTR)strAppNameINI);
+        if (iRes != 0) {
+            CheckDlgButton(hDlg, IDC_STOP_HISTO, BST_CHECKED);
+        }
+        GetPrivateProfileString(L"MargolusBCADlg", L"StopHisto0", L"-1", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_STOP_HISTO0, szString);
+        GetPrivateProfileString(L"MargolusBCADlg", L"StopHisto1", L"-1", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_STOP_HISTO1, szString);
+        GetPrivateProfileString(L"MargolusBCADlg", L"StopHisto2", L"-1", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_STOP_HISTO2, szString);
+        GetPrivateProfileString(L"MargolusBCADlg", L"StopHisto3", L"-1", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_STOP_HISTO3, szString);
+        GetPrivateProfileString(L"MargolusBCADlg", L"StopHisto4", L"-1", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_STOP_HISTO4, szString);
+
+        iRes = GetPrivateProfileInt(L"MargolusBCADlg", L"StopHammingEnable", 0, (LPCTSTR)strAppNameINI);
+        if (iRes != 0) {
+            CheckDlgButton(hDlg, IDC_STOP_HAMMING, BST_CHECKED);
+        }
+        GetPrivateProfileString(L"MargolusBCADlg", L"StopHamming", L"0", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_STOP_DISTANCE, szString);
+        GetPrivateProfileString(L"MargolusBCADlg", L"StopReference", L"", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_STOP_REFERENCE, szString);
+
+        iRes = GetPrivateProfileInt(L"MargolusBCADlg", L"StopInitialEnable", 0, (LPCTSTR)strAppNameINI);
+        if (iRes != 0) {
+            CheckDlgButton(hDlg, IDC_STOP_INITIAL, BST_CHECKED);
+        }
+        SetDlgItemText(hDlg, IDC_CURRENT_DISTANCE, L"");
+
+        iRes = GetPrivateProfileInt(L"MargolusBCADlg", L"InfoTape", 0, (LPCTSTR)strAppNameINI);
+        if (iRes != 0) {
+            CheckDlgButton(hDlg, IDC_INFO_TAPE, BST_CHECKED);
+        }
+        SetDlgItemText(hDlg, IDC_TAPE_STATUS, L"");
+
+        // checkpoint/restart
+        iRes = GetPrivateProfileInt(L"MargolusBCADlg", L"CheckpointEnable", 0, (LPCTSTR)strAppNameINI);
+        if (iRes != 0) {
+            CheckDlgButton(hDlg, IDC_CHECKPOINT, BST_CHECKED);
+        }
+        GetPrivateProfileString(L"MargolusBCADlg", L"CheckpointMinutes", L"30", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_CHECKPOINT_MINUTES, szString);
+        GetPrivateProfileString(L"MargolusBCADlg", L"CheckpointFile", L"Checkpoint.bcack", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_CHECKPOINT_FILE, szString);
+        SetDlgItemText(hDlg, IDC_STOP_STATUS, L"");
+
         SetDlgItemText(hDlg, IDC_CURRENT_ITERATION, L"0");
         
-        EvenStep = TRUE;
-        if (EvenStep) {
+        MargolusEngine->ReleaseImage();
+        MargolusEngine->Reset();
+        if (MargolusEngine->GetEvenStep()) {
             CheckRadioButton(hDlg, IDC_EVEN, IDC_ODD, IDC_EVEN);
         }
         else {
             CheckRadioButton(hDlg, IDC_EVEN, IDC_ODD, IDC_ODD);
         }
-        
-        CurrentIteration = 0;
-        BCAimageLoaded = FALSE;
 
         int ResetWindows = GetPrivateProfileInt(L"GlobalSettings", L"ResetWindows", 0, (LPCTSTR)strAppNameINI);
         if (!ResetWindows) {
@@ -196,10 +284,8 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
     {
         // must destroy any brushes created
 
-        if (TheImage) {
-            delete[] TheImage;
-            TheImage = NULL;
-        }
+        MargolusEngine->StopCheckpoints();
+        MargolusEngine->ReleaseImage();
         hwndMargolusBCA = NULL;
         return (INT_PTR)TRUE;
     }
@@ -235,12 +321,11 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
             }
             else {
                 // then try .bmp file format
-                int* InputImage;
-                if (ReadBMPfile(&InputImage, szString, &ImageHeader) == APP_SUCCESS) {
+                Image<int> InputImage;
+                if (ReadBMPfile(InputImage, szString, &ImageHeader) == APP_SUCCESS) {
                     SetDlgItemInt(hDlg, IDC_XSIZEI, ImageHeader.Xsize, TRUE);
                     SetDlgItemInt(hDlg, IDC_YSIZEI, ImageHeader.Ysize, TRUE);
                     SetDlgItemInt(hDlg, IDC_NUM_FRAMES, ImageHeader.NumFrames, TRUE);
-                    delete[] InputImage;
                 }
                 else {
                     // unrecognized file format
@@ -253,6 +338,31 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
             return (INT_PTR)TRUE;
         }
 
+        case IDC_STOP_REFERENCE_BROWSE:
+        {
+            PWSTR pszFilename;
+
+            GetDlgItemText(hDlg, IDC_STOP_REFERENCE, szString, MAX_PATH);
+            COMDLG_FILTERSPEC rawType[] =
+            {
+                 { L"raw image files", L"*.raw" },
+                 { L"Bitmap files", L"*.bmp"},
+                 { L"All Files", L"*.*" },
+            };
+            if (!CCFileOpen(hDlg, szString, &pszFilename, FALSE, 3, rawType, L"*.raw")) {
+                return (INT_PTR)TRUE;
+            }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
+            }
+            SetDlgItemText(hDlg, IDC_STOP_REFERENCE, szString);
+            // reference image is loaded with the input image
+            SetDlgItemText(hDlg, IDC_STOP_STATUS, L"(Re)Load to use new reference image");
+
+            return (INT_PTR)TRUE;
+        }
+
         case IDC_TEXT_INPUT1_BROWSE:
         {
             PWSTR pszFilename;
@@ -313,10 +423,108 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
             return (INT_PTR)TRUE;
         }
 
+        case IDC_CHECKPOINT_BROWSE:
+        {
+            PWSTR pszFilename;
+            GetDlgItemText(hDlg, IDC_CHECKPOINT_FILE, szString, MAX_PATH);
+            COMDLG_FILTERSPEC ckType[] =
+            {
+                 { L"BCA checkpoint files", L"*.bcack" },
+                 { L"All Files", L"*.*" },
+            };
+            if (!CCFileSave(hDlg, szString, &pszFilename, FALSE, 2, ckType, L"*.bcack")) {
+                return (INT_PTR)TRUE;
+            }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
+            }
+            SetDlgItemText(hDlg, IDC_CHECKPOINT_FILE, szString);
+            return (INT_PTR)TRUE;
+        }
+
+        case IDC_RESUME:
+        {
+            int iRes;
+
+            if (MargolusEngine->GetRunning() != 0) {
+                return (INT_PTR)TRUE;
+            }
+
+            // Disable Layer 0 in Display dialog
+            ImageLayers->DisableLayer(0);
+
+            // this replaces the image, rules, iteration and even/odd step
+            GetDlgItemText(hDlg, IDC_CHECKPOINT_FILE, szString, MAX_PATH);
+            iRes = MargolusEngine->LoadCheckpoint(szString);
+            if (iRes != APP_SUCCESS) {
+                MessageMySETIBCAError(hDlg, iRes, L"Resume from checkpoint file");
+                return (INT_PTR)TRUE;
+            }
+            IMAGINGHEADER* ImageHeader = MargolusEngine->GetImageHeader();
+
+            MargolusEngine->SetTapeRecording(IsDlgButtonChecked(hDlg, IDC_INFO_TAPE) == BST_CHECKED);
+
+            // continue the histogram file if the checkpointed run was saving one
+            NewHistoFile = MargolusEngine->GetStatsCursor() == 0;
+
+            if (MargolusEngine->GetEvenStep()) {
+                CheckRadioButton(hDlg, IDC_EVEN, IDC_ODD, IDC_EVEN);
+            }
+            else {
+                CheckRadioButton(hDlg, IDC_EVEN, IDC_ODD, IDC_ODD);
+            }
+
+            // clear histogram
+            SetDlgItemText(hDlg, IDC_HISTO0, L"");
+            SetDlgItemText(hDlg, IDC_HISTO1, L"");
+            SetDlgItemText(hDlg, IDC_HISTO2, L"");
+            SetDlgItemText(hDlg, IDC_HISTO3, L"");
+            SetDlgItemText(hDlg, IDC_HISTO4, L"");
+
+            SetDlgItemInt(hDlg, IDC_CURRENT_BITS, MargolusEngine->GetBitCount(), TRUE);
+            SetDlgItemInt64(hDlg, IDC_CURRENT_ITERATION, MargolusEngine->GetIteration());
+            ShowTapeStatus(hDlg);
+
+            // the resumed image becomes the initial image for the stop conditions
+            iRes = MargolusEngine->StartStopCondition(nullptr);
+            if (iRes != APP_SUCCESS) {
+                MessageMySETIBCAError(hDlg, iRes, L"Setting up stop conditions");
+            }
+            ShowStopStatus(hDlg, STOP_NONE);
+
+            // update Layer 0 in display dialog
+            ImageLayers->UpdateLayer(0, szString, MargolusEngine->GetImage().GetPixels(), ImageHeader->Xsize, ImageHeader->Ysize);
+
+            // enable save button, step forward, step backward
+            HWND ItemHandle;
+
+            ItemHandle = GetDlgItem(hDlg, IDC_STEP_BACKWARD);
+            EnableWindow(ItemHandle, TRUE);
+
+            ItemHandle = GetDlgItem(hDlg, IDC_RUN_BACKWARD);
+            EnableWindow(ItemHandle, TRUE);
+
+            ItemHandle = GetDlgItem(hDlg, IDC_STEP_FORWARD);
+            EnableWindow(ItemHandle, TRUE);
+
+            ItemHandle = GetDlgItem(hDlg, IDC_RUN_FORWARD);
+            EnableWindow(ItemHandle, TRUE);
+
+            ItemHandle = GetDlgItem(hDlg, IDC_SAVE_IMAGE);
+            EnableWindow(ItemHandle, TRUE);
+
+            // update displays
+            SendMessage(hwndLayers, WM_COMMAND, ID_UPDATE, 1); // apply 
+
+            return (INT_PTR)TRUE;
+        }
+
         case IDC_EVEN:
         {
             if (IsDlgButtonChecked(hDlg, IDC_EVEN)) {
-                EvenStep = TRUE;
+                MargolusEngine->SetEvenStep(TRUE);
+                ShowTapeStatus(hDlg);
             }
             return (INT_PTR)TRUE;
         }
@@ -324,24 +532,46 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
         case IDC_ODD:
         {
              if (IsDlgButtonChecked(hDlg, IDC_ODD)) {
-                EvenStep = FALSE;
+                MargolusEngine->SetEvenStep(FALSE);
+                ShowTapeStatus(hDlg);
             }
             return (INT_PTR)TRUE;
         }
+
+        case IDC_INFO_TAPE:
+        {
+            // turning the tape off discards it
+            MargolusEngine->SetTapeRecording(IsDlgButtonChecked(hDlg, IDC_INFO_TAPE) == BST_CHECKED);
+            ShowTapeStatus(hDlg);
+            return (INT_PTR)TRUE;
+        }
         case IDC_STEP_BACKWARD:
         {
             BOOL bSuccess;
-            int BackwardLimit;
+            __int64 BackwardLimit;
             int NumberSteps;
             int Histo[5] = { 0,0,0,0,0 };
             BOOL HistoFileSave = FALSE;
             BOOL SaveStep = FALSE;
+            int StopReason = STOP_NONE;
 
-            if (!BCAimageLoaded) {
+            if (!MargolusEngine->IsImageLoaded()) {
                 // This really shouldn't ever get here but just in case
                 return (INT_PTR)TRUE;
             }
 
+            if (lParam == 0 && MargolusEngine->GetRunning() == 0) {
+                // step posted by the run timer after the run was stopped
+                return (INT_PTR)TRUE;
+            }
+
+            if (!ReadStopSettings(hDlg, MargolusEngine->GetStopCondition())) {
+                if (MargolusEngine->GetRunning() != 0) {
+                    SendMessage(hDlg, WM_COMMAND, IDC_STOP, 0);
+                }
+                return (INT_PTR)TRUE;
+            }
+
             // IDC_BACKWARD_STEPS
             NumberSteps = GetDlgItemInt(hDlg, IDC_BACKWARD_STEPS, &bSuccess, TRUE);
             if (!bSuccess) {
@@ -354,14 +584,13 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
             }
 
             // read backward limit
-            BackwardLimit = GetDlgItemInt(hDlg, IDC_BACKWARD_LIMIT, &bSuccess, TRUE);
-            if (!bSuccess) {
+            if (!GetDlgItemInt64(hDlg, IDC_BACKWARD_LIMIT, &BackwardLimit)) {
                 MessageBox(hDlg, L"Backward iteration limit not valid", L"Not a number", MB_OK);
                 return (INT_PTR)TRUE;
             }
 
             // if step at limit we are done
-            if (CurrentIteration <= BackwardLimit) {
+            if (MargolusEngine->GetIteration() <= BackwardLimit) {
                 return (INT_PTR)TRUE;
             }
 
@@ -375,39 +604,41 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
 
             for (int i = 0; i < NumberSteps; i++) {
                 // step backward on iteration
-                EvenStep = !EvenStep;
-                Histo[0] = 0;
-                Histo[1] = 0;
-                Histo[2] = 0;
-                Histo[3] = 0;
-                Histo[4] = 0;
-                MargolusBCAp1p1(EvenStep, TheImage,
-                    BCAimageHeader.Xsize, BCAimageHeader.Ysize,
-                    BackwardRules, Histo);
-                CurrentIteration--;
+                StopReason = MargolusEngine->StepBackward(Histo);
                 if (HistoFileSave) {
                     WCHAR Filename[MAX_PATH];
                     GetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, Filename, MAX_PATH);
-                    SaveHistogramData(Filename, NewHistoFile, CurrentIteration, Histo, 5);
+                    SaveHistogramData(Filename, NewHistoFile, MargolusEngine->GetIteration(), Histo, 5);
+                    MargolusEngine->CountStatsRow();
                     NewHistoFile = FALSE;
                 }
 
-                if (CurrentIteration <= BackwardLimit) break;
+                if (StopReason != STOP_NONE) break;
+                if (MargolusEngine->GetIteration() <= BackwardLimit) break;
             }
 
             if (SaveStep) {
-                SaveSnapshot(hDlg, CurrentIteration, TheImage, &BCAimageHeader);
+                if (SaveSnapshot(hDlg, MargolusEngine->GetIteration(), MargolusEngine->GetImage(),
+                        MargolusEngine->GetImageHeader()) != APP_SUCCESS && MargolusEngine->GetRunning() != 0) {
+                    // it has been reported, do not report it again for every iteration
+                    SendMessage(hDlg, WM_COMMAND, IDC_STOP, 0);
+                }
+                if (MargolusEngine->GetRunning() == 0) {
+                    // single step, a run reports them when it stops
+                    WaitSnapshotFiles(hDlg);
+                }
             }
 
             // update bit count
-            int Count = CountBitInImage(TheImage, &BCAimageHeader);
+            int Count = MargolusEngine->GetBitCount();
             SetDlgItemInt(hDlg, IDC_CURRENT_BITS, Count, TRUE);
 
             // update current iteration
-            SetDlgItemInt(hDlg, IDC_CURRENT_ITERATION, CurrentIteration, TRUE);
+            SetDlgItemInt64(hDlg, IDC_CURRENT_ITERATION, MargolusEngine->GetIteration());
+            ShowTapeStatus(hDlg);
             
             // update step radio buttons
-            if (EvenStep) {
+            if (MargolusEngine->GetEvenStep()) {
                 CheckRadioButton(hDlg, IDC_EVEN, IDC_ODD, IDC_EVEN);
             }
             else {
@@ -420,6 +651,12 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
             SetDlgItemInt(hDlg, IDC_HISTO3, Histo[3], TRUE);
             SetDlgItemInt(hDlg, IDC_HISTO4, Histo[4], TRUE);
 
+            // stop the run at this iteration if a stop condition was met
+            ShowStopStatus(hDlg, StopReason);
+            if (StopReason != STOP_NONE && MargolusEngine->GetRunning() != 0) {
+                SendMessage(hDlg, WM_COMMAND, IDC_STOP, 0);
+            }
+
             // update displays
             SendMessage(hwndLayers, WM_COMMAND, ID_UPDATE, 1); // apply 
 
@@ -430,16 +667,29 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
         {
             BOOL bSuccess;
             int NumberSteps;
-            int ForwardLimit;
+            __int64 ForwardLimit;
             int Histo[5] = { 0,0,0,0,0 };
             BOOL HistoFileSave = FALSE;
             BOOL SaveStep = FALSE;
+            int StopReason = STOP_NONE;
 
-            if (!BCAimageLoaded) {
+            if (!MargolusEngine->IsImageLoaded()) {
                 // This really shouldn't ever get here but just in case
                 return (INT_PTR)TRUE;
             }
 
+            if (lParam == 0 && MargolusEngine->GetRunning() == 0) {
+                // step posted by the run timer after the run was stopped
+                return (INT_PTR)TRUE;
+            }
+
+            if (!ReadStopSettings(hDlg, MargolusEngine->GetStopCondition())) {
+                if (MargolusEngine->GetRunning() != 0) {
+                    SendMessage(hDlg, WM_COMMAND, IDC_STOP, 0);
+                }
+                return (INT_PTR)TRUE;
+            }
+
             // IDC_FORWARD_STEPS
             NumberSteps = GetDlgItemInt(hDlg, IDC_FORWARD_STEPS, &bSuccess, TRUE);
             if (!bSuccess) {
@@ -452,14 +702,13 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
             }
 
             // read forward limit
-            ForwardLimit = GetDlgItemInt(hDlg, IDC_FORWARD_LIMIT, &bSuccess, TRUE);
-            if (!bSuccess) {
+            if (!GetDlgItemInt64(hDlg, IDC_FORWARD_LIMIT, &ForwardLimit)) {
                 MessageBox(hDlg, L"Forward iteration limit not valid", L"Not a number", MB_OK);
                 return (INT_PTR)TRUE;
             }
 
             // if step at limit we are done
-            if (CurrentIteration >= ForwardLimit) {
+            if (MargolusEngine->GetIteration() >= ForwardLimit) {
                 return (INT_PTR)TRUE;
             }
 
@@ -472,41 +721,42 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
             }
 
             for (int i = 0; i < NumberSteps; i++) {
-                Histo[0] = 0;
-                Histo[1] = 0;
-                Histo[2] = 0;
-                Histo[3] = 0;
-                Histo[4] = 0;
-
                 // step forward on iteration
-                MargolusBCAp1p1(EvenStep, TheImage,
-                    BCAimageHeader.Xsize, BCAimageHeader.Ysize,
-                    ForwardRules, Histo);
+                StopReason = MargolusEngine->StepForward(Histo);
 
-                CurrentIteration++;
                 if (HistoFileSave) {
                     WCHAR Filename[MAX_PATH];
                     GetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, Filename, MAX_PATH);
-                    SaveHistogramData(Filename, NewHistoFile, CurrentIteration, Histo, 5);
+                    SaveHistogramData(Filename, NewHistoFile, MargolusEngine->GetIteration(), Histo, 5);
+                    MargolusEngine->CountStatsRow();
                     NewHistoFile = FALSE;
                 }
 
-                EvenStep = !EvenStep;
-                if (CurrentIteration >= ForwardLimit) break;
+                if (StopReason != STOP_NONE) break;
+                if (MargolusEngine->GetIteration() >= ForwardLimit) break;
             }
 
             if (SaveStep) {
-                SaveSnapshot(hDlg, CurrentIteration, TheImage, &BCAimageHeader);
+                if (SaveSnapshot(hDlg, MargolusEngine->GetIteration(), MargolusEngine->GetImage(),
+                        MargolusEngine->GetImageHeader()) != APP_SUCCESS && MargolusEngine->GetRunning() != 0) {
+                    // it has been reported, do not report it again for every iteration
+                    SendMessage(hDlg, WM_COMMAND, IDC_STOP, 0);
+                }
+                if (MargolusEngine->GetRunning() == 0) {
+                    // single step, a run reports them when it stops
+                    WaitSnapshotFiles(hDlg);
+                }
             }
 
             // update bit count
-            int Count = CountBitInImage(TheImage, &BCAimageHeader);
+            int Count = MargolusEngine->GetBitCount();
             SetDlgItemInt(hDlg, IDC_CURRENT_BITS, Count, TRUE);
 
             // update current iteration
-            SetDlgItemInt(hDlg, IDC_CURRENT_ITERATION, CurrentIteration, TRUE);
+            SetDlgItemInt64(hDlg, IDC_CURRENT_ITERATION, MargolusEngine->GetIteration());
+            ShowTapeStatus(hDlg);
             
-            if (EvenStep) {
+            if (MargolusEngine->GetEvenStep()) {
                 CheckRadioButton(hDlg, IDC_EVEN, IDC_ODD, IDC_EVEN);
             }
             else {
@@ -520,6 +770,12 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
             SetDlgItemInt(hDlg, IDC_HISTO3, Histo[3], TRUE);
             SetDlgItemInt(hDlg, IDC_HISTO4, Histo[4], TRUE);
 
+            // stop the run at this iteration if a stop condition was met
+            ShowStopStatus(hDlg, StopReason);
+            if (StopReason != STOP_NONE && MargolusEngine->GetRunning() != 0) {
+                SendMessage(hDlg, WM_COMMAND, IDC_STOP, 0);
+            }
+
             // update displays
             SendMessage(hwndLayers, WM_COMMAND, ID_UPDATE, 1); // apply 
 
@@ -529,20 +785,20 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
         case IDC_RUN_FORWARD:
         {
             BOOL bSuccess;
-            int ForwardLimit;
+            __int64 ForwardLimit;
             int FPArun;
 
-            if (!BCAimageLoaded) {
+            if (!MargolusEngine->IsImageLoaded()) {
                 // This really shouldn't ever get here but just in case
                 return (INT_PTR)TRUE;
             }
 
-            if (BCArunning == 1) {
+            if (MargolusEngine->GetRunning() == 1) {
                 return (INT_PTR)TRUE;
             }
-            else if (BCArunning == -1) {
+            else if (MargolusEngine->GetRunning() == -1) {
                 // timer code does the rest
-                BCArunning = 1;
+                MargolusEngine->SetRunning(1);
                 return (INT_PTR)TRUE;
             }
 
@@ -558,17 +814,16 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
             }
 
             // read forward limit
-            ForwardLimit = GetDlgItemInt(hDlg, IDC_FORWARD_LIMIT, &bSuccess, TRUE);
-            if (!bSuccess) {
+            if (!GetDlgItemInt64(hDlg, IDC_FORWARD_LIMIT, &ForwardLimit)) {
                 MessageBox(hDlg, L"Forward iteration limit not valid", L"Not a number", MB_OK);
                 return (INT_PTR)TRUE;
             }
 
-            if (CurrentIteration >= ForwardLimit) {
+            if (MargolusEngine->GetIteration() >= ForwardLimit) {
                 return (INT_PTR)TRUE;
             }
 
-            BCArunning = 1;
+            MargolusEngine->SetRunning(1);
             
             HWND ItemHandle = GetDlgItem(hDlg, IDC_STOP);
             EnableWindow(ItemHandle, TRUE);
@@ -596,26 +851,28 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
 
             SetTimer(hwndMain, IDT_BCA_RUN_TIMER, Ticks, (TIMERPROC)NULL);
 
+            StartRunCheckpoints(hDlg);
+
             return (INT_PTR)TRUE;
         }
 
         case IDC_RUN_BACKWARD:
         {
             BOOL bSuccess;
-            int BackwardLimit;
+            __int64 BackwardLimit;
             int FPArun;
 
-            if (!BCAimageLoaded) {
+            if (!MargolusEngine->IsImageLoaded()) {
                 // This really shouldn't ever get here but just in case
                 return (INT_PTR)TRUE;
             }
 
-            if (BCArunning == -1) {
+            if (MargolusEngine->GetRunning() == -1) {
                 return (INT_PTR)TRUE;
             }
-            else if (BCArunning == 1) {
+            else if (MargolusEngine->GetRunning() == 1) {
                 // timer code does the rest
-                BCArunning = -1;
+                MargolusEngine->SetRunning(-1);
                 return (INT_PTR)TRUE;
             }
 
@@ -631,17 +888,16 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
             }
 
             // read forward limit
-            BackwardLimit = GetDlgItemInt(hDlg, IDC_BACKWARD_LIMIT, &bSuccess, TRUE);
-            if (!bSuccess) {
+            if (!GetDlgItemInt64(hDlg, IDC_BACKWARD_LIMIT, &BackwardLimit)) {
                 MessageBox(hDlg, L"Forward iteration limit not valid", L"Not a number", MB_OK);
                 return (INT_PTR)TRUE;
             }
 
-            if (CurrentIteration <= BackwardLimit) {
+            if (MargolusEngine->GetIteration() <= BackwardLimit) {
                 return (INT_PTR)TRUE;
             }
 
-            BCArunning = -1;
+            MargolusEngine->SetRunning(-1);
 
             HWND ItemHandle = GetDlgItem(hDlg, IDC_STOP);
             EnableWindow(ItemHandle, TRUE);
@@ -669,6 +925,8 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
 
             SetTimer(hwndMain, IDT_BCA_RUN_TIMER, Ticks, (TIMERPROC)NULL);
 
+            StartRunCheckpoints(hDlg);
+
             return (INT_PTR)TRUE;
         }
 
@@ -676,12 +934,10 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
         {
             int iRes;
             WCHAR InputFile[MAX_PATH];
+            int Forward[16];
+            int Backward[16];
 
-            if(BCAimageLoaded) {
-                delete[] TheImage;
-                TheImage = nullptr;
-                BCAimageLoaded = FALSE;
-            }
+            MargolusEngine->ReleaseImage();
 
             // Disable Layer 0 in Display dialog
             ImageLayers->DisableLayer(0);
@@ -689,7 +945,7 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
 
             // read forward rules file
             GetDlgItemText(hDlg, IDC_TEXT_INPUT1, InputFile, MAX_PATH);
-            iRes = ReadRulesFile(hDlg, InputFile, ForwardRules);
+            iRes = ReadRulesFile(hDlg, InputFile, Forward);
             if (iRes != APP_SUCCESS) {
                 if (iRes == APPERR_PARAMETER) {
                     MessageMySETIBCAError(hDlg, iRes, L"Rules are not 0-15");
@@ -702,7 +958,7 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
 
             // read backward rules file
             GetDlgItemText(hDlg, IDC_TEXT_INPUT2, InputFile, MAX_PATH);
-            iRes = ReadRulesFile(hDlg, InputFile, BackwardRules);
+            iRes = ReadRulesFile(hDlg, InputFile, Backward);
             if (iRes != APP_SUCCESS) {
                 if (iRes == APPERR_PARAMETER) {
                     MessageMySETIBCAError(hDlg, iRes, L"Rules are not 0-15");
@@ -712,9 +968,8 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
                 }
                 return (INT_PTR)TRUE;
             }
+            MargolusEngine->SetRules(Forward, Backward);
 
-            CurrentIteration = 0;
-            EvenStep = TRUE;
             CheckRadioButton(hDlg, IDC_EVEN, IDC_ODD, IDC_EVEN);
 
             GetDlgItemText(hDlg, IDC_IMAGE_INPUT, InputFile, MAX_PATH);
@@ -729,32 +984,20 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
                 return (INT_PTR)TRUE;
             }
 
-            iRes = LoadImageFile(&TheImage, InputFile, &BCAimageHeader);
-            if (iRes != APP_SUCCESS) {
-                // then try .bmp format
-                iRes = ReadBMPfile(&TheImage, InputFile, &BCAimageHeader);
-                if (iRes != APP_SUCCESS) {
-                    MessageBox(hDlg, L"Input image file is not valid", L"File read error", MB_OK);
-                    return (INT_PTR)TRUE;
-                }
-            }
-
-            // the image must be even in xsize and ysize
-            if (((BCAimageHeader.Xsize % 2)!=0) || ((BCAimageHeader.Ysize % 2)!=0)) {
-                delete[] TheImage;
-                TheImage = nullptr;
+            // this resets the iteration to 0 and the next step to even
+            iRes = MargolusEngine->LoadImage(InputFile, UseThisThreshold);
+            MargolusEngine->SetTapeRecording(IsDlgButtonChecked(hDlg, IDC_INFO_TAPE) == BST_CHECKED);
+            if (iRes == APPERR_PARAMETER) {
+                // the image must be even in xsize and ysize
                 MessageBox(hDlg, L"Image not loaded, x,y sizes must be even", L"File size error", MB_OK);
                 return (INT_PTR)TRUE;
             }
-
-            // check if this is 3 frame image (3 frame raw files are used as color images)
-            // If it is convert the 3 frames into the first frame as a binary 0 or 255
-            if (BCAimageHeader.NumFrames == 3) {
-                CollapseImageFrames(TheImage, &BCAimageHeader, UseThisThreshold);
-            }
-            else {
-                BinarizeImage(TheImage, &BCAimageHeader, UseThisThreshold);
+            if (iRes != APP_SUCCESS) {
+                MessageBox(hDlg, L"Input image file is not valid", L"File read error", MB_OK);
+                return (INT_PTR)TRUE;
             }
+            IMAGINGHEADER* ImageHeader = MargolusEngine->GetImageHeader();
+
             // clear histogram
             SetDlgItemText(hDlg, IDC_HISTO0, L"");
             SetDlgItemText(hDlg, IDC_HISTO1, L"");
@@ -763,11 +1006,49 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
             SetDlgItemText(hDlg, IDC_HISTO4, L"");
 
             // update bit count
-            int Count = CountBitInImage(TheImage, &BCAimageHeader);
+            int Count = MargolusEngine->GetBitCount();
             SetDlgItemInt(hDlg, IDC_CURRENT_BITS, Count, TRUE);
 
+            // set up the stop conditions for this image
+            // the reference image is optional, it must be the same size as the input image
+            {
+                WCHAR ReferenceFile[MAX_PATH];
+                Image<int> ReferenceImage;
+
+                GetDlgItemText(hDlg, IDC_STOP_REFERENCE, ReferenceFile, MAX_PATH);
+                if (wcslen(ReferenceFile) != 0) {
+                    IMAGINGHEADER ReferenceHeader;
+
+                    iRes = LoadImageFile(ReferenceImage, ReferenceFile, &ReferenceHeader);
+                    if (iRes != APP_SUCCESS) {
+                        // then try .bmp format
+                        iRes = ReadBMPfile(ReferenceImage, ReferenceFile, &ReferenceHeader);
+                    }
+                    if (iRes != APP_SUCCESS) {
+                        MessageBox(hDlg, L"Reference image file is not valid\nHamming distance stop condition not available",
+                            L"File read error", MB_OK);
+                    }
+                    else if (ReferenceHeader.Xsize != ImageHeader->Xsize ||
+                        ReferenceHeader.Ysize != ImageHeader->Ysize) {
+                        ReferenceImage.Release();
+                        MessageBox(hDlg, L"Reference image size does not match input image\nHamming distance stop condition not available",
+                            L"File size error", MB_OK);
+                    }
+                    else if (BinarizeImageFrames(ReferenceImage, &ReferenceHeader, UseThisThreshold) != APP_SUCCESS) {
+                        ReferenceImage.Release();
+                    }
+                }
+
+                // the reference image is only needed to set up the stop conditions
+                iRes = MargolusEngine->StartStopCondition(ReferenceImage.IsEmpty() ? nullptr : ReferenceImage.GetPixels());
+                if (iRes != APP_SUCCESS) {
+                    MessageMySETIBCAError(hDlg, iRes, L"Setting up stop conditions");
+                }
+                ShowStopStatus(hDlg, STOP_NONE);
+            }
+
             // update Layer 0 in display dialog
-            ImageLayers->UpdateLayer(0, InputFile, TheImage, BCAimageHeader.Xsize, BCAimageHeader.Ysize);
+            ImageLayers->UpdateLayer(0, InputFile, MargolusEngine->GetImage().GetPixels(), ImageHeader->Xsize, ImageHeader->Ysize);
 
             // enable save button, step forward, step backward
             HWND ItemHandle;
@@ -787,8 +1068,8 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
             ItemHandle = GetDlgItem(hDlg, IDC_SAVE_IMAGE);
             EnableWindow(ItemHandle, TRUE);
 
-            SetDlgItemInt(hDlg, IDC_CURRENT_ITERATION, CurrentIteration, TRUE);
-            BCAimageLoaded = TRUE;
+            SetDlgItemInt64(hDlg, IDC_CURRENT_ITERATION, MargolusEngine->GetIteration());
+            ShowTapeStatus(hDlg);
 
             // update displays
             SendMessage(hwndLayers, WM_COMMAND, ID_UPDATE, 1); // apply 
@@ -798,9 +1079,10 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
 
         case IDC_SAVE_IMAGE:
         {
-            if (BCAimageLoaded) {
+            if (MargolusEngine->IsImageLoaded()) {
                 // save current image using output name + iteration number
-                SaveSnapshot(hDlg, CurrentIteration, TheImage, &BCAimageHeader);
+                SaveSnapshot(hDlg, MargolusEngine->GetIteration(), MargolusEngine->GetImage(), MargolusEngine->GetImageHeader());
+                WaitSnapshotFiles(hDlg);
             }
             return (INT_PTR)TRUE;
         }
@@ -829,9 +1111,27 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
             EnableWindow(ItemHandle, TRUE);
 
             KillTimer(hwndMain, IDT_BCA_RUN_TIMER);
-            BCArunning = 0;
+            MargolusEngine->SetRunning(0);
+
+            // end of run, save a final checkpoint
+            if (IsDlgButtonChecked(hDlg, IDC_CHECKPOINT) == BST_CHECKED) {
+                int iRes;
+
+                MargolusEngine->StopCheckpoints();
+                iRes = MargolusEngine->GetCheckpointStatus();
+                if (iRes == APP_SUCCESS) {
+                    GetDlgItemText(hDlg, IDC_CHECKPOINT_FILE, szString, MAX_PATH);
+                    iRes = MargolusEngine->SaveCheckpoint(szString);
+                }
+                if (iRes != APP_SUCCESS) {
+                    MessageMySETIBCAError(hDlg, iRes, L"Saving checkpoint file");
+                }
+            }
 
-            if (EvenStep) {
+            // end of run, report errors writing the snapshot .png files
+            WaitSnapshotFiles(hDlg);
+
+            if (MargolusEngine->GetEvenStep()) {
                 CheckRadioButton(hDlg, IDC_EVEN, IDC_ODD, IDC_EVEN);
             }
             else {
@@ -887,6 +1187,75 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
                 WritePrivateProfileString(L"MargolusBCADlg", L"HistoFileSave", L"0", (LPCTSTR)strAppNameINI);
             }
 
+            // stop conditions
+            if (IsDlgButtonChecked(hDlg, IDC_STOP_BITS) == BST_CHECKED) {
+                WritePrivateProfileString(L"MargolusBCADlg", L"StopBitsEnable", L"1", (LPCTSTR)strAppNameINI);
+            }
+            else {
+                WritePrivateProfileString(L"MargolusBCADlg", L"StopBitsEnable", L"0", (LPCTSTR)strAppNameINI);
+            }
+            if (IsDlgButtonChecked(hDlg, IDC_STOP_BITS_LE) == BST_CHECKED) {
+                WritePrivateProfileString(L"MargolusBCADlg", L"StopBitsBelow", L"1", (LPCTSTR)strAppNameINI);
+            }
+            else {
+                WritePrivateProfileString(L"MargolusBCADlg", L"StopBitsBelow", L"0", (LPCTSTR)strAppNameINI);
+            }
+            GetDlgItemText(hDlg, IDC_STOP_BITS_VALUE, szString, MAX_PATH);
+            WritePrivateProfileString(L"MargolusBCADlg", L"StopBits", szString, (LPCTSTR)strAppNameINI);
+
+            if (IsDlgButtonChecked(hDlg, IDC_STOP_HISTO) == BST_CHECKED) {
+                WritePrivateProfileString(L"MargolusBCADlg", L"StopHistoEnable", L"1", (LPCTSTR)strAppNameINI);
+            }
+            else {
+                WritePrivateProfileString(L"MargolusBCADlg", L"StopHistoEnable", L"0", (LPCTSTR)strAppNameINI);
+            }
+            GetDlgItemText(hDlg, IDC_STOP_HISTO0, szString, MAX_PATH);
+            WritePrivateProfileString(L"MargolusBCADlg", L"StopHisto0", szString, (LPCTSTR)strAppNameINI);
+            GetDlgItemText(hDlg, IDC_STOP_HISTO1, szString, MAX_PATH);
+            WritePrivateProfileString(L"MargolusBCADlg", L"StopHisto1", szString, (LPCTSTR)strAppNameINI);
+            GetDlgItemText(hDlg, IDC_STOP_HISTO2, szString, MAX_PATH);
+            WritePrivateProfileString(L"MargolusBCADlg", L"StopHisto2", szString, (LPCTSTR)strAppNameINI);
+            GetDlgItemText(hDlg, IDC_STOP_HISTO3, szString, MAX_PATH);
+            WritePrivateProfileString(L"MargolusBCADlg", L"StopHisto3", szString, (LPCTSTR)strAppNameINI);
+            GetDlgItemText(hDlg, IDC_STOP_HISTO4, szString, MAX_PATH);
+            WritePrivateProfileString(L"MargolusBCADlg", L"StopHisto4", szString, (LPCTSTR)strAppNameINI);
+
+            if (IsDlgButtonChecked(hDlg, IDC_STOP_HAMMING) == BST_CHECKED) {
+                WritePrivateProfileString(L"MargolusBCADlg", L"StopHammingEnable", L"1", (LPCTSTR)strAppNameINI);
+            }
+            else {
+                WritePrivateProfileString(L"MargolusBCADlg", L"StopHammingEnable", L"0", (LPCTSTR)strAppNameINI);
+            }
+            GetDlgItemText(hDlg, IDC_STOP_DISTANCE, szString, MAX_PATH);
+            WritePrivateProfileString(L"MargolusBCADlg", L"StopHamming", szString, (LPCTSTR)strAppNameINI);
+            GetDlgItemText(hDlg, IDC_STOP_REFERENCE, szString, MAX_PATH);
+            WritePrivateProfileString(L"MargolusBCADlg", L"StopReference", szString, (LPCTSTR)strAppNameINI);
+
+            if (IsDlgButtonChecked(hDlg, IDC_STOP_INITIAL) == BST_CHECKED) {
+                WritePrivateProfileString(L"MargolusBCADlg", L"StopInitialEnable", L"1", (LPCTSTR)strAppNameINI);
+            }
+            else {
+                WritePrivateProfileString(L"MargolusBCADlg", L"StopInitialEnable", L"0", (LPCTSTR)strAppNameINI);
+            }
+
+            if (IsDlgButtonChecked(hDlg, IDC_INFO_TAPE) == BST_CHECKED) {
+                WritePrivateProfileString(L"MargolusBCADlg", L"InfoTape", L"1", (LPCTSTR)strAppNameINI);
+            }
+            else {
+                WritePrivateProfileString(L"MargolusBCADlg", L"InfoTape", L"0", (LPCTSTR)strAppNameINI);
+            }
+
+            if (IsDlgButtonChecked(hDlg, IDC_CHECKPOINT) == BST_CHECKED) {
+                WritePrivateProfileString(L"MargolusBCADlg", L"CheckpointEnable", L"1", (LPCTSTR)strAppNameINI);
+            }
+            else {
+                WritePrivateProfileString(L"MargolusBCADlg", L"CheckpointEnable", L"0", (LPCTSTR)strAppNameINI);
+            }
+            GetDlgItemText(hDlg, IDC_CHECKPOINT_MINUTES, szString, MAX_PATH);
+            WritePrivateProfileString(L"MargolusBCADlg", L"CheckpointMinutes", szString, (LPCTSTR)strAppNameINI);
+            GetDlgItemText(hDlg, IDC_CHECKPOINT_FILE, szString, MAX_PATH);
+            WritePrivateProfileString(L"MargolusBCADlg", L"CheckpointFile", szString, (LPCTSTR)strAppNameINI);
+
             CheckDlgButton(hDlg, IDC_SAVE_STEP, BST_UNCHECKED);
 
             {
@@ -911,6 +1280,229 @@ INT_PTR CALLBACK MargolusBCADlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
     return (INT_PTR)FALSE;
 }
 
+//*******************************************************************************
+//
+// ReadStopSettings
+// 
+// Read the stop condition enables and limits from the Margolus BCA dialog.
+// The packed reference and initial images are set up when the image is (re)loaded.
+// 
+// Parameters:
+//  HWND hDlg                   Handle of Margolus BCA dialog
+//  STOPCONDITION* Stop         stop conditions to update
+// 
+// return value:
+//  TRUE - settings are valid
+//  FALSE - a setting is not valid, user has been told which one
+// 
+//*******************************************************************************
+BOOL ReadStopSettings(HWND hDlg, STOPCONDITION* Stop)
+{
+    BOOL bSuccess;
+    int HistoControls[5] = { IDC_STOP_HISTO0, IDC_STOP_HISTO1, IDC_STOP_HISTO2,
+        IDC_STOP_HISTO3, IDC_STOP_HISTO4 };
+
+    Stop->BitCountEnable = FALSE;
+    Stop->HistoEnable = FALSE;
+    Stop->HammingEnable = FALSE;
+    Stop->InitialEnable = FALSE;
+
+    if (IsDlgButtonChecked(hDlg, IDC_STOP_BITS) == BST_CHECKED) {
+        Stop->BitCountLimit = GetDlgItemInt(hDlg, IDC_STOP_BITS_VALUE, &bSuccess, TRUE);
+        if (!bSuccess || Stop->BitCountLimit < 0) {
+            MessageBox(hDlg, L"Stop # of bits not valid", L"Not a number", MB_OK);
+            return FALSE;
+        }
+        if (IsDlgButtonChecked(hDlg, IDC_STOP_BITS_LE) == BST_CHECKED) {
+            Stop->BitCountBelow = TRUE;
+        }
+        else {
+            Stop->BitCountBelow = FALSE;
+        }
+        Stop->BitCountEnable = TRUE;
+    }
+
+    if (IsDlgButtonChecked(hDlg, IDC_STOP_HISTO) == BST_CHECKED) {
+        for (int i = 0; i < 5; i++) {
+            Stop->HistoPattern[i] = GetDlgItemInt(hDlg, HistoControls[i], &bSuccess, TRUE);
+            if (!bSuccess || Stop->HistoPattern[i] < -1) {
+                MessageBox(hDlg, L"Stop histogram pattern not valid\nuse -1 for any value", L"Not a number", MB_OK);
+                return FALSE;
+            }
+        }
+        Stop->HistoEnable = TRUE;
+    }
+
+    if (IsDlgButtonChecked(hDlg, IDC_STOP_HAMMING) == BST_CHECKED) {
+        Stop->HammingLimit = GetDlgItemInt(hDlg, IDC_STOP_DISTANCE, &bSuccess, TRUE);
+        if (!bSuccess || Stop->HammingLimit < 0) {
+            MessageBox(hDlg, L"Stop Hamming distance not valid", L"Not a number", MB_OK);
+            return FALSE;
+        }
+        if (Stop->Reference == nullptr) {
+            MessageBox(hDlg, L"No reference image loaded\nSelect the reference image and (Re)Load",
+                L"Hamming distance stop", MB_OK);
+            return FALSE;
+        }
+        Stop->HammingEnable = TRUE;
+    }
+
+    if (IsDlgButtonChecked(hDlg, IDC_STOP_INITIAL) == BST_CHECKED) {
+        Stop->InitialEnable = TRUE;
+    }
+
+    return TRUE;
+}
+
+//*******************************************************************************
+//
+// ShowStopStatus
+// 
+// Update the Hamming distance and stop reason in the Margolus BCA dialog
+// 
+// Parameters:
+//  HWND hDlg                   Handle of Margolus BCA dialog
+//  int StopReason              STOP_xxx flags from CheckStopCondition()
+// 
+//*******************************************************************************
+void ShowStopStatus(HWND hDlg, int StopReason)
+{
+    WCHAR szString[MAX_PATH];
+    STOPCONDITION* Stop = MargolusEngine->GetStopCondition();
+
+    if (Stop->Reference != nullptr) {
+        SetDlgItemInt(hDlg, IDC_CURRENT_DISTANCE, Stop->ReferenceDistance, TRUE);
+    }
+    else {
+        SetDlgItemText(hDlg, IDC_CURRENT_DISTANCE, L"");
+    }
+
+    if (StopReason == STOP_NONE) {
+        SetDlgItemText(hDlg, IDC_STOP_STATUS, L"");
+        return;
+    }
+
+    swprintf_s(szString, MAX_PATH, L"Stopped at iteration %lld:%s%s%s%s", MargolusEngine->GetIteration(),
+        (StopReason & STOP_BITCOUNT) ? L" # of bits" : L"",
+        (StopReason & STOP_HISTOGRAM) ? L" histogram" : L"",
+        (StopReason & STOP_HAMMING) ? L" Hamming distance" : L"",
+        (StopReason & STOP_INITIAL) ? L" initial image" : L"");
+    SetDlgItemText(hDlg, IDC_STOP_STATUS, szString);
+    return;
+}
+
+//*******************************************************************************
+//
+// ShowTapeStatus
+// 
+// Update the information tape size in the Margolus BCA dialog
+// 
+// Parameters:
+//  HWND hDlg                   Handle of Margolus BCA dialog
+// 
+//*******************************************************************************
+void ShowTapeStatus(HWND hDlg)
+{
+    WCHAR szString[MAX_PATH];
+
+    if (!MargolusEngine->GetTapeRecording()) {
+        SetDlgItemText(hDlg, IDC_TAPE_STATUS, L"");
+        return;
+    }
+
+    swprintf_s(szString, MAX_PATH, L"Tape: %d exact backward steps, %zu bytes",
+        MargolusEngine->GetTapeSteps(), MargolusEngine->GetTapeBytes());
+    SetDlgItemText(hDlg, IDC_TAPE_STATUS, szString);
+    return;
+}
+
+//*******************************************************************************
+//
+// GetDlgItemInt64
+// 
+// Read a 64 bit signed integer from a dialog control,
+// GetDlgItemInt() is limited to 32 bits.
+// 
+// Parameters:
+//  HWND hDlg                   Handle of dialog
+//  int nIDDlgItem              control ID
+//  __int64* Value              returns value
+// 
+// return value:
+//  TRUE - Value is valid
+//  FALSE - control text is not a number
+// 
+//*******************************************************************************
+BOOL GetDlgItemInt64(HWND hDlg, int nIDDlgItem, __int64* Value)
+{
+    WCHAR szString[MAX_PATH];
+    WCHAR Extra;
+
+    GetDlgItemText(hDlg, nIDDlgItem, szString, MAX_PATH);
+    // anything after the number makes it invalid
+    if (swscanf_s(szString, L"%lld %c", Value, &Extra, 1) != 1) {
+        return FALSE;
+    }
+    return TRUE;
+}
+
+//*******************************************************************************
+//
+// SetDlgItemInt64
+// 
+// Set a dialog control to a 64 bit signed integer
+// 
+// Parameters:
+//  HWND hDlg                   Handle of dialog
+//  int nIDDlgItem              control ID
+//  __int64 Value               value to display
+// 
+//*******************************************************************************
+void SetDlgItemInt64(HWND hDlg, int nIDDlgItem, __int64 Value)
+{
+    WCHAR szString[MAX_PATH];
+
+    swprintf_s(szString, MAX_PATH, L"%lld", Value);
+    SetDlgItemText(hDlg, nIDDlgItem, szString);
+    return;
+}
+
+//*******************************************************************************
+//
+// StartRunCheckpoints
+// 
+// Start the background checkpoint writer for a Margolus BCA run
+// if checkpoints are enabled in the dialog
+// 
+// Parameters:
+//  HWND hDlg                   Handle of Margolus BCA dialog
+// 
+//*******************************************************************************
+void StartRunCheckpoints(HWND hDlg)
+{
+    WCHAR szString[MAX_PATH];
+    BOOL bSuccess;
+    int Minutes;
+    int iRes;
+
+    if (IsDlgButtonChecked(hDlg, IDC_CHECKPOINT) != BST_CHECKED) {
+        return;
+    }
+
+    Minutes = GetDlgItemInt(hDlg, IDC_CHECKPOINT_MINUTES, &bSuccess, TRUE);
+    if (!bSuccess || Minutes <= 0) {
+        MessageBox(hDlg, L"Checkpoint minutes must be > 0\nrun is not being checkpointed", L"Bad Number", MB_OK);
+        return;
+    }
+
+    GetDlgItemText(hDlg, IDC_CHECKPOINT_FILE, szString, MAX_PATH);
+    iRes = MargolusEngine->StartCheckpoints(szString, Minutes);
+    if (iRes != APP_SUCCESS) {
+        MessageMySETIBCAError(hDlg, iRes, L"Starting checkpoints, run is not being checkpointed");
+    }
+    return;
+}
+
 //*******************************************************************************
 //
 // Message handler for ReceiveASISdlg dialog box.
@@ -927,7 +1519,7 @@ INT_PTR CALLBACK ReceiveASISdlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
     {
         IMAGINGHEADER ImageHeader;
         int BCAiterations = 0;
-        int* InputImage;
+        Image<int> InputImage;
         BYTE Header[10];
         BYTE Footer[10];
 
@@ -938,12 +1530,11 @@ INT_PTR CALLBACK ReceiveASISdlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
         int iRes;
         int BitCount;
         int Iterations;
-        iRes = ReadASISmessage(szString, &ImageHeader, &InputImage, Header, Footer, &Iterations, &BitCount);
+        iRes = ReadASISmessage(szString, &ImageHeader, InputImage, Header, Footer, &Iterations, &BitCount);
         if (iRes == APP_SUCCESS) {
             //IDC_NUM_BCA_STEPS
             SetDlgItemInt(hDlg, IDC_NUM_BCA_STEPS, Iterations, TRUE);
             SetDlgItemInt(hDlg, IDC_NUM_BITS, BitCount, TRUE);
-            delete[] InputImage;
         }
         else {
             SetDlgItemInt(hDlg, IDC_NUM_BCA_STEPS, 0, TRUE);
@@ -997,19 +1588,18 @@ INT_PTR CALLBACK ReceiveASISdlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
             int iRes;
             IMAGINGHEADER ImageHeader;
             int BCAiterations = 0;
-            int* InputImage;
+            Image<int> InputImage;
             BYTE Header[10];
             BYTE Footer[10];
             int IterationsNeeded;
             int BitCount;
 
-            iRes = ReadASISmessage(szString, &ImageHeader, &InputImage, Header, Footer,
+            iRes = ReadASISmessage(szString, &ImageHeader, InputImage, Header, Footer,
                 &IterationsNeeded, &BitCount);
             if (iRes == APP_SUCCESS) {
                 //IDC_NUM_BCA_STEPS
                 SetDlgItemInt(hDlg, IDC_NUM_BCA_STEPS, IterationsNeeded, TRUE);
                 SetDlgItemInt(hDlg, IDC_NUM_BITS, BitCount, TRUE);
-                delete[] InputImage;
             }
             else {
                 SetDlgItemInt(hDlg, IDC_NUM_BCA_STEPS, 0, TRUE);
@@ -1090,7 +1680,7 @@ INT_PTR CALLBACK ReceiveASISdlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
             int iRes;
             IMAGINGHEADER ImageHeader;
             int BCAiterations = 0;
-            int* InputImage;
+            Image<int> InputImage;
             BYTE Header[10];
             BYTE Footer[10];
             int IterationsNeeded;
@@ -1107,7 +1697,7 @@ INT_PTR CALLBACK ReceiveASISdlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
             }
 
             // read input file
-            iRes = ReadASISmessage(szString, &ImageHeader, &InputImage, Header, Footer, 
+            iRes = ReadASISmessage(szString, &ImageHeader, InputImage, Header, Footer, 
                 &IterationsInFooter, &BitCount);
             if (iRes != APP_SUCCESS) {
                 MessageBox(hDlg, L"Input file is not an ASIS message", L"Read error", MB_OK);
@@ -1136,35 +1726,39 @@ INT_PTR CALLBACK ReceiveASISdlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
             // run BCA to decode
             // single point CW rules for BCA
             int Rules[16] = { 0, 2, 8, 3, 1, 5, 6, 7, 4, 9,10,11,12,13,14,15};
-            int Histo[5] = { 0,0,0,0,0 };
+            int StopReason;
+
+            // this decode has its own BCA engine, it does not touch the Margolus BCA dialog simulation
+            // the engine owns InputImage from here on
+            BCAengine Engine;
+            iRes = Engine.AttachImage(std::move(InputImage), &ImageHeader);
+            if (iRes != APP_SUCCESS) {
+                MessageBox(hDlg, L"ASIS message x,y sizes must be even", L"File size error", MB_OK);
+                return (INT_PTR)TRUE;
+            }
+            Engine.SetRules(Rules, Rules);
 
             // EvenStep is true if the number of iterations is odd
             // EvenStep is false if the number of iterations is even
-            BOOL EvenStep;
             if (IterationsNeeded % 2) {
-                EvenStep = TRUE;
+                Engine.SetEvenStep(TRUE);
             }
             else {
-                EvenStep = FALSE;
+                Engine.SetEvenStep(FALSE);
             }
             
-            for (int i = 0; i < IterationsNeeded; i++) {
-                // step forward on iteration
-                MargolusBCAp1p1(EvenStep, InputImage,
-                    ImageHeader.Xsize, ImageHeader.Ysize, Rules, Histo);
-                EvenStep = !EvenStep;
-            }
+            // ASIS messages are sparse, the engine uses the particle list BCA
+            Engine.Run(TRUE, IterationsNeeded, IterationsNeeded, &StopReason);
 
             GetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, szString, MAX_PATH);
 
-            iRes = SaveImageFile(hDlg, InputImage, szString, &ImageHeader);
+            iRes = SaveImageFile(hDlg, Engine.GetImage(), szString, &ImageHeader);
             if (iRes != APP_SUCCESS) {
                 MessageBox(hDlg, L"Output image file save failed", L"File write error", MB_OK);
                 return (INT_PTR)TRUE;
             }
 
             WritePrivateProfileString(L"ReceiveASISdlg", L"ImageOutput", szString, (LPCTSTR)strAppNameINI);
-            delete[] InputImage;
 
             if (IsDlgButtonChecked(hDlg, IDC_BMP_FILE) == BST_CHECKED) {
                 WritePrivateProfileString(L"ReceiveASISdlg", L"AutoBMP", L"1", (LPCTSTR)strAppNameINI);
@@ -1196,12 +1790,10 @@ INT_PTR CALLBACK ReceiveASISdlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
                     return (INT_PTR)TRUE;
                 }
 
+                // SaveBMP() also saves the .png file if AutoPNG is set
                 iRes = SaveBMP(BMPFilename, szString, FALSE, TRUE);
-                if (iRes == APP_SUCCESS) {
-                    iRes = GetPrivateProfileInt(L"SettingsGlobalDlg", L"AutoPNG", 1, (LPCTSTR)strAppNameINI);
-                    if (iRes != 0) {
-                        SaveBMP2PNG(BMPFilename);
-                    }
+                if (iRes != APP_SUCCESS) {
+                    MessageMySETIBCAError(hDlg, iRes, L"Receive ASIS message, saving .bmp/.png file");
                 }
             }
 
@@ -1232,6 +1824,199 @@ INT_PTR CALLBACK ReceiveASISdlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM l
     return (INT_PTR)FALSE;
 }
 
+//*******************************************************************************
+//
+// Message handler for ReceiveASISbatchDlg dialog box.
+// 
+// Decodes all the ASIS messages in a directory, see ASISbatch.cpp
+// Each file can hold any number of messages, see ASIScontainer.h
+// 
+//*******************************************************************************
+INT_PTR CALLBACK ReceiveASISbatchDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam)
+{
+    UNREFERENCED_PARAMETER(lParam);
+    switch (message)
+    {
+        WCHAR szString[MAX_PATH];
+
+    case WM_INITDIALOG:
+    {
+        int iRes;
+
+        GetPrivateProfileString(L"ReceiveASISbatchDlg", L"Input",
+            L"C:\\MySETIBCA\\Data", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_BATCH_INPUT, szString);
+
+        GetPrivateProfileString(L"ReceiveASISbatchDlg", L"OutputDir",
+            L"C:\\MySETIBCA\\Data\\Results", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_BATCH_OUTPUT, szString);
+
+        GetPrivateProfileString(L"ReceiveASISbatchDlg", L"Summary",
+            L"C:\\MySETIBCA\\Data\\Results\\ASISbatch.csv", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_BATCH_SUMMARY, szString);
+
+        GetPrivateProfileString(L"ReceiveASISbatchDlg", L"XSize", L"256", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_BATCH_XSIZE, szString);
+
+        GetPrivateProfileString(L"ReceiveASISbatchDlg", L"YSize", L"256", szString, MAX_PATH, (LPCTSTR)strAppNameINI);
+        SetDlgItemText(hDlg, IDC_BATCH_YSIZE, szString);
+
+        iRes = GetPrivateProfileInt(L"ReceiveASISbatchDlg", L"AutoBMP", 1, (LPCTSTR)strAppNameINI);
+        if (iRes != 0) {
+            CheckDlgButton(hDlg, IDC_BMP_FILE, BST_CHECKED);
+        }
+        iRes = GetPrivateProfileInt(L"ReceiveASISbatchDlg", L"AutoPNG", 1, (LPCTSTR)strAppNameINI);
+        if (iRes != 0) {
+            CheckDlgButton(hDlg, IDC_PNG_FILE, BST_CHECKED);
+        }
+
+        int ResetWindows = GetPrivateProfileInt(L"GlobalSettings", L"ResetWindows", 0, (LPCTSTR)strAppNameINI);
+        if (!ResetWindows) {
+            CString csString = L"ReceiveASISbatchDlg";
+            RestoreWindowPlacement(hDlg, csString);
+        }
+
+        return (INT_PTR)TRUE;
+    }
+
+    case WM_COMMAND:
+        switch (LOWORD(wParam)) {
+        case IDC_BATCH_INPUT_BROWSE:
+        {
+            PWSTR pszFilename;
+            GetDlgItemText(hDlg, IDC_BATCH_INPUT, szString, MAX_PATH);
+            COMDLG_FILTERSPEC dirType[] =
+            {
+                 { L"All Files", L"*.*" } };
+            if (!CCFileOpen(hDlg, szString, &pszFilename, TRUE, 1, dirType, L"")) {
+                return (INT_PTR)TRUE;
+            }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
+            }
+            SetDlgItemText(hDlg, IDC_BATCH_INPUT, szString);
+            return (INT_PTR)TRUE;
+        }
+
+        case IDC_BATCH_OUTPUT_BROWSE:
+        {
+            PWSTR pszFilename;
+            GetDlgItemText(hDlg, IDC_BATCH_OUTPUT, szString, MAX_PATH);
+            COMDLG_FILTERSPEC dirType[] =
+            {
+                 { L"All Files", L"*.*" } };
+            if (!CCFileOpen(hDlg, szString, &pszFilename, TRUE, 1, dirType, L"")) {
+                return (INT_PTR)TRUE;
+            }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
+            }
+            SetDlgItemText(hDlg, IDC_BATCH_OUTPUT, szString);
+            return (INT_PTR)TRUE;
+        }
+
+        case IDC_BATCH_SUMMARY_BROWSE:
+        {
+            PWSTR pszFilename;
+            GetDlgItemText(hDlg, IDC_BATCH_SUMMARY, szString, MAX_PATH);
+            COMDLG_FILTERSPEC csvType[] =
+            {
+                 { L"csv files", L"*.csv" },
+                 { L"All Files", L"*.*" },
+            };
+            if (!CCFileSave(hDlg, szString, &pszFilename, FALSE, 2, csvType, L"*.csv")) {
+                return (INT_PTR)TRUE;
+            }
+            {
+                wcscpy_s(szString, pszFilename);
+                CoTaskMemFree(pszFilename);
+            }
+            SetDlgItemText(hDlg, IDC_BATCH_SUMMARY, szString);
+            return (INT_PTR)TRUE;
+        }
+
+        case IDOK:
+        {
+            WCHAR Input[MAX_PATH];
+            WCHAR OutputDir[MAX_PATH];
+            BOOL SaveBMPfile;
+            BOOL SavePNGfile;
+            BOOL bSuccess;
+            ASISFORMAT Format;
+            int NumFiles;
+            int NumMessages;
+            int NumFailed;
+            int iRes;
+
+            Format.FooterBits = ASIS_MAX_FOOTER_BITS;
+            // 0 is the size from the message, the BCA needs an even size
+            Format.Xsize = GetDlgItemInt(hDlg, IDC_BATCH_XSIZE, &bSuccess, TRUE);
+            if (!bSuccess || Format.Xsize < 0 || (Format.Xsize % 2) != 0) {
+                MessageBox(hDlg, L"Image x size must be 0 or an even number", L"Receive ASIS batch", MB_OK);
+                return (INT_PTR)TRUE;
+            }
+            Format.Ysize = GetDlgItemInt(hDlg, IDC_BATCH_YSIZE, &bSuccess, TRUE);
+            if (!bSuccess || Format.Ysize < 0 || (Format.Ysize % 2) != 0) {
+                MessageBox(hDlg, L"Image y size must be 0 or an even number", L"Receive ASIS batch", MB_OK);
+                return (INT_PTR)TRUE;
+            }
+
+            GetDlgItemText(hDlg, IDC_BATCH_XSIZE, szString, MAX_PATH);
+            WritePrivateProfileString(L"ReceiveASISbatchDlg", L"XSize", szString, (LPCTSTR)strAppNameINI);
+            GetDlgItemText(hDlg, IDC_BATCH_YSIZE, szString, MAX_PATH);
+            WritePrivateProfileString(L"ReceiveASISbatchDlg", L"YSize", szString, (LPCTSTR)strAppNameINI);
+
+            GetDlgItemText(hDlg, IDC_BATCH_INPUT, Input, MAX_PATH);
+            GetDlgItemText(hDlg, IDC_BATCH_OUTPUT, OutputDir, MAX_PATH);
+            GetDlgItemText(hDlg, IDC_BATCH_SUMMARY, szString, MAX_PATH);
+            SaveBMPfile = IsDlgButtonChecked(hDlg, IDC_BMP_FILE) == BST_CHECKED;
+            SavePNGfile = IsDlgButtonChecked(hDlg, IDC_PNG_FILE) == BST_CHECKED;
+
+            WritePrivateProfileString(L"ReceiveASISbatchDlg", L"Input", Input, (LPCTSTR)strAppNameINI);
+            WritePrivateProfileString(L"ReceiveASISbatchDlg", L"OutputDir", OutputDir, (LPCTSTR)strAppNameINI);
+            WritePrivateProfileString(L"ReceiveASISbatchDlg", L"Summary", szString, (LPCTSTR)strAppNameINI);
+            WritePrivateProfileString(L"ReceiveASISbatchDlg", L"AutoBMP", SaveBMPfile ? L"1" : L"0", (LPCTSTR)strAppNameINI);
+            WritePrivateProfileString(L"ReceiveASISbatchDlg", L"AutoPNG", SavePNGfile ? L"1" : L"0", (LPCTSTR)strAppNameINI);
+
+            HCURSOR OldCursor = SetCursor(LoadCursor(NULL, IDC_WAIT));
+            iRes = ReceiveASISbatch(Input, OutputDir, szString, &Format, SaveBMPfile, SavePNGfile,
+                &NumFiles, &NumMessages, &NumFailed);
+            SetCursor(OldCursor);
+
+            if (iRes != APP_SUCCESS) {
+                MessageMySETIBCAError(hDlg, iRes, L"Receive ASIS batch");
+                return (INT_PTR)TRUE;
+            }
+
+            {
+                // save window position/size data
+                CString csString = L"ReceiveASISbatchDlg";
+                SaveWindowPlacement(hDlg, csString);
+            }
+
+            WCHAR NewMessage[MAX_PATH];
+            swprintf_s(NewMessage, MAX_PATH, L"Batch decode complete\n%d files, %d messages\n%d failed, see summary file",
+                NumFiles, NumMessages, NumFailed);
+            MessageBox(hDlg, NewMessage, L"Receive ASIS batch", MB_OK);
+
+            EndDialog(hDlg, LOWORD(wParam));
+            return (INT_PTR)TRUE;
+        }
+
+        case IDCANCEL:
+        {
+            EndDialog(hDlg, LOWORD(wParam));
+            return (INT_PTR)TRUE;
+        }
+
+        }
+    }
+
+    return (INT_PTR)FALSE;
+}
+
 //*******************************************************************************
 //
 // Message handler for SendASISdlg dialog box.
@@ -1265,12 +2050,11 @@ INT_PTR CALLBACK SendASISdlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lPar
         }
         else {
             // then try .bmp file format
-            int* InputImage;
-            if (ReadBMPfile(&InputImage, szString, &ImageHeader) == APP_SUCCESS) {
+            Image<int> InputImage;
+            if (ReadBMPfile(InputImage, szString, &ImageHeader) == APP_SUCCESS) {
                 SetDlgItemInt(hDlg, IDC_XSIZEI, ImageHeader.Xsize, TRUE);
                 SetDlgItemInt(hDlg, IDC_YSIZEI, ImageHeader.Ysize, TRUE);
                 SetDlgItemInt(hDlg, IDC_NUM_FRAMES, ImageHeader.NumFrames, TRUE);
-                delete[] InputImage;
             }
             else {
                 // unrecognized file format
@@ -1335,12 +2119,11 @@ INT_PTR CALLBACK SendASISdlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lPar
             }
             else {
                 // then try .bmp file format
-                int* InputImage;
-                if (ReadBMPfile(&InputImage, szString, &ImageHeader) == APP_SUCCESS) {
+                Image<int> InputImage;
+                if (ReadBMPfile(InputImage, szString, &ImageHeader) == APP_SUCCESS) {
                     SetDlgItemInt(hDlg, IDC_XSIZEI, ImageHeader.Xsize, TRUE);
                     SetDlgItemInt(hDlg, IDC_YSIZEI, ImageHeader.Ysize, TRUE);
                     SetDlgItemInt(hDlg, IDC_NUM_FRAMES, ImageHeader.NumFrames, TRUE);
-                    delete[] InputImage;
                 }
                 else {
                     // unrecognized file format
@@ -1439,26 +2222,13 @@ INT_PTR CALLBACK SendASISdlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lPar
             }
 
             // check if this can be encoded as a unary expression in 79 bits 
-            std::vector<std::vector<int>> combinations;
+            BYTE Footer[10] = { 0,0,0,0,0,0,0,0,0,0 };
 
             if (UseIterations) {
-                if (NumSteps != 0) {
-                    combinations = factorCombinations(NumSteps);
-
-                    // only need to look at first combination
-                    int NumBits = 0;
-                    auto& combination = combinations[0];
-                    for (int factor : combination) {
-                        NumBits += factor;
-                    }
-
-                    if (NumBits > 79) {
-                        // Clear the combinations vector before reusing it
-                        combinations.clear();
-                        MessageBox(hDlg, L"# iterations can NOT be encoded into unary formatted footer\nChoose a different number of iterations",
-                            L"Unary number exceeds 79 bits", MB_OK);
-                        return (INT_PTR)TRUE;
-                    }
+                if (EncodeUnaryFooter(NumSteps, Footer, 80, NULL) != APP_SUCCESS) {
+                    MessageBox(hDlg, L"# iterations can NOT be encoded into unary formatted footer\nChoose a different number of iterations",
+                        L"Unary number exceeds 79 bits", MB_OK);
+                    return (INT_PTR)TRUE;
                 }
             }
 
@@ -1469,9 +2239,6 @@ INT_PTR CALLBACK SendASISdlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lPar
 
             UseThisThreshold = GetDlgItemInt(hDlg, IDC_THRESHOLD, &bSuccess, TRUE);
             if (!bSuccess || UseThisThreshold <= 0) {
-                if (UseIterations) {
-                    combinations.clear();
-                }
                 MessageBox(hDlg, L"Invalid threshold or <= 0", L"Bad Number", MB_OK);
                 return (INT_PTR)TRUE;
             }
@@ -1485,29 +2252,22 @@ INT_PTR CALLBACK SendASISdlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lPar
             // read the image file
             int iRes;
             BYTE Header[10];
-            BYTE Footer[10] = { 0,0,0,0,0,0,0,0,0,0 };
-            int* InputImage = nullptr;
+            Image<int> InputImage;
             IMAGINGHEADER ImageHeader;
 
             // Try .raw file format first
 
-            iRes = LoadImageFile(&InputImage, szString, &ImageHeader);
+            iRes = LoadImageFile(InputImage, szString, &ImageHeader);
             if (iRes != APP_SUCCESS) {
                 // then try .bmp format
-                iRes = ReadBMPfile(&InputImage, szString, &ImageHeader);
+                iRes = ReadBMPfile(InputImage, szString, &ImageHeader);
                 if (iRes != APP_SUCCESS) {
-                    if (UseIterations) {
-                        combinations.clear();
-                    }
                     MessageBox(hDlg, L"Input image file is not valid", L"File read error", MB_OK);
                     return (INT_PTR)TRUE;
                 }
             }
 
             if (ImageHeader.Xsize != 256 || ImageHeader.Ysize != 256) {
-                if (UseIterations) {
-                    combinations.clear();
-                }
                 MessageBox(hDlg, L"Input image file must be 256Hx256V", L"Image format error", MB_OK);
                 return (INT_PTR)TRUE;
             }
@@ -1516,10 +2276,6 @@ INT_PTR CALLBACK SendASISdlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lPar
             GetDlgItemText(hDlg, IDC_TEXT_INPUT1, szString, MAX_PATH);
             iRes = ReadBYTEs2Text(szString, Header, 10, FALSE);
             if (iRes != APP_SUCCESS) {
-                delete[]InputImage;
-                if (UseIterations) {
-                    combinations.clear();
-                }
                 MessageBox(hDlg, L"Header bit text file not valid", L"File read error", MB_OK);
                 return (INT_PTR)TRUE;
             }
@@ -1531,84 +2287,36 @@ INT_PTR CALLBACK SendASISdlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lPar
             if (!UseIterations) {
                 iRes = ReadBYTEs2Text(szString, Footer, 10, FALSE);
                 if (iRes != APP_SUCCESS) {
-                    delete[]InputImage;
                     MessageBox(hDlg, L"Footer bit text file not valid", L"File read error", MB_OK);
                     return (INT_PTR)TRUE;
                 }
                 WritePrivateProfileString(L"SendASISdlg", L"TextInput2", szString, (LPCTSTR)strAppNameINI);
             }
-            else {
-                if (NumSteps != 0) {
-                    // create footer from factors combination list
-                    BYTE CurrentByte = 0;
-                    int CurrentBit = 0;
-                    BOOL OddBit = TRUE;
-                    auto& combination = combinations[0];
-
-                    for (int factor : combination) {
-                        // set factor number of bits
-                        for (int i = 0; i < factor; i++) {
-                            if (OddBit) {
-                                // set to ones
-                                Footer[CurrentByte] = Footer[CurrentByte] | (0x80 >> CurrentBit);
-                            }
-                            // the footer is initillay already all zeros so no need to set those
-                            CurrentBit++;
-                            if (CurrentBit >= 8) {
-                                CurrentBit = 0;
-                                CurrentByte++;
-                                if (CurrentByte >= 10) {
-                                    // things are broken, this should never happens
-                                    combinations.clear();
-                                    delete[] InputImage;
-                                    MessageBox(hDlg, L"Program failure generating footer\nfrom iterations specified",
-                                        L"Array boundary error", MB_OK);
-                                    return (INT_PTR)TRUE;
-                                }
-                            }
-                        }
-                        OddBit = !OddBit;
-                    }
-                    if (OddBit) {
-                        // fill out rest of bits with 1s out to 80
-                        if (CurrentBit != 0) {
-                            for (int i = CurrentBit; i < 8; i++) {
-                                Footer[CurrentByte] = Footer[CurrentByte] | (0x80 >> i);
-                            }
-                            CurrentByte++;
-                        }
-                        for (int i = CurrentByte; i < 10; i++) {
-                            Footer[CurrentByte] = 0xff;
-                        }
-                    }
-                }
-                // no need to zero fill, already done at initialization
-                // this also works for 0 iterations
-            }
-            
-            if (UseIterations) {
-                combinations.clear();
-            }
+            // otherwise the footer was already generated from the iterations
+            // by EncodeUnaryFooter(), this also works for 0 iterations
 
-            if (ImageHeader.NumFrames == 3) {
-                CollapseImageFrames(InputImage, &ImageHeader, UseThisThreshold);
-            }
-            else {
-                BinarizeImage(InputImage, &BCAimageHeader, UseThisThreshold);
+            iRes = BinarizeImageFrames(InputImage, &ImageHeader, UseThisThreshold);
+            if (iRes != APP_SUCCESS) {
+                MessageMySETIBCAError(hDlg, iRes, L"Send ASIS message");
+                return (INT_PTR)TRUE;
             }
 
             if (NumSteps != 0) {
                 // run BCA to encode
                 // single point CCW rules for BCA
                 int Rules[16] = { 0, 4, 1, 3, 8, 5, 6, 7, 2, 9,10,11,12,13,14,15 };
-                int Histo[5] = { 0,0,0,0,0 };
-                BOOL EvenStep = TRUE;
-   
-                for (int i = 0; i < NumSteps; i++) {
-                    MargolusBCAp1p1(EvenStep, InputImage,
-                        ImageHeader.Xsize, ImageHeader.Ysize, Rules, Histo);
-                    EvenStep = !EvenStep;
+                int StopReason;
+
+                // this encode has its own BCA engine, it does not touch the Margolus BCA dialog simulation
+                BCAengine Engine;
+                iRes = Engine.AttachImage(std::move(InputImage), &ImageHeader);
+                if (iRes != APP_SUCCESS) {
+                    MessageBox(hDlg, L"Image x,y sizes must be even", L"File size error", MB_OK);
+                    return (INT_PTR)TRUE;
                 }
+                Engine.SetRules(Rules, Rules);
+                Engine.Run(TRUE, NumSteps, NumSteps, &StopReason);
+                InputImage = Engine.DetachImage();
             }
 
             GetDlgItemText(hDlg, IDC_IMAGE_OUTPUT, szString, MAX_PATH);
@@ -1627,7 +2335,6 @@ INT_PTR CALLBACK SendASISdlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lPar
                 err = _wsplitpath_s(szString, Drive, _MAX_DRIVE, Dir, _MAX_DIR, Fname,
                     _MAX_FNAME, Ext, _MAX_EXT);
                 if (err != 0) {
-                    delete[]InputImage;
                     MessageBox(hDlg, L"Could not create diagnostic output filename", L"Send ASIS message", MB_OK);
                     return (INT_PTR)TRUE;
                 }
@@ -1635,7 +2342,6 @@ INT_PTR CALLBACK SendASISdlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lPar
                 // reassemble filename as .raw file
                 err = _wmakepath_s(RawFilename, _MAX_PATH, Drive, Dir, L"diagnostic", L".raw");
                 if (err != 0) {
-                    delete[]InputImage;
                     MessageBox(hDlg, L"Could not create diagnostic output filename", L"Send ASIS message", MB_OK);
                     return (INT_PTR)TRUE;
                 }
@@ -1644,18 +2350,12 @@ INT_PTR CALLBACK SendASISdlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lPar
                 // reassemble filename as .bmp file
                 err = _wmakepath_s(BMPFilename, _MAX_PATH, Drive, Dir, L"diagnostic", L".bmp");
                 if (err != 0) {
-                    delete[]InputImage;
                    MessageBox(hDlg, L"Could not create output filename", L"Send ASIS message", MB_OK);
                     return (INT_PTR)TRUE;
                 }
 
-                iRes = SaveBMP(BMPFilename, RawFilename, FALSE, TRUE);
-                if (iRes == APP_SUCCESS) {
-                    iRes = GetPrivateProfileInt(L"SettingsGlobalDlg", L"AutoPNG", 1, (LPCTSTR)strAppNameINI);
-                    if (iRes != 0) {
-                        SaveBMP2PNG(BMPFilename);
-                    }
-                }
+                // SaveBMP() also saves the .png file if AutoPNG is set
+                SaveBMP(BMPFilename, RawFilename, FALSE, TRUE);
 
             }
             */
@@ -1663,12 +2363,10 @@ INT_PTR CALLBACK SendASISdlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lPar
             // Save Image to bitstream
             BYTE* MessageBody=nullptr;
             int BitCount;
-            iRes = ConvertImage2Bitstream(InputImage, &ImageHeader, &MessageBody, 8192, &BitCount);
+            iRes = ConvertImage2Bitstream(InputImage.GetPixels(), &ImageHeader, &MessageBody, 8192, &BitCount);
             if (iRes != APP_SUCCESS) {
-                delete[] InputImage;
                 return (INT_PTR)TRUE;
             }
-            delete[] InputImage;
 
             iRes = SaveASISbitstream(szString, Header, MessageBody, Footer);
             if (iRes != APP_SUCCESS) {
@@ -1829,40 +2527,16 @@ INT_PTR CALLBACK UnaryDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam)
             }
 
             int SeqCount = 0;
-            std::vector<std::vector<int>> combinations;
-
-            for (int i = 2; i <= NumSteps; i++) {
-                
-                // check if this can be encoded as a unary expression in 79 bits
-                combinations = factorCombinations(i);
-                // only need to look at first combination
-
-                int NumBits = 0;
-                auto& combination = combinations[0];
-                for (int factor : combination) {
-                    NumBits += factor;
-                }
-                if (NumBits == (NumBitsString-LastValue)) {
-                    SeqCount++;
-                    fprintf(Out, "%d: %d = ", SeqCount, i);
-                    int j = 0;
-                    for (int factor : combination) {
-                        if (j == 0) {
-                            fprintf(Out, "%d", factor);
-                        }
-                        else {
-                            fprintf(Out, " * %d", factor);
-                        }
-                        NumBits += factor;
-                        j++;
-                    }
-                    fprintf(Out, ", %d\n", LastValue);
-                }
-
-                combinations.clear();
-            }
+            int iRes;
 
+            // every iteration count whose prime factors add up to the
+            // bits left for the unary expression
+            iRes = UnaryFooterSequences(Out, NumSteps, NumBitsString, LastValue, &SeqCount);
             fclose(Out);
+            if (iRes != APP_SUCCESS) {
+                MessageMySETIBCAError(hDlg, iRes, L"Unary Sequence message");
+                return (INT_PTR)TRUE;
+            }
 
             {
                 // save window position/size data
@@ -34,6 +34,35 @@
 //                          like 00000001,00000002,...
 //                          This solves the alphabetical sorting issues for sorts that don't
 //                          understand numbers in the their filename
+// V1.2.0   2026-10-19  ReadBYTEs2Text() uses ReadBitText() instead of fscanf_s() for each bit
+//                      HEX2Binary() uses HexFile2Binary() instead of fscanf_s() and fwrite()
+//                      for each byte, the line and column of a bad character are reported
+//                      LoadImageFile() maps the file and converts blocks of pixels on all
+//                      processors with SSE2 instead of fread() and swapping each pixel
+//                      SaveImageFile() narrows each frame with SSE2 and writes it with one
+//                      fwrite() instead of one fwrite() per pixel, short writes are reported
+//                      SaveBMP() maps the input file with ImageView and converts only the
+//                      frames it uses
+//                      Added 1 bit per pixel .raw files (PixelSize PIXELSIZE_1BIT) to
+//                      ReadImageHeader(), LoadImageFile(), SaveImageFile() and SaveBMP()
+//                      SaveSnapshot() saves 1 bit per pixel files if PackedSnapshots is set
+//                      AutoPNG .png files are encoded from the BMP image in memory with
+//                      PNGwriter, SaveBMP2PNG() and GDI+ removed
+//                      Added GetPNGlevel()
+//                      Added SaveImage2BMP(), exports an image in memory to .bmp and .png,
+//                      SaveBMP() loads the file and calls it
+//                      SaveSnapshot() saves the .bmp and .png from the image in memory
+//                      instead of reading back the .raw file it just saved
+//                      .bmp files are written with one fwrite() instead of one per byte
+//                      Snapshot .png files are written on a background thread, added
+//                      WaitSnapshotFiles() to report their errors, all other .png files
+//                      are written before the save returns
+//                      SaveSnapshot() and SaveHistogramData() take a 64 bit iteration
+//                      LoadImageFile(), ReadBMPfile() and SaveImageFile() use Image<int>,
+//                      SaveBMP(), SaveTXT() and SaveSnapshot() no longer delete[] images
+//                      SaveTXT() reads one frame at a time with FrameCache
+//                      SaveSnapshot() reports and returns errors writing the .bmp file
+//                      Added MakeImageHeader(), SaveImageFile() writes the header it makes
 // 
 //  This module is a copy of the FileFunctions module used in MySETIviewer and customized
 //  for this application
@@ -71,13 +100,58 @@
 #include <winver.h>
 #include <vector>
 #include <atlstr.h>
-#include <gdiplus.h>
 #include "globals.h"
 #include <strsafe.h>
 #include "shellapi.h"
 #include "Appfunctions.h"
 #include "imageheader.h"
 #include "FileFunctions.h"
+#include "CA.h"
+#include "BitText.h"
+#include "HexDecode.h"
+#include "MappedFile.h"
+#include "ImageView.h"
+#include "PNGwriter.h"
+#include "Image.h"
+#include "FrameCache.h"
+
+// SSE2 is in every x64 processor and is the default for x86 builds
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define IMAGEFILE_SSE2
+#endif
+
+#define LOADIMAGE_BLOCK (1 << 20)   // # of pixels converted at a time, one block per thread
+
+// LoadImageFile() work shared by the threads
+// a block is whole rows, the rows of all the frames are numbered one after the other
+typedef struct {
+    MappedFile* File;
+    int* Image;
+    int Xsize;
+    size_t RowBytes;            // bytes of each row in the file
+    size_t NumRows;             // Ysize * NumFrames
+    size_t RowsPerBlock;
+    int PixelSize;              // 1, 2, 4 or PIXELSIZE_1BIT
+    BOOL Swap;                  // big endian pixels
+    LONG NumBlocks;
+    volatile LONG NextBlock;    // next block to convert
+    volatile LONG Status;       // APP_SUCCESS or APPERR_FILEREAD
+} LOADIMAGEWORK;
+
+// an image converted for a .bmp file, top row first, shared by the .bmp and .png files
+typedef struct {
+    int Xsize;                  // image pixels per row
+    int Ysize;
+    int biWidth;                // Xsize padded to an even # of pixels
+    int BitCount;               // 8, pixels are ColorTable indexes, or 24, blue, green, red
+    int Stride;                 // bytes from one row to the next
+    std::vector<BYTE> Pixels;   // Stride * Ysize bytes
+    RGBQUAD ColorTable[256];    // 8 bit DIBs only
+    int PNGformat;              // PNG_GREY1, PNG_GREY8 or PNG_RGB24, see SetPNGformat()
+} DIBIMAGE;
+
+static int SaveDIB2PNG(WCHAR* Filename, DIBIMAGE* DIB, BOOL Background);
 
 //****************************************************************
 //
@@ -411,7 +485,47 @@ BOOL CCFileSave(HWND hWnd, LPWSTR pszCurrentFilename, LPWSTR* pszFilename,
     return bReturnValue;
 }
 
+//*****************************************************************************************
+//
+// MakeImageHeader
+//
+// Fill in the header of a PC format .raw image file.  Every .raw file writer
+// uses this so the header rules are in one place.  There is no user
+// interaction, it can be called from worker threads.
+// 
+// Parameters:
+//	IMAGINGHEADER* Header	returns the header
+//	int Xsize				# of columns, > 0
+//	int Ysize				# of rows, > 0
+//	int NumFrames			# of frames, 1 to 32767
+//	int PixelSize			1, 2, 4 or PIXELSIZE_1BIT
+// 
+//  return value:
+//  1 - Success
+//  APPERR_PARAMETER, a size is not valid, Header is not changed
+//
+//*****************************************************************************************
+int MakeImageHeader(IMAGINGHEADER* Header, int Xsize, int Ysize, int NumFrames, int PixelSize)
+{
+    if (Xsize <= 0 || Ysize <= 0 || NumFrames < 1 || NumFrames > 32767) {
+        return APPERR_PARAMETER;
+    }
+    if (PixelSize != 1 && PixelSize != 2 && PixelSize != 4 && PixelSize != PIXELSIZE_1BIT) {
+        return APPERR_PARAMETER;
+    }
+
+    memset(Header, 0, sizeof(IMAGINGHEADER));
+    Header->Endian = (short)-1;  // PC format
+    Header->HeaderSize = (short)sizeof(IMAGINGHEADER);
+    Header->ID = (short)0xaaaa;
+    Header->Version = (short)1;
+    Header->NumFrames = (short)NumFrames;
+    Header->PixelSize = (short)PixelSize;
+    Header->Xsize = Xsize;
+    Header->Ysize = Ysize;
 
+    return APP_SUCCESS;
+}
 
 //*****************************************************************************************
 //
@@ -459,24 +573,158 @@ int ReadImageHeader(WCHAR* Filename, IMAGINGHEADER* ImageHeader)
         return 0;
     }
 
-    if (ImageHeader->PixelSize != 1 && ImageHeader->PixelSize != 2 && ImageHeader->PixelSize != 4) {
+    if (ImageHeader->PixelSize != 1 && ImageHeader->PixelSize != 2 && ImageHeader->PixelSize != 4 &&
+        ImageHeader->PixelSize != PIXELSIZE_1BIT) {
         return 0;
     }
 
     return 1;
 }
 
+//*****************************************************************************************
+//
+//	WidenPixels
+// 
+//	Convert 1, 2 or 4 byte file pixels to (int), swapping big endian pixels
+//	SSE2 does 16, 8 or 4 pixels at a time, the rest are done one at a time
+// 
+// Parameters:
+//	const BYTE* Source		file pixels
+//	int* Dest				(int) pixels
+//	size_t NumPixels		# of pixels
+//	int PixelSize			1, 2 or 4 bytes
+//	BOOL Swap				TRUE, pixels are big endian (Header->Endian == 0)
+//
+//*****************************************************************************************
+void WidenPixels(const BYTE* Source, int* Dest, size_t NumPixels, int PixelSize, BOOL Swap)
+{
+    size_t i = 0;
+
+#ifdef IMAGEFILE_SSE2
+    const __m128i Zero = _mm_setzero_si128();
+
+    if (PixelSize == 1) {
+        for (; i + 16 <= NumPixels; i += 16) {
+            __m128i Bytes = _mm_loadu_si128((const __m128i*)(Source + i));
+            __m128i Low = _mm_unpacklo_epi8(Bytes, Zero);
+            __m128i High = _mm_unpackhi_epi8(Bytes, Zero);
+            _mm_storeu_si128((__m128i*)(Dest + i), _mm_unpacklo_epi16(Low, Zero));
+            _mm_storeu_si128((__m128i*)(Dest + i + 4), _mm_unpackhi_epi16(Low, Zero));
+            _mm_storeu_si128((__m128i*)(Dest + i + 8), _mm_unpacklo_epi16(High, Zero));
+            _mm_storeu_si128((__m128i*)(Dest + i + 12), _mm_unpackhi_epi16(High, Zero));
+        }
+    }
+    else if (PixelSize == 2) {
+        for (; i + 8 <= NumPixels; i += 8) {
+            __m128i Words = _mm_loadu_si128((const __m128i*)(Source + i * 2));
+            if (Swap) {
+                Words = _mm_or_si128(_mm_slli_epi16(Words, 8), _mm_srli_epi16(Words, 8));
+            }
+            _mm_storeu_si128((__m128i*)(Dest + i), _mm_unpacklo_epi16(Words, Zero));
+            _mm_storeu_si128((__m128i*)(Dest + i + 4), _mm_unpackhi_epi16(Words, Zero));
+        }
+    }
+    else if (Swap) {
+        for (; i + 4 <= NumPixels; i += 4) {
+            __m128i Longs = _mm_loadu_si128((const __m128i*)(Source + i * 4));
+            // swap the bytes in each 16 bit half then swap the halves
+            Longs = _mm_or_si128(_mm_slli_epi16(Longs, 8), _mm_srli_epi16(Longs, 8));
+            Longs = _mm_shufflehi_epi16(_mm_shufflelo_epi16(Longs, 0xB1), 0xB1);
+            _mm_storeu_si128((__m128i*)(Dest + i), Longs);
+        }
+    }
+#endif
+
+    if (PixelSize == 4 && !Swap) {
+        // same layout as (int)
+        memcpy(Dest + i, Source + i * 4, (NumPixels - i) * 4);
+        return;
+    }
+
+    for (; i < NumPixels; i++) {
+        const BYTE* Pixel = Source + i * PixelSize;
+        if (PixelSize == 1) {
+            Dest[i] = (int)Pixel[0];
+        }
+        else if (PixelSize == 2) {
+            if (Swap) {
+                Dest[i] = (int)(((unsigned)Pixel[0] << 8) | Pixel[1]);
+            }
+            else {
+                Dest[i] = (int)(Pixel[0] | ((unsigned)Pixel[1] << 8));
+            }
+        }
+        else {
+            Dest[i] = (int)(((unsigned)Pixel[0] << 24) | ((unsigned)Pixel[1] << 16) |
+                ((unsigned)Pixel[2] << 8) | Pixel[3]);
+        }
+    }
+    return;
+}
+
+//*****************************************************************************************
+//
+//	LoadImageProc
+// 
+//	Worker thread for LoadImageFile(), maps and converts blocks of rows
+//	until there are none left
+//
+//*****************************************************************************************
+static DWORD WINAPI LoadImageProc(LPVOID Param)
+{
+    LOADIMAGEWORK* Work = (LOADIMAGEWORK*)Param;
+
+    while (Work->Status == APP_SUCCESS) {
+        LONG Block = InterlockedIncrement(&Work->NextBlock) - 1;
+        if (Block >= Work->NumBlocks) {
+            break;
+        }
+
+        size_t FirstRow = (size_t)Block * Work->RowsPerBlock;
+        size_t NumRows = Work->NumRows - FirstRow;
+        if (NumRows > Work->RowsPerBlock) {
+            NumRows = Work->RowsPerBlock;
+        }
+
+        void* ViewBase;
+        const BYTE* Source = Work->File->MapView(sizeof(IMAGINGHEADER) + (__int64)(FirstRow * Work->RowBytes),
+            NumRows * Work->RowBytes, &ViewBase);
+        if (Source == NULL) {
+            InterlockedCompareExchange(&Work->Status, APPERR_FILEREAD, APP_SUCCESS);
+            break;
+        }
+        int* Dest = Work->Image + FirstRow * Work->Xsize;
+        if (Work->PixelSize == PIXELSIZE_1BIT) {
+            for (size_t Row = 0; Row < NumRows; Row++) {
+                UnpackPixelBits((BYTE*)Source + Row * Work->RowBytes, Work->Xsize,
+                    Dest + Row * Work->Xsize, FALSE);
+            }
+        }
+        else {
+            WidenPixels(Source, Dest, NumRows * Work->Xsize, Work->PixelSize, Work->Swap);
+        }
+        MappedFile::UnmapView(ViewBase);
+    }
+
+    return 0;
+}
+
 //*****************************************************************************************
 //
 //	LoadImageFile
 // 
 //	Load Image file into memory including all frames
-//	The Image memory is allocated in this routine.  It must be deleted by the calling processes
-//	using 'delete [] ImagePtr' after usage if completed.
+//	The Image is created in this routine with rows that are not padded, it
+//	frees its memory when the caller is done with it.
 //	Note: regardless of Input image PixelSize the Image memory is of type (int)
+//
+//	The pixels are not read one at a time.  The file is memory mapped and
+//	blocks of about LOADIMAGE_BLOCK pixels are converted to (int) by WidenPixels()
+//	on all processors.  1 bit per pixel files (PIXELSIZE_1BIT) are unpacked to
+//	binary 0/255 pixels.
 // 
 // Parameters:
-//	int** ImagePtr			pointer to (int) array containing input image
+//	Image<int>& Dest		returns the (int) input image
 //	WCHAR* ImagingFilename	Image file to load
 //	IMAGINGHEADER* Header	pointer to IMAGINGHEADER structure of the loaded
 //							image file
@@ -484,64 +732,57 @@ int ReadImageHeader(WCHAR* Filename, IMAGINGHEADER* ImageHeader)
 // return:
 //	This function also checks for a valid image header from the file
 // 
-//	1 - success			'delete [] ImagePtr' must be used to free memory
-//	error #				no memory allocated, Header contents invalid
+//	1 - success
+//	error #				Dest is empty, Header contents invalid
 //						see standarized app error number listed above
 //
 // Usage exmaple:
 // 
-//		#include "imaging.h"
-//		int* Image1;
+//		#include "Image.h"
+//		Image<int> Image1;
 //		int iRes;
 //		IMAGINGHEADER InputHeader;
-//		iRes = LoadImageFile(&Image1, ImageInputFile, &InputHeader);
+//		iRes = LoadImageFile(Image1, ImageInputFile, &InputHeader);
 //		if (iRes != 1) {
 //			MessageBox(hDlg, L"Input file read error", L"File I/O error", MB_OK);
 //			return iRes;
 //		}
 //		int Pixel;
-//		Pixel = Image1[0];
-//		delete [] Image1;
+//		Pixel = Image1.GetPixels()[0];
 //
 //*****************************************************************************************
-int LoadImageFile(int** ImagePtr, WCHAR* ImagingFilename, IMAGINGHEADER* Header)
+int LoadImageFile(Image<int>& Dest, WCHAR* ImagingFilename, IMAGINGHEADER* Header)
 {
     FILE* In;
     size_t iRead;
 
+    Dest.Release();
+
     _wfopen_s(&In, ImagingFilename, L"rb");
     if (In == NULL) {
-        *ImagePtr = NULL;
         return -2;
     }
 
     iRead = fread(Header, sizeof(IMAGINGHEADER), 1, In);
     if (iRead != 1) {
-        *ImagePtr = NULL;
         fclose(In);
         return -3;
     }
-
+    fclose(In);
 
     if (Header->Endian != 0 && Header->Endian != -1 && Header->ID != 0xaaaa) {
-        *ImagePtr = NULL;
-        fclose(In);
         return 0;
     }
 
     if (Header->Xsize <= 0 || Header->Ysize <= 0 || Header->NumFrames <= 0) {
-        *ImagePtr = NULL;
-        fclose(In);
         return 0;
     }
 
-    if (Header->PixelSize != 1 && Header->PixelSize != 2 && Header->PixelSize != 4) {
-        *ImagePtr = NULL;
-        fclose(In);
+    if (Header->PixelSize != 1 && Header->PixelSize != 2 && Header->PixelSize != 4 &&
+        Header->PixelSize != PIXELSIZE_1BIT) {
         return 0;
     }
 
-    int* Image;
     int xsize;
     int ysize;
     int NumFrames;
@@ -553,56 +794,139 @@ int LoadImageFile(int** ImagePtr, WCHAR* ImagingFilename, IMAGINGHEADER* Header)
     PixelSize = (int)Header->PixelSize;
     Endian = (int)Header->Endian;
 
-    Image = new int[(size_t)xsize * (size_t)ysize * (size_t)NumFrames];  // alocate array of 'int's to receive image
-    if (Image == NULL) {
-        *ImagePtr = NULL;
-        fclose(In);
-        return -1;
+    size_t RowBytes = (PixelSize == PIXELSIZE_1BIT) ? BITROW_BYTES(xsize) : (size_t)xsize * PixelSize;
+    size_t NumRows = (size_t)ysize * (size_t)NumFrames;
+
+    MappedFile File;
+    int iRes = File.Open(ImagingFilename);
+    if (iRes != APP_SUCCESS) {
+        return -2;
+    }
+    if (File.GetFileSize() < (__int64)sizeof(IMAGINGHEADER) + (__int64)(RowBytes * NumRows)) {
+        // the file is shorter than the header says
+        return -3;
     }
 
-    *ImagePtr = Image;
+    // alocate array of 'int's to receive image
+    iRes = Dest.Create(xsize, ysize, NumFrames, FALSE);
+    if (iRes != APP_SUCCESS) {
+        return -1;
+    }
 
-    // we don't read entire file in one fread since we may need
-    // to covert pixel(BYTE,SHORT or LONG) and Endian to get correct 'int'
-    PIXEL Pixel;
-    for (int i = 0; i < xsize * ysize * NumFrames; i++) {
-        iRead = fread(&Pixel, PixelSize, 1, In);
-        if (iRead != 1) {
-            fclose(In);
-            delete[] Image;
-            *ImagePtr = NULL;
-            return -3;
+    LOADIMAGEWORK Work;
+    Work.File = &File;
+    Work.Image = Dest.GetPixels();
+    Work.Xsize = xsize;
+    Work.RowBytes = RowBytes;
+    Work.NumRows = NumRows;
+    Work.RowsPerBlock = LOADIMAGE_BLOCK / xsize;
+    if (Work.RowsPerBlock == 0) {
+        Work.RowsPerBlock = 1;
+    }
+    Work.PixelSize = PixelSize;
+    Work.Swap = !Endian;
+    Work.NumBlocks = (LONG)((NumRows + Work.RowsPerBlock - 1) / Work.RowsPerBlock);
+    Work.NextBlock = 0;
+    Work.Status = APP_SUCCESS;
+
+    SYSTEM_INFO SysInfo;
+    GetSystemInfo(&SysInfo);
+    int NumThreads = (int)SysInfo.dwNumberOfProcessors;
+    if (NumThreads > MAXIMUM_WAIT_OBJECTS) {
+        NumThreads = MAXIMUM_WAIT_OBJECTS;
+    }
+    if (NumThreads > Work.NumBlocks) {
+        NumThreads = Work.NumBlocks;
+    }
+
+    // this thread converts blocks too, it does them all if no threads are started
+    std::vector<HANDLE> Threads;
+    for (int t = 1; t < NumThreads; t++) {
+        HANDLE hThread = CreateThread(NULL, 0, LoadImageProc, &Work, 0, NULL);
+        if (hThread == NULL) {
+            break;
         }
+        Threads.push_back(hThread);
+    }
+    LoadImageProc(&Work);
+    for (size_t t = 0; t < Threads.size(); t++) {
+        WaitForSingleObject(Threads[t], INFINITE);
+        CloseHandle(Threads[t]);
+    }
 
-        if (PixelSize == 1) {
-            Image[i] = (int)Pixel.Byte[0];
+    if (Work.Status != APP_SUCCESS) {
+        Dest.Release();
+        return -3;
+    }
+
+    return 1;
+}
+
+//*****************************************************************************************
+//
+//	NarrowPixels
+// 
+//	Convert (int) pixels to 1 or 2 byte file pixels, values larger than 255 or 65535
+//	are clamped, the low byte(s) of other values are saved like the (PIXEL) union does
+//	SSE2 does 16 or 8 pixels at a time, the rest are done one at a time
+// 
+// Parameters:
+//	const int* Source		(int) pixels
+//	BYTE* Dest				file pixels
+//	size_t NumPixels		# of pixels
+//	int PixelSize			1 or 2 bytes
+//
+//*****************************************************************************************
+static void NarrowPixels(const int* Source, BYTE* Dest, size_t NumPixels, int PixelSize)
+{
+    size_t i = 0;
+
+#ifdef IMAGEFILE_SSE2
+    if (PixelSize == 1) {
+        const __m128i Max = _mm_set1_epi32(255);
+        for (; i + 16 <= NumPixels; i += 16) {
+            __m128i Pixels[4];
+            for (int j = 0; j < 4; j++) {
+                __m128i Value = _mm_loadu_si128((const __m128i*)(Source + i + j * 4));
+                __m128i Over = _mm_cmpgt_epi32(Value, Max);
+                Value = _mm_or_si128(_mm_andnot_si128(Over, Value), _mm_and_si128(Over, Max));
+                // the low byte, 0 to 255 is not changed by the saturating packs
+                Pixels[j] = _mm_and_si128(Value, Max);
+            }
+            __m128i Low = _mm_packs_epi32(Pixels[0], Pixels[1]);
+            __m128i High = _mm_packs_epi32(Pixels[2], Pixels[3]);
+            _mm_storeu_si128((__m128i*)(Dest + i), _mm_packus_epi16(Low, High));
         }
-        else if (PixelSize == 2) {
-            if (!Endian) {
-                int swap;
-                swap = Pixel.Byte[0];
-                Pixel.Byte[0] = Pixel.Byte[1];
-                Pixel.Byte[1] = swap;
+    }
+    else {
+        const __m128i Max = _mm_set1_epi32(65535);
+        for (; i + 8 <= NumPixels; i += 8) {
+            __m128i Pixels[2];
+            for (int j = 0; j < 2; j++) {
+                __m128i Value = _mm_loadu_si128((const __m128i*)(Source + i + j * 4));
+                __m128i Over = _mm_cmpgt_epi32(Value, Max);
+                Value = _mm_or_si128(_mm_andnot_si128(Over, Value), _mm_and_si128(Over, Max));
+                // sign extend the low 16 bits so the saturating pack keeps them
+                Pixels[j] = _mm_srai_epi32(_mm_slli_epi32(Value, 16), 16);
             }
-            Image[i] = (int)Pixel.uShort;
+            _mm_storeu_si128((__m128i*)(Dest + i * 2), _mm_packs_epi32(Pixels[0], Pixels[1]));
+        }
+    }
+#endif
+
+    for (; i < NumPixels; i++) {
+        int Value = Source[i];
+        if (PixelSize == 1) {
+            if (Value > 255) Value = 255;
+            Dest[i] = (BYTE)Value;
         }
         else {
-            if (!Endian) {
-                int swap;
-                swap = Pixel.Byte[0];
-                Pixel.Byte[0] = Pixel.Byte[3];
-                Pixel.Byte[3] = swap;
-                swap = Pixel.Byte[1];
-                Pixel.Byte[1] = Pixel.Byte[2];
-                Pixel.Byte[2] = swap;
-            }
-            Image[i] = (int)Pixel.Long;
+            if (Value > 65535) Value = 65535;
+            Dest[i * 2] = (BYTE)Value;
+            Dest[i * 2 + 1] = (BYTE)(Value >> 8);
         }
     }
-    fclose(In);
-    // calling routine is responsible for deleting 'Image' memory
-
-    return 1;
+    return;
 }
 
 //*****************************************************************************************
@@ -611,12 +935,20 @@ int LoadImageFile(int** ImagePtr, WCHAR* ImagingFilename, IMAGINGHEADER* Header)
 // 
 //	Save Image file memory including all frames
 //	Note: regardless of Input image PixelSize the Image memory is of type (int)
+//
+//	Each frame is narrowed to the file PixelSize by NarrowPixels(), or packed
+//	by PackPixelBits() for PIXELSIZE_1BIT, into a staging buffer and written
+//	with one fwrite().  The staging buffer is kept for the
+//	next call, SaveSnapshot() calls this for every saved iteration.
+//	(int) frames of an image with unpadded rows are written directly.
 // 
 // Parameters:
-//	int** ImagePtr			pointer to (int) array containing output image
+//	const Image<int>& OutputImage	(int) output image
 //	WCHAR* OutputFilename	Image file to save
-//	IMAGINGHEADER* Header	pointer to IMAGINGHEADER structure of the loaded
-//							image file
+//	IMAGINGHEADER* Header	pointer to IMAGINGHEADER structure of the
+//							image file, the Xsize, Ysize and NumFrames
+//							must match OutputImage.  The file header is
+//							made from it with MakeImageHeader().
 // 
 // return:
 //	This function also checks for a valid image header from the file
@@ -624,13 +956,53 @@ int LoadImageFile(int** ImagePtr, WCHAR* ImagingFilename, IMAGINGHEADER* Header)
 //	1 - success
 //	error #				no memory allocated, Header contents invalid
 //						see standarized app error number listed above
+//						APPERR_FILEWRITE if the file could not be completely written
 //
 //*****************************************************************************************
-int SaveImageFile(HWND hDlg, int* OutputImage, WCHAR* OutputFilename, IMAGINGHEADER* Header)
+int SaveImageFile(HWND hDlg, const Image<int>& OutputImage, WCHAR* OutputFilename, IMAGINGHEADER* Header)
 {
     errno_t ErrNum;
-    PIXEL Pixel;
     FILE* Out;
+    IMAGINGHEADER FileHeader;
+    static thread_local std::vector<BYTE> Staging;
+
+    int Xsize = Header->Xsize;
+    int Ysize = Header->Ysize;
+    int NumFrames = Header->NumFrames;
+    int PixelSize = Header->PixelSize;
+    if (OutputImage.IsEmpty() || Xsize != OutputImage.GetXsize() || Ysize != OutputImage.GetYsize() ||
+        NumFrames != OutputImage.GetNumFrames()) {
+        MessageBox(hDlg, L"Image does not match the output file header", L"File I/O", MB_OK);
+        return APPERR_PARAMETER;
+    }
+    if (MakeImageHeader(&FileHeader, Xsize, Ysize, NumFrames, PixelSize) != APP_SUCCESS) {
+        MessageBox(hDlg, L"Output file header is not valid", L"File I/O", MB_OK);
+        return APPERR_PARAMETER;
+    }
+
+    size_t FramePixels = (size_t)Xsize * (size_t)Ysize;
+    size_t RowBytes = BITROW_BYTES(Xsize);
+    size_t StagingBytes = 0;
+    if (PixelSize == 1 || PixelSize == 2) {
+        StagingBytes = FramePixels * PixelSize;
+    }
+    else if (PixelSize == PIXELSIZE_1BIT) {
+        StagingBytes = RowBytes * Ysize;
+    }
+    else if (OutputImage.GetStride() != (size_t)Xsize) {
+        // padded rows are copied together
+        StagingBytes = FramePixels * sizeof(int);
+    }
+
+    if (Staging.size() < StagingBytes) {
+        try {
+            Staging.resize(StagingBytes);
+        }
+        catch (...) {
+            MessageBox(hDlg, L"Could not allocate output buffer", L"File I/O", MB_OK);
+            return APPERR_MEMALLOC;
+        }
+    }
 
     ErrNum = _wfopen_s(&Out, OutputFilename, L"wb");
     if (Out == NULL) {
@@ -639,24 +1011,44 @@ int SaveImageFile(HWND hDlg, int* OutputImage, WCHAR* OutputFilename, IMAGINGHEA
     }
 
     //write output image
-    fwrite(Header, sizeof(IMAGINGHEADER), 1, Out);
-
-    // write image
-    for (int i = 0; i < (Header->Xsize * Header->Ysize * Header->NumFrames); i++) {
-        Pixel.Long = (long)OutputImage[i];
-        if (Header->PixelSize == 1) {
-            if (Pixel.Long > 255) Pixel.Long = 255;
-            fwrite(&Pixel.Byte, 1, 1, Out);
+    BOOL WriteOK = fwrite(&FileHeader, sizeof(IMAGINGHEADER), 1, Out) == 1;
+
+    // write image, one frame at a time
+    for (int Frame = 0; WriteOK && Frame < NumFrames; Frame++) {
+        if (PixelSize == 1 || PixelSize == 2) {
+            for (int y = 0; y < Ysize; y++) {
+                NarrowPixels(OutputImage.GetRow(y, Frame), Staging.data() + (size_t)y * Xsize * PixelSize,
+                    Xsize, PixelSize);
+            }
+            WriteOK = fwrite(Staging.data(), PixelSize, FramePixels, Out) == FramePixels;
+        }
+        else if (PixelSize == PIXELSIZE_1BIT) {
+            // rows are padded to whole bytes
+            for (int y = 0; y < Ysize; y++) {
+                PackPixelBits((int*)OutputImage.GetRow(y, Frame), Xsize,
+                    Staging.data() + y * RowBytes, FALSE);
+            }
+            WriteOK = fwrite(Staging.data(), 1, StagingBytes, Out) == StagingBytes;
         }
-        else if (Header->PixelSize == 2) {
-            if (Pixel.Long > 65535) Pixel.Long = 65535;
-            fwrite(&Pixel.uShort, 2, 1, Out);
+        else if (StagingBytes == 0) {
+            // (int) is the file pixel
+            WriteOK = fwrite(OutputImage.GetRow(0, Frame), 4, FramePixels, Out) == FramePixels;
         }
         else {
-            fwrite(&Pixel.Long, 4, 1, Out);
+            for (int y = 0; y < Ysize; y++) {
+                memcpy(Staging.data() + (size_t)y * Xsize * sizeof(int), OutputImage.GetRow(y, Frame),
+                    (size_t)Xsize * sizeof(int));
+            }
+            WriteOK = fwrite(Staging.data(), 4, FramePixels, Out) == FramePixels;
         }
     }
-    fclose(Out);
+    if (fclose(Out) != 0) {
+        WriteOK = FALSE;
+    }
+    if (!WriteOK) {
+        MessageBox(hDlg, L"Could not write output file", L"File I/O", MB_OK);
+        return APPERR_FILEWRITE;
+    }
 
 //    if (DisplayResults) {
 //        DisplayImage(OutputFilename);
@@ -667,75 +1059,123 @@ int SaveImageFile(HWND hDlg, int* OutputImage, WCHAR* OutputFilename, IMAGINGHEA
 
 //****************************************************************
 //
-//  SaveBMP
-// 
-//  This a generic function is used to export a 'image file' to a BMP file type.
-//  It does not have any uer interaction.
-// 
-//  Parmeters:
-//      Filename - BMP output file
-//      InputFile - Image file for to be exported
-//      RGBframes - RBG/Greyscale interpetation flag (see below)
-//                  This flag is ignored if the # of frames in the
-//                  image is not a multiple of 3.
-//      AutoScale - auto scale the output image
-// 
-//  Xsize of image must be <= 8192
-// 
-//  Input image pixel supported 8,16,32 bit
+//  SetPNGformat
 // 
-//  2 types of output BMP files are supported:
-//
-//  Input parameter RBGframes FALSE 
-//  8 bit per pixel, first frame from file
-//      AutoScale parameter TRUE, auto scale as greyscale image, 0 to 255
-//      AutoScale parameter only applies to 8 bit input image files.
-//      16 and 24 bit images are always automatically scaled as greyscale
-//      image, 0 to 255.  This is because there is no BMP file format for 
-//      16 or 32 bit monochrome images
+//  Set DIB->PNGformat, the smallest .png pixel format that has all the
+//  colors of the DIB: 1 bit if they are only black and white, 8 bit
+//  greyscale if they are only greys, else RGB.
+//  For 8 bit DIBs only the color table entries that are used are checked.
 //
-//  Input parameter RBGframes TRUE
-//  24 bit per pixel, RGB interpetation, requires a 3 frame image file
-//          a frame is used for each color, 1st frame Red, 2nd frame Green
-//          3rd frame Blue, autoscaling stretchs each color independently
-//          from the others. Only the first 3 frames are used.
+//****************************************************************
+static void SetPNGformat(DIBIMAGE* DIB)
+{
+    BOOL Grey = TRUE;
+    BOOL Binary = TRUE;
+
+    if (DIB->BitCount == 8) {
+        BYTE Used[256] = { 0 };
+        for (int y = 0; y < DIB->Ysize; y++) {
+            BYTE* Row = DIB->Pixels.data() + (size_t)y * DIB->Stride;
+            for (int x = 0; x < DIB->Xsize; x++) {
+                Used[Row[x]] = 1;
+            }
+        }
+        for (int i = 0; i <= 255; i++) {
+            if (!Used[i]) {
+                continue;
+            }
+            RGBQUAD Color = DIB->ColorTable[i];
+            if (Color.rgbRed != Color.rgbGreen || Color.rgbRed != Color.rgbBlue) {
+                Grey = FALSE;
+            }
+            else if (Color.rgbRed != 0 && Color.rgbRed != 255) {
+                Binary = FALSE;
+            }
+        }
+    }
+    else {
+        for (int y = 0; y < DIB->Ysize && Grey; y++) {
+            BYTE* Row = DIB->Pixels.data() + (size_t)y * DIB->Stride;
+            for (int x = 0; x < DIB->Xsize; x++) {
+                BYTE* Pixel = Row + x * 3;
+                if (Pixel[0] != Pixel[1] || Pixel[0] != Pixel[2]) {
+                    Grey = FALSE;
+                    break;
+                }
+                if (Pixel[0] != 0 && Pixel[0] != 255) {
+                    Binary = FALSE;
+                }
+            }
+        }
+    }
+
+    if (!Grey) {
+        DIB->PNGformat = PNG_RGB24;
+    }
+    else if (Binary) {
+        DIB->PNGformat = PNG_GREY1;
+    }
+    else {
+        DIB->PNGformat = PNG_GREY8;
+    }
+    return;
+}
+
+//****************************************************************
 //
-//  If input image is odd columns in size it is 0 padded to even size.
+//  Image2DIB
+// 
+//  Convert an image in memory to a top down DIB, the pixels and color
+//  table of a .bmp file.  This is the conversion SaveBMP() has always
+//  done, the scaling and color table are computed once here and are
+//  used by both the .bmp and the .png files.  The image is not changed.
+// 
+//  Parmeters:
+//      Image - (int) pixels, 3 frames if RGBframes, else 1 frame is used
+//      Header - image header, PixelSize 1, 2 or PIXELSIZE_1BIT
+//               PIXELSIZE_1BIT pixels are 0 or not 0, they are
+//               converted as 0 or 255 like a loaded 1 bit file
+//      RGBframes, AutoScale - see SaveBMP()
+//      DIB - output, its Pixels are reused from call to call
 //  
 //  return value:
 //  1 - Success
 //  see standardized app error list at top of this source file
 //
 //****************************************************************
-int SaveBMP(WCHAR* Filename, WCHAR* InputFile,int RGBframes, int AutoScale)
+static int Image2DIB(const int* Image, IMAGINGHEADER* Header, int RGBframes, int AutoScale, DIBIMAGE* DIB)
 {
-    int iRes;
-    int* InputImage;
-    IMAGINGHEADER ImageHeader;
-    BITMAPFILEHEADER BMPheader;
-    BITMAPINFOHEADER BMPinfoheader;
-    RGBQUAD* ColorTable = NULL;
-    BYTE* BMPimage;
+    int PixelSize = Header->PixelSize;
+    BOOL Binarize = FALSE;
 
-    iRes = LoadImageFile(&InputImage, InputFile, &ImageHeader);
-    if (iRes != 1) {
-        return iRes;
+    if (PixelSize == PIXELSIZE_1BIT) {
+        Binarize = TRUE;
+        PixelSize = 1;
     }
 
-    if (ImageHeader.PixelSize > 2) {
-        return 0;
-    }
+    DIB->Xsize = Header->Xsize;
+    DIB->Ysize = Header->Ysize;
 
-    if (ImageHeader.Xsize > 8192) {
-        return 0;
+    // correct for odd column size
+    DIB->biWidth = Header->Xsize;
+    if (DIB->biWidth % 2 != 0) {
+        // make sure bitmap width is even
+        DIB->biWidth++;
     }
 
-    if (RGBframes && ImageHeader.NumFrames%3!=0) {
-        RGBframes = 0;
-    }
+    // BMP files have a specific requirement for # of bytes per line
+    // This is called stride.  The formula used is from the specification.
+    DIB->BitCount = RGBframes ? 24 : 8;
+    DIB->Stride = ((((DIB->biWidth * DIB->BitCount) + 31) & ~31) >> 3);
 
-    DWORD BMPimageBytes;
-    int biWidth;
+    // zero padded image array
+    try {
+        DIB->Pixels.assign((size_t)DIB->Stride * Header->Ysize, 0);
+    }
+    catch (...) {
+        return APPERR_MEMALLOC;
+    }
+    BYTE* BMPimage = DIB->Pixels.data();
 
     if (RGBframes) {
         //
@@ -746,10 +1186,6 @@ int SaveBMP(WCHAR* Filename, WCHAR* InputFile,int RGBframes, int AutoScale)
         // Frame 3 BLUE
         //
         // convert image data to 24 bit DIB/BMP format.
-        // If xsize is odd add pad to even size.
-        // Pad as required in BMP 'stride' size.
-        //  
-        // only three frames file saved.
         //
         // scale display using RGBQUAD color map
         //
@@ -763,12 +1199,11 @@ int SaveBMP(WCHAR* Filename, WCHAR* InputFile,int RGBframes, int AutoScale)
         int ImagePixelGreen;
         int ImagePixelBlue;
         int InputFrameSize;
-        int Stride;
         float ScaleRed, OffsetRed;
         float ScaleGreen, OffsetGreen;
         float ScaleBlue, OffsetBlue;
 
-        InputFrameSize = ImageHeader.Xsize * ImageHeader.Ysize;
+        InputFrameSize = Header->Xsize * Header->Ysize;
 
         if (AutoScale) {
             // scan image for red,green,blue stats for scaling
@@ -776,40 +1211,54 @@ int SaveBMP(WCHAR* Filename, WCHAR* InputFile,int RGBframes, int AutoScale)
             GreenOffset = InputFrameSize;
             BlueOffset = 2 * InputFrameSize;
 
-            if (InputImage[RedOffset] < 0) {
+            ImagePixelRed = Image[RedOffset];
+            ImagePixelGreen = Image[GreenOffset];
+            ImagePixelBlue = Image[BlueOffset];
+            if (Binarize) {
+                ImagePixelRed = ImagePixelRed ? 255 : 0;
+                ImagePixelGreen = ImagePixelGreen ? 255 : 0;
+                ImagePixelBlue = ImagePixelBlue ? 255 : 0;
+            }
+
+            if (ImagePixelRed < 0) {
                 RedMin = RedMax = 0;
             }
-            else if (InputImage[RedOffset] > 255) {
+            else if (ImagePixelRed > 255) {
                 RedMin = RedMax = 255;
             }
             else {
-                RedMin = RedMax = InputImage[RedOffset];
+                RedMin = RedMax = ImagePixelRed;
             }
 
-            if (InputImage[GreenOffset] < 0) {
+            if (ImagePixelGreen < 0) {
                 GreenMin = GreenMax = 0;
             }
-            else if (InputImage[GreenOffset] > 255) {
+            else if (ImagePixelGreen > 255) {
                 GreenMin = GreenMax = 255;
             }
             else {
-                GreenMin = GreenMax = InputImage[GreenOffset];
+                GreenMin = GreenMax = ImagePixelGreen;
             }
 
-            if (InputImage[BlueOffset] < 0) {
+            if (ImagePixelBlue < 0) {
                 BlueMin = BlueMax = 0;
             }
-            else if (InputImage[BlueOffset] > 255) {
+            else if (ImagePixelBlue > 255) {
                 BlueMin = BlueMax = 255;
             }
             else {
-                BlueMin = BlueMax = InputImage[BlueOffset];
+                BlueMin = BlueMax = ImagePixelBlue;
             }
 
             for (int i = 0; i < InputFrameSize; i++) {
-                ImagePixelRed = InputImage[i + RedOffset];
-                ImagePixelGreen = InputImage[i + GreenOffset];
-                ImagePixelBlue = InputImage[i + BlueOffset];
+                ImagePixelRed = Image[i + RedOffset];
+                ImagePixelGreen = Image[i + GreenOffset];
+                ImagePixelBlue = Image[i + BlueOffset];
+                if (Binarize) {
+                    ImagePixelRed = ImagePixelRed ? 255 : 0;
+                    ImagePixelGreen = ImagePixelGreen ? 255 : 0;
+                    ImagePixelBlue = ImagePixelBlue ? 255 : 0;
+                }
 
                 if (ImagePixelRed < RedMin) 
                     RedMin = ImagePixelRed;
@@ -845,38 +1294,24 @@ int SaveBMP(WCHAR* Filename, WCHAR* InputFile,int RGBframes, int AutoScale)
             OffsetGreen = 0.0;
         }
 
-        // correct for odd column size
-        biWidth = ImageHeader.Xsize;
-        if (biWidth % 2 != 0) {
-            // make sure bitmap width is even
-            biWidth++;
-        }
-
-        // BMP files have a specific requirement for # of bytes per line
-        // This is called stride.  The formula used is from the specification.
-        Stride = ((((biWidth * 24) + 31) & ~31) >> 3); // 24 bpp
-        BMPimageBytes = Stride * ImageHeader.Ysize; // size of image in bytes
-
-        // allocate zero paddded image array
-        BMPimage = (BYTE*)calloc(BMPimageBytes, 1);
-        if (BMPimage == NULL) {
-            delete[] InputImage;
-            return -1;
-        }
-
         int BMPOffset;
         BYTE PixelRed, PixelGreen, PixelBlue;
 
         // copy input image to BMPimage DIB format
-        for (int y = 0; y < ImageHeader.Ysize; y++) {
-            BlueOffset = y * ImageHeader.Xsize;
-            GreenOffset = y * ImageHeader.Xsize + InputFrameSize;
-            RedOffset = y * ImageHeader.Xsize + (2* InputFrameSize);
-            BMPOffset = y * Stride;
-            for (int x = 0; x < ImageHeader.Xsize; x++) {
-                ImagePixelRed = InputImage[RedOffset + x];
-                ImagePixelGreen = InputImage[GreenOffset + x];
-                ImagePixelBlue = InputImage[BlueOffset + x];
+        for (int y = 0; y < Header->Ysize; y++) {
+            BlueOffset = y * Header->Xsize;
+            GreenOffset = y * Header->Xsize + InputFrameSize;
+            RedOffset = y * Header->Xsize + (2* InputFrameSize);
+            BMPOffset = y * DIB->Stride;
+            for (int x = 0; x < Header->Xsize; x++) {
+                ImagePixelRed = Image[RedOffset + x];
+                ImagePixelGreen = Image[GreenOffset + x];
+                ImagePixelBlue = Image[BlueOffset + x];
+                if (Binarize) {
+                    ImagePixelRed = ImagePixelRed ? 255 : 0;
+                    ImagePixelGreen = ImagePixelGreen ? 255 : 0;
+                    ImagePixelBlue = ImagePixelBlue ? 255 : 0;
+                }
                 // apply scaling
                 ImagePixelRed = (int)(ScaleRed * (float)ImagePixelRed + OffsetRed + 0.5);
                 if (ImagePixelRed < 0) {
@@ -920,46 +1355,43 @@ int SaveBMP(WCHAR* Filename, WCHAR* InputFile,int RGBframes, int AutoScale)
         //
         // convert image data to 8 bit DIB/BMP format
         // 
-        // If xsize is odd add pad to even size.
-        // Pad as required in BMP 'stride' size.
-        //  
-        // only first frame file saved.
+        // only first frame used.
         //
         // 8 bit input image, scale display using RGBQUAD color map, do not scale image data
-        // 16 or 32 bit, RGBQUAD color map is scaled 0 to 255 greyscale, input image data scaled to 8 bits
+        // 16 bit, RGBQUAD color map is 0 to 255 greyscale, input image data scaled to 8 bits
+        // negative pixels are 0
         //
         int PixelMin, PixelMax;
         int InputFrameSize;
-        int Stride;
+        int ImagePixel;
         float Scale, Offset;
-        int MaxPixel = 255;
-        
-        if (ImageHeader.PixelSize > 1) {
-            AutoScale = 1;
-        }
 
-        if (InputImage[0] < 0) {
-            PixelMin = PixelMax = 0;
+        if (PixelSize > 1) {
+            AutoScale = 1;
         }
-        PixelMin = PixelMax = InputImage[0];
 
-        InputFrameSize = ImageHeader.Xsize * ImageHeader.Ysize;
+        PixelMin = PixelMax = 0;
+        InputFrameSize = Header->Xsize * Header->Ysize;
         // scan image for scaling
         for (int i=0; i < InputFrameSize; i++) {
-            if (InputImage[i] < 0) {
-                InputImage[i] = 0;
+            ImagePixel = Image[i];
+            if (Binarize) {
+                ImagePixel = ImagePixel ? 255 : 0;
+            }
+            else if (ImagePixel < 0) {
+                ImagePixel = 0;
             }
-            if (InputImage[i] < PixelMin) {
-                PixelMin = InputImage[i];
+            if (i == 0 || ImagePixel < PixelMin) {
+                PixelMin = ImagePixel;
             }
-            if (InputImage[i] > PixelMax) {
-                PixelMax = InputImage[i];
+            if (i == 0 || ImagePixel > PixelMax) {
+                PixelMax = ImagePixel;
             }
         }
 
         if (AutoScale) {
             // compute scaling: Scale, Offset
-            // this is only used in the RGBQUAD color map for the image
+            // for 8 bit images this is only used in the RGBQUAD color map
             // It does not change the pixel value
             if (PixelMax == PixelMin) {
                 // array is all the same value
@@ -978,36 +1410,22 @@ int SaveBMP(WCHAR* Filename, WCHAR* InputFile,int RGBframes, int AutoScale)
             Scale = 1.0;
         }
 
-        // correct for odd column size
-        biWidth = ImageHeader.Xsize;
-        if (biWidth % 2 != 0) {
-            // make sure bitmap width is even
-            biWidth++;
-        }
-
-        // BMP files have a specific requirement for # of bytes per line
-        // This is called stride.  The formula used is from the specification.
-        Stride = ((((biWidth * 8) + 31) & ~31) >> 3); // 8 bpp
-        BMPimageBytes = Stride * ImageHeader.Ysize; // size of image in pixels, 8bpp
-
-        // allocate zero paddded image array
-        BMPimage = (BYTE*) calloc(BMPimageBytes, 1);
-        if (BMPimage == NULL) {
-            delete[] InputImage;
-            return -1;
-        }
-
         int InputOffset;
         int BMPOffset;
-        int ImagePixel;
 
         // copy image to BMPimage
-        for (int y = 0; y < ImageHeader.Ysize; y++) {
-            InputOffset = y * ImageHeader.Xsize;
-            BMPOffset = y * Stride;
-            for (int x = 0; x < ImageHeader.Xsize; x++) {
-                ImagePixel = InputImage[InputOffset + x];
-                if (ImageHeader.PixelSize > 1) {
+        for (int y = 0; y < Header->Ysize; y++) {
+            InputOffset = y * Header->Xsize;
+            BMPOffset = y * DIB->Stride;
+            for (int x = 0; x < Header->Xsize; x++) {
+                ImagePixel = Image[InputOffset + x];
+                if (Binarize) {
+                    ImagePixel = ImagePixel ? 255 : 0;
+                }
+                else if (ImagePixel < 0) {
+                    ImagePixel = 0;
+                }
+                if (PixelSize > 1) {
                     ImagePixel = (int)(Scale * (float)ImagePixel + Offset + 0.5);
                 }
                 // copy results into BMPimage
@@ -1017,63 +1435,63 @@ int SaveBMP(WCHAR* Filename, WCHAR* InputFile,int RGBframes, int AutoScale)
 
         // generate RGBDQUAD colormaps
         int k;
-        ColorTable = new RGBQUAD[256];
-        if (ImageHeader.PixelSize == 1) {
-            for (int i = 0; i <= 255; i++) {
+        for (int i = 0; i <= 255; i++) {
+            if (PixelSize == 1) {
                 k = (int)(Scale * (float)i + Offset + 0.5);
                 if (k < 0) k = 0;
                 if (k > 255) k = 255;
-                ColorTable[i].rgbBlue = k;
-                ColorTable[i].rgbGreen = k;
-                ColorTable[i].rgbRed = k;
-                ColorTable[i].rgbReserved = 0;
             }
-        }
-        else {
-            for (int i = 0; i <= 255; i++) {
-                ColorTable[i].rgbBlue = i;
-                ColorTable[i].rgbGreen = i;
-                ColorTable[i].rgbRed = i;
-                ColorTable[i].rgbReserved = 0;
+            else {
+                k = i;
             }
-
+            DIB->ColorTable[i].rgbBlue = k;
+            DIB->ColorTable[i].rgbGreen = k;
+            DIB->ColorTable[i].rgbRed = k;
+            DIB->ColorTable[i].rgbReserved = 0;
         }
     }
-    delete[] InputImage;
 
-    // fill in BMPheader
+    SetPNGformat(DIB);
 
-    BMPheader.bfType = 0x4d42;  // required ID
-    if (!RGBframes) {
-        // 8 bpp colormap
-        BMPheader.bfSize = (DWORD)(sizeof(BMPheader) + sizeof(BMPinfoheader) + sizeof(RGBQUAD) * 256) + BMPimageBytes;
-    }
-    else {
-        // 24 bit bpp does not have a colormap
-        BMPheader.bfSize = (DWORD)(sizeof(BMPheader) + sizeof(BMPinfoheader)) + BMPimageBytes;
+    return APP_SUCCESS;
+}
+
+//****************************************************************
+//
+//  WriteDIB
+// 
+//  Write a DIB to a .bmp file, 8 bit DIBs with their color table
+//  
+//  return value:
+//  1 - Success
+//  APPERR_FILEOPEN, APPERR_FILEWRITE
+//
+//****************************************************************
+static int WriteDIB(WCHAR* Filename, DIBIMAGE* DIB)
+{
+    BITMAPFILEHEADER BMPheader;
+    BITMAPINFOHEADER BMPinfoheader;
+    DWORD BMPimageBytes = (DWORD)DIB->Pixels.size();
+    DWORD ColorTableBytes = 0;
+
+    if (DIB->BitCount == 8) {
+        // 8 bpp colormap, 24 bit bpp does not have a colormap
+        ColorTableBytes = (DWORD)sizeof(RGBQUAD) * 256;
     }
+
+    // fill in BMPheader
+    BMPheader.bfType = 0x4d42;  // required ID
+    BMPheader.bfSize = (DWORD)(sizeof(BMPheader) + sizeof(BMPinfoheader)) + ColorTableBytes + BMPimageBytes;
     BMPheader.bfReserved1 = 0;
     BMPheader.bfReserved2 = 0;
-    if (!RGBframes) {
-        // 8 bpp colormap
-        BMPheader.bfOffBits = (DWORD)(sizeof(BMPheader) + sizeof(BMPinfoheader) + sizeof(RGBQUAD) * 256);
-    }
-    else {
-        // 24 bit bpp does not have a colormap
-        BMPheader.bfOffBits = (DWORD)(sizeof(BMPheader) + sizeof(BMPinfoheader));
-    }
+    BMPheader.bfOffBits = (DWORD)(sizeof(BMPheader) + sizeof(BMPinfoheader)) + ColorTableBytes;
 
     // fill in BMPinfoheader
     BMPinfoheader.biSize = (DWORD) sizeof(BMPinfoheader);
-    BMPinfoheader.biWidth = (LONG) biWidth; // calculated and then padded in needed
-    BMPinfoheader.biHeight = (LONG)-ImageHeader.Ysize;
+    BMPinfoheader.biWidth = (LONG)DIB->biWidth; // calculated and then padded if needed
+    BMPinfoheader.biHeight = (LONG)-DIB->Ysize;
     BMPinfoheader.biPlanes = 1;
-    if (RGBframes) {
-        BMPinfoheader.biBitCount = 24;
-    }
-    else {
-        BMPinfoheader.biBitCount = 8;
-    }
+    BMPinfoheader.biBitCount = (WORD)DIB->BitCount;
     BMPinfoheader.biCompression = BI_RGB;
     BMPinfoheader.biSizeImage = BMPimageBytes;
     BMPinfoheader.biXPelsPerMeter = 2834;
@@ -1081,45 +1499,176 @@ int SaveBMP(WCHAR* Filename, WCHAR* InputFile,int RGBframes, int AutoScale)
     BMPinfoheader.biClrUsed = 0;
     BMPinfoheader.biClrImportant = 0;
 
-    // write BMP file
+    // write BMP file
+    FILE* Out;
+    errno_t ErrNum;
+    ErrNum = _wfopen_s(&Out, Filename, L"wb");
+    if (Out == NULL) {
+        return APPERR_FILEOPEN;
+    }
+
+    BOOL WriteOK = fwrite(&BMPheader, sizeof(BMPheader), 1, Out) == 1;
+    WriteOK = WriteOK && fwrite(&BMPinfoheader, sizeof(BMPinfoheader), 1, Out) == 1;
+    if (ColorTableBytes != 0) {
+        WriteOK = WriteOK && fwrite(DIB->ColorTable, 1, ColorTableBytes, Out) == ColorTableBytes;
+    }
+    WriteOK = WriteOK && fwrite(DIB->Pixels.data(), 1, BMPimageBytes, Out) == BMPimageBytes;
+    if (fclose(Out) != 0) {
+        WriteOK = FALSE;
+    }
+    if (!WriteOK) {
+        return APPERR_FILEWRITE;
+    }
+
+    return APP_SUCCESS;
+}
+
+//****************************************************************
+//
+//  SaveImage2BMP
+// 
+//  Export an image in memory to a BMP file, and a .png file if AutoPNG
+//  is set.  The image is converted once with Image2DIB() and the .bmp
+//  and .png are both made from that.  See SaveBMP() for the parameters
+//  and output types.  The image is not changed.
+// 
+//  Header PixelSize PIXELSIZE_1BIT exports the image the way a 1 bit per
+//  pixel file of it would be exported, pixels are 0 or 255.
+//
+//  BackgroundPNG TRUE, the .png file is written on the PNGwriter background
+//  thread, errors writing it are returned by WaitPNG(), see WaitSnapshotFiles()
+//  FALSE, the .png file is written before this returns
+//  
+//  return value:
+//  1 - Success
+//  see standardized app error list at top of this source file
+//
+//****************************************************************
+int SaveImage2BMP(WCHAR* Filename, const int* Image, IMAGINGHEADER* Header, int RGBframes, int AutoScale,
+    BOOL BackgroundPNG)
+{
+    int iRes;
+    // reused for every image saved, SaveSnapshot() calls this for every saved iteration
+    static thread_local DIBIMAGE DIB;
+
+    if (Image == NULL || (Header->PixelSize != 1 && Header->PixelSize != 2 &&
+        Header->PixelSize != PIXELSIZE_1BIT)) {
+        return APPERR_PARAMETER;
+    }
+
+    if (Header->Xsize <= 0 || Header->Ysize <= 0 || Header->Xsize > 8192) {
+        return APPERR_PARAMETER;
+    }
+
+    if (RGBframes && Header->NumFrames%3!=0) {
+        RGBframes = 0;
+    }
+
+    iRes = Image2DIB(Image, Header, RGBframes, AutoScale, &DIB);
+    if (iRes != APP_SUCCESS) {
+        return iRes;
+    }
+
+    iRes = WriteDIB(Filename, &DIB);
+    if (iRes != APP_SUCCESS) {
+        return iRes;
+    }
 
-    FILE* Out;
-    errno_t ErrNum;
-    ErrNum = _wfopen_s(&Out, Filename, L"wb");
-    if (Out == NULL) {
-        free(BMPimage);
-        return -2;
+    if (AutoPNG) {
+        iRes = SaveDIB2PNG(Filename, &DIB, BackgroundPNG);
     }
 
-    // write the BMPheader
-    fwrite(&BMPheader, sizeof(BMPheader), 1, Out);
+    return iRes;
+}
 
-    // write the BMPinfoheader
-    fwrite(&BMPinfoheader, sizeof(BMPinfoheader), 1, Out);
+//****************************************************************
+//
+//  SaveBMP
+// 
+//  This a generic function is used to export a 'image file' to a BMP file type.
+//  It does not have any uer interaction.
+// 
+//  Parmeters:
+//      Filename - BMP output file
+//      InputFile - Image file for to be exported
+//      RGBframes - RBG/Greyscale interpetation flag (see below)
+//                  This flag is ignored if the # of frames in the
+//                  image is not a multiple of 3.
+//      AutoScale - auto scale the output image
+// 
+//  Xsize of image must be <= 8192
+// 
+//  Input image pixel supported 1,8,16 bit
+// 
+//  2 types of output BMP files are supported:
+//
+//  Input parameter RBGframes FALSE 
+//  8 bit per pixel, first frame from file
+//      AutoScale parameter TRUE, auto scale as greyscale image, 0 to 255
+//      AutoScale parameter only applies to 8 bit input image files.
+//      16 bit images are always automatically scaled as greyscale
+//      image, 0 to 255.  This is because there is no BMP file format for 
+//      16 bit monochrome images
+//
+//  Input parameter RBGframes TRUE
+//  24 bit per pixel, RGB interpetation, requires a 3 frame image file
+//          a frame is used for each color, 1st frame Red, 2nd frame Green
+//          3rd frame Blue, autoscaling stretchs each color independently
+//          from the others. Only the first 3 frames are used.
+//
+//  If input image is odd columns in size it is 0 padded to even size.
+//
+//  An image that is already in memory is exported with SaveImage2BMP(),
+//  without saving it and reading it back.
+//  
+//  return value:
+//  1 - Success
+//  see standardized app error list at top of this source file
+//
+//****************************************************************
+int SaveBMP(WCHAR* Filename, WCHAR* InputFile,int RGBframes, int AutoScale)
+{
+    int iRes;
+    Image<int> InputImage;
+    IMAGINGHEADER ImageHeader;
 
-    // write color map only if greyscale image
-    if (!RGBframes) {
-        fwrite(ColorTable, sizeof(RGBQUAD), 256, Out);
-        delete[] ColorTable;
+    ImageView View;
+    iRes = View.Open(InputFile);
+    if (iRes != 1) {
+        return iRes;
     }
+    ImageHeader = *View.GetHeader();
 
-    // write the image data
-    int Address = 0;
-    for (int i = 0; i < (int)BMPimageBytes; i++) {
-        fwrite(&BMPimage[i], 1, 1, Out);
-        Address++;
+    if (ImageHeader.PixelSize > 2) {
+        return 0;
     }
 
-    free(BMPimage);
-    fclose(Out);
+    if (ImageHeader.Xsize > 8192) {
+        return 0;
+    }
 
-    if (AutoPNG) {
-        if (SaveBMP2PNG(Filename) != 1) {
-            return 0;
-        }
+    if (RGBframes && ImageHeader.NumFrames%3!=0) {
+        RGBframes = 0;
     }
 
-    return 1;
+    // only the frames that are used are converted to (int), not the whole file
+    int NumFramesUsed = RGBframes ? 3 : 1;
+    iRes = InputImage.Create(ImageHeader.Xsize, ImageHeader.Ysize, NumFramesUsed, FALSE);
+    if (iRes != APP_SUCCESS) {
+        return iRes;
+    }
+    iRes = View.WidenFrames(0, NumFramesUsed, InputImage.GetPixels());
+    if (iRes != 1) {
+        return iRes;
+    }
+    if (ImageHeader.PixelSize == PIXELSIZE_1BIT) {
+        // the bits were unpacked to 0/255, same as an 8 bit image
+        ImageHeader.PixelSize = 1;
+    }
+
+    iRes = SaveImage2BMP(Filename, InputImage.GetPixels(), &ImageHeader, RGBframes, AutoScale, FALSE);
+
+    return iRes;
 }
 
 //****************************************************************
@@ -1142,6 +1691,7 @@ int SaveBMP(WCHAR* Filename, WCHAR* InputFile,int RGBframes, int AutoScale)
 //      2 byte - 0 to 65535
 //      4 byte - 0 to 2147483648
 // If there are multiple frames there is a blank line between frames. 
+// The frames are read one at a time, only one frame is in memory.
 //  
 //  return value:
 //  1 - Success
@@ -1151,13 +1701,14 @@ int SaveBMP(WCHAR* Filename, WCHAR* InputFile,int RGBframes, int AutoScale)
 int SaveTXT(WCHAR* Filename, WCHAR* InputFile)
 {
     int iRes;
-    int* InputImage;
+    FrameCache Cache;
 IMAGINGHEADER ImageHeader;
 
-iRes = LoadImageFile(&InputImage, InputFile, &ImageHeader);
+iRes = Cache.Open(InputFile, 1);
 if (iRes != 1) {
     return iRes;
 }
+ImageHeader = *Cache.GetHeader();
 
 FILE* Out;
 errno_t ErrNum;
@@ -1165,18 +1716,22 @@ int Address;
 
 ErrNum = _wfopen_s(&Out, Filename, L"w");
 if (Out == NULL) {
-    delete[] InputImage;
     return -2;
 }
 
 // save file in text format, blank line between frames
-Address = 0;
 int Pixel;
 
-for (int Frame = 0; Frame < ImageHeader.NumFrames; Frame++) {
+for (CACHEDFRAME Frame : Cache.Frames(0, ImageHeader.NumFrames)) {
+    const int* Pixels = Frame.Pixels;
+    if (Pixels == NULL) {
+        fclose(Out);
+        return APPERR_FILEREAD;
+    }
+    Address = 0;
     for (int y = 0; y < ImageHeader.Ysize; y++) {
         for (int x = 0; x < ImageHeader.Xsize; x++) {
-            Pixel = InputImage[Address];
+            Pixel = Pixels[Address];
             // make sure pixel is not less than 0
             if (Pixel < 0) Pixel = 0;
             if (ImageHeader.PixelSize == 1) {
@@ -1199,7 +1754,6 @@ for (int Frame = 0; Frame < ImageHeader.NumFrames; Frame++) {
     fprintf(Out, "\n");
 }
 fclose(Out);
-delete[] InputImage;
 
 return 1;
 }
@@ -1208,6 +1762,9 @@ return 1;
 //
 //  Hex2Binary
 // 
+//  Asks for a hex text file and a binary output file then
+//  converts it with HexFile2Binary() in HexDecode.cpp
+//
 //****************************************************************
 int HEX2Binary(HWND hWnd)
 {
@@ -1246,35 +1803,25 @@ int HEX2Binary(HWND hWnd)
     WritePrivateProfileString(L"Hex2Binary", L"InputFile", InputFilename, (LPCTSTR)strAppNameINI);
     WritePrivateProfileString(L"Hex2Binary", L"OutputFile", OutputFilename, (LPCTSTR)strAppNameINI);
 
-    FILE* Input;
-    FILE* Output;
-    errno_t ErrNum;
-    BYTE HexValue;
-    int HexRead;
+    HEXDECODEINFO Info;
     int iRes;
 
-    ErrNum = _wfopen_s(&Input, InputFilename, L"rb");
-    if (Input ==NULL) {
-        return -2;
-    }
+    HCURSOR OldCursor = SetCursor(LoadCursor(NULL, IDC_WAIT));
+    iRes = HexFile2Binary(InputFilename, OutputFilename, &Info);
+    SetCursor(OldCursor);
+    if (iRes == APPERR_FILETYPE) {
+        WCHAR Message[MAX_PATH];
 
-    ErrNum = _wfopen_s(&Output, OutputFilename, L"wb");
-    if (Output == NULL) {
-        return -2;
+        swprintf_s(Message, MAX_PATH, L"Not a hex digit or separator: 0x%02X\nline %lld, column %lld\n%lld bytes written before it",
+            Info.Char, Info.Line, Info.Column, Info.NumBytes);
+        MessageBox(hWnd, Message, L"Hex to binary", MB_OK);
+        return iRes;
     }
-
-    while (!feof(Input)) {
-        iRes = fscanf_s(Input, "%2x", &HexRead);
-        if (iRes != 1) {
-            break;
-        }
-        HexValue = (BYTE)HexRead;
-        fwrite(&HexValue, 1, 1, Output);
+    if (iRes != APP_SUCCESS) {
+        MessageMySETIBCAError(hWnd, iRes, L"Hex to binary");
+        return iRes;
     }
 
-    fclose(Output);
-    fclose(Input);
-
     return 1;
 }
 
@@ -1463,61 +2010,129 @@ int GetFileSize(WCHAR* szString)
 
 //****************************************************************
 //
-//  SaveBMP2PNG
+//  GetPNGlevel
 // 
-// This is based on a solution provided at:
-// https://learn.microsoft.com/en-us/windows/win32/gdiplus/-gdiplus-converting-a-bmp-image-to-a-png-image-use
+// The deflate level for .png files, SettingsGlobalDlg PNGlevel
+// PNG_LEVEL_STORE to PNG_LEVEL_MAX, PNG_LEVEL_DEFAULT if it is not set
 // 
 //****************************************************************
-// using namespace Gdiplus;
-
-int SaveBMP2PNG(WCHAR* Filename)
+int GetPNGlevel()
 {
-    // Initialize GDI+.
-    Gdiplus::GdiplusStartupInput gdiplusStartupInput;
-    ULONG_PTR gdiplusToken;
-    Gdiplus::GdiplusStartup(&gdiplusToken, &gdiplusStartupInput, NULL);
-
-    CLSID   encoderClsid;
-    Gdiplus::Status  stat;
+    int Level = GetPrivateProfileInt(L"SettingsGlobalDlg", L"PNGlevel", PNG_LEVEL_DEFAULT, (LPCTSTR)strAppNameINI);
+    if (Level < PNG_LEVEL_STORE || Level > PNG_LEVEL_MAX) {
+        Level = PNG_LEVEL_DEFAULT;
+    }
+    return Level;
+}
 
-    // load BMP file to image
-    Gdiplus::Image* image = new Gdiplus::Image(Filename);
+//****************************************************************
+//
+//  SaveDIB2PNG
+// 
+// Save the .png version of a .bmp file from the DIB that was just written
+// to it.  The .png has the same name with a .png extension.  The pixels are
+// the ones a .bmp to .png conversion would have, without the pad column
+// added to make odd BMP widths even.  The pixel format is DIB->PNGformat,
+// the colors are not scanned again.
+// 
+// Parameters:
+//  WCHAR* Filename     .bmp filename
+//  DIBIMAGE* DIB       the DIB saved in the .bmp file
+//  BOOL Background     TRUE, the file is encoded and written on the PNGwriter
+//                      background thread, write errors are returned by WaitPNG()
+//
+//  return value:
+//  1 - Success
+//  !=1 Error see standardized app error list in AppErrors.h
+// 
+//****************************************************************
+static int SaveDIB2PNG(WCHAR* Filename, DIBIMAGE* DIB, BOOL Background)
+{
+    int err;
+    WCHAR Drive[_MAX_DRIVE];
+    WCHAR Dir[_MAX_DIR];
+    WCHAR Fname[_MAX_FNAME];
+    WCHAR Ext[_MAX_EXT];
+    WCHAR PNGfilename[MAX_PATH];
 
-    // Get the CLSID of the PNG encoder.
-    GetEncoderClsid(L"image/png", &encoderClsid);
     // generate .png name version of Filename
-    {
-        //parse for just filename
-        int err;
-        WCHAR Drive[_MAX_DRIVE];
-        WCHAR Dir[_MAX_DIR];
-        WCHAR Fname[_MAX_FNAME];
-        WCHAR Ext[_MAX_EXT];
-        WCHAR PNGfilename[MAX_PATH];
+    err = _wsplitpath_s(Filename, Drive, _MAX_DRIVE, Dir, _MAX_DIR, Fname,
+        _MAX_FNAME, Ext, _MAX_EXT);
+    if (err != 0) {
+        return APPERR_PARAMETER;
+    }
+    err = _wmakepath_s(PNGfilename, _MAX_PATH, Drive, Dir, Fname, L".png");
+    if (err != 0) {
+        return APPERR_PARAMETER;
+    }
 
-        // split apart original filename
-        err = _wsplitpath_s(Filename, Drive, _MAX_DRIVE, Dir, _MAX_DIR, Fname,
-            _MAX_FNAME, Ext, _MAX_EXT);
-        if (err != 0) {
-            return 0;
-        }
+    int Xsize = DIB->Xsize;
+    int Ysize = DIB->Ysize;
+    if (Xsize <= 0 || Ysize <= 0 || (DIB->BitCount != 8 && DIB->BitCount != 24)) {
+        return APPERR_PARAMETER;
+    }
 
-        err = _wmakepath_s(PNGfilename, _MAX_PATH, Drive, Dir, Fname, L".png");
-        if (err != 0) {
-            return 0;
-        }
+    PNGIMAGE PNGImage;
+    PNGImage.Xsize = Xsize;
+    PNGImage.Ysize = Ysize;
+    PNGImage.Format = DIB->PNGformat;
+    if (DIB->PNGformat == PNG_GREY1) {
+        PNGImage.Stride = ((size_t)Xsize + 7) / 8;
+    }
+    else if (DIB->PNGformat == PNG_GREY8) {
+        PNGImage.Stride = (size_t)Xsize;
+    }
+    else {
+        PNGImage.Stride = (size_t)Xsize * 3;
+    }
 
-        stat = image->Save(PNGfilename, &encoderClsid, NULL);
+    // the grey level of each 8 bit DIB pixel value
+    BYTE Grey[256];
+    for (int i = 0; i <= 255; i++) {
+        Grey[i] = DIB->ColorTable[i].rgbRed;
     }
-    delete image;
-    Gdiplus::GdiplusShutdown(gdiplusToken);
 
-    if (stat == Gdiplus::Ok) {
-        return 1;
+    std::vector<BYTE> PNGpixels(PNGImage.Stride * Ysize, 0);
+    for (int y = 0; y < Ysize; y++) {
+        BYTE* Row = DIB->Pixels.data() + (size_t)y * DIB->Stride;
+        BYTE* Dest = PNGpixels.data() + (size_t)y * PNGImage.Stride;
+        if (DIB->PNGformat == PNG_GREY1) {
+            // 8 pixels per byte, MSB first, white is 1
+            for (int x = 0; x < Xsize; x++) {
+                BYTE Pixel = DIB->BitCount == 8 ? Grey[Row[x]] : Row[x * 3];
+                if (Pixel != 0) {
+                    Dest[x >> 3] |= (BYTE)(0x80 >> (x & 7));
+                }
+            }
+        }
+        else if (DIB->PNGformat == PNG_GREY8) {
+            for (int x = 0; x < Xsize; x++) {
+                Dest[x] = DIB->BitCount == 8 ? Grey[Row[x]] : Row[x * 3];
+            }
+        }
+        else if (DIB->BitCount == 8) {
+            for (int x = 0; x < Xsize; x++) {
+                RGBQUAD Color = DIB->ColorTable[Row[x]];
+                Dest[x * 3] = Color.rgbRed;
+                Dest[x * 3 + 1] = Color.rgbGreen;
+                Dest[x * 3 + 2] = Color.rgbBlue;
+            }
+        }
+        else {
+            // DIB pixels are blue, green, red
+            for (int x = 0; x < Xsize; x++) {
+                Dest[x * 3] = Row[x * 3 + 2];
+                Dest[x * 3 + 1] = Row[x * 3 + 1];
+                Dest[x * 3 + 2] = Row[x * 3];
+            }
+        }
     }
+    PNGImage.Pixels = PNGpixels.data();
 
-    return 0;
+    if (Background) {
+        return QueuePNG(PNGfilename, &PNGImage, GetPNGlevel());
+    }
+    return SavePNG(PNGfilename, &PNGImage, GetPNGlevel());
 }
 
 //****************************************************************
@@ -1530,29 +2145,32 @@ int SaveImageBMP(WCHAR* Filename,COLORREF* Image, int ImageXextent, int ImageYex
         return APPERR_PARAMETER;
     }
 
-    int biWidth;
-    int Stride;
-    int BMPimageBytes;
-    BYTE* BMPimage = NULL;
+    int iRes;
+    static thread_local DIBIMAGE DIB;
 
-    // correct for odd column size
+    DIB.Xsize = ImageXextent;
+    DIB.Ysize = ImageYextent;
 
-    biWidth = ImageXextent;
-    if (biWidth % 2 != 0) {
+    // correct for odd column size
+    DIB.biWidth = ImageXextent;
+    if (DIB.biWidth % 2 != 0) {
         // make sure bitmap width is even
-        biWidth++;
+        DIB.biWidth++;
     }
 
     // BMP files have a specific requirement for # of bytes per line
     // This is called stride.  The formula used is from the specification. 
-    Stride = ((((biWidth * 24) + 31) & ~31) >> 3); // 24 bpp
-    BMPimageBytes = Stride * ImageYextent; // size of image in bytes
+    DIB.BitCount = 24;
+    DIB.Stride = ((((DIB.biWidth * 24) + 31) & ~31) >> 3); // 24 bpp
 
-    // allocate zero paddded image array
-    BMPimage = (BYTE*)calloc(BMPimageBytes, 1);
-    if (BMPimage == NULL) {
+    // zero paddded image array
+    try {
+        DIB.Pixels.assign((size_t)DIB.Stride * ImageYextent, 0);
+    }
+    catch (...) {
         return APPERR_MEMALLOC;
     }
+    BYTE* BMPimage = DIB.Pixels.data();
 
     int BMPOffset;
     int Offset;
@@ -1564,7 +2182,7 @@ int SaveImageBMP(WCHAR* Filename,COLORREF* Image, int ImageXextent, int ImageYex
     // copy input COLORREF image to BMPimage DIB format
     for (int y = 0; y < ImageYextent; y++) {
         Offset = y * ImageXextent;
-        BMPOffset = y * Stride;
+        BMPOffset = y * DIB.Stride;
         for (int x = 0; x < ImageXextent; x++) {
             iColor.Color = Image[Offset + x];
             BMPimage[BMPOffset + (x * 3)] = iColor.rgb.rgbRed;
@@ -1572,71 +2190,33 @@ int SaveImageBMP(WCHAR* Filename,COLORREF* Image, int ImageXextent, int ImageYex
             BMPimage[BMPOffset + (x * 3) + 2] = iColor.rgb.rgbBlue;
         }
     }
+    SetPNGformat(&DIB);
 
-    // fill in BMPheader
-    BITMAPFILEHEADER BMPheader;
-
-    BMPheader.bfType = 0x4d42;  // required ID
-    BMPheader.bfSize = (DWORD)(sizeof(BMPheader) + sizeof(BITMAPINFOHEADER)) + BMPimageBytes;
-    BMPheader.bfReserved1 = 0;
-    BMPheader.bfReserved2 = 0;
-    BMPheader.bfOffBits = (DWORD)(sizeof(BMPheader) + sizeof(BITMAPINFOHEADER));
-
-    // fill in BMPinfoheader
-    BITMAPINFOHEADER BMPinfoheader;
-
-    BMPinfoheader.biSize = (DWORD)sizeof(BMPinfoheader);
-    BMPinfoheader.biWidth = (LONG)biWidth; // calculated and then padded if needed
-    BMPinfoheader.biHeight = (LONG)-ImageYextent;
-    BMPinfoheader.biPlanes = 1;
-    BMPinfoheader.biBitCount = 24;
-    BMPinfoheader.biCompression = BI_RGB;
-    BMPinfoheader.biSizeImage = BMPimageBytes;
-    BMPinfoheader.biXPelsPerMeter = 2834;
-    BMPinfoheader.biYPelsPerMeter = 2834;
-    BMPinfoheader.biClrUsed = 0;
-    BMPinfoheader.biClrImportant = 0;
-
-    // write BMP file
-
-    FILE* Out;
-    errno_t ErrNum;
-    ErrNum = _wfopen_s(&Out, Filename, L"wb");
-    if (Out == NULL) {
-        free(BMPimage);
-        return APPERR_FILEOPEN;
-    }
-
-    // write the BMPheader
-    fwrite(&BMPheader, sizeof(BMPheader), 1, Out);
-
-    // write the BMPinfoheader
-    fwrite(&BMPinfoheader, sizeof(BMPinfoheader), 1, Out);
-
-    // write the image data
-    int Address = 0;
-    for (int i = 0; i < (int)BMPimageBytes; i++) {
-        fwrite(&BMPimage[i], 1, 1, Out);
-        Address++;
+    iRes = WriteDIB(Filename, &DIB);
+    if (iRes != APP_SUCCESS) {
+        return iRes;
     }
 
-    free(BMPimage);
-    fclose(Out);
-
     if (AutoPNG) {
-        if (SaveBMP2PNG(Filename) != 1) {
-            return 0;
-        }
+        iRes = SaveDIB2PNG(Filename, &DIB, FALSE);
     }
-    return APP_SUCCESS;
+
+    return iRes;
 }
 
 //****************************************************************
 //
 //  LoadBMPfile
 // 
+//  Load a 1, 8 or 24 bit .bmp file as an (int) image with rows that are
+//  not padded.  24 bit files are 3 frame images, red, green, blue.
+// 
+//  Image<int>& Dest            returns the image
+//  WCHAR* InputFilename        .bmp file
+//  IMAGINGHEADER* ImgHeader    returns the header of the image
+// 
 //****************************************************************
-int  ReadBMPfile(int** ImagePtr, WCHAR* InputFilename, IMAGINGHEADER* ImgHeader)
+int  ReadBMPfile(Image<int>& Dest, WCHAR* InputFilename, IMAGINGHEADER* ImgHeader)
 {
     int Invert = 0;
 
@@ -1645,6 +2225,7 @@ int  ReadBMPfile(int** ImagePtr, WCHAR* InputFilename, IMAGINGHEADER* ImgHeader)
     errno_t ErrNum;
     int iRes;
 
+    Dest.Release();
     ErrNum = _wfopen_s(&BMPfile, InputFilename, L"rb");
     if (!BMPfile) {
         return APPERR_FILEOPEN;
@@ -1729,19 +2310,20 @@ int  ReadBMPfile(int** ImagePtr, WCHAR* InputFilename, IMAGINGHEADER* ImgHeader)
 
         // allocate Image
         // alocate array of 'int's to receive image
-        Image = new int[(size_t)BMPinfoheader.biWidth * (size_t)BMPinfoheader.biHeight];
-        if (Image == NULL) {
+        iRes = Dest.Create(BMPinfoheader.biWidth, BMPinfoheader.biHeight, 1, FALSE);
+        if (iRes != APP_SUCCESS) {
             delete[] Stride;
             fclose(BMPfile);
-            return APPERR_MEMALLOC;
+            return iRes;
         }
+        Image = Dest.GetPixels();
 
         // BMPimage of BMPimageBytes
         for (int y = 0; y < BMPinfoheader.biHeight; y++) {
             // read stride
             iRes = (int)fread(Stride, 1, StrideLen, BMPfile);
             if (iRes != StrideLen) {
-                delete[] Image;
+                Dest.Release();
                 delete[] Stride;
                 fclose(BMPfile);
                 return APPERR_FILETYPE;
@@ -1792,12 +2374,13 @@ int  ReadBMPfile(int** ImagePtr, WCHAR* InputFilename, IMAGINGHEADER* ImgHeader)
 
         // allocate Image
         // alocate array of 'int's to receive image
-        Image = new int[(size_t)BMPinfoheader.biWidth * (size_t)BMPinfoheader.biHeight];
-        if (Image == NULL) {
+        iRes = Dest.Create(BMPinfoheader.biWidth, BMPinfoheader.biHeight, 1, FALSE);
+        if (iRes != APP_SUCCESS) {
             delete[] Stride;
             fclose(BMPfile);
-            return APPERR_MEMALLOC;
+            return iRes;
         }
+        Image = Dest.GetPixels();
 
         // BMPimage of BMPimageBytes
         int Offset;
@@ -1806,7 +2389,7 @@ int  ReadBMPfile(int** ImagePtr, WCHAR* InputFilename, IMAGINGHEADER* ImgHeader)
             // read stride
             iRes = (int)fread(Stride, 1, StrideLen, BMPfile);
             if (iRes != StrideLen) {
-                delete[] Image;
+                Dest.Release();
                 delete[] Stride;
                 fclose(BMPfile);
                 return APPERR_FILETYPE;
@@ -1836,12 +2419,13 @@ int  ReadBMPfile(int** ImagePtr, WCHAR* InputFilename, IMAGINGHEADER* ImgHeader)
             }
         }
 
-        Image = new int[(size_t)BMPinfoheader.biWidth * (size_t)BMPinfoheader.biHeight * (size_t)3];
-        if (Image == NULL) {
+        iRes = Dest.Create(BMPinfoheader.biWidth, BMPinfoheader.biHeight, 3, FALSE);
+        if (iRes != APP_SUCCESS) {
             delete[] Stride;
             fclose(BMPfile);
-            return APPERR_MEMALLOC;
+            return iRes;
         }
+        Image = Dest.GetPixels();
 
         // BMPimage of BMPimageBytes
         int Offset;
@@ -1853,7 +2437,7 @@ int  ReadBMPfile(int** ImagePtr, WCHAR* InputFilename, IMAGINGHEADER* ImgHeader)
             // read stride
             iRes = (int)fread(Stride, 1, StrideLen, BMPfile);
             if (iRes != StrideLen) {
-                delete[] Image;
+                Dest.Release();
                 delete[] Stride;
                 fclose(BMPfile);
                 return APPERR_FILETYPE;
@@ -1876,8 +2460,6 @@ int  ReadBMPfile(int** ImagePtr, WCHAR* InputFilename, IMAGINGHEADER* ImgHeader)
     delete[] Stride;
     fclose(BMPfile);
 
-    *ImagePtr = Image;
-
     ImgHeader->Endian = (short)-1;  // PC format
     ImgHeader->HeaderSize = (short)sizeof(IMAGINGHEADER);
     ImgHeader->ID = (short)0xaaaa;
@@ -1962,44 +2544,19 @@ int SaveBYTEs2Text(WCHAR* OutputFile, BYTE* ByteStream,
 int ReadBYTEs2Text(WCHAR* InputFile, BYTE* ByteStream,
     int NumBytes, int BitOrder)
 {
-    FILE* In;
-    int CurrentByte = 0;
-    errno_t ErrNum;
+    std::vector<BYTE> Bytes;
+    BITTEXTINFO Info;
+    int iRes;
 
-    // this is a text file
-    ErrNum = _wfopen_s(&In, InputFile, L"r");
-    if (In == NULL) {
-        return APPERR_FILEOPEN;
+    iRes = ReadBitText(InputFile, BitOrder, (__int64)NumBytes * 8, FALSE, Bytes, &Info);
+    if (iRes != APP_SUCCESS) {
+        return iRes;
     }
-
-    for (int i = 0; i < NumBytes; i++) {
-        int iRes;
-        int BitValue;
-
-        for (int CurrentBit = 0; CurrentBit < 8; CurrentBit++) {
-            iRes = fscanf_s(In, "%d", &BitValue);
-            if (iRes != 1) {
-                fclose(In);
-                return APPERR_FILEREAD;
-            }
-            if (BitValue < 0) {
-                fclose(In);
-                return APPERR_FILEREAD;
-            }
-            if (BitValue != 0) {
-                if (BitOrder == 0) {
-                    CurrentByte = CurrentByte | (0x80 >> CurrentBit);
-                }
-                else {
-                    CurrentByte = CurrentByte | (0x01 << CurrentBit);
-                }
-            }
-        }
-        ByteStream[i] = CurrentByte;
-        CurrentByte = 0;
+    if (Info.NumBits != (__int64)NumBytes * 8) {
+        // not enough values in the file
+        return APPERR_FILEREAD;
     }
-
-    fclose(In);
+    memcpy(ByteStream, Bytes.data(), NumBytes);
 
     return APP_SUCCESS;
 }
@@ -2058,7 +2615,7 @@ int SaveASISbitstream(WCHAR* Filename, BYTE* Header, BYTE* MessageBody, BYTE* Fo
 // Save histogram data to .csv file
 // 
 //*******************************************************************
-int SaveHistogramData(WCHAR* Filename, BOOL CreateNew, int Index, int* Histogram, int NumEntries)
+int SaveHistogramData(WCHAR* Filename, BOOL CreateNew, __int64 Index, int* Histogram, int NumEntries)
 {
     FILE* Out;
     errno_t ErrNum;
@@ -2100,7 +2657,7 @@ int SaveHistogramData(WCHAR* Filename, BOOL CreateNew, int Index, int* Histogram
     }
 
     // write new line of data to file
-    fprintf(Out, "%10d,", Index);
+    fprintf(Out, "%10lld,", Index);
     for (int i = 0; i < (NumEntries-1); i++) {
         fprintf(Out, " %10d,", Histogram[i]);
     }
@@ -2117,8 +2674,17 @@ int SaveHistogramData(WCHAR* Filename, BOOL CreateNew, int Index, int* Histogram
 // 
 // Save snapshot of current iteration
 // 
+// Each snapshot is exported from TheImage: the .raw file with SaveImageFile(),
+// the .bmp and .png files with SaveImage2BMP().  No file is read back.
+// The .png file is written on a background thread, call WaitSnapshotFiles()
+// when the run or save is done to report errors writing it.
+// 
+// return value:
+//  1 - Success
+//  !=1 the first error saving the .raw or .bmp file, it has been reported
+// 
 //*******************************************************************
-int SaveSnapshot(HWND hDlg, int CurrentIteration, int* TheImage, IMAGINGHEADER* BCAimageHeader)
+int SaveSnapshot(HWND hDlg, __int64 CurrentIteration, const Image<int>& TheImage, IMAGINGHEADER* BCAimageHeader)
 {
     // save current image using output name + iteration number
     WCHAR OutputFilename[MAX_PATH];
@@ -2143,7 +2709,7 @@ int SaveSnapshot(HWND hDlg, int CurrentIteration, int* TheImage, IMAGINGHEADER*
     // use Kernel+1
     WCHAR NewFname[_MAX_FNAME];
 
-    swprintf_s(NewFname, _MAX_FNAME, L"%s_%08d", Fname, CurrentIteration);
+    swprintf_s(NewFname, _MAX_FNAME, L"%s_%08lld", Fname, CurrentIteration);
 
     // reassemble filename
     err = _wmakepath_s(NewFilename, _MAX_PATH, Drive, Dir, NewFname, Ext);
@@ -2153,20 +2719,55 @@ int SaveSnapshot(HWND hDlg, int CurrentIteration, int* TheImage, IMAGINGHEADER*
     }
 
     int iRes;
-    iRes = SaveImageFile(hDlg, TheImage, NewFilename, BCAimageHeader);
-    if (iRes == APP_SUCCESS && IsDlgButtonChecked(hDlg, IDC_BMP_FILE) == BST_CHECKED) {
+    IMAGINGHEADER SnapshotHeader = *BCAimageHeader;
+    iRes = GetPrivateProfileInt(L"SettingsGlobalDlg", L"PackedSnapshots", 0, (LPCTSTR)strAppNameINI);
+    if (iRes != 0) {
+        // the BCA image is binary, save it 1 bit per pixel
+        SnapshotHeader.PixelSize = PIXELSIZE_1BIT;
+    }
+    iRes = SaveImageFile(hDlg, TheImage, NewFilename, &SnapshotHeader);
+    if (iRes != APP_SUCCESS) {
+        // SaveImageFile() has reported it
+        return iRes;
+    }
+    if (IsDlgButtonChecked(hDlg, IDC_BMP_FILE) == BST_CHECKED) {
         // reassemble filename
         WCHAR BMPFilename[MAX_PATH];
         err = _wmakepath_s(BMPFilename, _MAX_PATH, Drive, Dir, NewFname, L".bmp");
-        if (err == 0) {
-            iRes = SaveBMP(BMPFilename, NewFilename, FALSE, TRUE);
-            if (iRes == APP_SUCCESS) {
-                iRes = GetPrivateProfileInt(L"SettingsGlobalDlg", L"AutoPNG", 1, (LPCTSTR)strAppNameINI);
-                if (iRes != 0) {
-                    SaveBMP2PNG(BMPFilename);
-                }
-            }
+        if (err != 0) {
+            MessageBox(hDlg, L"Could not creat output filename", L"BCA save image", MB_OK);
+            return APPERR_FILEOPEN;
+        }
+        // the .bmp and .png are made from the image in memory, with the
+        // same header as the .raw file so they have the same pixels
+        iRes = SaveImage2BMP(BMPFilename, TheImage.GetPixels(), &SnapshotHeader, FALSE, TRUE, TRUE);
+        if (iRes != APP_SUCCESS) {
+            MessageMySETIBCAError(hDlg, iRes, L"Saving snapshot .bmp file");
+            return iRes;
         }
     }
     return APP_SUCCESS;
 }
+
+//*******************************************************************
+//
+// WaitSnapshotFiles
+// 
+// Wait for the snapshot .png files still being written and report the
+// first error writing them.
+// 
+// return value:
+//  1 - Success
+//  !=1 Error see standardized app error list in AppErrors.h
+// 
+//*******************************************************************
+int WaitSnapshotFiles(HWND hDlg)
+{
+    int iRes;
+
+    iRes = WaitPNG();
+    if (iRes != APP_SUCCESS) {
+        MessageMySETIBCAError(hDlg, iRes, L"Saving snapshot .png files");
+    }
+    return iRes;
+}
@@ -2,25 +2,32 @@
 // 
 // function prototypes
 //
+template <typename T> class Image;
+
 BOOL CCFileSave(HWND hWnd, LPWSTR pszCurrentFilename, LPWSTR* pszFilename,
 BOOL bSelectFolder, int NumTypes, COMDLG_FILTERSPEC* FileTypes, LPCWSTR szDefExt);
 BOOL CCFileOpen(HWND hWnd, LPWSTR pszCurrentFilename, LPWSTR* pszFilename,
 BOOL bSelectFolder, int NumTypes, COMDLG_FILTERSPEC* FileTypes, LPCWSTR szDefExt);
+int MakeImageHeader(IMAGINGHEADER* Header, int Xsize, int Ysize, int NumFrames, int PixelSize);
 int ReadImageHeader(WCHAR* Filename, IMAGINGHEADER* ImageHeader);
-int LoadImageFile(int** ImagePtr, WCHAR* ImagingFilename, IMAGINGHEADER* Header);
-int SaveImageFile(HWND hDlg, int* TheImage, WCHAR* Filename, IMAGINGHEADER* Header);
-int ReadBMPfile(int** ImagePtr, WCHAR* InputFilename, IMAGINGHEADER* ImgHeader);
+int LoadImageFile(Image<int>& Dest, WCHAR* ImagingFilename, IMAGINGHEADER* Header);
+void WidenPixels(const BYTE* Source, int* Dest, size_t NumPixels, int PixelSize, BOOL Swap);
+int SaveImageFile(HWND hDlg, const Image<int>& TheImage, WCHAR* Filename, IMAGINGHEADER* Header);
+int ReadBMPfile(Image<int>& Dest, WCHAR* InputFilename, IMAGINGHEADER* ImgHeader);
 int SaveBMP(WCHAR* Filename, WCHAR* InputFile, int RGBframes, int AutoScale);
+int SaveImage2BMP(WCHAR* Filename, const int* Image, IMAGINGHEADER* Header, int RGBframes, int AutoScale,
+    BOOL BackgroundPNG);
 int SaveTXT(WCHAR* Filename, WCHAR* InputFile);
 int HEX2Binary(HWND hWnd);
 int CamIRaImport(HWND hWnd);
 int GetFileSize(WCHAR* szString);
-int SaveBMP2PNG(WCHAR* Filename);
+int GetPNGlevel();
 int SaveImageBMP(WCHAR* Filename, COLORREF* Image, int ImageXextent, int ImageYextent);
 int SaveBYTEs2Text(WCHAR* OutputFile, BYTE* ByteStream,
     int NumBytes, int BitOrder);
 int ReadBYTEs2Text(WCHAR* InputFile, BYTE* ByteStream,
     int NumBytes, int BitOrder);
 int SaveASISbitstream(WCHAR* Filename, BYTE* Header, BYTE* MessageBody, BYTE* Footer);
-int SaveHistogramData(WCHAR* Filename, BOOL CreateNew, int Index, int* Histogram, int NumEntries);
-int SaveSnapshot(HWND hDlg, int CurrentIteration, int* TheImage, IMAGINGHEADER* BCAimageHeader);
+int SaveHistogramData(WCHAR* Filename, BOOL CreateNew, __int64 Index, int* Histogram, int NumEntries);
+int SaveSnapshot(HWND hDlg, __int64 CurrentIteration, const Image<int>& TheImage, IMAGINGHEADER* BCAimageHeader);
+int WaitSnapshotFiles(HWND hDlg);
@@ -0,0 +1,231 @@
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// FrameCache.cpp
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the definitions of the FrameCache class methods/functions
+//
+// V1.2.0	2026-10-19	Added FrameCache class, random access to the frames of .raw files
+//					A frame that can not be read no longer replaces a cached frame
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+#include "framework.h"
+#include <shtypes.h>
+#include "AppErrors.h"
+#include "imageheader.h"
+#include "ImageView.h"
+#include "FrameCache.h"
+
+//*******************************************************************************
+//
+//  FrameCache()
+//  class constructor
+//
+//*******************************************************************************
+FrameCache::FrameCache()
+{
+}
+
+//*******************************************************************************
+//
+//  ~FrameCache()
+//  class destructor
+//
+//*******************************************************************************
+FrameCache::~FrameCache()
+{
+	Close();
+}
+
+//*******************************************************************************
+//
+//  Open
+//
+// Open a .raw image file.  Only the header is read, frames are read when
+// they are asked for.
+//
+// Parameters:
+//	WCHAR* Filename		image file
+//	int MaxFrames		# of frames kept in memory, >= 1
+//
+//	return value:
+//	1 - Success
+//	!=1 Error see standardized app error list in AppErrors.h
+//		APPERR_PARAMETER if MaxFrames < 1 or the header is not valid
+//		APPERR_FILEREAD if the file is shorter than the header says
+//
+//*******************************************************************************
+int FrameCache::Open(WCHAR* Filename, int MaxFrames)
+{
+	int iRes;
+
+	Close();
+
+	if (MaxFrames < 1) {
+		return APPERR_PARAMETER;
+	}
+
+	iRes = View.Open(Filename);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	FramePixels = (size_t)View.GetXsize() * (size_t)View.GetYsize();
+	if (MaxFrames > View.GetNumFrames()) {
+		MaxFrames = View.GetNumFrames();
+	}
+	Slots.resize(MaxFrames);
+	for (size_t i = 0; i < Slots.size(); i++) {
+		Slots[i].Frame = -1;
+		Slots[i].LastUsed = 0;
+	}
+
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  Close
+//
+// Free the frames and close the file.  Frame pointers are no longer valid.
+//
+//*******************************************************************************
+void FrameCache::Close()
+{
+	Slots.clear();
+	LoadBuffer.clear();
+	FramePixels = 0;
+	UseCount = 0;
+	View.Close();
+}
+
+//*******************************************************************************
+//
+//  GetHeader, GetXsize, GetYsize, GetNumFrames
+//
+// The header of the open file, all 0 if no file is open
+//
+//*******************************************************************************
+const IMAGINGHEADER* FrameCache::GetHeader()
+{
+	return View.GetHeader();
+}
+
+int FrameCache::GetXsize()
+{
+	return View.GetXsize();
+}
+
+int FrameCache::GetYsize()
+{
+	return View.GetYsize();
+}
+
+int FrameCache::GetNumFrames()
+{
+	return View.GetNumFrames();
+}
+
+//*******************************************************************************
+//
+//  GetFrame
+//
+// A frame as (int) pixels, the same pixels LoadImageFile() returns for it.
+// If the frame is not in memory it is read and then replaces the least
+// recently used frame.  If it can not be read the cached frames are kept.
+//
+// Parameters:
+//	int Frame		frame #, from 0
+//
+//	return value:
+//	pointer to Xsize*Ysize pixels
+//	NULL if Frame is not valid or it could not be read
+//
+//*******************************************************************************
+const int* FrameCache::GetFrame(int Frame)
+{
+	if (Slots.empty() || Frame < 0 || Frame >= View.GetNumFrames()) {
+		return NULL;
+	}
+
+	UseCount++;
+
+	size_t Oldest = 0;
+	for (size_t i = 0; i < Slots.size(); i++) {
+		if (Slots[i].Frame == Frame) {
+			Slots[i].LastUsed = UseCount;
+			return Slots[i].Pixels.data();
+		}
+		if (Slots[i].LastUsed < Slots[Oldest].LastUsed) {
+			Oldest = i;
+		}
+	}
+
+	LoadBuffer.resize(FramePixels);
+	int iRes = View.WidenFrames(Frame, 1, LoadBuffer.data());
+	// the (int) pixels are kept, the file view is not needed any more
+	View.ReleaseFrame(Frame);
+	if (iRes != APP_SUCCESS) {
+		return NULL;
+	}
+
+	FRAMESLOT& Slot = Slots[Oldest];
+	Slot.Pixels.swap(LoadBuffer);
+	Slot.Frame = Frame;
+	Slot.LastUsed = UseCount;
+	return Slot.Pixels.data();
+}
+
+//*******************************************************************************
+//
+//  Frames
+//
+// A range of frames for a range based for loop, each frame is read with
+// GetFrame() as the loop gets to it.
+//
+// Parameters:
+//	int FirstFrame		first frame #, from 0
+//	int NumFrames		# of frames
+//
+//	return value:
+//	the frames FirstFrame to FirstFrame+NumFrames-1 that are in the file
+//
+//*******************************************************************************
+FrameCache::Range FrameCache::Frames(int FirstFrame, int NumFrames)
+{
+	int EndFrame;
+
+	if (FirstFrame < 0) {
+		NumFrames += FirstFrame;
+		FirstFrame = 0;
+	}
+	if (FirstFrame > View.GetNumFrames()) {
+		FirstFrame = View.GetNumFrames();
+	}
+	if (NumFrames < 0) {
+		NumFrames = 0;
+	}
+	if (NumFrames > View.GetNumFrames() - FirstFrame) {
+		NumFrames = View.GetNumFrames() - FirstFrame;
+	}
+	EndFrame = FirstFrame + NumFrames;
+
+	return Range(this, FirstFrame, EndFrame);
+}
@@ -0,0 +1,106 @@
+#pragma once
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// FrameCache.h
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+// V1.2.0	2026-10-19	Added FrameCache class, random access to the frames of .raw files
+//					A frame that can not be read no longer replaces a cached frame
+//
+//	A .raw file can have up to 32767 frames.  FrameCache reads one frame at a
+//	time through an ImageView and keeps the last MaxFrames frames used as
+//	(int) pixels, like LoadImageFile() returns them.  Only MaxFrames frames
+//	are ever in memory, no matter how many frames the file has.
+//
+//	A pointer from GetFrame() is valid until MaxFrames other frames have been
+//	asked for, or Close().
+//
+//	Streaming through frames:
+//		for (CACHEDFRAME Frame : Cache.Frames(First, NumFrames)) {
+//			if (Frame.Pixels == NULL) ...	// read error
+//		}
+//
+//	Not for use from more than one thread at a time.
+//
+#include "framework.h"
+#include <vector>
+#include "imageheader.h"
+#include "ImageView.h"
+
+#define FRAMECACHE_FRAMES 8		// default # of frames kept in memory
+
+typedef struct {
+	int Frame;				// frame #, from 0
+	const int* Pixels;		// Xsize*Ysize pixels, NULL if the frame could not be read
+} CACHEDFRAME;
+
+class FrameCache {
+private:
+	typedef struct {
+		int Frame;					// frame # in this slot, -1 if not used
+		unsigned __int64 LastUsed;	// UseCount when the frame was last asked for
+		std::vector<int> Pixels;
+	} FRAMESLOT;
+
+	ImageView View;
+	std::vector<FRAMESLOT> Slots;
+	std::vector<int> LoadBuffer;	// a frame is read here, then swapped into its slot
+	size_t FramePixels = 0;
+	unsigned __int64 UseCount = 0;
+
+public:
+	class Iterator {
+	private:
+		FrameCache* Cache;
+		int Frame;
+	public:
+		Iterator(FrameCache* Cache, int Frame) : Cache(Cache), Frame(Frame) {}
+		CACHEDFRAME operator*() const { return { Frame, Cache->GetFrame(Frame) }; }
+		Iterator& operator++() { Frame++; return *this; }
+		bool operator!=(const Iterator& Other) const { return Frame != Other.Frame; }
+	};
+
+	class Range {
+	private:
+		FrameCache* Cache;
+		int FirstFrame;
+		int EndFrame;
+	public:
+		Range(FrameCache* Cache, int FirstFrame, int EndFrame) :
+			Cache(Cache), FirstFrame(FirstFrame), EndFrame(EndFrame) {}
+		Iterator begin() const { return Iterator(Cache, FirstFrame); }
+		Iterator end() const { return Iterator(Cache, EndFrame); }
+	};
+
+	FrameCache();
+	~FrameCache();
+
+	int Open(WCHAR* Filename, int MaxFrames = FRAMECACHE_FRAMES);
+	void Close();
+
+	const IMAGINGHEADER* GetHeader();
+	int GetXsize();
+	int GetYsize();
+	int GetNumFrames();
+
+	const int* GetFrame(int Frame);
+	Range Frames(int FirstFrame, int NumFrames);
+};
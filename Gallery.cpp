@@ -0,0 +1,566 @@
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// Gallery.cpp
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the bitstream parameter sweep gallery
+//
+// V1.2.0	2026-10-19	Added bitstream parameter sweep gallery
+//					.png files are written with PNGwriter instead of GDI+
+//					LoadBigEndian64(), ReverseBits32() and ReverseByte[] are shared from BitOrder.h
+//					SaveGalleryRaw() makes the .raw header with MakeImageHeader()
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+//	The gallery converts the start of a packed bitstream file to an image for
+//	every combination of prologue size, x size, bit depth, bit order, input bit
+//	order and invert in a parameter grid, the same conversion as BitImageDlg
+//	does for one block.  The file is read once, the images are made from the
+//	bytes in memory on a pool of worker threads, one per processor.
+//
+//	Each image gets a structure score, how much more often a pixel is the same
+//	as the pixel below it than it would be by chance (Cohen's kappa).  When the
+//	x size is right the rows line up and the score is high.
+//
+//	Output files in the output directory, Name is the base name:
+//		Name.csv						images ranked by score
+//		Name_mosaic.raw, .png			the top left of each image, best score first
+//		Name_p#_x#_d#_o#_i#_n#.raw, .png	each image (optional), p prologue, x x size,
+//										d bit depth, o bit order, i input bit order,
+//										n invert
+//
+#include "framework.h"
+#include <stdio.h>
+#include <vector>
+#include <algorithm>
+#include <atlstr.h>
+#include "AppErrors.h"
+#include "Appfunctions.h"
+#include "imageheader.h"
+#include "FileFunctions.h"
+#include "PNGwriter.h"
+#include "BitOrder.h"
+#include "Gallery.h"
+
+// shared by the gallery worker threads
+typedef struct {
+	GALLERYPARAM* Param;
+	GALLERYTILE* Tiles;
+	LONG NumTiles;
+	volatile LONG NextTile;		// next image to make
+	BYTE* Bits;					// file bytes, MSB first, 8 zero bytes after
+	BYTE* ReversedBits;			// file bytes with the bits in each byte reversed, LSB first files
+	__int64 NumBits;			// # of bits in Bits
+	BYTE* Cells;				// mosaic cell for each image, CellSize x CellSize
+	WCHAR* OutputDir;
+	WCHAR* BaseName;
+	int PNGlevel;				// deflate level of the .png files
+} GALLERYWORK;
+
+static int MakeGalleryTile(GALLERYWORK* Work, LONG Index);
+static int SaveGalleryRaw(WCHAR* Filename, int Xsize, int Ysize, int PixelSize, void* Pixels);
+static int SaveGalleryPNG(WCHAR* Filename, int Level, int Xsize, int Ysize, BYTE* Grey);
+static int CountRange(GALLERYRANGE* Range);
+static DWORD WINAPI GalleryProc(LPVOID Param);
+
+//*******************************************************************************
+//
+//  SweepGallery
+//
+// Make an image for each combination in a parameter grid
+//
+// Parameters:
+//	WCHAR* InputFile		packed bitstream file
+//	WCHAR* OutputDir		directory for the output files
+//	WCHAR* BaseName			base name of the output files
+//	GALLERYPARAM* Param		parameter grid and output options
+//	std::vector<GALLERYTILE>& Tiles	returns the images, best score first.
+//							Images with a Status != APP_SUCCESS are last,
+//							they are not in the mosaic.
+//
+//	return value:
+//	1 - Success, the status of each image is in Tiles
+//	!=1 Error see standardized app error list in AppErrors.h
+//
+//*******************************************************************************
+int SweepGallery(WCHAR* InputFile, WCHAR* OutputDir, WCHAR* BaseName, GALLERYPARAM* Param,
+	std::vector<GALLERYTILE>& Tiles)
+{
+	GALLERYWORK Work;
+	GALLERYRANGE* Ranges[6] = { &Param->PrologueSize, &Param->Xsize, &Param->BitDepth,
+		&Param->BitOrder, &Param->InputBitOrder, &Param->Invert };
+	__int64 NumCombinations = 1;
+	int LastPrologue = 0;
+	int iRes = APP_SUCCESS;
+	errno_t err;
+
+	Tiles.clear();
+	if (Param->PrologueSize.First < 0 || Param->Xsize.First < 1 ||
+		Param->BitDepth.First < 1 || Param->BitDepth.Last > GALLERY_MAX_BIT_DEPTH ||
+		Param->BitOrder.First < 0 || Param->BitOrder.Last > 1 ||
+		Param->InputBitOrder.First < 0 || Param->InputBitOrder.Last > 1 ||
+		Param->Invert.First < 0 || Param->Invert.Last > 1 ||
+		Param->BlockHeaderBits < 0 || Param->NumBlockBodyBits < 1 ||
+		Param->CellSize < 1 || Param->CellSize > GALLERY_MAX_CELL_SIZE || Param->Columns < 1) {
+		return APPERR_PARAMETER;
+	}
+	for (int i = 0; i < 6; i++) {
+		int Count = CountRange(Ranges[i]);
+		if (Count < 1) {
+			return APPERR_PARAMETER;
+		}
+		NumCombinations *= Count;
+		if (NumCombinations > GALLERY_MAX_TILES * 2) {
+			return APPERR_PARAMETER;
+		}
+	}
+
+	// the parameter grid, bit order does not change a 1 bit image
+	for (int p = Param->PrologueSize.First; p <= Param->PrologueSize.Last; p += Param->PrologueSize.Step) {
+		for (int x = Param->Xsize.First; x <= Param->Xsize.Last; x += Param->Xsize.Step) {
+			for (int d = Param->BitDepth.First; d <= Param->BitDepth.Last; d += Param->BitDepth.Step) {
+				for (int o = Param->BitOrder.First; o <= Param->BitOrder.Last; o += Param->BitOrder.Step) {
+					if (d == 1 && o != Param->BitOrder.First) {
+						continue;
+					}
+					for (int i = Param->InputBitOrder.First; i <= Param->InputBitOrder.Last; i += Param->InputBitOrder.Step) {
+						for (int n = Param->Invert.First; n <= Param->Invert.Last; n += Param->Invert.Step) {
+							GALLERYTILE Tile;
+
+							Tile.PrologueSize = p;
+							Tile.Xsize = x;
+							Tile.Ysize = Param->NumBlockBodyBits / (x * d);
+							Tile.BitDepth = d;
+							Tile.BitOrder = o;
+							Tile.InputBitOrder = i;
+							Tile.Invert = n;
+							Tile.Score = 0.0;
+							Tile.Status = APP_SUCCESS;
+							Tiles.push_back(Tile);
+							LastPrologue = p;
+						}
+					}
+				}
+			}
+		}
+	}
+	if (Tiles.size() > GALLERY_MAX_TILES) {
+		Tiles.clear();
+		return APPERR_PARAMETER;
+	}
+
+	// the file is read once, up to the end of the image with the largest prologue
+	FILE* In;
+	__int64 FileSize;
+	__int64 LastBit = (__int64)LastPrologue + Param->BlockHeaderBits + Param->NumBlockBodyBits;
+	size_t NumBytes;
+
+	_wfopen_s(&In, InputFile, L"rb");
+	if (In == NULL) {
+		Tiles.clear();
+		return APPERR_FILEOPEN;
+	}
+	_fseeki64(In, 0, SEEK_END);
+	FileSize = _ftelli64(In);
+	_fseeki64(In, 0, SEEK_SET);
+	NumBytes = (size_t)((LastBit + 7) / 8 < FileSize ? (LastBit + 7) / 8 : FileSize);
+
+	Work.Bits = new BYTE[NumBytes + 8];
+	if (Work.Bits == nullptr) {
+		fclose(In);
+		Tiles.clear();
+		return APPERR_MEMALLOC;
+	}
+	if (fread(Work.Bits, 1, NumBytes, In) != NumBytes) {
+		fclose(In);
+		delete[] Work.Bits;
+		Tiles.clear();
+		return APPERR_FILEREAD;
+	}
+	fclose(In);
+	memset(Work.Bits + NumBytes, 0, 8);
+	Work.NumBits = (__int64)NumBytes * 8;
+
+	Work.ReversedBits = nullptr;
+	if (Param->InputBitOrder.Last == 1) {
+		Work.ReversedBits = new BYTE[NumBytes + 8];
+		if (Work.ReversedBits == nullptr) {
+			delete[] Work.Bits;
+			Tiles.clear();
+			return APPERR_MEMALLOC;
+		}
+		for (size_t i = 0; i < NumBytes + 8; i++) {
+			Work.ReversedBits[i] = ReverseByte[Work.Bits[i]];
+		}
+	}
+
+	Work.Cells = new BYTE[Tiles.size() * Param->CellSize * Param->CellSize];
+	if (Work.Cells == nullptr) {
+		delete[] Work.Bits;
+		if (Work.ReversedBits != nullptr) delete[] Work.ReversedBits;
+		Tiles.clear();
+		return APPERR_MEMALLOC;
+	}
+
+	Work.Param = Param;
+	Work.Tiles = Tiles.data();
+	Work.NumTiles = (LONG)Tiles.size();
+	Work.NextTile = 0;
+	Work.OutputDir = OutputDir;
+	Work.BaseName = BaseName;
+
+	Work.PNGlevel = GetPNGlevel();
+
+	SYSTEM_INFO SysInfo;
+	int NumThreads;
+
+	GetSystemInfo(&SysInfo);
+	NumThreads = (int)SysInfo.dwNumberOfProcessors;
+	if (NumThreads > MAXIMUM_WAIT_OBJECTS) NumThreads = MAXIMUM_WAIT_OBJECTS;
+	if (NumThreads > (int)Work.NumTiles) NumThreads = (int)Work.NumTiles;
+	if (NumThreads < 1) NumThreads = 1;
+
+	std::vector<HANDLE> Threads(NumThreads);
+	int Started = 0;
+	for (int t = 0; t < NumThreads; t++) {
+		Threads[t] = CreateThread(NULL, 0, GalleryProc, &Work, 0, NULL);
+		if (Threads[t] == NULL) {
+			break;
+		}
+		Started++;
+	}
+	if (Started == 0) {
+		// no threads, make them all here
+		GalleryProc(&Work);
+	}
+	for (int t = 0; t < Started; t++) {
+		WaitForSingleObject(Threads[t], INFINITE);
+		CloseHandle(Threads[t]);
+	}
+	delete[] Work.Bits;
+	if (Work.ReversedBits != nullptr) delete[] Work.ReversedBits;
+
+	// rank, best score first, the images that could not be made last
+	std::vector<int> Rank(Tiles.size());
+	for (size_t i = 0; i < Tiles.size(); i++) {
+		Rank[i] = (int)i;
+	}
+	std::stable_sort(Rank.begin(), Rank.end(), [&Tiles](int a, int b) {
+		if ((Tiles[a].Status == APP_SUCCESS) != (Tiles[b].Status == APP_SUCCESS)) {
+			return Tiles[a].Status == APP_SUCCESS;
+		}
+		return Tiles[a].Score > Tiles[b].Score;
+	});
+
+	// mosaic of the images in rank order
+	int NumCells = 0;
+	for (size_t i = 0; i < Tiles.size(); i++) {
+		if (Tiles[i].Status == APP_SUCCESS) {
+			NumCells++;
+		}
+	}
+	WCHAR Filename[MAX_PATH];
+	WCHAR Fname[_MAX_FNAME];
+
+	if (NumCells != 0) {
+		int CellSize = Param->CellSize;
+		int Columns = (NumCells < Param->Columns) ? NumCells : Param->Columns;
+		int Rows = (NumCells + Columns - 1) / Columns;
+		int MosaicX = Columns * (CellSize + GALLERY_GAP) + GALLERY_GAP;
+		int MosaicY = Rows * (CellSize + GALLERY_GAP) + GALLERY_GAP;
+		BYTE* Mosaic = new BYTE[(size_t)MosaicX * MosaicY];
+
+		if (Mosaic == nullptr) {
+			iRes = APPERR_MEMALLOC;
+		}
+		else {
+			memset(Mosaic, 128, (size_t)MosaicX * MosaicY);
+			for (int Cell = 0; Cell < NumCells; Cell++) {
+				BYTE* Source = Work.Cells + (size_t)Rank[Cell] * CellSize * CellSize;
+				int x0 = GALLERY_GAP + (Cell % Columns) * (CellSize + GALLERY_GAP);
+				int y0 = GALLERY_GAP + (Cell / Columns) * (CellSize + GALLERY_GAP);
+				for (int y = 0; y < CellSize; y++) {
+					memcpy(&Mosaic[(size_t)(y0 + y) * MosaicX + x0], &Source[(size_t)y * CellSize], CellSize);
+				}
+			}
+
+			swprintf_s(Fname, _MAX_FNAME, L"%s_mosaic", BaseName);
+			err = _wmakepath_s(Filename, MAX_PATH, NULL, OutputDir, Fname, L".raw");
+			if (err != 0) {
+				iRes = APPERR_PARAMETER;
+			}
+			else {
+				iRes = SaveGalleryRaw(Filename, MosaicX, MosaicY, 1, Mosaic);
+			}
+			if (iRes == APP_SUCCESS && Param->SavePNGfiles) {
+				err = _wmakepath_s(Filename, MAX_PATH, NULL, OutputDir, Fname, L".png");
+				if (err != 0) {
+					iRes = APPERR_PARAMETER;
+				}
+				else {
+					iRes = SaveGalleryPNG(Filename, Work.PNGlevel, MosaicX, MosaicY, Mosaic);
+				}
+			}
+			delete[] Mosaic;
+		}
+	}
+	delete[] Work.Cells;
+
+	// the images in rank order
+	std::vector<GALLERYTILE> Ranked(Tiles.size());
+	for (size_t i = 0; i < Tiles.size(); i++) {
+		Ranked[i] = Tiles[Rank[i]];
+	}
+	Tiles.swap(Ranked);
+
+	// summary
+	if (iRes == APP_SUCCESS) {
+		FILE* Out;
+
+		err = _wmakepath_s(Filename, MAX_PATH, NULL, OutputDir, BaseName, L".csv");
+		if (err != 0) {
+			return APPERR_PARAMETER;
+		}
+		_wfopen_s(&Out, Filename, L"w");
+		if (Out == NULL) {
+			return APPERR_FILEOPEN;
+		}
+		fprintf(Out, "Rank, Score, Prologue, X size, Y size, Bit depth, Bit order, Input bit order, Invert, Status\n");
+		for (size_t i = 0; i < Tiles.size(); i++) {
+			fprintf(Out, "%zu, %.4f, %d, %d, %d, %d, %d, %d, %d, %d\n", i + 1, Tiles[i].Score,
+				Tiles[i].PrologueSize, Tiles[i].Xsize, Tiles[i].Ysize, Tiles[i].BitDepth,
+				Tiles[i].BitOrder, Tiles[i].InputBitOrder, Tiles[i].Invert, Tiles[i].Status);
+		}
+		if (ferror(Out)) {
+			iRes = APPERR_FILEWRITE;
+		}
+		fclose(Out);
+	}
+
+	return iRes;
+}
+
+//*******************************************************************************
+//
+//  CountRange
+//
+// # of values in a range, 0 if the range is not valid
+//
+//*******************************************************************************
+static int CountRange(GALLERYRANGE* Range)
+{
+	if (Range->Step < 1 || Range->Last < Range->First) {
+		return 0;
+	}
+	return (Range->Last - Range->First) / Range->Step + 1;
+}
+
+//*******************************************************************************
+//
+//  GalleryProc
+//
+// Worker thread, makes images until there are none left
+//
+//*******************************************************************************
+static DWORD WINAPI GalleryProc(LPVOID Param)
+{
+	GALLERYWORK* Work = (GALLERYWORK*)Param;
+	LONG Next;
+
+	while ((Next = InterlockedIncrement(&Work->NextTile) - 1) < Work->NumTiles) {
+		Work->Tiles[Next].Status = MakeGalleryTile(Work, Next);
+	}
+	return 0;
+}
+
+//*******************************************************************************
+//
+//  MakeGalleryTile
+//
+// Make one image, score it, fill in its mosaic cell and save its files
+//
+//*******************************************************************************
+static int MakeGalleryTile(GALLERYWORK* Work, LONG Index)
+{
+	GALLERYTILE* Tile = &Work->Tiles[Index];
+	GALLERYPARAM* Param = Work->Param;
+	BYTE* Bits = Tile->InputBitOrder ? Work->ReversedBits : Work->Bits;
+	BYTE* Cell = Work->Cells + (size_t)Index * Param->CellSize * Param->CellSize;
+	int BitDepth = Tile->BitDepth;
+	int MaxValue = (1 << BitDepth) - 1;
+	unsigned int InvertMask = Tile->Invert ? (unsigned int)MaxValue : 0;
+	__int64 FirstBit = (__int64)Tile->PrologueSize + Param->BlockHeaderBits;
+	size_t NumPixels = (size_t)Tile->Xsize * Tile->Ysize;
+	int iRes = APP_SUCCESS;
+
+	memset(Cell, 0, (size_t)Param->CellSize * Param->CellSize);
+	if (Tile->Ysize < 1) {
+		return APPERR_PARAMETER;
+	}
+	if (FirstBit + (__int64)NumPixels * BitDepth > Work->NumBits) {
+		return APPERR_FILESIZE;
+	}
+
+	unsigned short* Pixels = new unsigned short[NumPixels];
+	if (Pixels == nullptr) {
+		return APPERR_MEMALLOC;
+	}
+	std::vector<int> Histogram((size_t)MaxValue + 1, 0);
+
+	// same pixels as BitStream2Image(), the first bit of a pixel is its LSB
+	// unless the bit order is MSB to LSB
+	for (size_t i = 0; i < NumPixels; i++) {
+		__int64 Bit = FirstBit + (__int64)i * BitDepth;
+		unsigned __int64 Word = LoadBigEndian64(Bits + (Bit >> 3)) << (Bit & 7);
+		unsigned int Value = (unsigned int)(Word >> (64 - BitDepth)) ^ InvertMask;
+
+		if (!Tile->BitOrder && BitDepth > 1) {
+			Value = ReverseBits32(Value) >> (32 - BitDepth);
+		}
+		Pixels[i] = (unsigned short)Value;
+		Histogram[Value]++;
+	}
+
+	// structure score, pixels the same as the pixel below them compared to chance
+	__int64 Same = 0;
+	size_t NumPairs = NumPixels - Tile->Xsize;
+	for (size_t i = 0; i < NumPairs; i++) {
+		if (Pixels[i] == Pixels[i + Tile->Xsize]) {
+			Same++;
+		}
+	}
+	double Chance = 0.0;
+	for (int v = 0; v <= MaxValue; v++) {
+		double Fraction = (double)Histogram[v] / (double)NumPixels;
+		Chance += Fraction * Fraction;
+	}
+	if (NumPairs == 0 || Chance >= 1.0) {
+		// one row or all pixels the same
+		Tile->Score = 0.0;
+	}
+	else {
+		Tile->Score = ((double)Same / (double)NumPairs - Chance) / (1.0 - Chance);
+	}
+
+	// greyscale image for the mosaic cell and the .png file
+	BYTE* Grey = new BYTE[NumPixels];
+	if (Grey == nullptr) {
+		delete[] Pixels;
+		return APPERR_MEMALLOC;
+	}
+	for (size_t i = 0; i < NumPixels; i++) {
+		Grey[i] = (BYTE)((Pixels[i] * 255) / MaxValue);
+	}
+	for (int y = 0; y < Param->CellSize && y < Tile->Ysize; y++) {
+		memcpy(&Cell[(size_t)y * Param->CellSize], &Grey[(size_t)y * Tile->Xsize],
+			(Param->CellSize < Tile->Xsize) ? Param->CellSize : Tile->Xsize);
+	}
+
+	if (Param->SaveRawFiles || Param->SavePNGfiles) {
+		WCHAR Filename[MAX_PATH];
+		WCHAR Fname[_MAX_FNAME];
+		errno_t err;
+
+		swprintf_s(Fname, _MAX_FNAME, L"%s_p%d_x%d_d%d_o%d_i%d_n%d", Work->BaseName, Tile->PrologueSize,
+			Tile->Xsize, BitDepth, Tile->BitOrder, Tile->InputBitOrder, Tile->Invert);
+
+		if (Param->SaveRawFiles) {
+			err = _wmakepath_s(Filename, MAX_PATH, NULL, Work->OutputDir, Fname, L".raw");
+			if (err != 0) {
+				iRes = APPERR_PARAMETER;
+			}
+			else if (BitDepth <= 8) {
+				// pixels are bytes
+				for (size_t i = 0; i < NumPixels; i++) {
+					((BYTE*)Pixels)[i] = (BYTE)Pixels[i];
+				}
+				iRes = SaveGalleryRaw(Filename, Tile->Xsize, Tile->Ysize, 1, Pixels);
+			}
+			else {
+				iRes = SaveGalleryRaw(Filename, Tile->Xsize, Tile->Ysize, 2, Pixels);
+			}
+		}
+		if (iRes == APP_SUCCESS && Param->SavePNGfiles) {
+			err = _wmakepath_s(Filename, MAX_PATH, NULL, Work->OutputDir, Fname, L".png");
+			if (err != 0) {
+				iRes = APPERR_PARAMETER;
+			}
+			else {
+				iRes = SaveGalleryPNG(Filename, Work->PNGlevel, Tile->Xsize, Tile->Ysize, Grey);
+			}
+		}
+	}
+
+	delete[] Pixels;
+	delete[] Grey;
+	return iRes;
+}
+
+//*******************************************************************************
+//
+//  SaveGalleryRaw
+//
+// Save a one frame .raw image file, called from the worker threads.
+// The pixels are written as they are, PixelSize 1 or 2.
+//
+//*******************************************************************************
+static int SaveGalleryRaw(WCHAR* Filename, int Xsize, int Ysize, int PixelSize, void* Pixels)
+{
+	IMAGINGHEADER ImgHeader;
+	size_t NumPixels = (size_t)Xsize * Ysize;
+	FILE* Out;
+	int iRes;
+
+	iRes = MakeImageHeader(&ImgHeader, Xsize, Ysize, 1, PixelSize);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	_wfopen_s(&Out, Filename, L"wb");
+	if (Out == NULL) {
+		return APPERR_FILEOPEN;
+	}
+	if (fwrite(&ImgHeader, sizeof(IMAGINGHEADER), 1, Out) != 1 ||
+		fwrite(Pixels, PixelSize, NumPixels, Out) != NumPixels) {
+		iRes = APPERR_FILEWRITE;
+	}
+	fclose(Out);
+
+	return iRes;
+}
+
+//*******************************************************************************
+//
+//  SaveGalleryPNG
+//
+// Save a greyscale image as a .png file, called from the worker threads
+//
+//*******************************************************************************
+static int SaveGalleryPNG(WCHAR* Filename, int Level, int Xsize, int Ysize, BYTE* Grey)
+{
+	PNGIMAGE Image;
+
+	Image.Xsize = Xsize;
+	Image.Ysize = Ysize;
+	Image.Format = PNG_GREY8;
+	Image.Stride = (size_t)Xsize;
+	Image.Pixels = Grey;
+
+	return SavePNG(Filename, &Image, Level);
+}
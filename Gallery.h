@@ -0,0 +1,72 @@
+#pragma once
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// Gallery.h
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+// V1.2.0	2026-10-19	Added bitstream parameter sweep gallery
+//
+#include "framework.h"
+#include <vector>
+
+#define GALLERY_MAX_TILES 1024		// most parameter combinations in a sweep
+#define GALLERY_MAX_BIT_DEPTH 16	// largest image bit depth in a sweep
+#define GALLERY_MAX_CELL_SIZE 512	// largest mosaic cell
+#define GALLERY_GAP 2				// # of pixels between the mosaic cells
+
+// values First, First+Step, ... up to Last
+typedef struct {
+	int First;
+	int Last;
+	int Step;
+} GALLERYRANGE;
+
+// parameter grid, the same parameters as BitImageDlg
+typedef struct {
+	GALLERYRANGE PrologueSize;	// # of bits skipped before the block header
+	GALLERYRANGE Xsize;			// # of pixels in a row
+	GALLERYRANGE BitDepth;		// # of bits per pixel, 1 to GALLERY_MAX_BIT_DEPTH
+	GALLERYRANGE BitOrder;		// 0 - LSB to MSB, 1 - MSB to LSB, only used if BitDepth > 1
+	GALLERYRANGE InputBitOrder;	// 1 - bytes in the file are LSB first
+	GALLERYRANGE Invert;		// 1 - invert the bits
+	int BlockHeaderBits;		// # of bits skipped after the prologue
+	int NumBlockBodyBits;		// # of bits in the image, Ysize = NumBlockBodyBits/(Xsize*BitDepth)
+	int CellSize;				// mosaic cell size, the top left CellSize x CellSize of each image
+	int Columns;				// # of cells in a mosaic row
+	BOOL SaveRawFiles;			// TRUE save a .raw file for each image
+	BOOL SavePNGfiles;			// TRUE save a .png file for each image and the mosaic
+} GALLERYPARAM;
+
+// one image in the gallery
+typedef struct {
+	int PrologueSize;
+	int Xsize;
+	int Ysize;
+	int BitDepth;
+	int BitOrder;
+	int InputBitOrder;
+	int Invert;
+	double Score;		// structure score, 1 every row the same as the row above, 0 random
+	int Status;			// APP_SUCCESS or the error for this image
+} GALLERYTILE;
+
+int SweepGallery(WCHAR* InputFile, WCHAR* OutputDir, WCHAR* BaseName, GALLERYPARAM* Param,
+	std::vector<GALLERYTILE>& Tiles);
@@ -0,0 +1,399 @@
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// HexDecode.cpp
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the hex text to binary file decoder
+//
+// V1.2.0	2026-10-19	Added hex text decoder
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+//	The hex text is pairs of hex digits, upper or lower case, each pair is a
+//	byte.  Bytes can be separated by white space or , ; : -, the same as
+//	fscanf_s("%2x") a run of digits is split into pairs from the start and a
+//	single digit at the end of a run is a byte by itself.  Any other
+//	character is an error, its line and column are returned.  The output
+//	file has the bytes before the error.
+//
+//	The input is read HEXDECODE_BUFFER bytes at a time.  The digits and
+//	separators in each 16 bytes are found and converted to nibbles with SSE2,
+//	16 digits in a row are packed into 8 bytes with SSE2.  The bytes are
+//	written HEXDECODE_BUFFER at a time.
+//
+//	HexFile2Binary() has no user interface so it can be used from batch
+//	code as well as HEX2Binary() in FileFunctions.cpp.
+//
+#include "framework.h"
+#include <stdio.h>
+#include "AppErrors.h"
+#include "HexDecode.h"
+
+// SSE2 is in every x64 processor and is the default for x86 builds
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define HEXDECODE_SSE2
+#endif
+
+// decoder state, carried from one input buffer to the next
+typedef struct {
+	FILE* Output;
+	BYTE* OutBuffer;			// HEXDECODE_BUFFER bytes
+	size_t OutBytes;			// # of bytes in OutBuffer
+	BOOL Pending;				// TRUE High is the first digit of a byte
+	BYTE High;
+	__int64 Line;				// current line #, from 1
+	__int64 LineStart;			// file offset of the first character of the line
+	HEXDECODEINFO* Info;
+} HEXSTATE;
+
+static int DecodeHex(HEXSTATE* State, const BYTE* Text, size_t Size, __int64 Offset);
+static int FlushHex(HEXSTATE* State);
+
+//*******************************************************************************
+//
+//  HexNibble
+//
+// value of a hex digit, -1 for a separator, -2 for anything else
+//
+//*******************************************************************************
+static inline int HexNibble(BYTE c)
+{
+	if ((unsigned)(c - '0') <= 9) {
+		return c - '0';
+	}
+	if ((unsigned)((c | 0x20) - 'a') <= 5) {
+		return (c | 0x20) - 'a' + 10;
+	}
+	if (c == ' ' || (unsigned)(c - '\t') <= (unsigned)('\r' - '\t') ||
+		c == ',' || c == ';' || c == ':' || c == '-') {
+		return -1;
+	}
+	return -2;
+}
+
+//*******************************************************************************
+//
+//  PutHexByte
+//
+//*******************************************************************************
+static inline int PutHexByte(HEXSTATE* State, BYTE Byte)
+{
+	State->OutBuffer[State->OutBytes++] = Byte;
+	if (State->OutBytes == HEXDECODE_BUFFER) {
+		return FlushHex(State);
+	}
+	return APP_SUCCESS;
+}
+
+#ifdef HEXDECODE_SSE2
+//*******************************************************************************
+//
+//  CountLeadingZeros32
+//
+// # of 0 bits before the first 1 bit.  Word must not be 0.
+//
+//*******************************************************************************
+static inline int CountLeadingZeros32(unsigned int Word)
+{
+#if defined(_MSC_VER)
+	unsigned long Index;
+	_BitScanReverse(&Index, Word);
+	return 31 - (int)Index;
+#else
+	return __builtin_clz(Word);
+#endif
+}
+
+//*******************************************************************************
+//
+//  PopCount32
+//
+//*******************************************************************************
+static inline int PopCount32(unsigned int Word)
+{
+	int Count = 0;
+
+	while (Word != 0) {
+		Word &= Word - 1;
+		Count++;
+	}
+	return Count;
+}
+#endif
+
+//*******************************************************************************
+//
+//  HexFile2Binary
+//
+// Convert a hex text file to a binary file
+//
+// Parameters:
+//	WCHAR* InputFile		hex text file
+//	WCHAR* OutputFile		binary file
+//	HEXDECODEINFO* Info		returns the # of bytes written, and where the
+//							error is if the text has a character that is
+//							not a hex digit or separator
+//
+//	return value:
+//	1 - Success
+//	!=1 Error see standardized app error list in AppErrors.h
+//		APPERR_FILETYPE the text has a character that is not a hex digit
+//		or separator, the output file has the bytes before it
+//
+//*******************************************************************************
+int HexFile2Binary(WCHAR* InputFile, WCHAR* OutputFile, HEXDECODEINFO* Info)
+{
+	FILE* Input;
+	HEXSTATE State;
+	BYTE* InBuffer;
+	__int64 Offset = 0;
+	int iRes = APP_SUCCESS;
+
+	Info->NumBytes = 0;
+	Info->Line = 0;
+	Info->Column = 0;
+	Info->Char = 0;
+
+	_wfopen_s(&Input, InputFile, L"rb");
+	if (Input == NULL) {
+		return APPERR_FILEOPEN;
+	}
+	_wfopen_s(&State.Output, OutputFile, L"wb");
+	if (State.Output == NULL) {
+		fclose(Input);
+		return APPERR_FILEOPEN;
+	}
+
+	InBuffer = new BYTE[HEXDECODE_BUFFER];
+	State.OutBuffer = new BYTE[HEXDECODE_BUFFER];
+	if (InBuffer == nullptr || State.OutBuffer == nullptr) {
+		if (InBuffer != nullptr) delete[] InBuffer;
+		if (State.OutBuffer != nullptr) delete[] State.OutBuffer;
+		fclose(Input);
+		fclose(State.Output);
+		return APPERR_MEMALLOC;
+	}
+	State.OutBytes = 0;
+	State.Pending = FALSE;
+	State.High = 0;
+	State.Line = 1;
+	State.LineStart = 0;
+	State.Info = Info;
+
+	while (iRes == APP_SUCCESS) {
+		size_t Size = fread(InBuffer, 1, HEXDECODE_BUFFER, Input);
+		size_t Skip = 0;
+
+		if (Size == 0) {
+			if (ferror(Input)) {
+				iRes = APPERR_FILEREAD;
+			}
+			break;
+		}
+		// UTF-8 byte order mark
+		if (Offset == 0 && Size >= 3 && InBuffer[0] == 0xEF && InBuffer[1] == 0xBB && InBuffer[2] == 0xBF) {
+			Skip = 3;
+			State.LineStart = 3;
+		}
+		iRes = DecodeHex(&State, InBuffer + Skip, Size - Skip, Offset + Skip);
+		Offset += Size;
+	}
+
+	// a single digit at the end is a byte
+	if (iRes == APP_SUCCESS && State.Pending) {
+		iRes = PutHexByte(&State, State.High);
+	}
+	if (iRes == APP_SUCCESS || iRes == APPERR_FILETYPE) {
+		int Flush = FlushHex(&State);
+		if (iRes == APP_SUCCESS) {
+			iRes = Flush;
+		}
+	}
+
+	delete[] InBuffer;
+	delete[] State.OutBuffer;
+	fclose(Input);
+	fclose(State.Output);
+
+	return iRes;
+}
+
+//*******************************************************************************
+//
+//  FlushHex
+//
+// Write the bytes in the output buffer
+//
+//*******************************************************************************
+static int FlushHex(HEXSTATE* State)
+{
+	if (State->OutBytes != 0) {
+		if (fwrite(State->OutBuffer, 1, State->OutBytes, State->Output) != State->OutBytes) {
+			return APPERR_FILEWRITE;
+		}
+		State->Info->NumBytes += State->OutBytes;
+		State->OutBytes = 0;
+	}
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  DecodeHex
+//
+// Decode one input buffer
+//
+// Parameters:
+//	HEXSTATE* State			decoder state
+//	const BYTE* Text		input buffer
+//	size_t Size				# of bytes in Text
+//	__int64 Offset			file offset of Text[0]
+//
+//*******************************************************************************
+static int DecodeHex(HEXSTATE* State, const BYTE* Text, size_t Size, __int64 Offset)
+{
+	size_t i = 0;
+	int iRes;
+
+#ifdef HEXDECODE_SSE2
+	const __m128i Zero = _mm_set1_epi8('0');
+	const __m128i LowerA = _mm_set1_epi8('a');
+	const __m128i Case = _mm_set1_epi8(0x20);
+	const __m128i Nine = _mm_set1_epi8(9);
+	const __m128i Five = _mm_set1_epi8(5);
+	const __m128i Ten = _mm_set1_epi8(10);
+	const __m128i Tab = _mm_set1_epi8('\t');
+	const __m128i Four = _mm_set1_epi8('\r' - '\t');
+	const __m128i Space = _mm_set1_epi8(' ');
+	const __m128i Comma = _mm_set1_epi8(',');
+	const __m128i Semicolon = _mm_set1_epi8(';');
+	const __m128i Colon = _mm_set1_epi8(':');
+	const __m128i Dash = _mm_set1_epi8('-');
+	const __m128i NewLine = _mm_set1_epi8('\n');
+	const __m128i LowByte = _mm_set1_epi16(0x00FF);
+	BYTE Nibbles[16];
+#endif
+
+	while (i < Size) {
+#ifdef HEXDECODE_SSE2
+		while (i + 16 <= Size) {
+			__m128i Bytes = _mm_loadu_si128((const __m128i*)(Text + i));
+			__m128i Digit = _mm_sub_epi8(Bytes, Zero);
+			__m128i Letter = _mm_sub_epi8(_mm_or_si128(Bytes, Case), LowerA);
+			__m128i Control = _mm_sub_epi8(Bytes, Tab);
+			__m128i IsDigit = _mm_cmpeq_epi8(_mm_min_epu8(Digit, Nine), Digit);
+			__m128i IsLetter = _mm_cmpeq_epi8(_mm_min_epu8(Letter, Five), Letter);
+			__m128i IsSeparator = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(Bytes, Space), _mm_cmpeq_epi8(_mm_min_epu8(Control, Four), Control)),
+				_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(Bytes, Comma), _mm_cmpeq_epi8(Bytes, Semicolon)),
+					_mm_or_si128(_mm_cmpeq_epi8(Bytes, Colon), _mm_cmpeq_epi8(Bytes, Dash))));
+			unsigned int Hex = (unsigned int)_mm_movemask_epi8(_mm_or_si128(IsDigit, IsLetter));
+			unsigned int Separators = (unsigned int)_mm_movemask_epi8(IsSeparator);
+
+			if ((Hex | Separators) != 0xFFFF) {
+				// a character that is not hex, found a byte at a time
+				break;
+			}
+			if (State->OutBytes + 16 > HEXDECODE_BUFFER) {
+				iRes = FlushHex(State);
+				if (iRes != APP_SUCCESS) {
+					return iRes;
+				}
+			}
+
+			unsigned int Lines = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(Bytes, NewLine));
+			if (Lines != 0) {
+				State->Line += PopCount32(Lines);
+				State->LineStart = Offset + (__int64)i + (31 - CountLeadingZeros32(Lines)) + 1;
+			}
+
+			__m128i Values = _mm_or_si128(_mm_and_si128(Digit, IsDigit),
+				_mm_and_si128(_mm_add_epi8(Letter, Ten), IsLetter));
+			if (Hex == 0xFFFF && !State->Pending) {
+				// 16 digits, each 16 bit lane is the high nibble then the low nibble
+				__m128i Pairs = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(Values, LowByte), 4),
+					_mm_srli_epi16(Values, 8));
+				_mm_storel_epi64((__m128i*)(State->OutBuffer + State->OutBytes),
+					_mm_packus_epi16(Pairs, _mm_setzero_si128()));
+				State->OutBytes += 8;
+			}
+			else {
+				_mm_storeu_si128((__m128i*)Nibbles, Values);
+				for (int j = 0; j < 16; j++) {
+					if (Hex & (1u << j)) {
+						if (State->Pending) {
+							State->OutBuffer[State->OutBytes++] = (BYTE)((State->High << 4) | Nibbles[j]);
+							State->Pending = FALSE;
+						}
+						else {
+							State->High = Nibbles[j];
+							State->Pending = TRUE;
+						}
+					}
+					else if (State->Pending) {
+						State->OutBuffer[State->OutBytes++] = State->High;
+						State->Pending = FALSE;
+					}
+				}
+			}
+			i += 16;
+		}
+#endif
+		// a byte at a time up to the next 16 bytes
+		size_t End = (Size - i > 16) ? i + 16 : Size;
+		for (; i < End; i++) {
+			int Nibble = HexNibble(Text[i]);
+
+			if (Nibble >= 0) {
+				if (State->Pending) {
+					iRes = PutHexByte(State, (BYTE)((State->High << 4) | Nibble));
+					State->Pending = FALSE;
+				}
+				else {
+					State->High = (BYTE)Nibble;
+					State->Pending = TRUE;
+					iRes = APP_SUCCESS;
+				}
+			}
+			else if (Nibble == -1) {
+				iRes = APP_SUCCESS;
+				if (State->Pending) {
+					iRes = PutHexByte(State, State->High);
+					State->Pending = FALSE;
+				}
+				if (Text[i] == '\n') {
+					State->Line++;
+					State->LineStart = Offset + (__int64)i + 1;
+				}
+			}
+			else {
+				State->Info->Line = State->Line;
+				State->Info->Column = Offset + (__int64)i - State->LineStart + 1;
+				State->Info->Char = Text[i];
+				return APPERR_FILETYPE;
+			}
+			if (iRes != APP_SUCCESS) {
+				return iRes;
+			}
+		}
+	}
+
+	return APP_SUCCESS;
+}
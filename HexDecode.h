@@ -0,0 +1,38 @@
+#pragma once
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// HexDecode.h
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+// V1.2.0	2026-10-19	Added hex text decoder
+//
+#include "framework.h"
+
+#define HEXDECODE_BUFFER (4 << 20)	// # of bytes read and written at a time
+
+typedef struct {
+	__int64 NumBytes;		// # of bytes written to the output file
+	__int64 Line;			// APPERR_FILETYPE, line # of the character that is not hex, from 1
+	__int64 Column;			// column # of the character, from 1
+	int Char;				// the character
+} HEXDECODEINFO;
+
+int HexFile2Binary(WCHAR* InputFile, WCHAR* OutputFile, HEXDECODEINFO* Info);
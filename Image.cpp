@@ -0,0 +1,154 @@
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// Image.cpp
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the definitions of the Image<bool> class methods/functions,
+// the 1 bit per pixel Image.  The other Image<T> are in Image.h
+//
+// V1.2.0	2026-10-19	Added Image<T> pixel container
+//					The IMAGINGHEADER is no longer kept with the bits
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+#include "framework.h"
+#include "AppErrors.h"
+#include "imageheader.h"
+#include "CA.h"
+#include "Image.h"
+
+//*******************************************************************************
+//
+//  Image(Image&& Other), operator=(Image&& Other)
+//  move the bits from another image, it is left empty
+//
+//*******************************************************************************
+Image<bool>::Image(Image&& Other) noexcept : Bits(Other.Bits), Stride(Other.Stride),
+	Xsize(Other.Xsize), Ysize(Other.Ysize), NumFrames(Other.NumFrames)
+{
+	Other.Bits = NULL;
+	Other.Release();
+}
+
+Image<bool>& Image<bool>::operator=(Image&& Other) noexcept
+{
+	if (this != &Other) {
+		Release();
+		Bits = Other.Bits;
+		Stride = Other.Stride;
+		Xsize = Other.Xsize;
+		Ysize = Other.Ysize;
+		NumFrames = Other.NumFrames;
+		Other.Bits = NULL;
+		Other.Release();
+	}
+	return *this;
+}
+
+//*******************************************************************************
+//
+//  Create
+//
+// Allocate an image, all pixels are 0
+//
+//	return value:
+//	1 - Success
+//	!=1 Error see standardized app error list in AppErrors.h
+//
+//*******************************************************************************
+int Image<bool>::Create(int Xsize, int Ysize, int NumFrames)
+{
+	if (Xsize <= 0 || Ysize <= 0 || NumFrames <= 0 || NumFrames > SHRT_MAX) {
+		return APPERR_PARAMETER;
+	}
+	Release();
+
+	size_t RowBytes = (((size_t)Xsize + 7) / 8 + IMAGE_ROW_ALIGN - 1) & ~(size_t)(IMAGE_ROW_ALIGN - 1);
+	size_t NumBytes = RowBytes * (size_t)Ysize * (size_t)NumFrames;
+	Bits = (BYTE*)_aligned_malloc(NumBytes, IMAGE_ROW_ALIGN);
+	if (Bits == NULL) {
+		return APPERR_MEMALLOC;
+	}
+	memset(Bits, 0, NumBytes);
+	Stride = RowBytes;
+	this->Xsize = Xsize;
+	this->Ysize = Ysize;
+	this->NumFrames = NumFrames;
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  Release
+//
+// Free the bits, the image is empty
+//
+//*******************************************************************************
+void Image<bool>::Release()
+{
+	if (Bits != NULL) {
+		_aligned_free(Bits);
+		Bits = NULL;
+	}
+	Stride = 0;
+	Xsize = 0;
+	Ysize = 0;
+	NumFrames = 0;
+}
+
+//*******************************************************************************
+//
+//  FromInt
+//
+// Create the image from an (int) image, Xsize*Ysize*NumFrames pixels with
+// no row padding.  Non zero pixels are 1, binarize the image first to use
+// a threshold.
+//
+//	return value:
+//	1 - Success
+//	!=1 Error see standardized app error list in AppErrors.h
+//
+//*******************************************************************************
+int Image<bool>::FromInt(const int* Source, int Xsize, int Ysize, int NumFrames)
+{
+	int iRes = Create(Xsize, Ysize, NumFrames);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	for (int y = 0; y < Ysize * NumFrames; y++, Source += Xsize) {
+		PackPixelBits((int*)Source, Xsize, Bits + (size_t)y * Stride, FALSE);
+	}
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  ToInt
+//
+// Copy the image to an (int) image of binary 0/255 pixels, Xsize*Ysize*NumFrames
+// pixels with no row padding
+//
+//*******************************************************************************
+void Image<bool>::ToInt(int* Dest) const
+{
+	for (int y = 0; y < Ysize * NumFrames; y++, Dest += Xsize) {
+		UnpackPixelBits(Bits + (size_t)y * Stride, Xsize, Dest, FALSE);
+	}
+}
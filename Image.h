@@ -0,0 +1,263 @@
+#pragma once
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// Image.h
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+// V1.2.0	2026-10-19	Added Image<T> pixel container
+//					Added unpadded rows and GetPixels() for the (int) images
+//					The IMAGINGHEADER is no longer kept with the pixels
+//
+//	Image<T> owns the pixels of an image, T is BYTE, USHORT, LONG32 or int.
+//	Image<bool> is 1 bit per pixel, 8 pixels per byte, pixel 0 of a row is
+//	the 0x80 bit of its first byte (the PackPixelBits() MSB first order).
+//	Unused bits at the end of a row are 0.
+//
+//	Each row starts on an IMAGE_ROW_ALIGN byte boundary, GetStride() is the
+//	# of pixels (bytes for Image<bool>) from the start of one row to the next.
+//	Frames follow each other, row Ysize of frame 0 is row 0 of frame 1.
+//	Create(...,FALSE) does not pad the rows, GetStride() is Xsize and
+//	GetPixels() is the whole image, Xsize*Ysize*NumFrames pixels.  The CA
+//	kernels and the file functions use Image<int> like this.
+//	An Image only knows its size.  The IMAGINGHEADER of the file it was
+//	loaded from or is saved to is kept by the caller, it is the one place
+//	for the file PixelSize.
+//
+//	An Image can be moved but not copied, the pixels are freed when it is
+//	destroyed.
+//
+#include "framework.h"
+#include <malloc.h>
+#include <string.h>
+#include <limits.h>
+#include <limits>
+#include <utility>
+#include "AppErrors.h"
+
+#define IMAGE_ROW_ALIGN 16		// bytes, rows are aligned for SSE2 loads and stores
+
+template <typename T>
+class Image {
+	static_assert(IMAGE_ROW_ALIGN % sizeof(T) == 0, "pixel size must divide IMAGE_ROW_ALIGN");
+
+private:
+	T* Pixels = NULL;
+	size_t Stride = 0;
+	int Xsize = 0;
+	int Ysize = 0;
+	int NumFrames = 0;
+
+public:
+	Image() {
+	}
+
+	~Image() {
+		Release();
+	}
+
+	Image(const Image&) = delete;
+	Image& operator=(const Image&) = delete;
+
+	Image(Image&& Other) noexcept : Pixels(Other.Pixels), Stride(Other.Stride),
+		Xsize(Other.Xsize), Ysize(Other.Ysize), NumFrames(Other.NumFrames) {
+		Other.Pixels = NULL;
+		Other.Release();
+	}
+
+	Image& operator=(Image&& Other) noexcept {
+		if (this != &Other) {
+			Release();
+			Pixels = Other.Pixels;
+			Stride = Other.Stride;
+			Xsize = Other.Xsize;
+			Ysize = Other.Ysize;
+			NumFrames = Other.NumFrames;
+			Other.Pixels = NULL;
+			Other.Release();
+		}
+		return *this;
+	}
+
+	//*******************************************************************************
+	//
+	//  Create
+	//
+	// Allocate an image, all pixels are 0
+	// PadRows FALSE, rows follow each other without padding
+	//
+	//	return value:
+	//	1 - Success
+	//	!=1 Error see standardized app error list in AppErrors.h
+	//
+	//*******************************************************************************
+	int Create(int Xsize, int Ysize, int NumFrames = 1, BOOL PadRows = TRUE) {
+		if (Xsize <= 0 || Ysize <= 0 || NumFrames <= 0 || NumFrames > SHRT_MAX) {
+			return APPERR_PARAMETER;
+		}
+		Release();
+
+		size_t RowBytes = (size_t)Xsize * sizeof(T);
+		if (PadRows) {
+			RowBytes = (RowBytes + IMAGE_ROW_ALIGN - 1) & ~(size_t)(IMAGE_ROW_ALIGN - 1);
+		}
+		size_t NumBytes = RowBytes * (size_t)Ysize * (size_t)NumFrames;
+		Pixels = (T*)_aligned_malloc(NumBytes, IMAGE_ROW_ALIGN);
+		if (Pixels == NULL) {
+			return APPERR_MEMALLOC;
+		}
+		memset(Pixels, 0, NumBytes);
+		Stride = RowBytes / sizeof(T);
+		this->Xsize = Xsize;
+		this->Ysize = Ysize;
+		this->NumFrames = NumFrames;
+		return APP_SUCCESS;
+	}
+
+	void Release() {
+		if (Pixels != NULL) {
+			_aligned_free(Pixels);
+			Pixels = NULL;
+		}
+		Stride = 0;
+		Xsize = 0;
+		Ysize = 0;
+		NumFrames = 0;
+	}
+
+	BOOL IsEmpty() const { return Pixels == NULL; }
+	int GetXsize() const { return Xsize; }
+	int GetYsize() const { return Ysize; }
+	int GetNumFrames() const { return NumFrames; }
+	size_t GetStride() const { return Stride; }
+	T* GetPixels() { return Pixels; }
+	const T* GetPixels() const { return Pixels; }
+
+	T* GetRow(int y, int Frame = 0) {
+		return Pixels + ((size_t)Frame * Ysize + y) * Stride;
+	}
+
+	const T* GetRow(int y, int Frame = 0) const {
+		return Pixels + ((size_t)Frame * Ysize + y) * Stride;
+	}
+
+	//*******************************************************************************
+	//
+	//  FromInt
+	//
+	// Create the image from an (int) image, Xsize*Ysize*NumFrames pixels with
+	// no row padding.  Values outside the range of T are clamped.
+	//
+	//*******************************************************************************
+	int FromInt(const int* Source, int Xsize, int Ysize, int NumFrames = 1) {
+		int iRes = Create(Xsize, Ysize, NumFrames);
+		if (iRes != APP_SUCCESS) {
+			return iRes;
+		}
+		const __int64 Min = (__int64)(std::numeric_limits<T>::min)();
+		const __int64 Max = (__int64)(std::numeric_limits<T>::max)();
+		for (int y = 0; y < Ysize * NumFrames; y++, Source += Xsize) {
+			T* Row = Pixels + (size_t)y * Stride;
+			for (int x = 0; x < Xsize; x++) {
+				__int64 Value = Source[x];
+				if (Value < Min) Value = Min;
+				if (Value > Max) Value = Max;
+				Row[x] = (T)Value;
+			}
+		}
+		return APP_SUCCESS;
+	}
+
+	//*******************************************************************************
+	//
+	//  ToInt
+	//
+	// Copy the image to an (int) image, Xsize*Ysize*NumFrames pixels with
+	// no row padding
+	//
+	//*******************************************************************************
+	void ToInt(int* Dest) const {
+		for (int y = 0; y < Ysize * NumFrames; y++, Dest += Xsize) {
+			const T* Row = Pixels + (size_t)y * Stride;
+			for (int x = 0; x < Xsize; x++) {
+				Dest[x] = (int)Row[x];
+			}
+		}
+	}
+};
+
+// 1 bit per pixel, the member functions are in Image.cpp
+template <>
+class Image<bool> {
+private:
+	BYTE* Bits = NULL;
+	size_t Stride = 0;
+	int Xsize = 0;
+	int Ysize = 0;
+	int NumFrames = 0;
+
+public:
+	Image() {
+	}
+
+	~Image() {
+		Release();
+	}
+
+	Image(const Image&) = delete;
+	Image& operator=(const Image&) = delete;
+
+	Image(Image&& Other) noexcept;
+	Image& operator=(Image&& Other) noexcept;
+
+	int Create(int Xsize, int Ysize, int NumFrames = 1);
+	void Release();
+
+	BOOL IsEmpty() const { return Bits == NULL; }
+	int GetXsize() const { return Xsize; }
+	int GetYsize() const { return Ysize; }
+	int GetNumFrames() const { return NumFrames; }
+	size_t GetStride() const { return Stride; }
+
+	BYTE* GetRow(int y, int Frame = 0) {
+		return Bits + ((size_t)Frame * Ysize + y) * Stride;
+	}
+
+	const BYTE* GetRow(int y, int Frame = 0) const {
+		return Bits + ((size_t)Frame * Ysize + y) * Stride;
+	}
+
+	BOOL GetPixel(int x, int y, int Frame = 0) const {
+		return (GetRow(y, Frame)[x >> 3] >> (7 - (x & 7))) & 1;
+	}
+
+	void SetPixel(int x, int y, BOOL Value, int Frame = 0) {
+		BYTE* Row = GetRow(y, Frame);
+		if (Value) {
+			Row[x >> 3] |= (BYTE)(0x80 >> (x & 7));
+		}
+		else {
+			Row[x >> 3] &= (BYTE)~(0x80 >> (x & 7));
+		}
+	}
+
+	int FromInt(const int* Source, int Xsize, int Ysize, int NumFrames = 1);
+	void ToInt(int* Dest) const;
+};
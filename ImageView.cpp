@@ -0,0 +1,335 @@
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// ImageView.cpp
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the definitions of the ImageView class methods/functions
+//
+// V1.2.0	2026-10-19	Added ImageView class, read only memory mapped .raw image files
+//					1 bit per pixel files, PIXELSIZE_1BIT
+//					ReleaseFrame()
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+#include "framework.h"
+#include <shtypes.h>
+#include "AppErrors.h"
+#include "imageheader.h"
+#include "FileFunctions.h"
+#include "CA.h"
+#include "ImageView.h"
+
+//*******************************************************************************
+//
+//  ImageView()
+//  class constructor
+//
+//*******************************************************************************
+ImageView::ImageView()
+{
+	memset(&Header, 0, sizeof(IMAGINGHEADER));
+}
+
+//*******************************************************************************
+//
+//  ~ImageView()
+//  class destructor
+//
+//*******************************************************************************
+ImageView::~ImageView()
+{
+	Close();
+}
+
+//*******************************************************************************
+//
+//  Open
+//
+// Map a .raw image file and validate its header the same way LoadImageFile()
+// does.  No frames are mapped until they are asked for.
+//
+// Parameters:
+//	WCHAR* Filename		image file
+//
+//	return value:
+//	1 - Success
+//	!=1 Error see standardized app error list in AppErrors.h
+//		APPERR_PARAMETER if the header is not valid
+//		APPERR_FILEREAD if the file is shorter than the header says
+//
+//*******************************************************************************
+int ImageView::Open(WCHAR* Filename)
+{
+	int iRes;
+
+	Close();
+
+	iRes = File.Open(Filename);
+	if (iRes == APPERR_FILESIZE) {
+		return APPERR_FILEREAD;
+	}
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+	if (File.GetFileSize() < (__int64)sizeof(IMAGINGHEADER)) {
+		File.Close();
+		return APPERR_FILEREAD;
+	}
+
+	void* ViewBase;
+	const BYTE* View = File.MapView(0, sizeof(IMAGINGHEADER), &ViewBase);
+	if (View == NULL) {
+		File.Close();
+		return APPERR_FILEREAD;
+	}
+	memcpy(&Header, View, sizeof(IMAGINGHEADER));
+	MappedFile::UnmapView(ViewBase);
+
+	if ((Header.Endian != 0 && Header.Endian != -1 && Header.ID != 0xaaaa) ||
+		Header.Xsize <= 0 || Header.Ysize <= 0 || Header.NumFrames <= 0 ||
+		(Header.PixelSize != 1 && Header.PixelSize != 2 && Header.PixelSize != 4 &&
+		Header.PixelSize != PIXELSIZE_1BIT)) {
+		Close();
+		return APPERR_PARAMETER;
+	}
+
+	FramePixels = (size_t)Header.Xsize * (size_t)Header.Ysize;
+	if (Header.PixelSize == PIXELSIZE_1BIT) {
+		FrameBytes = BITROW_BYTES(Header.Xsize) * Header.Ysize;
+	}
+	else {
+		FrameBytes = FramePixels * Header.PixelSize;
+	}
+	if (File.GetFileSize() < (__int64)sizeof(IMAGINGHEADER) + (__int64)FrameBytes * Header.NumFrames) {
+		Close();
+		return APPERR_FILEREAD;
+	}
+	Swap = Header.Endian == 0 && (Header.PixelSize == 2 || Header.PixelSize == 4);
+
+	ViewBases.assign(Header.NumFrames, NULL);
+	Frames.assign(Header.NumFrames, NULL);
+
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  Close
+//
+// Unmap all the frames and close the file.  Frame pointers are no longer valid.
+//
+//*******************************************************************************
+void ImageView::Close()
+{
+	for (size_t i = 0; i < ViewBases.size(); i++) {
+		if (ViewBases[i] != NULL) {
+			MappedFile::UnmapView(ViewBases[i]);
+		}
+	}
+	ViewBases.clear();
+	Frames.clear();
+	FramePixels = 0;
+	FrameBytes = 0;
+	Swap = FALSE;
+	memset(&Header, 0, sizeof(IMAGINGHEADER));
+	File.Close();
+}
+
+//*******************************************************************************
+//
+//  GetHeader, GetXsize, GetYsize, GetNumFrames, GetPixelSize
+//
+// The header of the open file, all 0 if no file is open
+//
+//*******************************************************************************
+const IMAGINGHEADER* ImageView::GetHeader()
+{
+	return &Header;
+}
+
+int ImageView::GetXsize()
+{
+	return (int)Header.Xsize;
+}
+
+int ImageView::GetYsize()
+{
+	return (int)Header.Ysize;
+}
+
+int ImageView::GetNumFrames()
+{
+	return (int)Header.NumFrames;
+}
+
+int ImageView::GetPixelSize()
+{
+	return (int)Header.PixelSize;
+}
+
+//*******************************************************************************
+//
+//  IsNative
+//
+// return value:
+//	TRUE	the frames can be used in place as BYTE, USHORT or LONG32 pixels
+//	FALSE	no file is open, the pixels are big endian or 1 bit per pixel,
+//			use WidenFrames()
+//
+//*******************************************************************************
+BOOL ImageView::IsNative()
+{
+	return FramePixels != 0 && !Swap && Header.PixelSize != PIXELSIZE_1BIT;
+}
+
+//*******************************************************************************
+//
+//  GetFrameBytes
+//
+// The file bytes of a frame, Xsize*Ysize*PixelSize bytes or
+// BITROW_BYTES(Xsize)*Ysize bytes for PIXELSIZE_1BIT.  The frame is
+// mapped the first time it is asked for.
+//
+// Parameters:
+//	int Frame		frame #, from 0
+//
+//	return value:
+//	pointer to the frame, NULL if Frame is not valid or it could not be mapped
+//
+//*******************************************************************************
+const BYTE* ImageView::GetFrameBytes(int Frame)
+{
+	if (Frame < 0 || Frame >= (int)Frames.size()) {
+		return NULL;
+	}
+	if (Frames[Frame] == NULL) {
+		Frames[Frame] = File.MapView(sizeof(IMAGINGHEADER) + (__int64)FrameBytes * Frame,
+			FrameBytes, &ViewBases[Frame]);
+		if (Frames[Frame] == NULL) {
+			ViewBases[Frame] = NULL;
+		}
+	}
+	return Frames[Frame];
+}
+
+//*******************************************************************************
+//
+//  GetFrame8, GetFrame16, GetFrame32
+//
+// A frame as pixels of the file type, Xsize*Ysize pixels.
+//
+// Parameters:
+//	int Frame		frame #, from 0
+//
+//	return value:
+//	pointer to the frame pixels
+//	NULL if the file PixelSize is different, the pixels are big endian,
+//	Frame is not valid or it could not be mapped
+//
+//*******************************************************************************
+const BYTE* ImageView::GetFrame8(int Frame)
+{
+	if (Header.PixelSize != 1) {
+		return NULL;
+	}
+	return GetFrameBytes(Frame);
+}
+
+const USHORT* ImageView::GetFrame16(int Frame)
+{
+	if (Header.PixelSize != 2 || Swap) {
+		return NULL;
+	}
+	return (const USHORT*)GetFrameBytes(Frame);
+}
+
+const LONG32* ImageView::GetFrame32(int Frame)
+{
+	if (Header.PixelSize != 4 || Swap) {
+		return NULL;
+	}
+	return (const LONG32*)GetFrameBytes(Frame);
+}
+
+//*******************************************************************************
+//
+//  ReleaseFrame
+//
+// Unmap a frame.  Pointers to it are no longer valid, it is mapped again the
+// next time it is asked for.  Used by code that goes through many frames of
+// a large file so the frames do not all stay mapped until Close().
+//
+// Parameters:
+//	int Frame		frame #, from 0
+//
+//*******************************************************************************
+void ImageView::ReleaseFrame(int Frame)
+{
+	if (Frame < 0 || Frame >= (int)Frames.size() || ViewBases[Frame] == NULL) {
+		return;
+	}
+	MappedFile::UnmapView(ViewBases[Frame]);
+	ViewBases[Frame] = NULL;
+	Frames[Frame] = NULL;
+}
+
+//*******************************************************************************
+//
+//  WidenFrames
+//
+// Convert frames to (int) pixels like LoadImageFile() does, for code that
+// needs an (int) image.  Big endian pixels are swapped, 1 bit per pixel
+// frames are unpacked to 0/255.
+//
+// Parameters:
+//	int FirstFrame		first frame #, from 0
+//	int NumFrames		# of frames
+//	int* Image			Xsize*Ysize*NumFrames (int) pixels are written here
+//
+//	return value:
+//	1 - Success
+//	!=1 Error see standardized app error list in AppErrors.h
+//
+//*******************************************************************************
+int ImageView::WidenFrames(int FirstFrame, int NumFrames, int* Image)
+{
+	if (Image == NULL || FirstFrame < 0 || NumFrames < 0 ||
+		FirstFrame + NumFrames > (int)Frames.size()) {
+		return APPERR_PARAMETER;
+	}
+
+	for (int i = 0; i < NumFrames; i++) {
+		const BYTE* Pixels = GetFrameBytes(FirstFrame + i);
+		if (Pixels == NULL) {
+			return APPERR_FILEREAD;
+		}
+		int* Dest = Image + (size_t)i * FramePixels;
+		if (Header.PixelSize == PIXELSIZE_1BIT) {
+			size_t RowBytes = BITROW_BYTES(Header.Xsize);
+			for (int y = 0; y < Header.Ysize; y++) {
+				UnpackPixelBits((BYTE*)Pixels + y * RowBytes, Header.Xsize, Dest + (size_t)y * Header.Xsize, FALSE);
+			}
+		}
+		else {
+			WidenPixels(Pixels, Dest, FramePixels, Header.PixelSize, Swap);
+		}
+	}
+
+	return APP_SUCCESS;
+}
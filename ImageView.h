@@ -0,0 +1,75 @@
+#pragma once
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// ImageView.h
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+// V1.2.0	2026-10-19	Added ImageView class, read only memory mapped .raw image files
+//					1 bit per pixel files, PIXELSIZE_1BIT
+//					ReleaseFrame()
+//
+//	The header is validated like LoadImageFile() does and the frames are
+//	mapped when they are first asked for.  The frame pointers are the file
+//	pixels, nothing is copied.  They are valid until ReleaseFrame() or Close().
+//	Big endian (Endian == 0) 2 and 4 byte files can not be used in place,
+//	GetFrame16() and GetFrame32() return NULL for them, use WidenFrames().
+//	1 bit per pixel files (PIXELSIZE_1BIT) are only GetFrameBytes(), the
+//	packed rows, or WidenFrames().
+//
+//	Not for use from more than one thread at a time.
+//
+#include "framework.h"
+#include <vector>
+#include "imageheader.h"
+#include "MappedFile.h"
+
+class ImageView {
+private:
+	MappedFile File;
+	IMAGINGHEADER Header;
+	size_t FramePixels = 0;
+	size_t FrameBytes = 0;				// bytes of a frame in the file
+	BOOL Swap = FALSE;					// big endian pixels
+	std::vector<void*> ViewBases;		// NULL until the frame is mapped
+	std::vector<const BYTE*> Frames;
+
+public:
+	ImageView();
+	~ImageView();
+
+	int Open(WCHAR* Filename);
+	void Close();
+
+	const IMAGINGHEADER* GetHeader();
+	int GetXsize();
+	int GetYsize();
+	int GetNumFrames();
+	int GetPixelSize();
+	BOOL IsNative();
+
+	const BYTE* GetFrameBytes(int Frame);
+	const BYTE* GetFrame8(int Frame);
+	const USHORT* GetFrame16(int Frame);
+	const LONG32* GetFrame32(int Frame);
+	void ReleaseFrame(int Frame);
+
+	int WidenFrames(int FirstFrame, int NumFrames, int* Image);
+};
@@ -22,6 +22,10 @@
 // V1.0.0	2024-06-21	Initial release
 // V1.1.0	2024-06-28	Corrected loading of BMP files
 // V1.1.2	2024-07-08	added LayerBits, # bits in image
+// V1.2.0	2026-10-19	Layer 0 state comes from the MargolusEngine BCAengine
+//					.raw layer files are memory mapped, only the frames used are loaded
+//					Layer images other than layer 0 are Image<bool>, 1 bit per pixel
+//					Layer files are loaded into an Image<int>
 //
 //  This module is a copy of the Layers module used in MySETIviewer and customized
 //  for this application
@@ -37,11 +41,103 @@
 #include <shtypes.h>
 #include <string.h>
 #include <stdio.h>
+#include <utility>
 #include "AppErrors.h"
 #include "imageheader.h"
 #include "FileFunctions.h"
 #include "Layers.h"
 #include "CA.h"
+#include "BCAengine.h"
+#include "ImageView.h"
+
+//*******************************************************************************
+//
+//  LoadLayerImage
+//
+// Load only the frames of a .raw image file that a layer uses, the first
+// frame or all 3 frames of a 3 frame color image.  The file is memory mapped,
+// the other frames are not read.
+// 
+// Image<int>& Dest			returns the (int) image, rows are not padded
+// WCHAR* Filename				.raw image file
+// IMAGINGHEADER* ImageHeader	file header, NumFrames is the # of frames loaded
+// 
+// return
+// int					APP_SUCCESS, 1,	Success
+//						!=1 Error see standardized app error list in AppErrors.h
+//
+//*******************************************************************************
+static int LoadLayerImage(Image<int>& Dest, WCHAR* Filename, IMAGINGHEADER* ImageHeader)
+{
+	ImageView View;
+	int iRes;
+
+	Dest.Release();
+	iRes = View.Open(Filename);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+	*ImageHeader = *View.GetHeader();
+	if (ImageHeader->NumFrames != 3) {
+		ImageHeader->NumFrames = 1;
+	}
+
+	iRes = Dest.Create(ImageHeader->Xsize, ImageHeader->Ysize, ImageHeader->NumFrames, FALSE);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+	iRes = View.WidenFrames(0, ImageHeader->NumFrames, Dest.GetPixels());
+	if (iRes != APP_SUCCESS) {
+		Dest.Release();
+		return iRes;
+	}
+
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  LoadLayerBits
+//
+// Load a .raw image or BMP file as a binary layer image, 1 bit per pixel.
+// 3 frame images are color images, the frames are collapsed into one.
+// 
+// WCHAR* Filename				Image, or BMP file
+// Image<bool>& Bits			returns the layer image
+// 
+// return
+// int					APP_SUCCESS, 1,	Success
+//						!=1 Error see standardized app error list in AppErrors.h
+//
+//*******************************************************************************
+static int LoadLayerBits(WCHAR* Filename, Image<bool>& Bits)
+{
+	int iRes;
+	Image<int> Pixels;
+	IMAGINGHEADER ImageHeader;
+	int UseThisThreshold;
+
+	// try loading as .img file
+	iRes = LoadLayerImage(Pixels, Filename, &ImageHeader);
+	if (iRes == APP_SUCCESS) {
+		UseThisThreshold = 1;
+	} else {
+		iRes = ReadBMPfile(Pixels, Filename, &ImageHeader);
+		if (iRes != APP_SUCCESS) {
+			return iRes;
+		}
+		UseThisThreshold = BINARY_THRESHOLD;
+	}
+
+	// check if this is 3 frame image (3 frame raw files are used as color images)
+	// If it is convert the 3 frames into the first frame as a binary 0 or 255
+	iRes = BinarizeImageFrames(Pixels, &ImageHeader, UseThisThreshold);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	return Bits.FromInt(Pixels.GetPixels(), ImageHeader.Xsize, ImageHeader.Ysize, 1);
+}
 
 //*******************************************************************************
 //
@@ -98,8 +194,6 @@ int Layers::ReleaseOverlay(void) {
 //*******************************************************************************
 int Layers::AddLayer(WCHAR* Filename) {
 	int iRes;
-	int* Image;
-	IMAGINGHEADER ImageHeader;
 
 	if (NumLayers > MAX_LAYERS) {
 		return APPERR_PARAMETER;
@@ -113,7 +207,7 @@ int Layers::AddLayer(WCHAR* Filename) {
 		// This layer can not be deleted it should be updated when
 		// the BCA image is loaded or reloaded
 		//
-		LayerImage[NumLayers] = NULL; // will be changed to point the to BCA memory image
+		BCAimage = NULL; // will be changed to point the to BCA memory image
 		LayerXsize[NumLayers] = 0;
 		LayerYsize[NumLayers] = 0;
 
@@ -132,36 +226,19 @@ int Layers::AddLayer(WCHAR* Filename) {
 		return APP_SUCCESS;
 	}
 
-	// try loading as .img file
-	int UseThisThreshold;
-
-	iRes = LoadImageFile(&Image, Filename, &ImageHeader);
-	if (iRes == APP_SUCCESS) {
-		UseThisThreshold = 1;
-	} else {
-		iRes = ReadBMPfile(&Image, Filename, &ImageHeader);
-		if (iRes != APP_SUCCESS) {
-			return iRes;
-		}
-		UseThisThreshold = BINARY_THRESHOLD;
-	}
-
-	// check if this is 3 frame image (3 frame raw files are used as color images)
-	// If it is convert the 3 frames into the first frame as a binary 0 or 255
-	if (ImageHeader.NumFrames == 3) {
-		CollapseImageFrames(Image, &ImageHeader, UseThisThreshold);
-	}
-	else {
-		BinarizeImage(Image, &ImageHeader, UseThisThreshold);
+	Image<bool> Bits;
+	iRes = LoadLayerBits(Filename, Bits);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
 	}
 
 	// update bit count
-	int Count = CountBitInImage(Image, &ImageHeader);
+	int Count = CountBitInImage(Bits);
 
 	// save results in Layers class variables
-	LayerImage[NumLayers] = Image;
-	LayerXsize[NumLayers] = ImageHeader.Xsize;
-	LayerYsize[NumLayers] = ImageHeader.Ysize;
+	LayerXsize[NumLayers] = Bits.GetXsize();
+	LayerYsize[NumLayers] = Bits.GetYsize();
+	LayerImage[NumLayers] = std::move(Bits);
 
 	LayerBits[NumLayers] = Count;
 
@@ -200,7 +277,7 @@ int Layers::AddLayer(WCHAR* Filename) {
 //						APPERR_PARAMETER, max layers already reached
 //
 //*******************************************************************************
-int Layers::UpdateLayer(int LayerNumber, WCHAR* Filename, int *BCAimage, int Xsize, int Ysize) {
+int Layers::UpdateLayer(int LayerNumber, WCHAR* Filename, int *NewBCAimage, int Xsize, int Ysize) {
 	int iRes;
 	if(LayerNumber>=NumLayers || LayerNumber <0) {
 		return APPERR_PARAMETER;
@@ -223,7 +300,7 @@ int Layers::UpdateLayer(int LayerNumber, WCHAR* Filename, int *BCAimage, int Xsi
 		else {
 			wcscpy_s(LayerFilename[0], MAX_PATH, Filename);
 		}
-		LayerImage[0] = BCAimage;
+		BCAimage = NewBCAimage;
 		LayerXsize[0] = Xsize;
 		LayerYsize[0] = Ysize;
 		Enabled[0] = TRUE;
@@ -232,38 +309,16 @@ int Layers::UpdateLayer(int LayerNumber, WCHAR* Filename, int *BCAimage, int Xsi
 		return APP_SUCCESS;
 	}
 
-	IMAGINGHEADER ImageHeader;
-
-	// try loading as .img file
-	int* Image;
-	int UseThisThreshold;
-
-	iRes = LoadImageFile(&Image, Filename, &ImageHeader);
-	if (iRes == APP_SUCCESS) {
-		UseThisThreshold = 1;
-	} else {
-		iRes = ReadBMPfile(&Image, Filename, &ImageHeader);
-		if (iRes != APP_SUCCESS) {
-			return iRes;
-		}
-		UseThisThreshold = BINARY_THRESHOLD;
-	}
-	// check if this is 3 frame image (3 frame raw files are used as color images)
-	// If it is convert the 3 frames into the first frame as a binary 0 or 255
-	if (ImageHeader.NumFrames == 3) {
-		CollapseImageFrames(Image, &ImageHeader, UseThisThreshold);
+	Image<bool> Bits;
+	iRes = LoadLayerBits(Filename, Bits);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
 	}
-	else {
-		BinarizeImage(Image, &ImageHeader, UseThisThreshold);
-	}
-	
+
 	// save results in Layers class variables
-	if (LayerImage[LayerNumber] != nullptr) {
-		delete[] LayerImage[LayerNumber];
-	}
-	LayerImage[LayerNumber] = Image;
-	LayerXsize[LayerNumber] = ImageHeader.Xsize;
-	LayerYsize[LayerNumber] = ImageHeader.Ysize;
+	LayerXsize[LayerNumber] = Bits.GetXsize();
+	LayerYsize[LayerNumber] = Bits.GetYsize();
+	LayerImage[LayerNumber] = std::move(Bits);
 
 	wcscpy_s(LayerFilename[NumLayers], MAX_PATH, Filename);
 
@@ -294,7 +349,7 @@ int Layers::ReleaseLayer(int LayerNum) {
 		return APPERR_PARAMETER;
 	}
 	// release allocated memory
-	delete[] LayerImage[LayerNum];
+	LayerImage[LayerNum].Release();
 	delete[] LayerFilename[LayerNum];
 
 	NumLayers--;
@@ -306,7 +361,7 @@ int Layers::ReleaseLayer(int LayerNum) {
 	}
 	// move the rest of the layers down 1 slot
 	for (int i = LayerNum; i < NumLayers; i++) {
-		LayerImage[i] = LayerImage[i+1];
+		LayerImage[i] = std::move(LayerImage[i+1]);
 		LayerXsize[i] = LayerXsize[i+1];
 		LayerYsize[i] = LayerYsize[i+1];
 		LayerColor[i] = LayerColor[i+1];
@@ -368,7 +423,8 @@ int Layers::UpdateOverlay(void) {
 	int ImageXsize;
 	int ImageYsize;
 	int Pixel;
-	int* Image;
+	const int* IntRow = NULL;		// layer 0, the BCA image
+	const BYTE* BitRow = NULL;		// the other layers, 1 bit per pixel
 
 	union {
 		COLORREF Color;
@@ -390,12 +446,14 @@ int Layers::UpdateOverlay(void) {
 	for (int Layer = 0; Layer < NumLayers; Layer++) {
 		ImageXsize = LayerXsize[Layer];
 		ImageYsize = LayerYsize[Layer];
-		Image = LayerImage[Layer];
 		if (!Enabled[Layer] || LayerColor[Layer] == rgbOverlayColor) {
 			// if current layer is not enabled, do no add layer to overlay
 			// if current layer color is the overlay color, do not add layer to overlay
 			continue;
 		}
+		if ((Layer == 0 && BCAimage == NULL) || (Layer != 0 && LayerImage[Layer].IsEmpty())) {
+			continue;
+		}
 		iColor.Color = LayerColor[Layer];
 
 		if (yposDir == 0) {
@@ -411,9 +469,20 @@ int Layers::UpdateOverlay(void) {
 			 y++, iAddress += ImageXsize, oAddress += ImageXextent) {
 
 			oOffset = ((Xextent0 + LayerX[Layer]) - (LayerXsize[Layer] / 2));
+			if (Layer == 0) {
+				IntRow = BCAimage + iAddress;
+			}
+			else {
+				BitRow = LayerImage[Layer].GetRow(y);
+			}
 
 			for (int x = 0; x < ImageXsize; x++, oOffset++) {
-				Pixel = Image[iAddress + x];
+				if (Layer == 0) {
+					Pixel = IntRow[x];
+				}
+				else {
+					Pixel = (BitRow[x >> 3] >> (7 - (x & 7))) & 1;
+				}
 				OverlayPixel.Color = OverlayImage[oAddress+ oOffset];
 				if (Pixel == 0) {
 					// if pixel is already set ignore
@@ -922,7 +991,7 @@ int Layers::EnableLayer(int Layer) {
 	}
 	// can not enable layer 0 if not loaded
 	if (Layer == 0) {
-		if (!BCAimageLoaded) {
+		if (!MargolusEngine->IsImageLoaded()) {
 			Enabled[Layer] = FALSE;
 		}
 	}
@@ -23,15 +23,18 @@
 // 
 //	V1.0.0	2024-06-21	Initial release, used Layers.h from MySETIviewer V1.1.3
 //	V1.1.2	2024-07-10	Corrected initial of class, EnableGrid should have been disabled
+//	V1.2.0	2026-10-19	Layer images are Image<bool>, the BCA image layer 0 is BCAimage
 //
 #include "framework.h"
+#include "Image.h"
 
 #define MAX_LAYERS 20
 
 class Layers {
 private:
 	// variables
-	int* LayerImage[MAX_LAYERS] = { NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL };
+	int* BCAimage = NULL;				// layer 0, not owned by Layers
+	Image<bool> LayerImage[MAX_LAYERS];	// the other layers, binary images
 	int LayerXsize[MAX_LAYERS] = { 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0 };
 	int LayerYsize[MAX_LAYERS] = { 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0 };
 	int LayerBits[MAX_LAYERS] = { 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0 };
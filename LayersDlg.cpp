@@ -21,6 +21,8 @@
 //
 // V1.0.0	2024-06-21	Initial release
 // V1.1.2   2024-07-06  Changed default size of display to be 256x256, save user settings for min size
+// V1.2.0   2026-10-19  Layer 0 state comes from the MargolusEngine BCAengine
+//                      Layer 0 shows the 64 bit iteration count
 //
 //  This module is a copy of the LayersDlg module used in MySETIviewer and customized
 //  for this application
@@ -43,6 +45,7 @@
 #include "FileFunctions.h"
 #include "Appfunctions.h"
 #include "CA.h"
+#include "BCAengine.h"
 
 // Layer class brushes
 static HBRUSH hbrSelectedLayer = NULL;
@@ -199,7 +202,7 @@ INT_PTR CALLBACK SettingsLayersDlg(HWND hDlg, UINT message, WPARAM wParam, LPARA
 
                 if (IsDlgButtonChecked(hDlg, IDC_ENABLE) == BST_CHECKED) {
                     // Layer 0, BCA image can only be enabled if image is loaded
-                    if (Selection == 0 && !BCAimageLoaded) {
+                    if (Selection == 0 && !MargolusEngine->IsImageLoaded()) {
                         // uncheck the box
                         CheckDlgButton(hDlg, IDC_ENABLE, BST_UNCHECKED);
                         return (INT_PTR)FALSE;
@@ -207,8 +210,8 @@ INT_PTR CALLBACK SettingsLayersDlg(HWND hDlg, UINT message, WPARAM wParam, LPARA
 
                     ImageLayers->EnableLayer(Selection);
                     if (Selection == 0) {
-                        swprintf_s(szString, MAX_PATH, L"Enabled:  %d iter, %dHx%dV, %s",
-                            CurrentIteration, x, y,
+                        swprintf_s(szString, MAX_PATH, L"Enabled:  %lld iter, %dHx%dV, %s",
+                            MargolusEngine->GetIteration(), x, y,
                             ImageLayers->LayerFilename[Selection]);
                     }
                     else {
@@ -221,8 +224,8 @@ INT_PTR CALLBACK SettingsLayersDlg(HWND hDlg, UINT message, WPARAM wParam, LPARA
                 else {
                     ImageLayers->DisableLayer(Selection);
                     if (Selection == 0) {
-                        swprintf_s(szString, MAX_PATH, L"Disabled:  %d iter, %dHx%dV, %s",
-                            CurrentIteration, x, y,
+                        swprintf_s(szString, MAX_PATH, L"Disabled:  %lld iter, %dHx%dV, %s",
+                            MargolusEngine->GetIteration(), x, y,
                             ImageLayers->LayerFilename[Selection]);
                     }
                     else {
@@ -821,11 +824,11 @@ void LoadLayerList(HWND hDlg, int CurrentLayer)
         // It includes the iteration number for the BCA
         ImageLayers->GetSize(0, &x, &y);
         if (ImageLayers->IsLayerEnabled(0)) {
-            swprintf_s(szString, MAX_PATH, L"Enabled:  %d iter, %dHx%dV, %s", CurrentIteration, x, y,
+            swprintf_s(szString, MAX_PATH, L"Enabled:  %lld iter, %dHx%dV, %s", MargolusEngine->GetIteration(), x, y,
                 ImageLayers->LayerFilename[0]);
         }
         else {
-            swprintf_s(szString, MAX_PATH, L"Disabled: %d iter, %dHx%dV, %s", CurrentIteration, x, y,
+            swprintf_s(szString, MAX_PATH, L"Disabled: %lld iter, %dHx%dV, %s", MargolusEngine->GetIteration(), x, y,
                 ImageLayers->LayerFilename[0]);
         }
 
@@ -0,0 +1,184 @@
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// MappedFile.cpp
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the definitions of the MappedFile class methods/functions
+//
+// V1.2.0	2026-10-19	Added MappedFile class, read only memory mapped files
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+#include "framework.h"
+#include "AppErrors.h"
+#include "MappedFile.h"
+
+//*******************************************************************************
+//
+//  MappedFile()
+//  class constructor
+//
+//*******************************************************************************
+MappedFile::MappedFile()
+{
+	SYSTEM_INFO SysInfo;
+
+	GetSystemInfo(&SysInfo);
+	if (SysInfo.dwAllocationGranularity != 0) {
+		Granularity = SysInfo.dwAllocationGranularity;
+	}
+}
+
+//*******************************************************************************
+//
+//  ~MappedFile()
+//  class destructor
+//
+//*******************************************************************************
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+//*******************************************************************************
+//
+//  Open
+//
+// Open a file and create a read only mapping of all of it
+//
+// Parameters:
+//	WCHAR* Filename		file to map
+//
+//	return value:
+//	1 - Success
+//	!=1 Error see standardized app error list in AppErrors.h
+//		APPERR_FILESIZE if the file is empty, an empty file can not be mapped
+//
+//*******************************************************************************
+int MappedFile::Open(WCHAR* Filename)
+{
+	LARGE_INTEGER Size;
+
+	Close();
+
+	hFile = CreateFile(Filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		return APPERR_FILEOPEN;
+	}
+
+	if (!GetFileSizeEx(hFile, &Size)) {
+		Close();
+		return APPERR_FILEREAD;
+	}
+	FileSize = Size.QuadPart;
+	if (FileSize == 0) {
+		Close();
+		return APPERR_FILESIZE;
+	}
+
+	hMapping = CreateFileMapping(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (hMapping == NULL) {
+		Close();
+		return APPERR_FILEREAD;
+	}
+
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  Close
+//
+// Views that are still mapped stay valid until they are unmapped
+//
+//*******************************************************************************
+void MappedFile::Close()
+{
+	if (hMapping != NULL) {
+		CloseHandle(hMapping);
+		hMapping = NULL;
+	}
+	if (hFile != INVALID_HANDLE_VALUE) {
+		CloseHandle(hFile);
+		hFile = INVALID_HANDLE_VALUE;
+	}
+	FileSize = 0;
+}
+
+//*******************************************************************************
+//
+//  MapView
+//
+// Map part of the file.  The view is mapped from the allocation granularity
+// boundary at or before Offset, the returned pointer is the byte at Offset.
+//
+// Parameters:
+//	__int64 Offset		first byte of the file in the view
+//	size_t Size			# of bytes in the view, limited to the end of the file
+//	void** ViewBase		returns the view for UnmapView()
+//
+//	return value:
+//	pointer to the byte at Offset, nullptr if the view could not be mapped
+//
+//*******************************************************************************
+const BYTE* MappedFile::MapView(__int64 Offset, size_t Size, void** ViewBase)
+{
+	*ViewBase = nullptr;
+	if (hMapping == NULL || Offset < 0 || Offset >= FileSize) {
+		return nullptr;
+	}
+	if ((__int64)Size > FileSize - Offset) {
+		Size = (size_t)(FileSize - Offset);
+	}
+
+	__int64 Base = Offset - (Offset % Granularity);
+	size_t Lead = (size_t)(Offset - Base);
+
+	void* View = MapViewOfFile(hMapping, FILE_MAP_READ,
+		(DWORD)((unsigned __int64)Base >> 32), (DWORD)(Base & 0xFFFFFFFF), Lead + Size);
+	if (View == NULL) {
+		return nullptr;
+	}
+	*ViewBase = View;
+
+	return (const BYTE*)View + Lead;
+}
+
+//*******************************************************************************
+//
+//  UnmapView
+//
+//*******************************************************************************
+void MappedFile::UnmapView(void* ViewBase)
+{
+	if (ViewBase != nullptr) {
+		UnmapViewOfFile(ViewBase);
+	}
+}
+
+//*******************************************************************************
+//
+//  GetFileSize
+//
+//*******************************************************************************
+__int64 MappedFile::GetFileSize()
+{
+	return FileSize;
+}
@@ -0,0 +1,52 @@
+#pragma once
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// MappedFile.h
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+// V1.2.0	2026-10-19	Added MappedFile class, read only memory mapped files
+//
+//	The file is mapped once, views of any part of it are mapped on demand.
+//	Files larger than the address space are read by mapping views of
+//	one part at a time.  Views can be mapped from several threads at once,
+//	each thread unmaps its own views.
+//
+#include "framework.h"
+
+class MappedFile {
+private:
+	HANDLE hFile = INVALID_HANDLE_VALUE;
+	HANDLE hMapping = NULL;
+	__int64 FileSize = 0;
+	DWORD Granularity = 65536;	// view offsets must be a multiple of this
+
+public:
+	MappedFile();
+	~MappedFile();
+
+	int Open(WCHAR* Filename);
+	void Close();
+
+	const BYTE* MapView(__int64 Offset, size_t Size, void** ViewBase);
+	static void UnmapView(void* ViewBase);
+
+	__int64 GetFileSize();
+};
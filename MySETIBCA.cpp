@@ -133,6 +133,18 @@
 //						output rules special entries,
 //							<space>		a space character is output
 //							<no>		no output symbol (empty)
+// V1.2.0   2026-10-19  Margolus BCA uses a sparse particle list engine for low density images
+//                      Added stop conditions to Margolus BCA runs
+//                      Correction, run timer no longer posts a backward step after the run is stopped
+//                      Margolus BCA simulation state is kept by the MargolusEngine BCAengine class
+//                      Added Receive ASIS batch menu item
+//                      Added Find bit pattern menu item
+//                      Added Run length profile menu item
+//                      Added Find line length menu item
+//                      Added Parameter sweep gallery menu item
+//                      Added Convert hex text file to binary file menu item
+//                      Waits for .png files still being written on exit, reports errors
+//                      writing them
 // 
 //  This appliction stores user parameters in a Windows style .ini file
 //  The MySETIBCA.ini file must be in the same directory as the exectable
@@ -174,6 +186,8 @@
 #include "imageheader.h"
 #include "FileFunctions.h"
 #include "CA.h"
+#include "BCAengine.h"
+#include "PNGwriter.h"
 
 #define MAX_LOADSTRING 100
 
@@ -191,6 +205,7 @@ WCHAR szTempDir[MAX_PATH] = L"";        // used as a temporary storage location
 Layers* ImageLayers = NULL;     // This class loads the image layers, combines them into the Overlay image
 Display* Displays = NULL;       // This class creates a refernce image based on the display format paraneters
                                 // and then inserts the Overlay image to create the Dislay image
+BCAengine* MargolusEngine = NULL;   // This class runs the Margolus BCA dialog simulation, its image is layer 0
 ImageDialog* ImgDlg = NULL;     // This class is used to support displaying the Display image in a window
                                 // on the desktop.  This also includes scaling and panning of the displayed image
 
@@ -236,8 +251,13 @@ INT_PTR CALLBACK    SettingsGlobalDlg(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    ImageDlg(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    Text2StreamDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam);
 INT_PTR CALLBACK    BitImageDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam);
+INT_PTR CALLBACK    BitSearchDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam);
+INT_PTR CALLBACK    RunProfileDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam);
+INT_PTR CALLBACK    AutocorrDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam);
+INT_PTR CALLBACK    GalleryDlg(HWND hDlg, UINT message, WPARAM wParam, LPARAM lParam);
 INT_PTR CALLBACK    MargolusBCADlg(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    ReceiveASISdlg(HWND, UINT, WPARAM, LPARAM);
+INT_PTR CALLBACK    ReceiveASISbatchDlg(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    SendASISdlg(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    UnaryDlg(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    GenericFSMdlg(HWND, UINT, WPARAM, LPARAM);
@@ -410,6 +430,7 @@ BOOL InitInstance(HINSTANCE hInstance, int nCmdShow)
    hwndMain = hWnd;
    ImgDlg = new ImageDialog;
    ImageLayers = new Layers;
+   MargolusEngine = new BCAengine;
    Displays = new Display;
 
    // create display window
@@ -712,6 +733,26 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
             DialogBox(hInst, MAKEINTRESOURCE(IDD_BITTOOLS_BINARYIMAGE), hWnd, BitImageDlg);
             break;
 
+        case IDM_BITTOOLS_BITSEARCH:
+            DialogBox(hInst, MAKEINTRESOURCE(IDD_BITTOOLS_BITSEARCH), hWnd, BitSearchDlg);
+            break;
+
+        case IDM_BITTOOLS_RUNPROFILE:
+            DialogBox(hInst, MAKEINTRESOURCE(IDD_BITTOOLS_RUNPROFILE), hWnd, RunProfileDlg);
+            break;
+
+        case IDM_BITTOOLS_AUTOCORR:
+            DialogBox(hInst, MAKEINTRESOURCE(IDD_BITTOOLS_AUTOCORR), hWnd, AutocorrDlg);
+            break;
+
+        case IDM_BITTOOLS_GALLERY:
+            DialogBox(hInst, MAKEINTRESOURCE(IDD_BITTOOLS_GALLERY), hWnd, GalleryDlg);
+            break;
+
+        case IDM_FILE_HEX2BINARY:
+            HEX2Binary(hWnd);
+            break;
+
         case IDM_EXIT:
         {
             if (hwndImage) {
@@ -747,6 +788,12 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
             break;
         }
 
+        case IDM_RECEIVE_ASIS_BATCH:
+        {
+            DialogBox(hInst, MAKEINTRESOURCE(IDD_RECEIVE_ASIS_BATCH), hWnd, ReceiveASISbatchDlg);
+            break;
+        }
+
         case IDM_SEND_ASIS:
         {
             DialogBox(hInst, MAKEINTRESOURCE(IDD_SEND_ASIS), hWnd, SendASISdlg);
@@ -811,13 +858,13 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
     } // This is the end of WM_COMMAND
   
     case WM_TIMER:
-        if (BCArunning == 0) {
+        if (MargolusEngine->GetRunning() == 0) {
             KillTimer(hWnd, IDT_BCA_RUN_TIMER);
         }
-        if (BCArunning == 1) {
+        if (MargolusEngine->GetRunning() == 1) {
             PostMessage(hwndMargolusBCA, WM_COMMAND, IDC_STEP_FORWARD, 0);
         }
-        else {
+        else if (MargolusEngine->GetRunning() == -1) {
             PostMessage(hwndMargolusBCA, WM_COMMAND, IDC_STEP_BACKWARD, 0);
         }
         return 0;
@@ -896,9 +943,18 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 
         // delete the global classes;
         if (ImageLayers != NULL) delete ImageLayers;
+        if (MargolusEngine != NULL) delete MargolusEngine;
         if (Displays != NULL) delete Displays;
         if (ImgDlg != NULL) delete ImgDlg;
 
+        // finish any .png files still being written in the background
+        {
+            int iRes = WaitPNG();
+            if (iRes != APP_SUCCESS) {
+                MessageMySETIBCAError(NULL, iRes, L"Saving .png files");
+            }
+        }
+
         PostQuitMessage(0);
         break;
     }
@@ -0,0 +1,1045 @@
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// PNGwriter.cpp
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the PNG writer and the deflate (RFC 1951) compressor it uses
+//
+// V1.2.0	2026-10-19	Added PNG writer, encodes .png files from images in memory
+//					Round trip check with zlib in tools/PNGtest
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+//	PNG specification: https://www.w3.org/TR/png/
+//	The image data is a zlib (RFC 1950) stream of deflate blocks.  Each block
+//	is written as stored, fixed Huffman or dynamic Huffman codes, whichever
+//	is smallest for that block.
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <system_error>
+#include "AppErrors.h"
+#include "PNGwriter.h"
+
+#define DEFLATE_WINDOW 32768			// largest match distance
+#define DEFLATE_HASH_BITS 15
+#define DEFLATE_MIN_MATCH 3
+#define DEFLATE_MAX_MATCH 258
+#define DEFLATE_BLOCK_TOKENS 65536		// literals and matches in a block
+#define DEFLATE_STORED_MAX 65535		// largest stored block
+#define PNG_IDAT_SIZE (256 * 1024)		// largest IDAT chunk
+
+// hash chain search, by level
+static const int MaxChain[PNG_LEVEL_MAX + 1] = { 0, 0, 4, 8, 16, 32, 128, 256, 1024, 4096 };
+static const int NiceLength[PNG_LEVEL_MAX + 1] = { 0, 0, 8, 16, 32, 64, 128, 128, 258, 258 };
+// levels >= DEFLATE_LAZY_LEVEL look one byte ahead for a longer match when the
+// match is shorter than LazyLength, and search 1/4 of the chain when it is at
+// least GoodLength.  Lower levels only put the bytes of matches up to
+// LazyLength in the hash chains.
+#define DEFLATE_LAZY_LEVEL 4
+static const int LazyLength[PNG_LEVEL_MAX + 1] = { 0, 0, 4, 5, 4, 16, 16, 32, 128, 258 };
+static const int GoodLength[PNG_LEVEL_MAX + 1] = { 0, 0, 4, 4, 4, 8, 8, 8, 32, 32 };
+
+// length codes 257 to 285
+static const uint16_t LengthBase[29] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t LengthExtra[29] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+
+// distance codes 0 to 29
+static const uint16_t DistBase[30] = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t DistExtra[30] = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+// order the code length code lengths are written in
+static const uint8_t CodeLengthOrder[19] = {
+	16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+typedef struct {
+	uint16_t Length;		// match length, or the literal byte if Dist == 0
+	uint16_t Dist;			// match distance, 0 for a literal
+} DEFLATETOKEN;
+
+typedef struct {
+	std::vector<uint8_t>* Out;
+	uint64_t Bits;			// bits not written yet, LSB first
+	int NumBits;
+} BITWRITER;
+
+// tables built once
+typedef struct DEFLATETABLES {
+	uint8_t LengthCode[DEFLATE_MAX_MATCH + 1];	// length -> length code - 257
+	uint8_t DistCode[512];						// see GetDistCode()
+	uint32_t CRC[256];
+
+	DEFLATETABLES() {
+		for (int Code = 0; Code < 29; Code++) {
+			for (int i = 0; i < (1 << LengthExtra[Code]); i++) {
+				if (LengthBase[Code] + i <= DEFLATE_MAX_MATCH) {
+					LengthCode[LengthBase[Code] + i] = (uint8_t)Code;
+				}
+			}
+		}
+		// 258 has its own code, not 284 + 31
+		LengthCode[DEFLATE_MAX_MATCH] = 28;
+
+		for (int Code = 0; Code < 30; Code++) {
+			for (int i = 0; i < (1 << DistExtra[Code]); i++) {
+				int Dist = DistBase[Code] + i - 1;
+				if (Dist < 256) {
+					DistCode[Dist] = (uint8_t)Code;
+				}
+				else {
+					DistCode[256 + (Dist >> 7)] = (uint8_t)Code;
+				}
+			}
+		}
+
+		for (uint32_t n = 0; n < 256; n++) {
+			uint32_t c = n;
+			for (int k = 0; k < 8; k++) {
+				c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+			}
+			CRC[n] = c;
+		}
+	}
+} DEFLATETABLES;
+
+static const DEFLATETABLES Tables;
+
+static int GetDistCode(int Dist)
+{
+	Dist--;
+	return Dist < 256 ? Tables.DistCode[Dist] : Tables.DistCode[256 + (Dist >> 7)];
+}
+
+//*******************************************************************************
+//
+//  PutBits, AlignBits
+//
+// Write bits LSB first, as deflate packs them.  AlignBits() pads with 0 bits
+// to a whole byte.
+//
+//*******************************************************************************
+static void PutBits(BITWRITER* Writer, uint32_t Value, int NumBits)
+{
+	Writer->Bits |= (uint64_t)Value << Writer->NumBits;
+	Writer->NumBits += NumBits;
+	while (Writer->NumBits >= 8) {
+		Writer->Out->push_back((uint8_t)Writer->Bits);
+		Writer->Bits >>= 8;
+		Writer->NumBits -= 8;
+	}
+}
+
+static void AlignBits(BITWRITER* Writer)
+{
+	if (Writer->NumBits > 0) {
+		Writer->Out->push_back((uint8_t)Writer->Bits);
+	}
+	Writer->Bits = 0;
+	Writer->NumBits = 0;
+}
+
+//*******************************************************************************
+//
+//  BuildLengths
+//
+// Huffman code lengths for symbol frequencies, no longer than MaxBits.
+// If the code is too long the frequencies are halved until it fits.
+// At least 2 symbols always get a code so the code is complete.
+//
+// Parameters:
+//	const uint32_t* Freq	frequency of each symbol
+//	int NumSymbols			# of symbols
+//	int MaxBits				longest code allowed
+//	uint8_t* Lengths		code length of each symbol, 0 if not used
+//
+//*******************************************************************************
+static void BuildLengths(const uint32_t* Freq, int NumSymbols, int MaxBits, uint8_t* Lengths)
+{
+	std::vector<uint32_t> Weight(Freq, Freq + NumSymbols);
+	std::vector<int> Leaves;
+
+	for (int i = 0; i < NumSymbols; i++) {
+		if (Weight[i] != 0) {
+			Leaves.push_back(i);
+		}
+	}
+	for (int i = 0; Leaves.size() < 2 && i < NumSymbols; i++) {
+		if (Weight[i] == 0) {
+			Weight[i] = 1;
+			Leaves.push_back(i);
+		}
+	}
+	memset(Lengths, 0, NumSymbols);
+
+	int NumLeaves = (int)Leaves.size();
+	std::vector<uint64_t> NodeWeight(2 * NumLeaves);
+	std::vector<int> Parent(2 * NumLeaves);
+	std::vector<int> Depth(2 * NumLeaves);
+
+	for (;;) {
+		// leaves in order of weight, internal nodes are made in order of
+		// weight too, so the two lightest are always at the front of the two queues
+		std::sort(Leaves.begin(), Leaves.end(), [&Weight](int a, int b) {
+			return Weight[a] < Weight[b] || (Weight[a] == Weight[b] && a < b); });
+		for (int i = 0; i < NumLeaves; i++) {
+			NodeWeight[i] = Weight[Leaves[i]];
+		}
+		int NextLeaf = 0;
+		int NextNode = NumLeaves;
+		int NumNodes = NumLeaves;
+		while (NumNodes < 2 * NumLeaves - 1) {
+			int Pick[2];
+			for (int k = 0; k < 2; k++) {
+				if (NextLeaf < NumLeaves &&
+					(NextNode >= NumNodes || NodeWeight[NextLeaf] <= NodeWeight[NextNode])) {
+					Pick[k] = NextLeaf++;
+				}
+				else {
+					Pick[k] = NextNode++;
+				}
+			}
+			NodeWeight[NumNodes] = NodeWeight[Pick[0]] + NodeWeight[Pick[1]];
+			Parent[Pick[0]] = NumNodes;
+			Parent[Pick[1]] = NumNodes;
+			NumNodes++;
+		}
+
+		// the root is the last node, parents always come after their children
+		int MaxDepth = 0;
+		Depth[NumNodes - 1] = 0;
+		for (int i = NumNodes - 2; i >= 0; i--) {
+			Depth[i] = Depth[Parent[i]] + 1;
+			if (Depth[i] > MaxDepth) {
+				MaxDepth = Depth[i];
+			}
+		}
+		if (MaxDepth <= MaxBits) {
+			for (int i = 0; i < NumLeaves; i++) {
+				Lengths[Leaves[i]] = (uint8_t)Depth[i];
+			}
+			return;
+		}
+
+		// flatten the frequencies and try again
+		for (int i = 0; i < NumLeaves; i++) {
+			Weight[Leaves[i]] = (Weight[Leaves[i]] >> 1) | 1;
+		}
+	}
+}
+
+//*******************************************************************************
+//
+//  BuildCodes
+//
+// Canonical Huffman codes for code lengths (RFC 1951 3.2.2), bit reversed
+// so they can be written LSB first with PutBits().
+//
+//*******************************************************************************
+static void BuildCodes(const uint8_t* Lengths, int NumSymbols, uint16_t* Codes)
+{
+	int Count[16] = { 0 };
+	int NextCode[16];
+
+	for (int i = 0; i < NumSymbols; i++) {
+		Count[Lengths[i]]++;
+	}
+	Count[0] = 0;
+	int Code = 0;
+	for (int Bits = 1; Bits < 16; Bits++) {
+		Code = (Code + Count[Bits - 1]) << 1;
+		NextCode[Bits] = Code;
+	}
+	for (int i = 0; i < NumSymbols; i++) {
+		int Len = Lengths[i];
+		Codes[i] = 0;
+		if (Len != 0) {
+			int c = NextCode[Len]++;
+			int r = 0;
+			for (int b = 0; b < Len; b++) {
+				r = (r << 1) | ((c >> b) & 1);
+			}
+			Codes[i] = (uint16_t)r;
+		}
+	}
+}
+
+//*******************************************************************************
+//
+//  WriteStored
+//
+// Stored deflate blocks for Size bytes, split into blocks of
+// DEFLATE_STORED_MAX bytes.
+//
+//*******************************************************************************
+static void WriteStored(BITWRITER* Writer, const uint8_t* Data, size_t Size, bool Final)
+{
+	do {
+		size_t Len = Size < DEFLATE_STORED_MAX ? Size : DEFLATE_STORED_MAX;
+		PutBits(Writer, (Final && Len == Size) ? 1 : 0, 1);
+		PutBits(Writer, 0, 2);
+		AlignBits(Writer);
+		PutBits(Writer, (uint32_t)Len, 16);
+		PutBits(Writer, (uint32_t)(~Len & 0xffff), 16);
+		Writer->Out->insert(Writer->Out->end(), Data, Data + Len);
+		Data += Len;
+		Size -= Len;
+	} while (Size != 0);
+}
+
+//*******************************************************************************
+//
+//  WriteBlock
+//
+// Write the tokens as one deflate block, or stored blocks of the same bytes
+// if that is smaller.  Dynamic Huffman codes are used unless the fixed codes
+// are as small.
+//
+// Parameters:
+//	BITWRITER* Writer
+//	const std::vector<DEFLATETOKEN>& Tokens
+//	const uint8_t* Data		bytes the tokens encode
+//	size_t Size				# of bytes
+//	bool Final				last block of the stream
+//
+//*******************************************************************************
+static void WriteBlock(BITWRITER* Writer, const std::vector<DEFLATETOKEN>& Tokens,
+	const uint8_t* Data, size_t Size, bool Final)
+{
+	uint32_t LitFreq[286] = { 0 };
+	uint32_t DistFreq[30] = { 0 };
+	uint64_t ExtraBits = 0;
+
+	for (size_t i = 0; i < Tokens.size(); i++) {
+		if (Tokens[i].Dist == 0) {
+			LitFreq[Tokens[i].Length]++;
+		}
+		else {
+			int LCode = Tables.LengthCode[Tokens[i].Length];
+			int DCode = GetDistCode(Tokens[i].Dist);
+			LitFreq[257 + LCode]++;
+			DistFreq[DCode]++;
+			ExtraBits += LengthExtra[LCode] + DistExtra[DCode];
+		}
+	}
+	LitFreq[256] = 1;
+
+	// dynamic codes
+	uint8_t LitLengths[286];
+	uint8_t DistLengths[30];
+	BuildLengths(LitFreq, 286, 15, LitLengths);
+	BuildLengths(DistFreq, 30, 15, DistLengths);
+
+	int NumLit = 286;
+	while (NumLit > 257 && LitLengths[NumLit - 1] == 0) NumLit--;
+	int NumDist = 30;
+	while (NumDist > 1 && DistLengths[NumDist - 1] == 0) NumDist--;
+
+	// run length code the code lengths, symbol | extra value << 8
+	uint8_t AllLengths[286 + 30];
+	int NumLengths = NumLit + NumDist;
+	memcpy(AllLengths, LitLengths, NumLit);
+	memcpy(AllLengths + NumLit, DistLengths, NumDist);
+
+	std::vector<uint16_t> CLsymbols;
+	uint32_t CLFreq[19] = { 0 };
+	for (int i = 0; i < NumLengths;) {
+		int Len = AllLengths[i];
+		int Run = 1;
+		while (i + Run < NumLengths && AllLengths[i + Run] == Len) Run++;
+		i += Run;
+		if (Len == 0) {
+			while (Run >= 11) {
+				int n = Run < 138 ? Run : 138;
+				CLsymbols.push_back((uint16_t)(18 | ((n - 11) << 8)));
+				Run -= n;
+			}
+			if (Run >= 3) {
+				CLsymbols.push_back((uint16_t)(17 | ((Run - 3) << 8)));
+				Run = 0;
+			}
+		}
+		else {
+			CLsymbols.push_back((uint16_t)Len);
+			Run--;
+			while (Run >= 3) {
+				int n = Run < 6 ? Run : 6;
+				CLsymbols.push_back((uint16_t)(16 | ((n - 3) << 8)));
+				Run -= n;
+			}
+		}
+		while (Run > 0) {
+			CLsymbols.push_back((uint16_t)Len);
+			Run--;
+		}
+	}
+	for (size_t i = 0; i < CLsymbols.size(); i++) {
+		CLFreq[CLsymbols[i] & 0xff]++;
+	}
+	uint8_t CLLengths[19];
+	BuildLengths(CLFreq, 19, 7, CLLengths);
+	int NumCL = 19;
+	while (NumCL > 4 && CLLengths[CodeLengthOrder[NumCL - 1]] == 0) NumCL--;
+
+	// sizes in bits of the three ways to write the block
+	uint64_t DynamicBits = 3 + 5 + 5 + 4 + 3 * NumCL + ExtraBits;
+	uint64_t FixedBits = 3 + ExtraBits;
+	for (size_t i = 0; i < CLsymbols.size(); i++) {
+		int Sym = CLsymbols[i] & 0xff;
+		DynamicBits += CLLengths[Sym] + (Sym == 16 ? 2 : Sym == 17 ? 3 : Sym == 18 ? 7 : 0);
+	}
+	for (int i = 0; i < 286; i++) {
+		DynamicBits += (uint64_t)LitFreq[i] * LitLengths[i];
+		FixedBits += (uint64_t)LitFreq[i] * (i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8);
+	}
+	for (int i = 0; i < 30; i++) {
+		DynamicBits += (uint64_t)DistFreq[i] * DistLengths[i];
+		FixedBits += (uint64_t)DistFreq[i] * 5;
+	}
+	uint64_t StoredBits = (uint64_t)Size * 8 +
+		(uint64_t)((Size + DEFLATE_STORED_MAX - 1) / DEFLATE_STORED_MAX + 1) * (3 + 7 + 32);
+
+	if (StoredBits <= DynamicBits && StoredBits <= FixedBits) {
+		WriteStored(Writer, Data, Size, Final);
+		return;
+	}
+
+	uint16_t LitCodes[288];
+	uint16_t DistCodes[30];
+	if (FixedBits <= DynamicBits) {
+		uint8_t FixedLit[288];
+		uint8_t FixedDist[30];
+		for (int i = 0; i < 288; i++) {
+			FixedLit[i] = (uint8_t)(i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8);
+		}
+		memset(FixedDist, 5, sizeof(FixedDist));
+		BuildCodes(FixedLit, 288, LitCodes);
+		BuildCodes(FixedDist, 30, DistCodes);
+		memcpy(LitLengths, FixedLit, 286);
+		memcpy(DistLengths, FixedDist, 30);
+		PutBits(Writer, Final ? 1 : 0, 1);
+		PutBits(Writer, 1, 2);
+	}
+	else {
+		uint16_t CLCodes[19];
+		BuildCodes(LitLengths, 286, LitCodes);
+		BuildCodes(DistLengths, 30, DistCodes);
+		BuildCodes(CLLengths, 19, CLCodes);
+		PutBits(Writer, Final ? 1 : 0, 1);
+		PutBits(Writer, 2, 2);
+		PutBits(Writer, NumLit - 257, 5);
+		PutBits(Writer, NumDist - 1, 5);
+		PutBits(Writer, NumCL - 4, 4);
+		for (int i = 0; i < NumCL; i++) {
+			PutBits(Writer, CLLengths[CodeLengthOrder[i]], 3);
+		}
+		for (size_t i = 0; i < CLsymbols.size(); i++) {
+			int Sym = CLsymbols[i] & 0xff;
+			int Extra = CLsymbols[i] >> 8;
+			PutBits(Writer, CLCodes[Sym], CLLengths[Sym]);
+			if (Sym == 16) PutBits(Writer, Extra, 2);
+			else if (Sym == 17) PutBits(Writer, Extra, 3);
+			else if (Sym == 18) PutBits(Writer, Extra, 7);
+		}
+	}
+
+	for (size_t i = 0; i < Tokens.size(); i++) {
+		if (Tokens[i].Dist == 0) {
+			PutBits(Writer, LitCodes[Tokens[i].Length], LitLengths[Tokens[i].Length]);
+		}
+		else {
+			int LCode = Tables.LengthCode[Tokens[i].Length];
+			int DCode = GetDistCode(Tokens[i].Dist);
+			PutBits(Writer, LitCodes[257 + LCode], LitLengths[257 + LCode]);
+			PutBits(Writer, Tokens[i].Length - LengthBase[LCode], LengthExtra[LCode]);
+			PutBits(Writer, DistCodes[DCode], DistLengths[DCode]);
+			PutBits(Writer, Tokens[i].Dist - DistBase[DCode], DistExtra[DCode]);
+		}
+	}
+	PutBits(Writer, LitCodes[256], LitLengths[256]);
+}
+
+//*******************************************************************************
+//
+//  Deflate
+//
+// Compress bytes as a raw deflate stream (RFC 1951).
+//
+// Parameters:
+//	const uint8_t* Data		bytes to compress
+//	size_t Size				# of bytes
+//	int Level				PNG_LEVEL_STORE to PNG_LEVEL_MAX
+//	std::vector<uint8_t>& Out	the stream is appended to this
+//
+//*******************************************************************************
+static void Deflate(const uint8_t* Data, size_t Size, int Level, std::vector<uint8_t>& Out)
+{
+	BITWRITER Writer = { &Out, 0, 0 };
+
+	if (Level == PNG_LEVEL_STORE) {
+		WriteStored(&Writer, Data, Size, true);
+		return;
+	}
+
+	std::vector<DEFLATETOKEN> Tokens;
+	Tokens.reserve(DEFLATE_BLOCK_TOKENS);
+	std::vector<int> Head;
+	std::vector<int> Prev;
+	if (Level != PNG_LEVEL_RLE) {
+		Head.assign((size_t)1 << DEFLATE_HASH_BITS, -1);
+		Prev.assign(DEFLATE_WINDOW, -1);
+	}
+	size_t NextInsert = 0;		// positions before this are in the hash chains
+	size_t BlockStart = 0;
+	size_t Pos = 0;
+
+	// put positions up to and including Last in the hash chains
+	auto Insert = [&](size_t Last) {
+		for (; NextInsert <= Last && NextInsert + DEFLATE_MIN_MATCH <= Size; NextInsert++) {
+			const uint8_t* p = Data + NextInsert;
+			int Hash = ((p[0] << 10) ^ (p[1] << 5) ^ p[2]) & ((1 << DEFLATE_HASH_BITS) - 1);
+			Prev[NextInsert & (DEFLATE_WINDOW - 1)] = Head[Hash];
+			Head[Hash] = (int)NextInsert;
+		}
+	};
+
+	// longest match for the bytes at At, returns the length, 0 if < DEFLATE_MIN_MATCH
+	auto FindMatch = [&](size_t At, int Chain, int* Dist) -> int {
+		size_t MaxLen = Size - At < DEFLATE_MAX_MATCH ? Size - At : DEFLATE_MAX_MATCH;
+		int Best = 0;
+		if (MaxLen < DEFLATE_MIN_MATCH) {
+			return 0;
+		}
+		if (Level == PNG_LEVEL_RLE) {
+			// the previous byte repeated, distance 1
+			if (At == 0) {
+				return 0;
+			}
+			uint8_t b = Data[At - 1];
+			size_t Len = 0;
+			while (Len < MaxLen && Data[At + Len] == b) Len++;
+			if (Len < DEFLATE_MIN_MATCH) {
+				return 0;
+			}
+			*Dist = 1;
+			return (int)Len;
+		}
+
+		Insert(At);
+		int Candidate = Prev[At & (DEFLATE_WINDOW - 1)];
+		while (Candidate >= 0 && At - (size_t)Candidate <= DEFLATE_WINDOW && Chain-- > 0) {
+			const uint8_t* a = Data + Candidate;
+			const uint8_t* b = Data + At;
+			if (a[Best] == b[Best] && a[0] == b[0] && a[1] == b[1]) {
+				size_t Len = 2;
+				uint64_t x, y;
+				while (Len + 8 <= MaxLen && (memcpy(&x, a + Len, 8), memcpy(&y, b + Len, 8), x == y)) Len += 8;
+				while (Len < MaxLen && a[Len] == b[Len]) Len++;
+				if ((int)Len > Best) {
+					Best = (int)Len;
+					*Dist = (int)(At - Candidate);
+					if (Best >= NiceLength[Level] || Len == MaxLen) {
+						break;
+					}
+				}
+			}
+			int Next = Prev[Candidate & (DEFLATE_WINDOW - 1)];
+			if (Next >= Candidate) {
+				break;
+			}
+			Candidate = Next;
+		}
+		return Best >= DEFLATE_MIN_MATCH ? Best : 0;
+	};
+
+	while (Pos < Size) {
+		int Dist = 0;
+		int Len = FindMatch(Pos, MaxChain[Level], &Dist);
+
+		if (Len != 0 && Level >= DEFLATE_LAZY_LEVEL) {
+			// a longer match one byte later is better than this one
+			while (Len < LazyLength[Level] && Pos + 1 < Size) {
+				int NextDist = 0;
+				int Chain = Len >= GoodLength[Level] ? MaxChain[Level] >> 2 : MaxChain[Level];
+				int NextLen = FindMatch(Pos + 1, Chain, &NextDist);
+				if (NextLen <= Len) {
+					break;
+				}
+				Tokens.push_back({ (uint16_t)Data[Pos], 0 });
+				Pos++;
+				Len = NextLen;
+				Dist = NextDist;
+			}
+		}
+
+		if (Len == 0) {
+			Tokens.push_back({ (uint16_t)Data[Pos], 0 });
+			Pos++;
+		}
+		else {
+			Tokens.push_back({ (uint16_t)Len, (uint16_t)Dist });
+			Pos += Len;
+			if (Level >= DEFLATE_LAZY_LEVEL || Len <= LazyLength[Level]) {
+				Insert(Pos - 1);
+			}
+			else if (Level != PNG_LEVEL_RLE) {
+				NextInsert = Pos;
+			}
+		}
+
+		if (Tokens.size() >= DEFLATE_BLOCK_TOKENS - 2 && Pos < Size) {
+			WriteBlock(&Writer, Tokens, Data + BlockStart, Pos - BlockStart, false);
+			Tokens.clear();
+			BlockStart = Pos;
+		}
+	}
+	WriteBlock(&Writer, Tokens, Data + BlockStart, Size - BlockStart, true);
+	AlignBits(&Writer);
+}
+
+//*******************************************************************************
+//
+//  Adler32, CRC32
+//
+//*******************************************************************************
+static uint32_t Adler32(const uint8_t* Data, size_t Size)
+{
+	uint32_t a = 1;
+	uint32_t b = 0;
+
+	while (Size > 0) {
+		// 5552 bytes is the most that can be summed before b overflows
+		size_t n = Size < 5552 ? Size : 5552;
+		Size -= n;
+		while (n-- > 0) {
+			a += *Data++;
+			b += a;
+		}
+		a %= 65521;
+		b %= 65521;
+	}
+	return (b << 16) | a;
+}
+
+static uint32_t CRC32(uint32_t CRC, const uint8_t* Data, size_t Size)
+{
+	CRC = ~CRC;
+	for (size_t i = 0; i < Size; i++) {
+		CRC = Tables.CRC[(CRC ^ Data[i]) & 0xff] ^ (CRC >> 8);
+	}
+	return ~CRC;
+}
+
+static void PutUint32(std::vector<uint8_t>& Out, uint32_t Value)
+{
+	Out.push_back((uint8_t)(Value >> 24));
+	Out.push_back((uint8_t)(Value >> 16));
+	Out.push_back((uint8_t)(Value >> 8));
+	Out.push_back((uint8_t)Value);
+}
+
+static void PutChunk(std::vector<uint8_t>& Out, const char* Type, const uint8_t* Data, size_t Size)
+{
+	PutUint32(Out, (uint32_t)Size);
+	size_t Start = Out.size();
+	Out.insert(Out.end(), Type, Type + 4);
+	if (Size != 0) {
+		Out.insert(Out.end(), Data, Data + Size);
+	}
+	PutUint32(Out, CRC32(0, Out.data() + Start, Size + 4));
+}
+
+//*******************************************************************************
+//
+//  GetRowBytes
+//
+// # of bytes in a row of the image, 0 if the image is not valid
+//
+//*******************************************************************************
+static size_t GetRowBytes(const PNGIMAGE* Image)
+{
+	size_t RowBytes;
+
+	if (Image == NULL || Image->Pixels == NULL || Image->Xsize <= 0 || Image->Ysize <= 0) {
+		return 0;
+	}
+	switch (Image->Format) {
+	case PNG_GREY1:
+		RowBytes = ((size_t)Image->Xsize + 7) / 8;
+		break;
+	case PNG_GREY8:
+		RowBytes = (size_t)Image->Xsize;
+		break;
+	case PNG_RGB24:
+		RowBytes = (size_t)Image->Xsize * 3;
+		break;
+	default:
+		return 0;
+	}
+	if (Image->Stride < RowBytes) {
+		return 0;
+	}
+	return RowBytes;
+}
+
+//*******************************************************************************
+//
+//  FilterRow
+//
+// Choose the PNG filter for a row, the one with the smallest sum of the
+// filtered bytes taken as signed values, and write the filter type and
+// the filtered row to Dest.
+//
+// Parameters:
+//	const uint8_t* Row		row to filter
+//	const uint8_t* Above	row above it, all 0 for the first row
+//	size_t RowBytes
+//	int Bpp					bytes per pixel, 1 or 3
+//	uint8_t* Dest			RowBytes+1 bytes
+//	uint8_t* Temp			RowBytes bytes
+//
+//*******************************************************************************
+static void FilterRow(const uint8_t* Row, const uint8_t* Above, size_t RowBytes, int Bpp,
+	uint8_t* Dest, uint8_t* Temp)
+{
+	uint64_t BestSum = UINT64_MAX;
+	size_t First = (size_t)Bpp < RowBytes ? (size_t)Bpp : RowBytes;
+
+	for (int Type = 0; Type < 5; Type++) {
+		// the first pixel has no pixel to its left, a and c are 0 for it
+		switch (Type) {
+		case 0:
+			memcpy(Temp, Row, RowBytes);
+			break;
+		case 1:
+			memcpy(Temp, Row, First);
+			for (size_t i = First; i < RowBytes; i++) {
+				Temp[i] = (uint8_t)(Row[i] - Row[i - Bpp]);
+			}
+			break;
+		case 2:
+			for (size_t i = 0; i < RowBytes; i++) {
+				Temp[i] = (uint8_t)(Row[i] - Above[i]);
+			}
+			break;
+		case 3:
+			for (size_t i = 0; i < First; i++) {
+				Temp[i] = (uint8_t)(Row[i] - (Above[i] >> 1));
+			}
+			for (size_t i = First; i < RowBytes; i++) {
+				Temp[i] = (uint8_t)(Row[i] - ((Row[i - Bpp] + Above[i]) >> 1));
+			}
+			break;
+		default:
+			// Paeth with a = c = 0 is b
+			for (size_t i = 0; i < First; i++) {
+				Temp[i] = (uint8_t)(Row[i] - Above[i]);
+			}
+			for (size_t i = First; i < RowBytes; i++) {
+				int a = Row[i - Bpp];
+				int b = Above[i];
+				int c = Above[i - Bpp];
+				int pa = abs(b - c);
+				int pb = abs(a - c);
+				int pc = abs(a + b - c - c);
+				int Predict = (pa <= pb && pa <= pc) ? a : (pb <= pc) ? b : c;
+				Temp[i] = (uint8_t)(Row[i] - Predict);
+			}
+			break;
+		}
+
+		uint64_t Sum = 0;
+		for (size_t i = 0; i < RowBytes && Sum < BestSum; i++) {
+			Sum += Temp[i] < 128 ? Temp[i] : 256 - Temp[i];
+		}
+		if (Sum < BestSum) {
+			BestSum = Sum;
+			Dest[0] = (uint8_t)Type;
+			memcpy(Dest + 1, Temp, RowBytes);
+		}
+	}
+}
+
+//*******************************************************************************
+//
+//  EncodePNG
+//
+// Encode an image as a .png file in memory.
+//
+// Parameters:
+//	const PNGIMAGE* Image	pixels to encode, see PNGwriter.h for the row layout
+//	int Level				PNG_LEVEL_STORE, PNG_LEVEL_RLE, 2 to PNG_LEVEL_MAX
+//							higher levels are smaller and slower
+//	std::vector<uint8_t>& PNG	the .png file bytes
+//
+//	return value:
+//	1 - Success
+//	!=1 Error see standardized app error list in AppErrors.h
+//
+//*******************************************************************************
+int EncodePNG(const PNGIMAGE* Image, int Level, std::vector<uint8_t>& PNG)
+{
+	size_t RowBytes = GetRowBytes(Image);
+	if (RowBytes == 0 || Level < PNG_LEVEL_STORE || Level > PNG_LEVEL_MAX) {
+		return APPERR_PARAMETER;
+	}
+	int Bpp = Image->Format == PNG_RGB24 ? 3 : 1;
+
+	// filter the rows, each row starts with its filter type
+	// 1 bit rows are not filtered, bytes of 8 pixels do not predict well
+	std::vector<uint8_t> Filtered(((size_t)RowBytes + 1) * Image->Ysize);
+	std::vector<uint8_t> Zeros(RowBytes, 0);
+	std::vector<uint8_t> Temp(RowBytes);
+	for (int y = 0; y < Image->Ysize; y++) {
+		const uint8_t* Row = Image->Pixels + (size_t)y * Image->Stride;
+		const uint8_t* Above = y == 0 ? Zeros.data() : Row - Image->Stride;
+		uint8_t* Dest = Filtered.data() + (size_t)y * (RowBytes + 1);
+		if (Level == PNG_LEVEL_STORE || Image->Format == PNG_GREY1) {
+			Dest[0] = 0;
+			memcpy(Dest + 1, Row, RowBytes);
+		}
+		else {
+			FilterRow(Row, Above, RowBytes, Bpp, Dest, Temp.data());
+		}
+	}
+
+	// zlib stream
+	std::vector<uint8_t> Zlib;
+	Zlib.reserve(Filtered.size() / 4 + 64);
+	Zlib.push_back(0x78);
+	Zlib.push_back(Level <= PNG_LEVEL_RLE ? 0x01 : Level < PNG_LEVEL_DEFAULT ? 0x5e :
+		Level == PNG_LEVEL_DEFAULT ? 0x9c : 0xda);
+	Deflate(Filtered.data(), Filtered.size(), Level, Zlib);
+	PutUint32(Zlib, Adler32(Filtered.data(), Filtered.size()));
+
+	static const uint8_t Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+	uint8_t IHDR[13];
+	IHDR[0] = (uint8_t)(Image->Xsize >> 24);
+	IHDR[1] = (uint8_t)(Image->Xsize >> 16);
+	IHDR[2] = (uint8_t)(Image->Xsize >> 8);
+	IHDR[3] = (uint8_t)Image->Xsize;
+	IHDR[4] = (uint8_t)(Image->Ysize >> 24);
+	IHDR[5] = (uint8_t)(Image->Ysize >> 16);
+	IHDR[6] = (uint8_t)(Image->Ysize >> 8);
+	IHDR[7] = (uint8_t)Image->Ysize;
+	IHDR[8] = Image->Format == PNG_GREY1 ? 1 : 8;	// bit depth
+	IHDR[9] = Image->Format == PNG_RGB24 ? 2 : 0;	// color type, truecolor or greyscale
+	IHDR[10] = 0;		// deflate
+	IHDR[11] = 0;		// adaptive filtering
+	IHDR[12] = 0;		// not interlaced
+
+	PNG.clear();
+	PNG.reserve(Zlib.size() + 64);
+	PNG.insert(PNG.end(), Signature, Signature + 8);
+	PutChunk(PNG, "IHDR", IHDR, 13);
+	for (size_t i = 0; i < Zlib.size(); i += PNG_IDAT_SIZE) {
+		size_t n = Zlib.size() - i < PNG_IDAT_SIZE ? Zlib.size() - i : PNG_IDAT_SIZE;
+		PutChunk(PNG, "IDAT", Zlib.data() + i, n);
+	}
+	PutChunk(PNG, "IEND", NULL, 0);
+
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  SavePNG
+//
+// Encode an image and write it to a .png file.
+//
+// Parameters:
+//	const wchar_t* Filename	.png file to write
+//	const PNGIMAGE* Image	pixels to encode
+//	int Level				see EncodePNG()
+//
+//	return value:
+//	1 - Success
+//	!=1 Error see standardized app error list in AppErrors.h
+//
+//*******************************************************************************
+int SavePNG(const wchar_t* Filename, const PNGIMAGE* Image, int Level)
+{
+	std::vector<uint8_t> PNG;
+	int iRes;
+
+	if (Filename == NULL || wcslen(Filename) == 0) {
+		return APPERR_PARAMETER;
+	}
+
+	iRes = EncodePNG(Image, Level, PNG);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+
+	FILE* Out = NULL;
+#ifdef _WIN32
+	_wfopen_s(&Out, Filename, L"wb");
+#else
+	std::vector<char> Name(wcslen(Filename) * MB_CUR_MAX + 1);
+	if (wcstombs(Name.data(), Filename, Name.size()) != (size_t)-1) {
+		Out = fopen(Name.data(), "wb");
+	}
+#endif
+	if (Out == NULL) {
+		return APPERR_FILEOPEN;
+	}
+
+	size_t Written = fwrite(PNG.data(), 1, PNG.size(), Out);
+	if (fclose(Out) != 0 || Written != PNG.size()) {
+		return APPERR_FILEWRITE;
+	}
+
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+// Background writer
+//
+// QueuePNG() copies the pixels and returns, a thread encodes and writes the
+// queued files in order.  The thread is started when something is queued
+// and ends when the queue is empty.
+//
+//*******************************************************************************
+typedef struct {
+	std::wstring Filename;
+	std::vector<uint8_t> Pixels;
+	PNGIMAGE Image;
+	int Level;
+} PNGJOB;
+
+static std::mutex QueueLock;
+static std::condition_variable QueueChanged;
+static std::deque<PNGJOB*> Queue;
+static bool WorkerRunning = false;
+static int QueueError = APP_SUCCESS;		// first error since WaitPNG()
+
+static void PNGworker()
+{
+	std::unique_lock<std::mutex> Lock(QueueLock);
+
+	while (!Queue.empty()) {
+		PNGJOB* Job = Queue.front();
+		Queue.pop_front();
+		QueueChanged.notify_all();
+		Lock.unlock();
+
+		int iRes = SavePNG(Job->Filename.c_str(), &Job->Image, Job->Level);
+		delete Job;
+
+		Lock.lock();
+		if (iRes != APP_SUCCESS && QueueError == APP_SUCCESS) {
+			QueueError = iRes;
+		}
+	}
+	WorkerRunning = false;
+	QueueChanged.notify_all();
+}
+
+//*******************************************************************************
+//
+//  QueuePNG
+//
+// Write a .png file on the background thread.  The pixels are copied so the
+// image can be changed or freed as soon as this returns.  If
+// PNG_QUEUE_LENGTH files are already waiting this waits for one of them.
+//
+// Parameters:
+//	see SavePNG()
+//
+//	return value:
+//	1 - Success, the file is queued, errors writing it are returned by WaitPNG()
+//	!=1 Error see standardized app error list in AppErrors.h
+//
+//*******************************************************************************
+int QueuePNG(const wchar_t* Filename, const PNGIMAGE* Image, int Level)
+{
+	size_t RowBytes = GetRowBytes(Image);
+	if (RowBytes == 0 || Filename == NULL || wcslen(Filename) == 0 ||
+		Level < PNG_LEVEL_STORE || Level > PNG_LEVEL_MAX) {
+		return APPERR_PARAMETER;
+	}
+
+	PNGJOB* Job = new PNGJOB;
+	Job->Filename = Filename;
+	Job->Pixels.resize(RowBytes * Image->Ysize);
+	for (int y = 0; y < Image->Ysize; y++) {
+		memcpy(Job->Pixels.data() + (size_t)y * RowBytes, Image->Pixels + (size_t)y * Image->Stride, RowBytes);
+	}
+	Job->Image = *Image;
+	Job->Image.Stride = RowBytes;
+	Job->Image.Pixels = Job->Pixels.data();
+	Job->Level = Level;
+
+	std::unique_lock<std::mutex> Lock(QueueLock);
+	QueueChanged.wait(Lock, [] { return Queue.size() < PNG_QUEUE_LENGTH; });
+	Queue.push_back(Job);
+	if (!WorkerRunning) {
+		try {
+			std::thread(PNGworker).detach();
+			WorkerRunning = true;
+		}
+		catch (const std::system_error&) {
+			// no thread, write it now
+			Queue.pop_back();
+			Lock.unlock();
+			int iRes = SavePNG(Job->Filename.c_str(), &Job->Image, Job->Level);
+			delete Job;
+			return iRes;
+		}
+	}
+
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  WaitPNG
+//
+// Wait until the queued .png files are written.  Call before the program
+// exits.
+//
+//	return value:
+//	1 - Success, all the files queued since the last WaitPNG() were written
+//	!=1 the first error writing one of them, see AppErrors.h
+//
+//*******************************************************************************
+int WaitPNG()
+{
+	std::unique_lock<std::mutex> Lock(QueueLock);
+	QueueChanged.wait(Lock, [] { return Queue.empty() && !WorkerRunning; });
+
+	int iRes = QueueError;
+	QueueError = APP_SUCCESS;
+	return iRes;
+}
@@ -0,0 +1,65 @@
+#pragma once
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// PNGwriter.h
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+// V1.2.0	2026-10-19	Added PNG writer, encodes .png files from images in memory
+//
+//	This module does not use Windows or any other library, only the standard
+//	C++ library, so it can be built and tested on any platform.
+//
+//	Pixel rows are given in the PNG layout:
+//		PNG_GREY1	8 pixels per byte, pixel 0 is the 0x80 bit, 1 is white
+//					(the PackPixelBits() and PIXELSIZE_1BIT row layout)
+//		PNG_GREY8	1 byte per pixel
+//		PNG_RGB24	3 bytes per pixel, red, green, blue
+//
+#include <stdint.h>
+#include <stddef.h>
+#include <wchar.h>
+#include <vector>
+
+// pixel formats
+#define PNG_GREY1 1
+#define PNG_GREY8 8
+#define PNG_RGB24 24
+
+// deflate levels
+#define PNG_LEVEL_STORE 0		// no compression
+#define PNG_LEVEL_RLE 1			// runs of the same byte only, fast, good for binary images
+#define PNG_LEVEL_DEFAULT 6
+#define PNG_LEVEL_MAX 9
+
+#define PNG_QUEUE_LENGTH 8		// QueuePNG() waits when this many files are waiting
+
+typedef struct {
+	int Xsize;				// # of pixels in a row
+	int Ysize;				// # of rows
+	int Format;				// PNG_GREY1, PNG_GREY8 or PNG_RGB24
+	size_t Stride;			// bytes from the start of one row to the next
+	const uint8_t* Pixels;	// first row
+} PNGIMAGE;
+
+int EncodePNG(const PNGIMAGE* Image, int Level, std::vector<uint8_t>& PNG);
+int SavePNG(const wchar_t* Filename, const PNGIMAGE* Image, int Level);
+int QueuePNG(const wchar_t* Filename, const PNGIMAGE* Image, int Level);
+int WaitPNG();
@@ -0,0 +1,727 @@
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// RunProfile.cpp
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the run length profile of packed bitstream files
+//
+// V1.2.0	2026-10-19	Added run length profile of packed bitstream files
+//					LoadBigEndian64() and ReverseByte[] are shared from BitOrder.h
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+//	Runs are found a 64 bit word at a time.  Each word is XORed with itself
+//	shifted by 1 bit (and the last bit of the word before) which leaves a 1
+//	bit at every run boundary.  The boundaries are taken from this word with
+//	a count leading zeros, so the work is per run, not per bit.
+//
+//	The file is memory mapped and split into chunks that are profiled on a
+//	pool of worker threads, one per processor.  The first and last run of each
+//	chunk can continue into the chunks next to it.  These are returned with
+//	the chunk and joined in file order after all the chunks are done, as are
+//	windows that are split between two chunks.
+//
+//	This is the whole file version of BitSequences() which is only used for
+//	the ASIS footer.
+//
+#include "framework.h"
+#include <stdio.h>
+#include <vector>
+#include "AppErrors.h"
+#include "MappedFile.h"
+#include "BitOrder.h"
+#include "RunProfile.h"
+
+#define RUNPROFILE_CHUNK (16 << 20)	// # of bytes in a chunk, multiple of RUNPROFILE_BLOCK
+#define RUNPROFILE_BLOCK (64 << 10)	// # of bytes profiled at a time in a chunk, multiple of 8
+
+// results from a chunk that are joined with the chunks next to it
+typedef struct {
+	int Status;
+	__int64 BeginBit;			// bits in the chunk
+	__int64 EndBit;
+	int FirstValue;				// run at the start of the chunk
+	__int64 FirstLength;
+	int LastValue;				// run at the end of the chunk
+	__int64 LastLength;
+	BOOL SingleRun;				// TRUE the whole chunk is one run, only First is used
+	__int64 FirstWindowNum;		// windows at the start and end of the chunk
+	__int64 LastWindowNum;
+	RUNWINDOW FirstWindow;
+	RUNWINDOW LastWindow;
+} RUNCHUNK;
+
+// shared by the profile worker threads
+typedef struct {
+	MappedFile* File;
+	BOOL InputBitOrder;			// TRUE bytes in the file are LSB first
+	__int64 BeginBit;			// bits profiled
+	__int64 EndBit;
+	int WindowBits;				// 0 no per window statistics
+	RUNWINDOW* Windows;			// windows not at the start or end of a chunk
+	LONG FirstChunk;			// chunk # of the first chunk, chunk 0 is at the start of the file
+	LONG NumChunks;
+	volatile LONG NextChunk;	// next chunk to profile
+	RUNCHUNK* Chunks;
+	RUNPROFILE* ThreadProfiles;	// one for each thread, added together at the end
+	volatile LONG NextThread;
+} RUNPROFILEWORK;
+
+// state while profiling a chunk
+typedef struct {
+	RUNPROFILEWORK* Work;
+	RUNCHUNK* Chunk;
+	RUNPROFILE* Profile;
+	BOOL HaveFirst;				// TRUE the first run of the chunk is done
+	__int64 RunStart;			// first bit of the current run
+	int Value;					// bit value of the current run
+	unsigned __int64 PrevBit;	// last bit of the word before
+} RUNSTATE;
+
+static int ProfileChunk(RUNPROFILEWORK* Work, RUNPROFILE* Profile, LONG Chunk);
+static void ProfileWord(RUNSTATE* State, unsigned __int64 Word, __int64 WordBit);
+static void AddRun(RUNPROFILE* Profile, int Value, __int64 BitOffset, __int64 Length);
+static void AddTopRun(RUNPROFILE* Profile, int Value, __int64 BitOffset, __int64 Length);
+static void AddWindowRun(RUNWINDOW* Window, int Value, __int64 Length);
+static void AddWindow(RUNWINDOW* Window, RUNWINDOW* Part);
+static RUNWINDOW* ChunkWindow(RUNSTATE* State, __int64 WindowNum);
+static DWORD WINAPI RunProfileProc(LPVOID Param);
+
+//*******************************************************************************
+//
+//  CountLeadingZeros64
+//
+// # of 0 bits before the first 1 bit, MSB first.  Word must not be 0.
+//
+//*******************************************************************************
+static int CountLeadingZeros64(unsigned __int64 Word)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long Index;
+	_BitScanReverse64(&Index, Word);
+	return 63 - (int)Index;
+#elif defined(_MSC_VER)
+	unsigned long Index;
+	if (_BitScanReverse(&Index, (unsigned long)(Word >> 32))) {
+		return 31 - (int)Index;
+	}
+	_BitScanReverse(&Index, (unsigned long)Word);
+	return 63 - (int)Index;
+#else
+	return __builtin_clzll(Word);
+#endif
+}
+
+//*******************************************************************************
+//
+//  PopCount64
+//
+// # of bits set in a 64 bit word
+//
+//*******************************************************************************
+static int PopCount64(unsigned __int64 Word)
+{
+	Word = Word - ((Word >> 1) & 0x5555555555555555ULL);
+	Word = (Word & 0x3333333333333333ULL) + ((Word >> 2) & 0x3333333333333333ULL);
+	Word = (Word + (Word >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+	return (int)((Word * 0x0101010101010101ULL) >> 56);
+}
+
+//*******************************************************************************
+//
+//  RunProfileFile
+//
+// Run length profile of a packed bitstream file
+//
+// Parameters:
+//	WCHAR* Filename				packed bitstream file
+//	BOOL InputBitOrder			FALSE bytes are MSB first, TRUE LSB first,
+//								same as BitImageDlg
+//	__int64 SkipBits			# of bits at the start of the file that are not
+//								profiled (prologue)
+//	int WindowBits				# of bits in each window for the per window
+//								statistics, >= 64, 0 for none
+//	RUNPROFILE* Profile			returns the profile
+//	std::vector<RUNWINDOW>* Windows	returns the per window statistics,
+//								nullptr if WindowBits is 0
+//
+//	return value:
+//	1 - Success
+//	!=1 Error see standardized app error list in AppErrors.h
+//
+//*******************************************************************************
+int RunProfileFile(WCHAR* Filename, BOOL InputBitOrder, __int64 SkipBits, int WindowBits,
+	RUNPROFILE* Profile, std::vector<RUNWINDOW>* Windows)
+{
+	RUNPROFILEWORK Work;
+	MappedFile File;
+	__int64 NumWindows = 0;
+	int iRes;
+
+	memset(Profile, 0, sizeof(RUNPROFILE));
+	if (Windows != nullptr) {
+		Windows->clear();
+	}
+
+	if (SkipBits < 0 || (WindowBits != 0 && (WindowBits < 64 || Windows == nullptr))) {
+		return APPERR_PARAMETER;
+	}
+
+	iRes = File.Open(Filename);
+	if (iRes != APP_SUCCESS) {
+		return iRes;
+	}
+	if (SkipBits >= File.GetFileSize() * 8) {
+		return APPERR_PARAMETER;
+	}
+
+	Work.File = &File;
+	Work.InputBitOrder = InputBitOrder;
+	Work.BeginBit = SkipBits;
+	Work.EndBit = File.GetFileSize() * 8;
+	Work.WindowBits = WindowBits;
+	Work.Windows = nullptr;
+	if (WindowBits != 0) {
+		NumWindows = (Work.EndBit - Work.BeginBit + WindowBits - 1) / WindowBits;
+		if (NumWindows > RUNPROFILE_MAX_WINDOWS) {
+			return APPERR_PARAMETER;
+		}
+		RUNWINDOW Empty;
+		memset(&Empty, 0, sizeof(RUNWINDOW));
+		Windows->assign((size_t)NumWindows, Empty);
+		Work.Windows = Windows->data();
+	}
+	Work.FirstChunk = (LONG)((Work.BeginBit / 8) / RUNPROFILE_CHUNK);
+	Work.NumChunks = (LONG)((File.GetFileSize() - 1) / RUNPROFILE_CHUNK) - Work.FirstChunk + 1;
+	Work.NextChunk = 0;
+	Work.NextThread = 0;
+
+	std::vector<RUNCHUNK> Chunks(Work.NumChunks);
+	Work.Chunks = Chunks.data();
+
+	SYSTEM_INFO SysInfo;
+	int NumThreads;
+
+	GetSystemInfo(&SysInfo);
+	NumThreads = (int)SysInfo.dwNumberOfProcessors;
+	if (NumThreads > MAXIMUM_WAIT_OBJECTS) NumThreads = MAXIMUM_WAIT_OBJECTS;
+	if (NumThreads > (int)Work.NumChunks) NumThreads = (int)Work.NumChunks;
+	if (NumThreads < 1) NumThreads = 1;
+
+	Work.ThreadProfiles = new RUNPROFILE[NumThreads];
+	if (Work.ThreadProfiles == nullptr) {
+		return APPERR_MEMALLOC;
+	}
+	memset(Work.ThreadProfiles, 0, sizeof(RUNPROFILE) * NumThreads);
+
+	std::vector<HANDLE> Threads(NumThreads);
+	int Started = 0;
+	for (int t = 0; t < NumThreads; t++) {
+		Threads[t] = CreateThread(NULL, 0, RunProfileProc, &Work, 0, NULL);
+		if (Threads[t] == NULL) {
+			break;
+		}
+		Started++;
+	}
+	if (Started == 0) {
+		// no threads, profile it all here
+		RunProfileProc(&Work);
+	}
+	for (int t = 0; t < Started; t++) {
+		WaitForSingleObject(Threads[t], INFINITE);
+		CloseHandle(Threads[t]);
+	}
+
+	for (LONG c = 0; c < Work.NumChunks; c++) {
+		if (Chunks[c].Status != APP_SUCCESS) {
+			delete[] Work.ThreadProfiles;
+			if (Windows != nullptr) {
+				Windows->clear();
+			}
+			return Chunks[c].Status;
+		}
+	}
+
+	// add the thread results together
+	int NumUsed = (Started == 0) ? 1 : Started;
+	for (int t = 0; t < NumUsed; t++) {
+		RUNPROFILE* Part = &Work.ThreadProfiles[t];
+		for (int v = 0; v < 2; v++) {
+			Profile->NumBits[v] += Part->NumBits[v];
+			Profile->NumRuns[v] += Part->NumRuns[v];
+			for (int i = 0; i <= RUNPROFILE_MAX_LENGTH; i++) {
+				Profile->Histogram[v][i] += Part->Histogram[v][i];
+			}
+			for (int i = 0; i < Part->NumTop[v]; i++) {
+				AddTopRun(Profile, v, Part->Top[v][i].BitOffset, Part->Top[v][i].Length);
+			}
+		}
+	}
+	delete[] Work.ThreadProfiles;
+	Profile->TotalBits = Work.EndBit - Work.BeginBit;
+	Profile->NumBits[0] = Profile->TotalBits - Profile->NumBits[1];
+
+	// windows split between chunks
+	if (WindowBits != 0) {
+		for (LONG c = 0; c < Work.NumChunks; c++) {
+			AddWindow(&(*Windows)[(size_t)Chunks[c].FirstWindowNum], &Chunks[c].FirstWindow);
+			if (Chunks[c].LastWindowNum != Chunks[c].FirstWindowNum) {
+				AddWindow(&(*Windows)[(size_t)Chunks[c].LastWindowNum], &Chunks[c].LastWindow);
+			}
+		}
+		for (__int64 w = 0; w < NumWindows; w++) {
+			RUNWINDOW* Window = &(*Windows)[(size_t)w];
+			Window->FirstBit = Work.BeginBit + w * WindowBits;
+			Window->NumBits = (int)((Work.EndBit - Window->FirstBit < WindowBits) ?
+				Work.EndBit - Window->FirstBit : WindowBits);
+		}
+	}
+
+	// join the runs at the ends of the chunks
+	BOOL Open = FALSE;
+	int OpenValue = 0;
+	__int64 OpenStart = 0;
+	__int64 OpenLength = 0;
+
+	for (LONG c = 0; c < Work.NumChunks; c++) {
+		RUNCHUNK* Chunk = &Chunks[c];
+
+		if (Open && Chunk->FirstValue == OpenValue) {
+			OpenLength += Chunk->FirstLength;
+		}
+		else {
+			if (Open) {
+				AddRun(Profile, OpenValue, OpenStart, OpenLength);
+				if (WindowBits != 0) {
+					AddWindowRun(&(*Windows)[(size_t)((OpenStart - Work.BeginBit) / WindowBits)],
+						OpenValue, OpenLength);
+				}
+			}
+			Open = TRUE;
+			OpenValue = Chunk->FirstValue;
+			OpenStart = Chunk->BeginBit;
+			OpenLength = Chunk->FirstLength;
+		}
+
+		if (!Chunk->SingleRun) {
+			// the first run ends in this chunk
+			AddRun(Profile, OpenValue, OpenStart, OpenLength);
+			if (WindowBits != 0) {
+				AddWindowRun(&(*Windows)[(size_t)((OpenStart - Work.BeginBit) / WindowBits)],
+					OpenValue, OpenLength);
+			}
+			OpenValue = Chunk->LastValue;
+			OpenStart = Chunk->EndBit - Chunk->LastLength;
+			OpenLength = Chunk->LastLength;
+		}
+	}
+	if (Open) {
+		// the last run ends at the end of the file
+		AddRun(Profile, OpenValue, OpenStart, OpenLength);
+		if (WindowBits != 0) {
+			AddWindowRun(&(*Windows)[(size_t)((OpenStart - Work.BeginBit) / WindowBits)],
+				OpenValue, OpenLength);
+		}
+	}
+
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  RunProfileProc
+//
+// Worker thread, profiles chunks until there are none left
+//
+//*******************************************************************************
+static DWORD WINAPI RunProfileProc(LPVOID Param)
+{
+	RUNPROFILEWORK* Work = (RUNPROFILEWORK*)Param;
+	RUNPROFILE* Profile = &Work->ThreadProfiles[InterlockedIncrement(&Work->NextThread) - 1];
+	LONG Next;
+
+	while ((Next = InterlockedIncrement(&Work->NextChunk) - 1) < Work->NumChunks) {
+		Work->Chunks[Next].Status = ProfileChunk(Work, Profile, Next);
+	}
+	return 0;
+}
+
+//*******************************************************************************
+//
+//  ProfileChunk
+//
+// Profile the bits in one chunk of the file.  Runs that end in the chunk are
+// added to Profile, the runs at the start and end of the chunk are returned
+// in the RUNCHUNK.  The chunk is profiled in blocks, the last block of the file
+// and all blocks in LSB first files are copied to a 0 padded buffer first.
+//
+//*******************************************************************************
+static int ProfileChunk(RUNPROFILEWORK* Work, RUNPROFILE* Profile, LONG Chunk)
+{
+	RUNCHUNK* ThisChunk = &Work->Chunks[Chunk];
+	__int64 FileSize = Work->File->GetFileSize();
+	__int64 ChunkStart = (__int64)(Work->FirstChunk + Chunk) * RUNPROFILE_CHUNK;
+	size_t ChunkBytes = RUNPROFILE_CHUNK;
+	BYTE* Copy = nullptr;
+	void* ViewBase;
+	RUNSTATE State;
+
+	if ((__int64)ChunkBytes > FileSize - ChunkStart) {
+		ChunkBytes = (size_t)(FileSize - ChunkStart);
+	}
+
+	memset(ThisChunk, 0, sizeof(RUNCHUNK));
+	ThisChunk->BeginBit = (ChunkStart * 8 > Work->BeginBit) ? ChunkStart * 8 : Work->BeginBit;
+	ThisChunk->EndBit = (ChunkStart + (__int64)ChunkBytes) * 8;
+	if (Work->WindowBits != 0) {
+		ThisChunk->FirstWindowNum = (ThisChunk->BeginBit - Work->BeginBit) / Work->WindowBits;
+		ThisChunk->LastWindowNum = (ThisChunk->EndBit - 1 - Work->BeginBit) / Work->WindowBits;
+	}
+
+	State.Work = Work;
+	State.Chunk = ThisChunk;
+	State.Profile = Profile;
+	State.HaveFirst = FALSE;
+	State.RunStart = ThisChunk->BeginBit;
+	State.Value = -1;
+	State.PrevBit = 0;
+
+	const BYTE* View = Work->File->MapView(ChunkStart, ChunkBytes, &ViewBase);
+	if (View == nullptr) {
+		return APPERR_FILEREAD;
+	}
+
+	// the first block starts at the word with the first bit profiled
+	size_t NextBlock;
+	for (size_t Block = (size_t)(ThisChunk->BeginBit / 8 - ChunkStart) & ~(size_t)7;
+		Block < ChunkBytes; Block = NextBlock) {
+		NextBlock = (Block / RUNPROFILE_BLOCK + 1) * RUNPROFILE_BLOCK;
+		if (NextBlock > ChunkBytes) {
+			NextBlock = ChunkBytes;
+		}
+		size_t BlockBytes = NextBlock - Block;
+		const BYTE* Data = View + Block;
+
+		if (Work->InputBitOrder || (BlockBytes % 8) != 0) {
+			if (Copy == nullptr) {
+				Copy = new BYTE[RUNPROFILE_BLOCK + 8];
+				if (Copy == nullptr) {
+					MappedFile::UnmapView(ViewBase);
+					return APPERR_MEMALLOC;
+				}
+			}
+			if (Work->InputBitOrder) {
+				for (size_t i = 0; i < BlockBytes; i++) {
+					Copy[i] = ReverseByte[Data[i]];
+				}
+			}
+			else {
+				memcpy(Copy, Data, BlockBytes);
+			}
+			memset(Copy + BlockBytes, 0, 8);
+			Data = Copy;
+		}
+
+		__int64 BlockBit = (ChunkStart + (__int64)Block) * 8;
+		for (size_t i = 0; i < BlockBytes; i += 8) {
+			ProfileWord(&State, LoadBigEndian64(Data + i), BlockBit + (__int64)i * 8);
+		}
+	}
+
+	MappedFile::UnmapView(ViewBase);
+	if (Copy != nullptr) {
+		delete[] Copy;
+	}
+
+	// the run at the end of the chunk
+	if (!State.HaveFirst) {
+		ThisChunk->SingleRun = TRUE;
+		ThisChunk->FirstValue = State.Value;
+		ThisChunk->FirstLength = ThisChunk->EndBit - State.RunStart;
+	}
+	ThisChunk->LastValue = State.Value;
+	ThisChunk->LastLength = ThisChunk->EndBit - State.RunStart;
+
+	return APP_SUCCESS;
+}
+
+//*******************************************************************************
+//
+//  ProfileWord
+//
+// Find the run boundaries in 64 bits of the bitstream
+//
+// Parameters:
+//	RUNSTATE* State			chunk state
+//	unsigned __int64 Word	bits, MSB first
+//	__int64 WordBit			bitstream bit # of the MSB of Word
+//
+//*******************************************************************************
+static void ProfileWord(RUNSTATE* State, unsigned __int64 Word, __int64 WordBit)
+{
+	RUNCHUNK* Chunk = State->Chunk;
+	RUNPROFILEWORK* Work = State->Work;
+	unsigned __int64 Range;
+	unsigned __int64 Boundaries;
+	__int64 Low;
+	__int64 High;
+
+	// bits in this word that are in the chunk
+	Low = (Chunk->BeginBit > WordBit) ? Chunk->BeginBit - WordBit : 0;
+	High = (Chunk->EndBit < WordBit + 64) ? Chunk->EndBit - WordBit : 64;
+	if (Low >= High) {
+		State->PrevBit = Word & 1;
+		return;
+	}
+	Range = ~0ULL >> Low;
+	if (High < 64) {
+		Range &= ~(~0ULL >> High);
+	}
+
+	if (State->Value < 0) {
+		// first bit of the chunk
+		State->Value = (int)((Word >> (63 - Low)) & 1);
+	}
+
+	// 1 bits where a bit is different from the bit before it,
+	// the first bit of the chunk is not a boundary
+	Boundaries = Word ^ ((Word >> 1) | (State->PrevBit << 63));
+	Boundaries &= Range;
+	if (WordBit + Low == Chunk->BeginBit) {
+		Boundaries &= ~(0x8000000000000000ULL >> Low);
+	}
+	State->PrevBit = Word & 1;
+
+	// 1 bits, split at a window boundary
+	int NumOnes = PopCount64(Word & Range);
+	State->Profile->NumBits[1] += NumOnes;
+	if (Work->WindowBits != 0) {
+		__int64 WindowNum = (WordBit + Low - Work->BeginBit) / Work->WindowBits;
+		__int64 WindowEnd = Work->BeginBit + (WindowNum + 1) * Work->WindowBits;
+		if (WindowEnd < WordBit + High) {
+			unsigned __int64 Split = ~0ULL >> (WindowEnd - WordBit);
+			int NextOnes = PopCount64(Word & Range & Split);
+			ChunkWindow(State, WindowNum)->NumOnes += NumOnes - NextOnes;
+			ChunkWindow(State, WindowNum + 1)->NumOnes += NextOnes;
+		}
+		else {
+			ChunkWindow(State, WindowNum)->NumOnes += NumOnes;
+		}
+	}
+
+	while (Boundaries != 0) {
+		int n = CountLeadingZeros64(Boundaries);
+		__int64 Boundary = WordBit + n;
+		__int64 Length = Boundary - State->RunStart;
+
+		if (!State->HaveFirst) {
+			// the run at the start of the chunk can continue from the chunk before
+			Chunk->FirstValue = State->Value;
+			Chunk->FirstLength = Length;
+			State->HaveFirst = TRUE;
+		}
+		else {
+			AddRun(State->Profile, State->Value, State->RunStart, Length);
+			if (Work->WindowBits != 0) {
+				AddWindowRun(ChunkWindow(State, (State->RunStart - Work->BeginBit) / Work->WindowBits),
+					State->Value, Length);
+			}
+		}
+		State->RunStart = Boundary;
+		State->Value ^= 1;
+		Boundaries &= ~(0x8000000000000000ULL >> n);
+	}
+}
+
+//*******************************************************************************
+//
+//  ChunkWindow
+//
+// Window statistics for a window in the chunk.  Windows at the start and end
+// of the chunk can be shared with the chunks next to it, these are kept in
+// the RUNCHUNK and added to the window when all the chunks are done.
+//
+//*******************************************************************************
+static RUNWINDOW* ChunkWindow(RUNSTATE* State, __int64 WindowNum)
+{
+	if (WindowNum == State->Chunk->FirstWindowNum) {
+		return &State->Chunk->FirstWindow;
+	}
+	if (WindowNum == State->Chunk->LastWindowNum) {
+		return &State->Chunk->LastWindow;
+	}
+	return &State->Work->Windows[(size_t)WindowNum];
+}
+
+//*******************************************************************************
+//
+//  AddRun
+//
+// Add a run to the counts and the longest runs list
+//
+//*******************************************************************************
+static void AddRun(RUNPROFILE* Profile, int Value, __int64 BitOffset, __int64 Length)
+{
+	Profile->NumRuns[Value]++;
+	Profile->Histogram[Value][(Length < RUNPROFILE_MAX_LENGTH) ? Length : RUNPROFILE_MAX_LENGTH]++;
+	AddTopRun(Profile, Value, BitOffset, Length);
+}
+
+//*******************************************************************************
+//
+//  AddTopRun
+//
+// Add a run to the longest runs list if it is long enough
+//
+//*******************************************************************************
+static void AddTopRun(RUNPROFILE* Profile, int Value, __int64 BitOffset, __int64 Length)
+{
+	RUNENTRY* Top = Profile->Top[Value];
+	int NumTop = Profile->NumTop[Value];
+
+	// longest first, the earlier run first for the same length
+	if (NumTop == RUNPROFILE_TOP) {
+		RUNENTRY* Last = &Top[RUNPROFILE_TOP - 1];
+		if (Length < Last->Length || (Length == Last->Length && BitOffset > Last->BitOffset)) {
+			return;
+		}
+		NumTop--;
+	}
+	int i = NumTop;
+	while (i > 0 && (Top[i - 1].Length < Length ||
+		(Top[i - 1].Length == Length && Top[i - 1].BitOffset > BitOffset))) {
+		Top[i] = Top[i - 1];
+		i--;
+	}
+	Top[i].BitOffset = BitOffset;
+	Top[i].Length = Length;
+	Profile->NumTop[Value] = NumTop + 1;
+}
+
+//*******************************************************************************
+//
+//  AddWindowRun
+//
+//*******************************************************************************
+static void AddWindowRun(RUNWINDOW* Window, int Value, __int64 Length)
+{
+	Window->NumRuns[Value]++;
+	if (Length > Window->LongestRun[Value]) {
+		Window->LongestRun[Value] = Length;
+	}
+}
+
+//*******************************************************************************
+//
+//  AddWindow
+//
+// Add the part of a window from one chunk to the window
+//
+//*******************************************************************************
+static void AddWindow(RUNWINDOW* Window, RUNWINDOW* Part)
+{
+	Window->NumOnes += Part->NumOnes;
+	for (int v = 0; v < 2; v++) {
+		Window->NumRuns[v] += Part->NumRuns[v];
+		if (Part->LongestRun[v] > Window->LongestRun[v]) {
+			Window->LongestRun[v] = Part->LongestRun[v];
+		}
+	}
+}
+
+//*******************************************************************************
+//
+//  SaveRunProfile
+//
+// Save a run length profile to a .csv file
+//
+// Parameters:
+//	WCHAR* Filename				.csv file
+//	WCHAR* InputFile			bitstream file that was profiled
+//	RUNPROFILE* Profile			profile
+//	std::vector<RUNWINDOW>* Windows	per window statistics, nullptr or empty for none
+//
+//	return value:
+//	1 - Success
+//	!=1 Error see standardized app error list in AppErrors.h
+//
+//*******************************************************************************
+int SaveRunProfile(WCHAR* Filename, WCHAR* InputFile, RUNPROFILE* Profile,
+	std::vector<RUNWINDOW>* Windows)
+{
+	FILE* Out;
+	int iRes = APP_SUCCESS;
+
+	_wfopen_s(&Out, Filename, L"w");
+	if (Out == NULL) {
+		return APPERR_FILEOPEN;
+	}
+
+	fprintf(Out, "Run length profile, \"%ls\"\n", InputFile);
+	fprintf(Out, "Bits, 0 bits, 1 bits, 0 runs, 1 runs\n");
+	fprintf(Out, "%lld, %lld, %lld, %lld, %lld\n\n", Profile->TotalBits,
+		Profile->NumBits[0], Profile->NumBits[1], Profile->NumRuns[0], Profile->NumRuns[1]);
+
+	fprintf(Out, "Longest runs, 0 run length, 0 run bit offset, 1 run length, 1 run bit offset\n");
+	for (int i = 0; i < RUNPROFILE_TOP; i++) {
+		if (i >= Profile->NumTop[0] && i >= Profile->NumTop[1]) {
+			break;
+		}
+		fprintf(Out, "%d", i + 1);
+		for (int v = 0; v < 2; v++) {
+			if (i < Profile->NumTop[v]) {
+				fprintf(Out, ", %lld, %lld", Profile->Top[v][i].Length, Profile->Top[v][i].BitOffset);
+			}
+			else {
+				fprintf(Out, ", , ");
+			}
+		}
+		fprintf(Out, "\n");
+	}
+	fprintf(Out, "\n");
+
+	// only run lengths that occur
+	fprintf(Out, "Run length, # of 0 runs, # of 1 runs\n");
+	for (int i = 1; i < RUNPROFILE_MAX_LENGTH; i++) {
+		if (Profile->Histogram[0][i] != 0 || Profile->Histogram[1][i] != 0) {
+			fprintf(Out, "%d, %lld, %lld\n", i, Profile->Histogram[0][i], Profile->Histogram[1][i]);
+		}
+	}
+	if (Profile->Histogram[0][RUNPROFILE_MAX_LENGTH] != 0 || Profile->Histogram[1][RUNPROFILE_MAX_LENGTH] != 0) {
+		fprintf(Out, ">=%d, %lld, %lld\n", RUNPROFILE_MAX_LENGTH,
+			Profile->Histogram[0][RUNPROFILE_MAX_LENGTH], Profile->Histogram[1][RUNPROFILE_MAX_LENGTH]);
+	}
+
+	if (Windows != nullptr && Windows->size() != 0) {
+		fprintf(Out, "\nWindow, First bit, Bits, 1 bits, 0 runs, 1 runs, Longest 0 run, Longest 1 run\n");
+		for (size_t w = 0; w < Windows->size(); w++) {
+			RUNWINDOW* Window = &(*Windows)[w];
+			fprintf(Out, "%zu, %lld, %d, %d, %d, %d, %lld, %lld\n", w + 1, Window->FirstBit,
+				Window->NumBits, Window->NumOnes, Window->NumRuns[0], Window->NumRuns[1],
+				Window->LongestRun[0], Window->LongestRun[1]);
+		}
+	}
+
+	if (ferror(Out)) {
+		iRes = APPERR_FILEWRITE;
+	}
+	fclose(Out);
+
+	return iRes;
+}
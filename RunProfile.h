@@ -0,0 +1,62 @@
+#pragma once
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// RunProfile.h
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// Application standardized error numbers for functions:
+//		See AppErrors.h
+//
+// V1.2.0	2026-10-19	Added run length profile of packed bitstream files
+//
+#include "framework.h"
+#include <vector>
+
+#define RUNPROFILE_MAX_LENGTH 4096		// runs this long or longer are in the last histogram bin
+#define RUNPROFILE_TOP 16				// # of longest runs kept for each bit value
+#define RUNPROFILE_MAX_WINDOWS (1 << 20)	// most windows for the per window statistics
+
+// one run of 0s or 1s
+typedef struct {
+	__int64 BitOffset;	// first bit of the run
+	__int64 Length;		// # of bits in the run
+} RUNENTRY;
+
+// run length profile of a bitstream, index [0] is 0 runs, [1] is 1 runs
+typedef struct {
+	__int64 TotalBits;		// # of bits profiled
+	__int64 NumBits[2];		// # of 0 bits, 1 bits
+	__int64 NumRuns[2];		// # of runs
+	__int64 Histogram[2][RUNPROFILE_MAX_LENGTH + 1];	// # of runs of each length, [0] not used
+	int NumTop[2];			// # of entries in Top
+	RUNENTRY Top[2][RUNPROFILE_TOP];	// longest runs, longest first, then by offset
+} RUNPROFILE;
+
+// statistics for one window of the bitstream
+typedef struct {
+	__int64 FirstBit;		// first bit of the window
+	int NumBits;			// # of bits in the window
+	int NumOnes;			// # of 1 bits in the window
+	int NumRuns[2];			// # of runs that start in the window
+	__int64 LongestRun[2];	// longest run that starts in the window
+} RUNWINDOW;
+
+int RunProfileFile(WCHAR* Filename, BOOL InputBitOrder, __int64 SkipBits, int WindowBits,
+	RUNPROFILE* Profile, std::vector<RUNWINDOW>* Windows);
+int SaveRunProfile(WCHAR* Filename, WCHAR* InputFile, RUNPROFILE* Profile,
+	std::vector<RUNWINDOW>* Windows);
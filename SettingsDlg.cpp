@@ -20,6 +20,8 @@
 //
 //
 // V1.0.0	2024-06-21	Initial release
+// V1.2.0	2026-10-19	Added Save BCA snapshots 1 bit per pixel setting
+//					Added PNG level setting
 //
 //  This module is a copy of the SettingsDlg module used in MySETIviewer and customized
 //  for this application
@@ -40,6 +42,7 @@
 #include "Globals.h"
 #include "imageheader.h"
 #include "FileFunctions.h"
+#include "PNGwriter.h"
 #include "Appfunctions.h"
 
 //*******************************************************************************
@@ -79,6 +82,9 @@ INT_PTR CALLBACK SettingsGlobalDlg(HWND hDlg, UINT message, WPARAM wParam, LPARA
             CheckDlgButton(hDlg, IDC_SETTINGS_AUTO_PNG, BST_CHECKED);
         }
 
+        // IDC_SETTINGS_PNG_LEVEL
+        SetDlgItemInt(hDlg, IDC_SETTINGS_PNG_LEVEL, GetPNGlevel(), FALSE);
+
         // IDC_SETTINGS_START_LAST
         iRes = GetPrivateProfileInt(L"SettingsGlobalDlg", L"StartLast", 0, (LPCTSTR)strAppNameINI);
         if (iRes != 0) {
@@ -91,6 +97,12 @@ INT_PTR CALLBACK SettingsGlobalDlg(HWND hDlg, UINT message, WPARAM wParam, LPARA
             CheckDlgButton(hDlg, IDC_SETTINGS_STATUSBAR, BST_CHECKED);
         }
 
+        // IDC_SETTINGS_PACKED_SNAPSHOTS
+        iRes = GetPrivateProfileInt(L"SettingsGlobalDlg", L"PackedSnapshots", 0, (LPCTSTR)strAppNameINI);
+        if (iRes != 0) {
+            CheckDlgButton(hDlg, IDC_SETTINGS_PACKED_SNAPSHOTS, BST_CHECKED);
+        }
+
         // Radio buttons
         int ydir = ImageLayers->GetYdir();
         if (ydir) {
@@ -156,6 +168,15 @@ INT_PTR CALLBACK SettingsGlobalDlg(HWND hDlg, UINT message, WPARAM wParam, LPARA
                 return (INT_PTR)TRUE;
             }
            
+            BOOL bSuccess;
+            int PNGlevel = GetDlgItemInt(hDlg, IDC_SETTINGS_PNG_LEVEL, &bSuccess, FALSE);
+            if (!bSuccess || PNGlevel < PNG_LEVEL_STORE || PNGlevel > PNG_LEVEL_MAX) {
+                MessageBox(hDlg, L"PNG level must be 0 to 9", L"Globals", MB_OK);
+                return (INT_PTR)TRUE;
+            }
+            swprintf_s(szString, MAX_PATH, L"%d", PNGlevel);
+            WritePrivateProfileString(L"SettingsGlobalDlg", L"PNGlevel", szString, (LPCTSTR)strAppNameINI);
+
             ImgDlg->SetScalePos(sf, px, py);
 
             GetDlgItemText(hDlg, IDC_IMG_TEMP, szString, MAX_PATH);
@@ -185,6 +206,14 @@ INT_PTR CALLBACK SettingsGlobalDlg(HWND hDlg, UINT message, WPARAM wParam, LPARA
                 WritePrivateProfileString(L"SettingsGlobalDlg", L"StartLast", L"0", (LPCTSTR)strAppNameINI);
             }
 
+            // IDC_SETTINGS_PACKED_SNAPSHOTS
+            if (IsDlgButtonChecked(hDlg, IDC_SETTINGS_PACKED_SNAPSHOTS) == BST_CHECKED) {
+                WritePrivateProfileString(L"SettingsGlobalDlg", L"PackedSnapshots", L"1", (LPCTSTR)strAppNameINI);
+            }
+            else {
+                WritePrivateProfileString(L"SettingsGlobalDlg", L"PackedSnapshots", L"0", (LPCTSTR)strAppNameINI);
+            }
+
             // IDC_SETTINGS_STATUSBAR
             if (IsDlgButtonChecked(hDlg, IDC_SETTINGS_STATUSBAR) == BST_CHECKED) {
                 WritePrivateProfileString(L"SettingsGlobalDlg", L"ShowStatusBar", L"1", (LPCTSTR)strAppNameINI);
@@ -9,6 +9,7 @@ typedef struct IMAGINGHEADER {
 	LONG32 Xsize;			// number of columns in image (type long allows for long linear bitstreams)
 	LONG32 Ysize;			// number of rows image
 	short PixelSize;	// pixel size, 1-byte (uchar), 2-uint16 (ushort), 4-int32 (int)
+						// PIXELSIZE_1BIT, 1 bit per pixel
 	short NumFrames;	// Number of image frames in the file
 	short Version;		// header version  number
 						// 1 - this 32 byte header
@@ -16,6 +17,16 @@ typedef struct IMAGINGHEADER {
 } IMAGINGHEADER;
 #pragma pack(pop)
 
+// PixelSize of a 1 bit per pixel (binary) image file
+// Each row is packed 8 pixels per byte, pixel 0 of the row is the 0x80 bit
+// of its first byte.  A row is padded with 0 bits to a whole byte, it is
+// BITROW_BYTES(Xsize) bytes.  Rows and frames follow each other with no other
+// padding.  Endian does not apply.  Set bits are loaded as 255, non zero
+// pixels are saved as set bits.
+// Readers that only know PixelSize 1, 2 and 4 reject these files.
+#define PIXELSIZE_1BIT (-1)
+#define BITROW_BYTES(Xsize) (((size_t)(Xsize) + 7) / 8)
+
 union PIXEL {
 	BYTE Byte[4];
 	USHORT uShort;
@@ -22,6 +22,11 @@
 #define IDD_SEND_ASIS                   176
 #define IDD_UNARY                       177
 #define IDD_GENERIC_FSM                 178
+#define IDD_RECEIVE_ASIS_BATCH          203
+#define IDD_BITTOOLS_BITSEARCH          204
+#define IDD_BITTOOLS_RUNPROFILE         205
+#define IDD_BITTOOLS_AUTOCORR           206
+#define IDD_BITTOOLS_GALLERY            207
 #define ID_UPDATE                       200
 #define ID_IMG_STATUSBAR                201
 #define ID_UPDATE_BCA_LAYER             202
@@ -167,6 +172,93 @@
 #define IDC_NUM_BCA_STEPS2              1324
 #define IDC_NUM_BITS                    1324
 #define IDC_LAST_VALUE                  1325
+#define IDC_STOP_BITS                   1326
+#define IDC_STOP_BITS_GE                1327
+#define IDC_STOP_BITS_LE                1328
+#define IDC_STOP_BITS_VALUE             1329
+#define IDC_STOP_HISTO                  1330
+#define IDC_STOP_HISTO0                 1331
+#define IDC_STOP_HISTO1                 1332
+#define IDC_STOP_HISTO2                 1333
+#define IDC_STOP_HISTO3                 1334
+#define IDC_STOP_HISTO4                 1335
+#define IDC_STOP_HAMMING                1336
+#define IDC_STOP_DISTANCE               1337
+#define IDC_STOP_REFERENCE              1338
+#define IDC_STOP_REFERENCE_BROWSE       1339
+#define IDC_STOP_INITIAL                1340
+#define IDC_STOP_STATUS                 1341
+#define IDC_CURRENT_DISTANCE            1342
+#define IDC_CHECKPOINT                  1343
+#define IDC_CHECKPOINT_MINUTES          1344
+#define IDC_CHECKPOINT_FILE             1345
+#define IDC_CHECKPOINT_BROWSE           1346
+#define IDC_RESUME                      1347
+#define IDC_INFO_TAPE                   1348
+#define IDC_TAPE_STATUS                 1349
+#define IDC_BATCH_INPUT                 1350
+#define IDC_BATCH_INPUT_BROWSE          1351
+#define IDC_BATCH_OUTPUT                1352
+#define IDC_BATCH_OUTPUT_BROWSE         1353
+#define IDC_BATCH_SUMMARY               1354
+#define IDC_BATCH_SUMMARY_BROWSE        1355
+#define IDC_PNG_FILE                    1356
+#define IDC_BATCH_XSIZE                 1357
+#define IDC_BATCH_YSIZE                 1358
+#define IDC_FIND_PATTERN                1359
+#define IDC_SEARCH_PATTERN1             1360
+#define IDC_SEARCH_PATTERN2             1361
+#define IDC_SEARCH_PATTERN3             1362
+#define IDC_SEARCH_PATTERN4             1363
+#define IDC_SEARCH_ERRORS1              1364
+#define IDC_SEARCH_ERRORS2              1365
+#define IDC_SEARCH_ERRORS3              1366
+#define IDC_SEARCH_ERRORS4              1367
+#define IDC_SEARCH_MAX_HITS             1368
+#define IDC_SEARCH                      1369
+#define IDC_SEARCH_HITS                 1370
+#define IDC_SEARCH_RESULT               1371
+#define IDC_SEARCH_SKIP_PATTERN         1372
+#define IDC_SEARCH_SAVE                 1373
+#define IDC_RUN_WINDOW_BITS             1374
+#define IDC_RUN_PROFILE                 1375
+#define IDC_RUN_RESULT                  1376
+#define IDC_AUTOCORR_NUM_BITS           1377
+#define IDC_AUTOCORR_LINE_MIN           1378
+#define IDC_AUTOCORR_LINE_MAX           1379
+#define IDC_AUTOCORR_BLOCK_MIN          1380
+#define IDC_AUTOCORR_BLOCK_MAX          1381
+#define IDC_AUTOCORR                    1382
+#define IDC_AUTOCORR_LINES              1383
+#define IDC_AUTOCORR_BLOCKS             1384
+#define IDC_AUTOCORR_RESULT             1385
+#define IDC_FIND_XSIZE                  1386
+#define IDC_GALLERY_OUTPUT              1387
+#define IDC_GALLERY_OUTPUT_BROWSE       1388
+#define IDC_GALLERY_NAME                1389
+#define IDC_GALLERY_PROLOGUE_FIRST      1390
+#define IDC_GALLERY_PROLOGUE_LAST       1391
+#define IDC_GALLERY_PROLOGUE_STEP       1392
+#define IDC_GALLERY_XSIZE_FIRST         1393
+#define IDC_GALLERY_XSIZE_LAST          1394
+#define IDC_GALLERY_XSIZE_STEP          1395
+#define IDC_GALLERY_DEPTH_FIRST         1396
+#define IDC_GALLERY_DEPTH_LAST          1397
+#define IDC_GALLERY_BITORDER0           1398
+#define IDC_GALLERY_BITORDER1           1399
+#define IDC_GALLERY_INBITORDER0         1400
+#define IDC_GALLERY_INBITORDER1         1401
+#define IDC_GALLERY_INVERT0             1402
+#define IDC_GALLERY_INVERT1             1403
+#define IDC_GALLERY_CELL                1404
+#define IDC_GALLERY_COLUMNS             1405
+#define IDC_GALLERY_SAVE_RAW            1406
+#define IDC_GALLERY_SAVE_PNG            1407
+#define IDC_GALLERY                     1408
+#define IDC_GALLERY_RESULT              1409
+#define IDC_TEXT_PARALLEL               1410
+#define IDC_SETTINGS_PACKED_SNAPSHOTS   1411
+#define IDC_SETTINGS_PNG_LEVEL          1412
 #define IDM_PROPERTIES_SETTINGS         32601
 #define IDM_SETTINGS                    32602
 #define IDC_FILE_OPEN                   32604
@@ -188,6 +280,12 @@
 #define IDM_RECEIVE_ASIS                32646
 #define IDM_UNARY                       32648
 #define IDM_GENERIC_FSM                 32652
+#define IDM_RECEIVE_ASIS_BATCH          32653
+#define IDM_BITTOOLS_BITSEARCH          32654
+#define IDM_BITTOOLS_RUNPROFILE         32655
+#define IDM_BITTOOLS_AUTOCORR           32656
+#define IDM_BITTOOLS_GALLERY            32657
+#define IDM_FILE_HEX2BINARY             32658
 #define IDM_RESET_ZOOM                  32783
 #define IDM_RESET_PAN                   32784
 #define IDM_CROSSHAIRS                  32789
@@ -199,9 +297,9 @@
 #ifdef APSTUDIO_INVOKED
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NO_MFC                     1
-#define _APS_NEXT_RESOURCE_VALUE        203
-#define _APS_NEXT_COMMAND_VALUE         32653
-#define _APS_NEXT_CONTROL_VALUE         1260
+#define _APS_NEXT_RESOURCE_VALUE        208
+#define _APS_NEXT_COMMAND_VALUE         32659
+#define _APS_NEXT_CONTROL_VALUE         1413
 #define _APS_NEXT_SYMED_VALUE           300
 #endif
 #endif
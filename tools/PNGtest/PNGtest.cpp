@@ -0,0 +1,509 @@
+//
+// MySETIBCA, an application for decoding, encoding message images using
+// a block cellular automata like what was used in the 'A Sign inSpace' project message
+//
+// PNGtest.cpp
+// (C) 2024, Mark Stegall
+// Author: Mark Stegall
+//
+// This file is part of MySETIBCA.
+//
+// MySETIBCA is free software : you can redistribute it and /or modify it under
+// the terms of the GNU General Public License as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// MySETIBCA is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License along with MySETIBCA.
+// If not, see < https://www.gnu.org/licenses/>.
+//
+// This file contains the round trip check of the PNG writer (PNGwriter.cpp)
+//
+// V1.2.0	2026-10-19	Added PNG writer round trip check
+//
+//	This is a stand alone console program, it is not part of MySETIBCA.exe.
+//	It encodes test images with EncodePNG(), SavePNG() and QueuePNG() and
+//	decodes them again with zlib, which is independent of the writer:
+//		the signature, IHDR and chunk order are checked
+//		every chunk CRC is checked with zlib crc32()
+//		the IDAT data is inflated with zlib, this checks the zlib header,
+//		every deflate block (stored, fixed and dynamic Huffman) and the Adler-32
+//		the rows are unfiltered (None, Sub, Up, Average, Paeth) and compared
+//		with the source pixels
+//	Every level is used for every image.  The filter types seen are counted,
+//	all 5 must be used by the test images.
+//
+//	Build and run on Linux (or any platform with zlib):
+//		make -C tools/PNGtest test
+//	The program returns 0 when all checks pass.
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <wchar.h>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include "../../AppErrors.h"
+#include "../../PNGwriter.h"
+
+static int NumChecks = 0;
+static int NumFailed = 0;
+static long FilterCount[5] = { 0, 0, 0, 0, 0 };
+
+typedef struct {
+	int Xsize;
+	int Ysize;
+	int Format;
+	size_t Stride;
+	std::vector<uint8_t> Pixels;
+} TESTIMAGE;
+
+//*******************************************************************************
+//
+//  Check
+//
+// Count a check and print it if it failed
+//
+//*******************************************************************************
+static bool Check(bool Passed, const char* Name, const char* What)
+{
+	NumChecks++;
+	if (!Passed) {
+		NumFailed++;
+		printf("FAIL %s: %s\n", Name, What);
+	}
+	return Passed;
+}
+
+//*******************************************************************************
+//
+//  GetUint32
+//
+// Big endian 32 bit value, the PNG byte order
+//
+//*******************************************************************************
+static uint32_t GetUint32(const uint8_t* Bytes)
+{
+	return ((uint32_t)Bytes[0] << 24) | ((uint32_t)Bytes[1] << 16) | ((uint32_t)Bytes[2] << 8) | Bytes[3];
+}
+
+//*******************************************************************************
+//
+//  RowBytes
+//
+//*******************************************************************************
+static size_t RowBytes(int Xsize, int Format)
+{
+	switch (Format) {
+	case PNG_GREY1:
+		return ((size_t)Xsize + 7) / 8;
+	case PNG_RGB24:
+		return (size_t)Xsize * 3;
+	default:
+		return (size_t)Xsize;
+	}
+}
+
+//*******************************************************************************
+//
+//  Paeth
+//
+// The PNG Paeth predictor
+//
+//*******************************************************************************
+static int Paeth(int a, int b, int c)
+{
+	int pa = abs(b - c);
+	int pb = abs(a - c);
+	int pc = abs(a + b - c - c);
+	return (pa <= pb && pa <= pc) ? a : (pb <= pc) ? b : c;
+}
+
+//*******************************************************************************
+//
+//  DecodePNG
+//
+// Check the .png file structure, inflate the image data with zlib and
+// unfilter it.
+//
+// Parameters:
+//	const std::vector<uint8_t>& PNG		.png file bytes
+//	const TESTIMAGE& Image				image that was encoded, for the IHDR
+//	const char* Name					test name for the messages
+//	std::vector<uint8_t>& Rows			returns the rows, RowBytes each
+//
+//	return value:
+//	true if the file could be decoded
+//
+//*******************************************************************************
+static bool DecodePNG(const std::vector<uint8_t>& PNG, const TESTIMAGE& Image, const char* Name,
+	std::vector<uint8_t>& Rows)
+{
+	static const uint8_t Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+	std::vector<uint8_t> Zlib;
+	std::string Order;
+	size_t Pos = 8;
+
+	if (!Check(PNG.size() >= 8 && memcmp(PNG.data(), Signature, 8) == 0, Name, "signature")) {
+		return false;
+	}
+
+	while (Pos + 12 <= PNG.size()) {
+		uint32_t Length = GetUint32(&PNG[Pos]);
+		if (!Check(Pos + 12 + (size_t)Length <= PNG.size(), Name, "chunk length past the end of the file")) {
+			return false;
+		}
+		const uint8_t* Type = &PNG[Pos + 4];
+		const uint8_t* Data = &PNG[Pos + 8];
+		uint32_t CRC = (uint32_t)crc32(0, Type, 4 + Length);
+		if (!Check(CRC == GetUint32(Data + Length), Name, "chunk CRC")) {
+			return false;
+		}
+
+		if (memcmp(Type, "IHDR", 4) == 0) {
+			Order += 'H';
+			Check(Length == 13 &&
+				GetUint32(Data) == (uint32_t)Image.Xsize &&
+				GetUint32(Data + 4) == (uint32_t)Image.Ysize &&
+				Data[8] == (Image.Format == PNG_GREY1 ? 1 : 8) &&
+				Data[9] == (Image.Format == PNG_RGB24 ? 2 : 0) &&
+				Data[10] == 0 && Data[11] == 0 && Data[12] == 0, Name, "IHDR contents");
+		}
+		else if (memcmp(Type, "IDAT", 4) == 0) {
+			Order += 'D';
+			Zlib.insert(Zlib.end(), Data, Data + Length);
+		}
+		else if (memcmp(Type, "IEND", 4) == 0) {
+			Order += 'E';
+			Check(Length == 0, Name, "IEND is not empty");
+		}
+		else {
+			Order += '?';
+		}
+		Pos += 12 + (size_t)Length;
+	}
+
+	Check(Pos == PNG.size(), Name, "bytes after the last chunk");
+	if (!Check(Order.size() >= 3 && Order.front() == 'H' && Order.back() == 'E' &&
+		Order.find_first_not_of('D', 1) == Order.size() - 1, Name, "chunk order is not IHDR, IDAT..., IEND")) {
+		return false;
+	}
+	if (!Check(Zlib.size() >= 2 && ((Zlib[0] << 8) | Zlib[1]) % 31 == 0 && (Zlib[0] & 0x0f) == 8,
+		Name, "zlib header")) {
+		return false;
+	}
+
+	// inflate() checks the Adler-32 at the end of the stream
+	size_t Row = RowBytes(Image.Xsize, Image.Format);
+	std::vector<uint8_t> Filtered((Row + 1) * Image.Ysize + 1);
+	z_stream Stream;
+	memset(&Stream, 0, sizeof(Stream));
+	if (!Check(inflateInit(&Stream) == Z_OK, Name, "inflateInit")) {
+		return false;
+	}
+	Stream.next_in = Zlib.data();
+	Stream.avail_in = (uInt)Zlib.size();
+	Stream.next_out = Filtered.data();
+	Stream.avail_out = (uInt)Filtered.size();
+	int zRes = inflate(&Stream, Z_FINISH);
+	size_t Inflated = Filtered.size() - Stream.avail_out;
+	size_t Unused = Stream.avail_in;
+	inflateEnd(&Stream);
+	if (!Check(zRes == Z_STREAM_END, Name, "inflate, deflate data or Adler-32 is not valid") ||
+		!Check(Unused == 0, Name, "data after the end of the zlib stream") ||
+		!Check(Inflated == (Row + 1) * Image.Ysize, Name, "size of the image data")) {
+		return false;
+	}
+
+	// undo the filters
+	int Bpp = Image.Format == PNG_RGB24 ? 3 : 1;
+	std::vector<uint8_t> Zeros(Row, 0);
+	Rows.assign(Row * Image.Ysize, 0);
+	for (int y = 0; y < Image.Ysize; y++) {
+		const uint8_t* Src = Filtered.data() + (size_t)y * (Row + 1);
+		uint8_t* Dest = Rows.data() + (size_t)y * Row;
+		const uint8_t* Above = y == 0 ? Zeros.data() : Dest - Row;
+		int Type = Src[0];
+		if (!Check(Type <= 4, Name, "filter type")) {
+			return false;
+		}
+		FilterCount[Type]++;
+		Src++;
+		for (size_t i = 0; i < Row; i++) {
+			int a = i >= (size_t)Bpp ? Dest[i - Bpp] : 0;
+			int b = Above[i];
+			int c = i >= (size_t)Bpp ? Above[i - Bpp] : 0;
+			int Predict;
+			switch (Type) {
+			case 0: Predict = 0; break;
+			case 1: Predict = a; break;
+			case 2: Predict = b; break;
+			case 3: Predict = (a + b) >> 1; break;
+			default: Predict = Paeth(a, b, c); break;
+			}
+			Dest[i] = (uint8_t)(Src[i] + Predict);
+		}
+	}
+	return true;
+}
+
+//*******************************************************************************
+//
+//  ComparePixels
+//
+//*******************************************************************************
+static void ComparePixels(const TESTIMAGE& Image, const std::vector<uint8_t>& Rows, const char* Name)
+{
+	size_t Row = RowBytes(Image.Xsize, Image.Format);
+	bool Same = true;
+
+	for (int y = 0; y < Image.Ysize && Same; y++) {
+		Same = memcmp(Image.Pixels.data() + (size_t)y * Image.Stride, Rows.data() + (size_t)y * Row, Row) == 0;
+	}
+	Check(Same, Name, "pixels are not the same after the round trip");
+}
+
+//*******************************************************************************
+//
+//  MakeImage
+//
+// Test image, the pixel values come from Pattern.  The padding at the end
+// of each row (Stride > row bytes) is filled with 0xa5, it must not be used.
+//
+//*******************************************************************************
+enum { PATTERN_RANDOM, PATTERN_CONSTANT, PATTERN_HRAMP, PATTERN_VRAMP, PATTERN_AVERAGE, PATTERN_EDGES, PATTERN_SPARSE };
+
+static TESTIMAGE MakeImage(int Xsize, int Ysize, int Format, int Pattern, size_t Padding)
+{
+	TESTIMAGE Image;
+	size_t Row = RowBytes(Xsize, Format);
+
+	Image.Xsize = Xsize;
+	Image.Ysize = Ysize;
+	Image.Format = Format;
+	Image.Stride = Row + Padding;
+	Image.Pixels.assign(Image.Stride * Ysize, 0xa5);
+
+	int Bpp = Format == PNG_RGB24 ? 3 : 1;
+	uint32_t Seed = 12345u + (uint32_t)(Xsize * 31 + Ysize * 17 + Format + Pattern * 7);
+	for (int y = 0; y < Ysize; y++) {
+		uint8_t* Dest = Image.Pixels.data() + (size_t)y * Image.Stride;
+		const uint8_t* Above = y > 0 ? Dest - Image.Stride : NULL;
+		for (size_t i = 0; i < Row; i++) {
+			int x = (int)(i / Bpp);
+			uint8_t Value;
+			Seed = Seed * 1664525u + 1013904223u;
+			switch (Pattern) {
+			case PATTERN_RANDOM:
+				Value = (uint8_t)(Seed >> 24);
+				break;
+			case PATTERN_CONSTANT:
+				Value = 0x3c;
+				break;
+			case PATTERN_HRAMP:
+				Value = (uint8_t)(x * 7 + (int)(i % Bpp) * 40);
+				break;
+			case PATTERN_VRAMP:
+				Value = (uint8_t)(y * 9 + (int)(i % Bpp) * 40 + ((Seed >> 28) == 0 ? 1 : 0));
+				break;
+			case PATTERN_AVERAGE:
+				// each pixel is the average of its left and above pixels,
+				// the Average filter makes it all 0
+				if (y == 0) {
+					Value = (uint8_t)(200 - x * 3);
+				}
+				else {
+					int Left = i >= (size_t)Bpp ? Dest[i - Bpp] : 0;
+					Value = (uint8_t)((Left + Above[i]) >> 1);
+				}
+				break;
+			case PATTERN_EDGES:
+				// blocks of different levels with noise, left and above
+				// predict in different places, for Paeth
+				Value = (uint8_t)((((x / 5) * 37 + (y / 3) * 91) & 0xff) + ((Seed >> 30) & 1));
+				break;
+			default:
+				// mostly 0 with a few set pixels, like the BCA images
+				Value = (Seed >> 24) < 8 ? 0xff : 0;
+				break;
+			}
+			Dest[i] = Value;
+		}
+		if (Format == PNG_GREY1 && (Xsize & 7) != 0) {
+			// unused bits at the end of a row are 0, as in the PackPixelBits() rows
+			Dest[Row - 1] &= (uint8_t)(0xff << (8 - (Xsize & 7)));
+		}
+	}
+	return Image;
+}
+
+static PNGIMAGE GetPNGimage(const TESTIMAGE& Image)
+{
+	PNGIMAGE PNGImage;
+
+	PNGImage.Xsize = Image.Xsize;
+	PNGImage.Ysize = Image.Ysize;
+	PNGImage.Format = Image.Format;
+	PNGImage.Stride = Image.Stride;
+	PNGImage.Pixels = Image.Pixels.data();
+	return PNGImage;
+}
+
+//*******************************************************************************
+//
+//  ReadFile
+//
+//*******************************************************************************
+static bool ReadFile(const char* Filename, std::vector<uint8_t>& Bytes)
+{
+	FILE* In = fopen(Filename, "rb");
+	if (In == NULL) {
+		return false;
+	}
+	Bytes.clear();
+	uint8_t Buffer[65536];
+	size_t n;
+	while ((n = fread(Buffer, 1, sizeof(Buffer), In)) > 0) {
+		Bytes.insert(Bytes.end(), Buffer, Buffer + n);
+	}
+	fclose(In);
+	return true;
+}
+
+//*******************************************************************************
+//
+//  TestRoundTrip
+//
+// Encode an image at every level and decode it again
+//
+//*******************************************************************************
+static void TestRoundTrip(const TESTIMAGE& Image, const char* Description)
+{
+	PNGIMAGE PNGImage = GetPNGimage(Image);
+	std::vector<uint8_t> PNG;
+	std::vector<uint8_t> Rows;
+	char Name[256];
+
+	for (int Level = PNG_LEVEL_STORE; Level <= PNG_LEVEL_MAX; Level++) {
+		snprintf(Name, sizeof(Name), "%s %dx%d format %d level %d", Description,
+			Image.Xsize, Image.Ysize, Image.Format, Level);
+		if (!Check(EncodePNG(&PNGImage, Level, PNG) == APP_SUCCESS, Name, "EncodePNG")) {
+			continue;
+		}
+		if (DecodePNG(PNG, Image, Name, Rows)) {
+			ComparePixels(Image, Rows, Name);
+		}
+	}
+}
+
+//*******************************************************************************
+//
+//  TestFiles
+//
+// SavePNG() and QueuePNG() write the same bytes as EncodePNG()
+//
+//*******************************************************************************
+static void TestFiles()
+{
+	TESTIMAGE Image = MakeImage(123, 45, PNG_RGB24, PATTERN_EDGES, 5);
+	PNGIMAGE PNGImage = GetPNGimage(Image);
+	std::vector<uint8_t> PNG;
+	std::vector<uint8_t> FileBytes;
+	const char* Filename = "PNGtest_save.png";
+	const wchar_t* WFilename = L"PNGtest_save.png";
+
+	EncodePNG(&PNGImage, PNG_LEVEL_DEFAULT, PNG);
+
+	Check(SavePNG(WFilename, &PNGImage, PNG_LEVEL_DEFAULT) == APP_SUCCESS, "SavePNG", "returned an error");
+	Check(ReadFile(Filename, FileBytes) && FileBytes == PNG, "SavePNG", "file is not the EncodePNG() bytes");
+	remove(Filename);
+
+	Check(QueuePNG(WFilename, &PNGImage, PNG_LEVEL_DEFAULT) == APP_SUCCESS, "QueuePNG", "returned an error");
+	// the pixels are copied by QueuePNG(), changing them now must not change the file
+	memset(Image.Pixels.data(), 0, Image.Pixels.size());
+	Check(WaitPNG() == APP_SUCCESS, "QueuePNG", "WaitPNG() returned an error");
+	Check(ReadFile(Filename, FileBytes) && FileBytes == PNG, "QueuePNG", "file is not the EncodePNG() bytes");
+	remove(Filename);
+
+	// a file that can not be opened is reported by WaitPNG()
+	Image = MakeImage(8, 8, PNG_GREY8, PATTERN_RANDOM, 0);
+	PNGImage = GetPNGimage(Image);
+	Check(QueuePNG(L"PNGtest_no_such_directory/x.png", &PNGImage, PNG_LEVEL_DEFAULT) == APP_SUCCESS,
+		"QueuePNG", "returned an error for a bad path, it is reported by WaitPNG()");
+	Check(WaitPNG() == APPERR_FILEOPEN, "QueuePNG", "WaitPNG() did not report the bad path");
+	Check(WaitPNG() == APP_SUCCESS, "WaitPNG", "error was not cleared");
+	Check(SavePNG(L"PNGtest_no_such_directory/x.png", &PNGImage, PNG_LEVEL_DEFAULT) == APPERR_FILEOPEN,
+		"SavePNG", "did not report the bad path");
+}
+
+//*******************************************************************************
+//
+//  TestParameters
+//
+// Images the writer must reject
+//
+//*******************************************************************************
+static void TestParameters()
+{
+	TESTIMAGE Image = MakeImage(16, 4, PNG_GREY8, PATTERN_RANDOM, 0);
+	PNGIMAGE PNGImage = GetPNGimage(Image);
+	std::vector<uint8_t> PNG;
+
+	Check(EncodePNG(&PNGImage, PNG_LEVEL_MAX + 1, PNG) == APPERR_PARAMETER, "parameters", "level too large");
+	Check(EncodePNG(&PNGImage, -1, PNG) == APPERR_PARAMETER, "parameters", "level < 0");
+	PNGImage.Format = 16;
+	Check(EncodePNG(&PNGImage, PNG_LEVEL_DEFAULT, PNG) == APPERR_PARAMETER, "parameters", "bad format");
+	PNGImage = GetPNGimage(Image);
+	PNGImage.Stride = 15;
+	Check(EncodePNG(&PNGImage, PNG_LEVEL_DEFAULT, PNG) == APPERR_PARAMETER, "parameters", "stride < row bytes");
+	PNGImage = GetPNGimage(Image);
+	PNGImage.Xsize = 0;
+	Check(EncodePNG(&PNGImage, PNG_LEVEL_DEFAULT, PNG) == APPERR_PARAMETER, "parameters", "Xsize 0");
+	PNGImage = GetPNGimage(Image);
+	PNGImage.Pixels = NULL;
+	Check(EncodePNG(&PNGImage, PNG_LEVEL_DEFAULT, PNG) == APPERR_PARAMETER, "parameters", "no pixels");
+	Check(EncodePNG(NULL, PNG_LEVEL_DEFAULT, PNG) == APPERR_PARAMETER, "parameters", "no image");
+}
+
+int main()
+{
+	static const struct {
+		int Xsize;
+		int Ysize;
+	} Sizes[] = { { 1, 1 }, { 2, 3 }, { 7, 5 }, { 13, 9 }, { 64, 64 }, { 257, 131 } };
+	static const int Formats[] = { PNG_GREY1, PNG_GREY8, PNG_RGB24 };
+	static const char* PatternNames[] = { "random", "constant", "hramp", "vramp", "average", "edges", "sparse" };
+
+	for (int f = 0; f < 3; f++) {
+		for (size_t s = 0; s < sizeof(Sizes) / sizeof(Sizes[0]); s++) {
+			for (int p = 0; p < 7; p++) {
+				TestRoundTrip(MakeImage(Sizes[s].Xsize, Sizes[s].Ysize, Formats[f], p, 0), PatternNames[p]);
+			}
+			// rows that do not follow each other
+			TestRoundTrip(MakeImage(Sizes[s].Xsize, Sizes[s].Ysize, Formats[f], PATTERN_EDGES, 7), "stride");
+		}
+	}
+
+	// more than one 64K stored block, more than one deflate block of tokens
+	// and more than one IDAT chunk
+	TestRoundTrip(MakeImage(1024, 768, PNG_RGB24, PATTERN_RANDOM, 0), "large random");
+	TestRoundTrip(MakeImage(2048, 1024, PNG_GREY8, PATTERN_SPARSE, 0), "large sparse");
+	TestRoundTrip(MakeImage(4096, 2048, PNG_GREY1, PATTERN_SPARSE, 0), "large binary");
+
+	TestParameters();
+	TestFiles();
+
+	for (int Type = 0; Type < 5; Type++) {
+		char What[64];
+		snprintf(What, sizeof(What), "filter type %d was never used", Type);
+		Check(FilterCount[Type] > 0, "filters", What);
+	}
+
+	printf("%d checks, %d failed\n", NumChecks, NumFailed);
+	printf("rows by filter type: None %ld, Sub %ld, Up %ld, Average %ld, Paeth %ld\n",
+		FilterCount[0], FilterCount[1], FilterCount[2], FilterCount[3], FilterCount[4]);
+	return NumFailed == 0 ? 0 : 1;
+}